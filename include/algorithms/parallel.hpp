@@ -0,0 +1,169 @@
+/**
+ * @file parallel.hpp
+ * @brief Parallel sort, partition, scan and histogram with arena-backed temporaries
+ *
+ * This header defines a small set of data-parallel algorithms that run on a
+ * process-wide pool of worker threads. The calling thread takes part as worker
+ * zero and the call returns once every worker finished its share.
+ *
+ * Temporaries come from thread-local lazy StackAllocator arenas, one per worker,
+ * that live as long as their thread. Every call records a scope, allocates its
+ * buffers and unwinds the scope before returning, so after the first call of a
+ * given size the algorithms neither allocate from the heap nor commit memory.
+ * The arenas are created through `config::create_stack` under the name
+ * `algorithms`, so their capacity can be tuned with `ANVIL_ARENA_ALGORITHMS_*`
+ * and they show up in the allocator registry. All workers share that name, so
+ * the metrics exporter reports them as one summed series whose
+ * `anvil_allocator_instances` gauge is the number of workers that allocated.
+ *
+ * @note All functions in this module follow fail-fast design - programmer errors
+ *       trigger immediate abort with diagnostics.
+ *
+ * @note Calls from different threads are serialized on the shared pool. Callbacks
+ *       must not call back into this module.
+ */
+
+#ifndef ANVIL_ALGORITHMS_PARALLEL_HPP
+#define ANVIL_ALGORITHMS_PARALLEL_HPP
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <cstdint>
+
+namespace anvil::algorithms {
+
+/**
+ * @brief Predicate of `stable_partition`; may run concurrently on several workers.
+ */
+using Predicate = bool (*)(std::uint64_t value, void* context);
+
+/**
+ * @brief Default capacity of every worker's temporary arena, reserved but only committed when used.
+ */
+inline constexpr std::size_t DEFAULT_SCRATCH_CAPACITY = std::size_t(1) << 32;
+
+/**
+ * @brief Inputs shorter than this are processed by the calling thread alone.
+ */
+inline constexpr std::size_t SERIAL_CUTOFF = std::size_t(1) << 14;
+
+/**
+ * @brief Number of workers, the calling thread included.
+ */
+[[nodiscard]] std::size_t concurrency();
+
+/**
+ * @brief Resizes the worker pool.
+ *
+ * @pre `workers > 0`.
+ * @pre No algorithm is running.
+ *
+ * @post `concurrency() == workers`. Without a call the pool has `std::thread::hardware_concurrency()` workers.
+ *
+ * @param[in] workers   Number of workers, the calling thread included.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error       set_concurrency(const std::size_t workers);
+
+/**
+ * @brief Sorts unsigned integers in ascending order with a least significant digit radix sort.
+ *
+ * Eight bit digits are scattered stably in parallel; passes in which every key has the same digit are skipped.
+ *
+ * @pre `data != nullptr` unless `count == 0`.
+ *
+ * @post `data[0..count)` is sorted in ascending order.
+ *
+ * @param[in,out] data  Keys to sort.
+ * @param[in]     count Number of keys.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if the temporary buffer of `count` keys did not fit in the
+ *         calling thread's arena, in which case `data` is unchanged.
+ */
+[[nodiscard]] Error       radix_sort(std::uint32_t* const data, const std::size_t count);
+
+/**
+ * @brief Sorts unsigned integers in ascending order, see the 32 bit overload.
+ */
+[[nodiscard]] Error       radix_sort(std::uint64_t* const data, const std::size_t count);
+
+/**
+ * @brief Sorts doubles in ascending order with a stable merge sort.
+ *
+ * Every worker sorts its slice with a bottom-up merge sort, then slices are merged pairwise in parallel.
+ *
+ * @pre `data != nullptr` unless `count == 0`.
+ * @pre `data` holds no NaN.
+ *
+ * @post `data[0..count)` is sorted in ascending order; equal values keep their relative order.
+ *
+ * @param[in,out] data  Values to sort.
+ * @param[in]     count Number of values.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if a temporary buffer did not fit in an arena, in which case the
+ *         content of `data` is unspecified but still a permutation of the input.
+ */
+[[nodiscard]] Error       merge_sort(double* const data, const std::size_t count);
+
+/**
+ * @brief Moves the values satisfying `predicate` in front of the others, keeping the order within both groups.
+ *
+ * @pre `data != nullptr` unless `count == 0`.
+ * @pre `predicate != nullptr`.
+ * @pre `split != nullptr`.
+ *
+ * @post `predicate` was called exactly once per value.
+ * @post `data[0..*split)` holds the values satisfying `predicate` and `data[*split..count)` the others.
+ *
+ * @param[in,out] data      Values to partition.
+ * @param[in]     count     Number of values.
+ * @param[in]     predicate Predicate selecting the values to move to the front.
+ * @param[in]     context   Passed to every call of `predicate`.
+ * @param[out]    split     Number of values satisfying `predicate`.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if a temporary buffer did not fit in an arena, in which case
+ *         `data` is unchanged.
+ */
+[[nodiscard]] Error       stable_partition(std::uint64_t* const data, const std::size_t count, Predicate predicate,
+                                           void* context, std::size_t* const split);
+
+/**
+ * @brief Writes the exclusive prefix sums of `input`, starting at `init`, to `output`.
+ *
+ * @pre `input != nullptr` and `output != nullptr` unless `count == 0`.
+ * @pre `input` and `output` are the same array or do not overlap.
+ *
+ * @post `output[i] == init + input[0] + ... + input[i - 1]`, wrapping modulo 2^64.
+ *
+ * @param[in]  input    Values to sum.
+ * @param[out] output   Prefix sums; may be `input`.
+ * @param[in]  count    Number of values.
+ * @param[in]  init     Value of `output[0]`.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if the per-worker sums did not fit in the calling thread's arena.
+ */
+[[nodiscard]] Error       exclusive_scan(const std::uint64_t* const input, std::uint64_t* const output,
+                                         const std::size_t count, const std::uint64_t init);
+
+/**
+ * @brief Counts how often every value in [0, bins) occurs in `data`.
+ *
+ * @pre `data != nullptr` unless `count == 0`.
+ * @pre `counts != nullptr`.
+ * @pre `bins > 0`.
+ *
+ * @post `counts[b]` is the number of values equal to `b`; values of at least `bins` are not counted.
+ *
+ * @param[in]  data     Values to count.
+ * @param[in]  count    Number of values.
+ * @param[out] counts   Array of `bins` counters, overwritten.
+ * @param[in]  bins     Number of counters.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if the per-worker counters did not fit in the calling thread's arena.
+ */
+[[nodiscard]] Error       histogram(const std::uint32_t* const data, const std::size_t count,
+                                    std::uint64_t* const counts, const std::size_t bins);
+
+} // namespace anvil::algorithms
+
+#endif // ANVIL_ALGORITHMS_PARALLEL_HPP
@@ -0,0 +1,97 @@
+/**
+ * @file search.hpp
+ * @brief Static search tables laid out for the cache inside a ScratchAllocator
+ *
+ * This header defines read-only lookup tables built once from sorted keys and
+ * then searched many times, typically rebuilt every epoch. Instead of a sorted
+ * array, whose binary search touches a new cache line on almost every step,
+ * the keys are stored in one of two cache-friendly orders:
+ *
+ * Layout     | Description
+ * ---------- | ---------------------------------------------------------------------
+ * Eytzinger  | Breadth-first order of the implicit binary search tree; the search is
+ *            | branchless and prefetches the cache line holding the node's
+ *            | descendants three levels down.
+ * BTree      | Blocks of eight keys, one cache line each, forming a static nine-ary
+ *            | tree; a block is searched with two AVX2 compares.
+ *
+ * A table is a single contiguous region carved from the arena: a header followed
+ * by the keys and their ranks, addressed by offsets only. It therefore lives and
+ * dies with the arena's epoch, and can be copied, shared or persisted byte for
+ * byte to any 64 byte aligned address.
+ *
+ * @note All functions in this module follow fail-fast design - programmer errors
+ *       trigger immediate abort with diagnostics.
+ */
+
+#ifndef ANVIL_ALGORITHMS_SEARCH_HPP
+#define ANVIL_ALGORITHMS_SEARCH_HPP
+#include "memory/constants.hpp"
+#include "memory/scratch_allocator.hpp"
+#include <cstdint>
+
+namespace anvil::algorithms {
+
+/**
+ * @brief Order in which a search table stores its keys.
+ */
+enum class SearchLayout : std::uint32_t {
+        Eytzinger = 0,
+        BTree     = 1,
+};
+
+/**
+ * @brief Opaque search table; lives in the arena it was built in.
+ */
+struct SearchTable;
+
+/**
+ * @brief Builds a search table over `keys` inside `arena`.
+ *
+ * @pre `arena != nullptr`.
+ * @pre `keys != nullptr` unless `count == 0`.
+ * @pre `keys` is sorted in ascending order; duplicates are allowed.
+ *
+ * @post The table does not refer to `keys`, which may be freed.
+ *
+ * @param[in] arena     Arena holding the table until its next reset.
+ * @param[in] keys      Sorted keys.
+ * @param[in] count     Number of keys.
+ * @param[in] layout    Order of the keys in the table.
+ *
+ * @return The table, or `nullptr` if it did not fit in the arena.
+ */
+[[nodiscard]] const SearchTable* build_search_table(memory::scratch_allocator::ScratchAllocator* const arena,
+                                                    const std::uint64_t* const keys, const std::size_t count,
+                                                    const SearchLayout layout);
+
+/**
+ * @brief Finds the first key not less than `key`.
+ *
+ * @pre `table != nullptr`.
+ *
+ * @param[in] table     Table to search.
+ * @param[in] key       Key to look up.
+ *
+ * @return Index of that key in the sorted input of `build_search_table`, or the number of keys if every key
+ *         is less than `key`; the same result as `std::lower_bound` on the input.
+ */
+[[nodiscard]] std::size_t        lower_bound(const SearchTable* const table, const std::uint64_t key);
+
+/**
+ * @brief Number of keys in `table`.
+ *
+ * @pre `table != nullptr`.
+ */
+[[nodiscard]] std::size_t        search_table_count(const SearchTable* const table);
+
+/**
+ * @brief Size in bytes of the region holding `table`, header included.
+ *
+ * @pre `table != nullptr`.
+ */
+[[nodiscard]] std::size_t        search_table_bytes(const SearchTable* const table);
+
+} // namespace anvil::algorithms
+
+#endif // ANVIL_ALGORITHMS_SEARCH_HPP
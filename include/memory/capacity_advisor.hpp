@@ -0,0 +1,133 @@
+/**
+ * @file capacity_advisor.hpp
+ * @brief Capacity right-sizing advisor based on observed allocator peaks
+ *
+ * This header defines an advisor that keeps a sliding window of the high-water
+ * marks an allocator reaches between resets and inside recorded scopes. From the
+ * window it derives percentiles and recommends a capacity and a commit chunk size.
+ *
+ * An advisor is attached to an allocator with the allocator's `attach_advisor`
+ * operation; the allocator then reports its peaks on reset and unwind, and the
+ * recommendation becomes visible through the allocator's `stats`. In adaptive mode
+ * a lazily committed allocator additionally applies the recommendation on every
+ * reset by adopting the recommended commit chunk and releasing committed pages
+ * beyond the recommended capacity.
+ *
+ * @note All functions in this module follow fail-fast design - programmer errors
+ *       trigger immediate abort with diagnostics.
+ *
+ * @note Advisors are **NOT** thread safe, they share the threading rules of the
+ *       allocator they are attached to.
+ */
+
+#ifndef ANVIL_MEMORY_CAPACITY_ADVISOR_HPP
+#define ANVIL_MEMORY_CAPACITY_ADVISOR_HPP
+#include "constants.hpp"
+#include "error.hpp"
+
+namespace anvil::memory::capacity_advisor {
+struct CapacityAdvisor;
+
+enum class Mode : std::size_t {
+        Advisory = 1u << 0, ///< Only report recommendations.
+        Adaptive = 1u << 1, ///< Report and apply recommendations to lazily committed allocators on reset.
+};
+
+/**
+ * @brief Recommendation derived from the current observation window.
+ *
+ * Field           | Description
+ * --------------- | --------------------------------------------------------------------------
+ * capacity        | Suggested capacity: p99 of per-reset peaks plus 25% headroom, page rounded
+ * commit_chunk    | Suggested commit chunk: median scope peak rounded to a power of two
+ * reset_p50       | Median per-reset high-water mark
+ * reset_p99       | 99th percentile per-reset high-water mark
+ * reset_max       | Largest per-reset high-water mark in the window
+ * scope_p50       | Median per-scope high-water mark
+ * scope_p99       | 99th percentile per-scope high-water mark
+ * observations    | Number of per-reset observations in the window
+ *
+ * @note All fields are zero until at least one reset has been observed.
+ */
+struct Recommendation {
+        std::size_t capacity;
+        std::size_t commit_chunk;
+        std::size_t reset_p50;
+        std::size_t reset_p99;
+        std::size_t reset_max;
+        std::size_t scope_p50;
+        std::size_t scope_p99;
+        std::size_t observations;
+};
+
+/**
+ * @brief Creates an advisor with a sliding window of `window` observations.
+ *
+ * @pre `window > 0`.
+ * @pre `mode == Mode::Advisory || mode == Mode::Adaptive`.
+ *
+ * @post The advisor holds no observations.
+ *
+ * @param[in] window    Number of most recent per-reset and per-scope peaks that are retained.
+ * @param[in] mode      Whether attached allocators apply the recommendation on reset.
+ *
+ * @return Pointer to a CapacityAdvisor, or `nullptr` if its memory could not be mapped.
+ */
+[[nodiscard]] CapacityAdvisor* create(const std::size_t window, const Mode mode);
+
+/**
+ * @brief Releases an advisor.
+ *
+ * @pre `advisor != nullptr`.
+ * @pre `*advisor != nullptr`.
+ * @pre No allocator has the advisor attached.
+ *
+ * @post `*advisor == nullptr`.
+ *
+ * @param[in,out] advisor   Reference to the advisor that should be released.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error            destroy(CapacityAdvisor** advisor);
+
+/**
+ * @brief Records the high-water mark an allocator reached before a reset.
+ *
+ * @pre `advisor != nullptr`.
+ *
+ * @param[in] advisor       Advisor that should record the observation.
+ * @param[in] high_water    Peak number of allocated bytes since the previous reset.
+ */
+void                           observe_reset(CapacityAdvisor* const advisor, const std::size_t high_water);
+
+/**
+ * @brief Records the high-water mark of a recorded scope, relative to the scope's start.
+ *
+ * @pre `advisor != nullptr`.
+ *
+ * @param[in] advisor       Advisor that should record the observation.
+ * @param[in] high_water    Peak number of bytes allocated inside the scope, nested scopes included.
+ */
+void                           observe_scope(CapacityAdvisor* const advisor, const std::size_t high_water);
+
+/**
+ * @brief Computes a recommendation from the current window.
+ *
+ * @pre `advisor != nullptr`.
+ *
+ * @param[in] advisor       Advisor to query.
+ *
+ * @return Recommendation for the observed workload.
+ */
+[[nodiscard]] Recommendation   recommend(CapacityAdvisor* const advisor);
+
+/**
+ * @brief Mode the advisor was created with.
+ *
+ * @pre `advisor != nullptr`.
+ */
+[[nodiscard]] Mode             mode(const CapacityAdvisor* const advisor);
+
+} // namespace anvil::memory::capacity_advisor
+
+#endif // ANVIL_MEMORY_CAPACITY_ADVISOR_HPP
@@ -0,0 +1,114 @@
+/**
+ * @file config.hpp
+ * @brief Runtime tuning of allocators through ANVIL_* environment variables and a config file
+ *
+ * This header defines a configuration layer that lets a deployment override the
+ * capacity, alignment, strategy, commit chunk and mapping flags of named arenas
+ * without rebuilding. The configuration is read once, on the first call to `load`
+ * or `resolve`, and is immutable afterwards. It is only consulted when an arena is
+ * created, so allocation, reset, record and unwind never touch it.
+ *
+ * Sources, later ones taking precedence:
+ *
+ * Source                                    | Scope
+ * ----------------------------------------- | ------------------------------------------------
+ * Values passed by the call site            | The arena being created
+ * Keys before the first section of the file | Every arena
+ * Keys in a `[name]` section of the file    | The arena called `name`
+ * `ANVIL_<KEY>`                             | Every arena
+ * `ANVIL_ARENA_<NAME>_<KEY>`                | The arena called `name`
+ *
+ * The file is the one named by `ANVIL_CONFIG`; without it only the environment is read.
+ * It holds `key = value` lines, `[name]` section headers and `#` comments. Arena names
+ * are compared after upper-casing them and replacing every character that is not a
+ * letter or a digit by `_`, so `[frame-scratch]` and `ANVIL_ARENA_FRAME_SCRATCH_*` match
+ * the arena `frame-scratch`.
+ *
+ * Key          | Value
+ * ------------ | ----------------------------------------------------------------------
+ * capacity     | Bytes, with an optional K, M or G suffix (powers of 1024)
+ * alignment    | Power of two in [MIN_ALIGNMENT, MAX_ALIGNMENT]
+ * strategy     | `eager`, `lazy` or `guarded`; ignored by scratch allocators
+ * commit_chunk | Bytes with an optional suffix; ignored by eager and scratch allocators
+ * mapping      | `none`, or `dontfork`, `wipeonfork` and `dontdump` joined by `,` or `|`
+ *
+ * @note Malformed entries are skipped and reported through the result of `load`; a bad
+ *       deployment setting never aborts the process.
+ */
+
+#ifndef ANVIL_MEMORY_CONFIG_HPP
+#define ANVIL_MEMORY_CONFIG_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include "scratch_allocator.hpp"
+#include "stack_allocator.hpp"
+
+namespace anvil::memory::config {
+
+/**
+ * @brief Creation parameters of an arena.
+ *
+ * Field        | Description
+ * ------------ | -----------------------------------------------------------------
+ * capacity     | Usable bytes
+ * alignment    | Alignment of every allocation
+ * strategy     | Commit strategy of stack allocators
+ * commit_chunk | Minimum bytes committed at once by lazy and guarded stack allocators
+ * mapping      | Fork and core dump treatment of the arena
+ */
+struct ArenaConfig {
+        std::size_t        capacity;
+        std::size_t        alignment;
+        AllocationStrategy strategy;
+        std::size_t        commit_chunk;
+        MappingFlags       mapping;
+};
+
+/**
+ * @brief Reads the configuration on first use and reports how that went.
+ *
+ * Thread safe; every call after the first returns the first call's result without reading anything.
+ *
+ * @return ERR_SUCCESS, ERR_IO_FAILURE if `ANVIL_CONFIG` names a file that cannot be read, or
+ *         ERR_INVALID_CONFIG if an entry was malformed. Well-formed entries are applied in every case.
+ */
+[[nodiscard]] Error                                load();
+
+/**
+ * @brief Applies the configured overrides for the arena called `name` to the call site's parameters.
+ *
+ * @pre `name != nullptr`.
+ *
+ * @post Fields without an override keep their value from `defaults`.
+ *
+ * @param[in] name          Name of the arena.
+ * @param[in] defaults      Parameters the call site would use without a configuration.
+ *
+ * @return Parameters to create the arena with.
+ */
+[[nodiscard]] ArenaConfig                          resolve(const char* name, const ArenaConfig& defaults);
+
+/**
+ * @brief Creates a ScratchAllocator with the resolved parameters of `name` and registers it under that name.
+ *
+ * @pre Same as `resolve`; `strategy` and `commit_chunk` are ignored.
+ *
+ * @return Pointer to a registered ScratchAllocator, or `nullptr` if it could not be created.
+ */
+[[nodiscard]] scratch_allocator::ScratchAllocator* create_scratch(const char* name, const ArenaConfig& defaults);
+
+/**
+ * @brief Creates a StackAllocator with the resolved parameters of `name` and registers it under that name.
+ *
+ * @pre Same as `resolve`.
+ * @pre `defaults.commit_chunk > 0`, usually DEFAULT_COMMIT_CHUNK.
+ *
+ * @post Lazy and guarded allocators commit at least the resolved `commit_chunk` bytes at a time.
+ *
+ * @return Pointer to a registered StackAllocator, or `nullptr` if it could not be created.
+ */
+[[nodiscard]] stack_allocator::StackAllocator*     create_stack(const char* name, const ArenaConfig& defaults);
+
+} // namespace anvil::memory::config
+
+#endif // ANVIL_MEMORY_CONFIG_HPP
@@ -28,13 +28,40 @@
 namespace anvil::memory {
 
 enum class AllocationStrategy : std::size_t {
-        Eager = 1u << 0,
-        Lazy  = 1u << 1,
+        Eager   = 1u << 0,
+        Lazy    = 1u << 1,
+        Guarded = 1u << 2, ///< Lazy, and page faults on the uncommitted tail commit it (see `alloc_unchecked`).
 };
 
+/// How an allocator's arena is treated by fork(2) and core dumps; flags combine with `|`.
+enum class MappingFlags : std::size_t {
+        None       = 0,
+        DontFork   = 1u << 0, ///< Child processes do not inherit the arena (MADV_DONTFORK).
+        WipeOnFork = 1u << 1, ///< Child processes see the arena zero-filled (MADV_WIPEONFORK).
+        DontDump   = 1u << 2, ///< The arena is left out of core dumps (MADV_DONTDUMP).
+};
+
+inline constexpr MappingFlags operator|(const MappingFlags lhs, const MappingFlags rhs) noexcept {
+        return static_cast<MappingFlags>(static_cast<std::size_t>(lhs) | static_cast<std::size_t>(rhs));
+}
+
+inline constexpr MappingFlags operator&(const MappingFlags lhs, const MappingFlags rhs) noexcept {
+        return static_cast<MappingFlags>(static_cast<std::size_t>(lhs) & static_cast<std::size_t>(rhs));
+}
+
+inline constexpr bool has_flag(const MappingFlags flags, const MappingFlags flag) noexcept {
+        return (flags & flag) == flag;
+}
+
+inline constexpr std::size_t MAPPING_FLAGS_MASK = 0x7;
+
 inline constexpr std::size_t MAX_ALIGNMENT   = 1 << 11; // alignment is capped at half a page.
 inline constexpr std::size_t MIN_ALIGNMENT   = 1;
 inline constexpr std::size_t MAX_STACK_DEPTH = 64;
+inline constexpr std::size_t NO_BUDGET       = ~std::size_t{0}; // scope budget that never binds.
+
+inline constexpr std::size_t DEFAULT_COMMIT_CHUNK = 1 << 16; // bytes committed at once by lazy allocators.
+inline constexpr std::size_t GUARD_REGION_SIZE    = 1 << 16; // never committed bytes past a guarded arena.
 
 } // namespace anvil::memory
 
@@ -0,0 +1,163 @@
+/**
+ * @file deferred_allocator.hpp
+ * @brief Scratch arena handle that maps its memory on first allocation
+ *
+ * This header defines a linear allocator whose state fits in a handle of a few
+ * words, meant to be embedded in per-connection or per-request structures of
+ * which many never allocate. Creating a handle only records the configuration:
+ * no memory is mapped and no system call is made. The mapping is created by the
+ * first allocation, and destroying a handle that never allocated is free.
+ *
+ * An unmapped handle has a limit of zero, so its first allocation fails the same
+ * capacity check as an exhausted arena and lands on the slow path, which maps the
+ * arena and retries. The hot path is the one of the scratch allocator and gains
+ * no branch for the deferral.
+ *
+ * Once mapped, the handle behaves like a scratch allocator of the same capacity
+ * and alignment: allocations bump a watermark and `reset` releases them in bulk.
+ *
+ * @note All functions in this module follow fail-fast design - programmer errors
+ *       trigger immediate abort with diagnostics.
+ *
+ * @note The deferred allocators are **NOT** thread safe and should not be used
+ *       in a concurrent environment without proper synchronization.
+ */
+
+#ifndef ANVIL_MEMORY_DEFERRED_ALLOCATOR_HPP
+#define ANVIL_MEMORY_DEFERRED_ALLOCATOR_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include "result.hpp"
+#include "stats.hpp"
+#include <cstdint>
+
+namespace anvil::memory::deferred_allocator {
+
+/**
+ * @brief Handle of a deferred arena, owned by value by the caller.
+ *
+ * The fields are only read and written by this module; they are public so the handle can be embedded
+ * without an allocation of its own.
+ *
+ * Field            | Description
+ * ---------------- | ---------------------------------------------------------------------
+ * base             | Start of the usable region, zero until the arena is mapped
+ * allocated        | Current number of bytes allocated
+ * limit            | Usable bytes, zero until the arena is mapped
+ * capacity         | Usable bytes the mapping is created with
+ * alignment        | Alignment of the mapping
+ * offset           | Bytes from the address returned by the mapping to `base`
+ * mapping          | Fork and core dump treatment applied when the arena is mapped
+ * reset_count      | Number of resets since creation
+ * exhaustion_count | Number of allocations that ran out of capacity
+ */
+struct DeferredAllocator {
+        std::uintptr_t base;
+        std::size_t    allocated;
+        std::size_t    limit;
+        std::size_t    capacity;
+        std::uint32_t  alignment;
+        std::uint32_t  offset;
+        MappingFlags   mapping;
+        std::size_t    reset_count;
+        std::size_t    exhaustion_count;
+};
+
+/**
+ * @brief Creates an unmapped handle; makes no system call and no allocation.
+ *
+ * @pre `capacity > 0`.
+ * @pre `alignment` is a power of two.
+ * @pre `MIN_ALIGNMENT <= alignment <= MAX_ALIGNMENT`.
+ *
+ * @post `mapped(&handle) == false`.
+ *
+ * @param[in] capacity      The amount of memory mapped by the first allocation.
+ * @param[in] alignment     The alignment of the mapping.
+ * @param[in] mapping       Fork and core dump treatment of the arena once mapped; anything but
+ *                          `MappingFlags::None` maps one more page so the arena can start on a page boundary.
+ *
+ * @return The handle.
+ */
+[[nodiscard]] DeferredAllocator create(const std::size_t capacity, const std::size_t alignment,
+                                       const MappingFlags mapping = MappingFlags::None);
+
+/**
+ * @brief Unmaps the arena if it was mapped and returns the handle to its unmapped state.
+ *
+ * @pre `handle != nullptr`.
+ *
+ * @post `mapped(handle) == false` on success; the handle may be used again and maps a new arena on demand.
+ * @post A handle that was never mapped is released without a system call.
+ *
+ * @param[in,out] handle    Pointer to the handle.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error             destroy(DeferredAllocator* const handle);
+
+/**
+ * @brief Allocates memory, mapping the arena first if this is the handle's first allocation.
+ *
+ * @pre `handle != nullptr`.
+ * @pre `allocation_size > 0`.
+ * @pre `alignment` is a power of two.
+ * @pre `MIN_ALIGNMENT <= alignment <= MAX_ALIGNMENT`.
+ *
+ * @param[in,out] handle          Pointer to the handle.
+ * @param[in]     allocation_size Number of bytes to allocate.
+ * @param[in]     alignment       Alignment of the allocation.
+ *
+ * @post An allocation larger than the capacity fails without mapping the arena.
+ *
+ * @return Pointer to the allocation, or `nullptr` if the arena is exhausted or could not be mapped.
+ */
+[[nodiscard]] void*             alloc(DeferredAllocator* const handle, const std::size_t allocation_size,
+                                      const std::size_t alignment);
+
+/**
+ * @brief Allocates memory like `alloc` and reports why an allocation failed.
+ *
+ * @pre Same as `alloc`.
+ *
+ * @return The allocation and ERR_SUCCESS; or `nullptr` and ERR_OUT_OF_MEMORY if the arena is exhausted or could
+ *         not be mapped, or the error of applying the mapping flags.
+ */
+[[nodiscard]] AllocResult       try_alloc(DeferredAllocator* const handle, const std::size_t allocation_size,
+                                          const std::size_t alignment);
+
+/**
+ * @brief Releases all allocations; the arena stays mapped.
+ *
+ * @pre `handle != nullptr`.
+ *
+ * @param[in,out] handle    Pointer to the handle.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error             reset(DeferredAllocator* const handle);
+
+/**
+ * @brief Whether the handle's arena has been mapped.
+ *
+ * @pre `handle != nullptr`.
+ */
+[[nodiscard]] bool              mapped(const DeferredAllocator* const handle);
+
+/**
+ * @brief Retrieves usage statistics; `committed` is zero until the arena is mapped.
+ *
+ * Allocations only grow the watermark until reset, so `peak`, the highest watermark since the last reset, is
+ * `allocated`.
+ *
+ * @pre `handle != nullptr`.
+ *
+ * @param[in] handle    Pointer to the handle.
+ *
+ * @return Snapshot of the handle's counters.
+ */
+[[nodiscard]] AllocatorStats    stats(const DeferredAllocator* const handle);
+
+} // namespace anvil::memory::deferred_allocator
+
+#endif // ANVIL_MEMORY_DEFERRED_ALLOCATOR_HPP
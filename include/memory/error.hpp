@@ -13,6 +13,7 @@ enum class Domain : std::uint8_t {
         Memory = 1,
         State  = 2,
         Value  = 3,
+        Io     = 4,
 };
 
 enum class Severity : std::uint8_t {
@@ -51,8 +52,13 @@ inline constexpr Error ERR_OUT_OF_MEMORY                = make_error(Domain::Mem
 inline constexpr Error ERR_MEMORY_PERMISSION_CHANGE     = make_error(Domain::Memory, Severity::Failure, 0x20);
 inline constexpr Error ERR_MEMORY_DEALLOCATION          = make_error(Domain::Memory, Severity::Failure, 0x30);
 inline constexpr Error ERR_STACK_OVERFLOW               = make_error(Domain::Memory, Severity::Failure, 0x40);
+inline constexpr Error ERR_MEMORY_ADVICE                = make_error(Domain::Memory, Severity::Failure, 0x50);
+inline constexpr Error ERR_FAULT_HANDLER                = make_error(Domain::Memory, Severity::Failure, 0x60);
+inline constexpr Error ERR_BUDGET_EXHAUSTED             = make_error(Domain::Memory, Severity::Failure, 0x70);
+inline constexpr Error ERR_INVALID_CONFIG               = make_error(Domain::Value, Severity::Failure, 0x10);
+inline constexpr Error ERR_IO_FAILURE                   = make_error(Domain::Io, Severity::Failure, 0x10);
 
-inline constexpr std::array<Descriptor, 11> DESCRIPTORS = {
+inline constexpr std::array<Descriptor, 16> DESCRIPTORS = {
     Descriptor{ERR_SUCCESS, Domain::None, Severity::Success, "Success"},
     Descriptor{INV_NULL_POINTER, Domain::Memory, Severity::Fatal, "Null pointer violation"},
     Descriptor{INV_ZERO_SIZE, Domain::Memory, Severity::Fatal, "Size must be positive"},
@@ -65,7 +71,15 @@ inline constexpr std::array<Descriptor, 11> DESCRIPTORS = {
                "Failed to change permissions on virutal and physical memory"},
     Descriptor{ERR_MEMORY_DEALLOCATION, Domain::Memory, Severity::Failure,
                "Failed to properly deallocate virtual or physical memory"},
-    Descriptor{ERR_STACK_OVERFLOW, Domain::Memory, Severity::Failure, "Stack exeeded it's maximum depth of 64"}};
+    Descriptor{ERR_STACK_OVERFLOW, Domain::Memory, Severity::Failure, "Stack exeeded it's maximum depth of 64"},
+    Descriptor{ERR_MEMORY_ADVICE, Domain::Memory, Severity::Failure,
+               "Failed to apply fork or core dump advice to a memory mapping"},
+    Descriptor{ERR_FAULT_HANDLER, Domain::Memory, Severity::Failure,
+               "Failed to install the fault handler or to register a guarded arena with it"},
+    Descriptor{ERR_BUDGET_EXHAUSTED, Domain::Memory, Severity::Failure,
+               "Allocation exceeds the byte budget of the enclosing scope"},
+    Descriptor{ERR_INVALID_CONFIG, Domain::Value, Severity::Failure, "Malformed entry in the runtime configuration"},
+    Descriptor{ERR_IO_FAILURE, Domain::Io, Severity::Failure, "Failed to read or write an external resource"}};
 
 constexpr Domain error_domain(Error err) noexcept {
         return static_cast<Domain>((err >> DOMAIN_SHIFT) & DOMAIN_MASK);
@@ -146,6 +160,11 @@ using ErrorDomain     = anvil::error::Domain;
 using ErrorSeverity   = anvil::error::Severity;
 using ErrorDescriptor = anvil::error::Descriptor;
 
+using anvil::error::ERR_IO_FAILURE;
+using anvil::error::ERR_MEMORY_ADVICE;
+using anvil::error::ERR_FAULT_HANDLER;
+using anvil::error::ERR_BUDGET_EXHAUSTED;
+using anvil::error::ERR_INVALID_CONFIG;
 using anvil::error::ERR_MEMORY_DEALLOCATION;
 using anvil::error::ERR_MEMORY_PERMISSION_CHANGE;
 using anvil::error::ERR_OUT_OF_MEMORY;
@@ -161,6 +180,7 @@ using anvil::error::INV_ZERO_SIZE;
 static inline constexpr ErrorDomain   ERR_DOMAIN_MEMORY  = ErrorDomain::Memory;
 static inline constexpr ErrorDomain   ERR_DOMAIN_STATE   = ErrorDomain::State;
 static inline constexpr ErrorDomain   ERR_DOMAIN_VALUE   = ErrorDomain::Value;
+static inline constexpr ErrorDomain   ERR_DOMAIN_IO      = ErrorDomain::Io;
 
 static inline constexpr ErrorSeverity ERR_SEVERITY_ERROR = ErrorSeverity::Failure;
 static inline constexpr ErrorSeverity ERR_SEVERITY_FATAL = ErrorSeverity::Fatal;
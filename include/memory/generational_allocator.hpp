@@ -0,0 +1,229 @@
+/**
+ * @file generational_allocator.hpp
+ * @brief Two-generation arena for per-frame objects, a few of which survive
+ *
+ * This header defines a generational allocator built from scratch arenas. New
+ * objects are bump allocated from a young arena that is reset at the end of every
+ * frame. Objects that must outlive the frame are promoted: copied into an old
+ * arena before the reset. The old generation is itself a pair of scratch arenas
+ * used as semispaces, so it is compacted by evacuation: the live objects are
+ * copied into the empty semispace and the other one is reset as a whole.
+ *
+ * Every copy records a forwarding entry from the old address to the new one.
+ * References that were not updated while tracing can be translated with `forward`
+ * until the next `alloc`, which may reuse the young addresses, or the next
+ * `advance` or `compact`.
+ *
+ * Copies are rounded up to whole multiples of the alignment, so evacuating the
+ * live objects of one semispace into the other always fits and never fails.
+ *
+ * A frame looks like this:
+ *
+ * @code
+ * // during the frame
+ * Node* node = static_cast<Node*>(alloc(allocator, sizeof(Node), alignof(Node)));
+ * // at its end, promote what survives from the tracer and reset the young arena
+ * advance(allocator, [](GenerationalAllocator* a, void* roots) { ... promote(a, node, sizeof(Node)) ... }, roots);
+ * @endcode
+ *
+ * @note All functions in this module follow fail-fast design - programmer errors
+ *       trigger immediate abort with diagnostics.
+ *
+ * @note The generational allocators are **NOT** thread safe and should not be used
+ *       in a concurrent environment without proper synchronization.
+ */
+
+#ifndef ANVIL_MEMORY_GENERATIONAL_ALLOCATOR_HPP
+#define ANVIL_MEMORY_GENERATIONAL_ALLOCATOR_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include "stats.hpp"
+
+namespace anvil::memory::generational_allocator {
+struct GenerationalAllocator;
+
+/**
+ * @brief Marks the live objects by calling `promote` on each of them and storing the returned addresses.
+ */
+using Tracer = void (*)(GenerationalAllocator* allocator, void* context);
+
+/**
+ * @brief Usage of both generations and the volume of copying.
+ *
+ * Field            | Description
+ * ---------------- | ------------------------------------------------------------------------
+ * young            | Statistics of the young arena
+ * old              | Statistics of the old semispace in use
+ * promoted_count   | Objects copied out of the young arena since creation
+ * promoted_bytes   | Bytes copied out of the young arena since creation
+ * evacuated_count  | Old objects copied by compactions since creation
+ * evacuated_bytes  | Bytes copied by compactions since creation
+ * compaction_count | Number of compactions since creation
+ */
+struct GenerationalStats {
+        AllocatorStats young;
+        AllocatorStats old;
+        std::size_t    promoted_count;
+        std::size_t    promoted_bytes;
+        std::size_t    evacuated_count;
+        std::size_t    evacuated_bytes;
+        std::size_t    compaction_count;
+};
+
+/**
+ * @brief Creates a generational allocator.
+ *
+ * @pre `young_capacity > 0`.
+ * @pre `old_capacity > 0`.
+ * @pre `alignment` is a power of two.
+ * @pre `MIN_ALIGNMENT <= alignment <= MAX_ALIGNMENT`.
+ *
+ * @post The young arena manages `young_capacity` bytes and each of the two old semispaces `old_capacity` bytes.
+ * @post Promoted and evacuated copies are aligned to `alignment`.
+ * @post A fourth scratch arena of 40 bytes per `alignment` bytes of `old_capacity` holds the forwarding entries;
+ *       its pages are only touched as entries are made.
+ *
+ * @param[in] young_capacity    Capacity of the young arena.
+ * @param[in] old_capacity      Capacity of each old semispace, the most the old generation can hold.
+ * @param[in] alignment         Alignment of the arenas and of every copy.
+ * @param[in] mapping           Fork and core dump treatment of all four arenas.
+ *
+ * @return Pointer to a GenerationalAllocator, or `nullptr` if an arena could not be created.
+ */
+[[nodiscard]] GenerationalAllocator* create(const std::size_t young_capacity, const std::size_t old_capacity,
+                                            const std::size_t alignment,
+                                            const MappingFlags mapping = MappingFlags::None);
+
+/**
+ * @brief Destroys a generational allocator and all four of its arenas.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `*allocator != nullptr`.
+ *
+ * @post `*allocator == nullptr` on success.
+ *
+ * @param[in,out] allocator Double pointer to the allocator.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error                  destroy(GenerationalAllocator** allocator);
+
+/**
+ * @brief Allocates from the young arena.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `allocation_size > 0`.
+ * @pre `alignment` is a power of two.
+ * @pre `MIN_ALIGNMENT <= alignment <= MAX_ALIGNMENT`.
+ *
+ * @post The memory is valid until the next `advance`, unless the object is promoted.
+ *
+ * @param[in] allocator         Pointer to the allocator.
+ * @param[in] allocation_size   Number of bytes to allocate.
+ * @param[in] alignment         Alignment of the allocation.
+ *
+ * @return Pointer to the allocation, or `nullptr` if the young arena is exhausted.
+ */
+[[nodiscard]] void*                  alloc(GenerationalAllocator* const allocator, const std::size_t allocation_size,
+                                           const std::size_t alignment);
+
+/**
+ * @brief Copies an object into the old generation and records where it went.
+ *
+ * Outside of `compact`, an object in the young arena is copied into the old generation. While `compact` runs,
+ * an object in the semispace being evacuated is copied instead, and young objects are left for the next
+ * `advance`. Any other address, an object that already lives in the current old semispace for instance, is
+ * returned as it is.
+ *
+ * Promoting an object twice, or an address inside an object already copied, returns the existing copy, so a
+ * tracer can promote whatever it reaches without keeping its own visited set.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `ptr != nullptr`.
+ * @pre `size > 0`.
+ * @pre `[ptr, ptr + size)` is one object allocated from this allocator.
+ *
+ * @param[in] allocator Pointer to the allocator.
+ * @param[in] ptr       Start of the object.
+ * @param[in] size      Size of the object in bytes.
+ *
+ * @return Address of the object in the old generation, or `nullptr` if the old generation is full.
+ */
+[[nodiscard]] void*                  promote(GenerationalAllocator* const allocator, void* const ptr,
+                                             const std::size_t size);
+
+/**
+ * @brief Translates an address through the forwarding entries of the last `advance` or `compact`.
+ *
+ * The entries are dropped by the next `alloc`, since new objects may take the addresses of promoted ones.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @param[in] allocator Pointer to the allocator.
+ * @param[in] ptr       Any address; interior addresses of copied objects are translated as well.
+ *
+ * @return The new address if `ptr` lies in an object copied since the last `advance` or `compact` began and
+ *         nothing was allocated since, otherwise `ptr`.
+ */
+[[nodiscard]] void*                  forward(const GenerationalAllocator* const allocator, void* const ptr);
+
+/**
+ * @brief Ends a frame: clears the forwarding entries, lets `tracer` promote the survivors, resets the young arena.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @post On success the young arena is empty.
+ * @post `forward` translates the addresses of the objects promoted by `tracer` until the next `alloc`,
+ *       `advance` or `compact`.
+ *
+ * @param[in] allocator Pointer to the allocator.
+ * @param[in] tracer    Promotes the live young objects; `nullptr` when nothing survives.
+ * @param[in] context   Passed to `tracer`.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if a promotion failed. The young arena is then kept, so the frame
+ *         can be retried with `advance` after a `compact` freed old space; objects already promoted are not
+ *         promoted again as long as the tracer stored their new addresses.
+ */
+[[nodiscard]] Error                  advance(GenerationalAllocator* const allocator, const Tracer tracer,
+                                             void* const context);
+
+/**
+ * @brief Compacts the old generation by evacuating its live objects into the other semispace.
+ *
+ * The tracer must promote every live old object and store the returned address in place of the old one.
+ * Young objects it reaches stay where they are. Once the tracer returns, the semispace it evacuated is reset,
+ * so any old object it did not promote is gone.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `tracer != nullptr`.
+ *
+ * @post The old generation holds exactly the objects promoted by `tracer`, contiguously.
+ * @post `forward` translates the addresses of the evacuated objects until the next `alloc`, `advance` or
+ *       `compact`.
+ *
+ * @param[in] allocator Pointer to the allocator.
+ * @param[in] tracer    Promotes the live objects.
+ * @param[in] context   Passed to `tracer`.
+ *
+ * @return ERR_SUCCESS, or ERR_OUT_OF_MEMORY if a promotion failed, which takes a tracer promoting more than the
+ *         live objects, overlapping ranges for instance. The old generation is then kept as it was and the
+ *         partial copies are dropped, so addresses the tracer already replaced must be set back to the ones it
+ *         promoted.
+ */
+[[nodiscard]] Error                  compact(GenerationalAllocator* const allocator, const Tracer tracer,
+                                             void* const context);
+
+/**
+ * @brief Retrieves usage statistics of both generations.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @param[in] allocator Pointer to the allocator.
+ *
+ * @return Snapshot of the generations and copy counters.
+ */
+[[nodiscard]] GenerationalStats      stats(const GenerationalAllocator* const allocator);
+
+} // namespace anvil::memory::generational_allocator
+
+#endif // ANVIL_MEMORY_GENERATIONAL_ALLOCATOR_HPP
@@ -0,0 +1,104 @@
+/**
+ * @file metrics_exporter.hpp
+ * @brief Prometheus text exposition of registered allocators
+ *
+ * This header defines a small exporter that serves the counters of every allocator in
+ * the registry, together with the process-wide commit latency histogram, in the
+ * Prometheus text exposition format (version 0.0.4). The exporter runs a single
+ * background thread that answers every connection on a Unix domain socket or on a
+ * loopback TCP port with one HTTP response and then closes it. A client that stops
+ * reading its response is dropped after a second, and at once when the exporter is
+ * stopped, so it can neither hold the server thread nor `stop`.
+ *
+ * Exported metric families:
+ *
+ * Metric                                 | Type      | Labels
+ * -------------------------------------- | --------- | ------------
+ * anvil_allocator_capacity_bytes         | gauge     | name, kind
+ * anvil_allocator_allocated_bytes        | gauge     | name, kind
+ * anvil_allocator_committed_bytes        | gauge     | name, kind
+ * anvil_allocator_peak_bytes             | gauge     | name, kind
+ * anvil_allocator_resets_total           | counter   | name, kind
+ * anvil_allocator_exhaustions_total      | counter   | name, kind
+ * anvil_allocator_instances              | gauge     | name, kind
+ * anvil_commit_latency_seconds           | histogram | le
+ * anvil_registered_allocators            | gauge     |
+ *
+ * Allocators registered under the same name and kind, such as one arena per connection
+ * or per thread, are reported as one series holding the sum of their counters, and
+ * `anvil_allocator_instances` tells how many were summed. The peak of such a series is
+ * the sum of the individual peaks, an upper bound of the peak of the group.
+ *
+ * @note The exporter only reads counters; allocators pay nothing for being exported
+ *       beyond what `stats` already maintains.
+ */
+
+#ifndef ANVIL_MEMORY_METRICS_EXPORTER_HPP
+#define ANVIL_MEMORY_METRICS_EXPORTER_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include <cstdint>
+
+namespace anvil::memory::metrics_exporter {
+struct MetricsExporter;
+
+/**
+ * @brief Starts serving metrics on a Unix domain socket.
+ *
+ * @pre `path != nullptr`.
+ *
+ * @post A file system socket exists at `path` until the exporter is stopped.
+ *
+ * @param[in] path      Socket path; an existing socket file at this path is replaced.
+ *
+ * @return Pointer to a running MetricsExporter, or `nullptr` if the socket could not be bound.
+ */
+[[nodiscard]] MetricsExporter* start_unix(const char* path);
+
+/**
+ * @brief Starts serving metrics on `127.0.0.1:port`.
+ *
+ * @param[in] port      TCP port to listen on, zero lets the kernel choose one.
+ *
+ * @return Pointer to a running MetricsExporter, or `nullptr` if the socket could not be bound.
+ */
+[[nodiscard]] MetricsExporter* start_tcp(const std::uint16_t port);
+
+/**
+ * @brief Port an exporter started with `start_tcp` listens on.
+ *
+ * @pre `exporter != nullptr`.
+ *
+ * @return Bound TCP port, or zero for a Unix domain socket exporter.
+ */
+[[nodiscard]] std::uint16_t    port(const MetricsExporter* const exporter);
+
+/**
+ * @brief Stops an exporter and releases its socket.
+ *
+ * @pre `exporter != nullptr`.
+ * @pre `*exporter != nullptr`.
+ *
+ * @post The background thread has exited and `*exporter == nullptr`.
+ *
+ * @param[in,out] exporter  Reference to the exporter that should be stopped.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error            stop(MetricsExporter** exporter);
+
+/**
+ * @brief Renders the current metrics into a caller provided buffer.
+ *
+ * @pre `buffer != nullptr || size == 0`.
+ *
+ * @param[out] buffer   Destination of the exposition text, not null terminated.
+ * @param[in] size      Size of `buffer` in bytes.
+ *
+ * @return Number of bytes the full exposition needs; the output was truncated if it exceeds `size`.
+ */
+[[nodiscard]] std::size_t      render(char* buffer, const std::size_t size);
+
+} // namespace anvil::memory::metrics_exporter
+
+#endif // ANVIL_MEMORY_METRICS_EXPORTER_HPP
@@ -0,0 +1,85 @@
+/**
+ * @file profiler.hpp
+ * @brief Sampling allocation-site profiler for Anvil allocators
+ *
+ * This header defines an interface for attributing arena usage to the call sites
+ * that produce it. Every thread keeps a countdown of bytes until its next sample;
+ * the countdown is drawn from an exponential distribution whose mean is the sample
+ * rate, so sampling is unbiased with respect to allocation size and periodicity.
+ * When the countdown expires the calling stack is captured and aggregated per
+ * allocator and per unique stack.
+ *
+ * Profiles are exported in the legacy gperftools heap format (`heap_v2`), which
+ * `pprof` reads directly and un-samples using the recorded sample rate.
+ *
+ * @note While the profiler is disabled the allocation hot path only tests a global
+ *       flag; while it is enabled it also decrements a thread local counter. Stack
+ *       capture and aggregation happen in a cold, out-of-line slow path.
+ *
+ * @note Aggregation is thread safe. Enabling, disabling and dumping may be done
+ *       from any thread.
+ */
+
+#ifndef ANVIL_MEMORY_PROFILER_HPP
+#define ANVIL_MEMORY_PROFILER_HPP
+#include "constants.hpp"
+#include "error.hpp"
+
+namespace anvil::memory::profiler {
+
+inline constexpr std::size_t DEFAULT_SAMPLE_RATE = 512 * 1024;
+
+/**
+ * @brief Starts sampling allocations on all threads.
+ *
+ * @pre `sample_rate > 0`.
+ *
+ * @post On average one sample is taken every `sample_rate` allocated bytes.
+ * @post Threads pick up the new rate no later than their next sample. A thread that has not sampled yet, or
+ *       whose countdown ran out while sampling was disabled, arms its countdown on its next allocation.
+ *
+ * @param[in] sample_rate   Mean number of bytes between two samples.
+ */
+void                      enable(const std::size_t sample_rate);
+
+/**
+ * @brief Stops sampling allocations.
+ *
+ * @post No further samples are recorded. Previously recorded samples are retained.
+ */
+void                      disable();
+
+/**
+ * @brief Discards all recorded samples.
+ *
+ * @post `sample_count(nullptr) == 0`.
+ */
+void                      clear();
+
+/**
+ * @brief Number of samples recorded for an allocator.
+ *
+ * @param[in] allocator     Allocator to query, or `nullptr` for the total over all allocators.
+ *
+ * @return Number of recorded samples.
+ */
+[[nodiscard]] std::size_t sample_count(const void* allocator);
+
+/**
+ * @brief Writes the recorded samples as a pprof compatible heap profile.
+ *
+ * @pre `path != nullptr`.
+ *
+ * @post The file at `path` contains one line per unique (allocator, call stack) pair
+ *       followed by the process memory map needed for symbolization.
+ *
+ * @param[in] path          Destination file, truncated if it exists.
+ * @param[in] allocator     Allocator whose samples should be written, or `nullptr` for all allocators.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error       dump(const char* path, const void* allocator);
+
+} // namespace anvil::memory::profiler
+
+#endif // ANVIL_MEMORY_PROFILER_HPP
@@ -0,0 +1,122 @@
+/**
+ * @file registry.hpp
+ * @brief Process-wide registry of named allocators
+ *
+ * This header defines an opt-in registry through which allocators are given a
+ * name and made visible to process-wide observers such as the metrics exporter.
+ * Registration, removal and visiting take a registry lock; allocation, reset,
+ * record and unwind never touch the registry. Destroying a registered allocator
+ * removes it from the registry before its memory is released.
+ *
+ * @note Counters of registered allocators are read with relaxed atomic loads by
+ *       observers, which may therefore see a snapshot that is slightly stale. The
+ *       owning thread keeps writing them with plain stores, so that the hot paths
+ *       stay free of atomics; under the C++ memory model a read racing such a write
+ *       is a data race. The counters are aligned machine words, which the supported
+ *       targets load and store without tearing, but ThreadSanitizer reports it.
+ */
+
+#ifndef ANVIL_MEMORY_REGISTRY_HPP
+#define ANVIL_MEMORY_REGISTRY_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include "scratch_allocator.hpp"
+#include "stack_allocator.hpp"
+#include "stats.hpp"
+
+namespace anvil::memory::registry {
+
+enum class Kind : std::size_t {
+        Scratch = 1u << 0,
+        Stack   = 1u << 1,
+};
+
+/**
+ * @brief View of a registered allocator handed to `visit`.
+ *
+ * @note `name` is only valid for the duration of the visit callback.
+ */
+struct Entry {
+        const char*    name;
+        Kind           kind;
+        const void*    allocator;
+        AllocatorStats stats;
+};
+
+using Visitor = void (*)(const Entry& entry, void* context);
+
+/**
+ * @brief Registers a ScratchAllocator under `name`, or renames it if it is already registered.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `name != nullptr`.
+ *
+ * @post The allocator is reported by `visit` until it is removed or destroyed.
+ *
+ * @param[in] allocator     Allocator to register.
+ * @param[in] name          Name reported for the allocator, copied by the registry; several allocators may
+ *                          share one, the exporter then sums their counters.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error       add(scratch_allocator::ScratchAllocator* const allocator, const char* name);
+
+/**
+ * @brief Registers a StackAllocator under `name`, or renames it if it is already registered.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `name != nullptr`.
+ *
+ * @post The allocator is reported by `visit` until it is removed or destroyed.
+ *
+ * @param[in] allocator     Allocator to register.
+ * @param[in] name          Name reported for the allocator, copied by the registry; several allocators may
+ *                          share one, the exporter then sums their counters.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error       add(stack_allocator::StackAllocator* const allocator, const char* name);
+
+/**
+ * @brief Removes a ScratchAllocator from the registry.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ *
+ * @note Removing an allocator that is not registered succeeds without effect.
+ */
+[[nodiscard]] Error       remove(scratch_allocator::ScratchAllocator* const allocator);
+
+/**
+ * @brief Removes a StackAllocator from the registry.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ *
+ * @note Removing an allocator that is not registered succeeds without effect.
+ */
+[[nodiscard]] Error       remove(stack_allocator::StackAllocator* const allocator);
+
+/**
+ * @brief Calls `visitor` once for every registered allocator, in registration order.
+ *
+ * @pre `visitor != nullptr`.
+ *
+ * @param[in] visitor       Callback receiving each registered allocator.
+ * @param[in] context       Opaque pointer forwarded to `visitor`.
+ *
+ * @note The registry lock is held while visiting; `visitor` must not call back into the registry
+ *       or destroy registered allocators.
+ */
+void                      visit(const Visitor visitor, void* context);
+
+/**
+ * @brief Number of registered allocators.
+ */
+[[nodiscard]] std::size_t size();
+
+} // namespace anvil::memory::registry
+
+#endif // ANVIL_MEMORY_REGISTRY_HPP
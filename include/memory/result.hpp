@@ -0,0 +1,44 @@
+/**
+ * @file result.hpp
+ * @brief Pointer and error pair returned by the `try_alloc` operations of Anvil allocators
+ *
+ * `alloc` reports every failure as `nullptr`, which leaves the caller guessing whether the
+ * arena ran out of capacity or the kernel refused to commit more pages. The `try_alloc`
+ * operations return an AllocResult instead. The pair is two machine words, so it is
+ * returned in registers (RAX:RDX on x86-64, X0:X1 on AArch64) and checking it on the
+ * success path costs the same single compare as the `nullptr` check of `alloc`.
+ */
+
+#ifndef ANVIL_MEMORY_RESULT_HPP
+#define ANVIL_MEMORY_RESULT_HPP
+#include "constants.hpp"
+#include "error.hpp"
+#include <type_traits>
+
+namespace anvil::memory {
+
+/**
+ * @brief Outcome of an allocation.
+ *
+ * Field | Description
+ * ----- | ---------------------------------------------------------------------
+ * ptr   | Allocated memory, `nullptr` exactly when `error != ERR_SUCCESS`
+ * error | ERR_SUCCESS, or the reason the allocation failed
+ */
+struct AllocResult {
+        void* ptr;
+        Error error;
+
+        /**
+         * @brief True when the allocation succeeded.
+         */
+        [[nodiscard]] ANVIL_ATTR_HOT ANVIL_ATTR_ALWAYS_INLINE constexpr bool ok() const noexcept {
+                return ptr != nullptr;
+        }
+};
+static_assert(sizeof(AllocResult) == 2 * sizeof(void*), "AllocResult must fit in two registers");
+static_assert(std::is_trivially_copyable_v<AllocResult>, "AllocResult must be returned in registers");
+
+} // namespace anvil::memory
+
+#endif // ANVIL_MEMORY_RESULT_HPP
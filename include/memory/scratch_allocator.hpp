@@ -17,7 +17,11 @@
 
 #ifndef ANVIL_MEMORY_SCRATCH_ALLOCATOR_HPP
 #define ANVIL_MEMORY_SCRATCH_ALLOCATOR_HPP
+#include "capacity_advisor.hpp"
+#include "constants.hpp"
 #include "error.hpp"
+#include "result.hpp"
+#include "stats.hpp"
 
 namespace anvil::memory::scratch_allocator {
 struct ScratchAllocator;
@@ -36,10 +40,13 @@ struct ScratchAllocator;
  *
  * @param[in] capacity      The amount of physical memory to allocate.
  * @param[in] alignment     The alignment of all memory allocated from the ScratchAllocator
+ * @param[in] mapping       Fork and core dump treatment of the arena, see `set_mapping_flags`. Anything but
+ *                          `MappingFlags::None` reserves one more page so the arena can start on a page boundary.
  *
- * @return Pointer to a ScratchAllocator.
+ * @return Pointer to a ScratchAllocator, or `nullptr` if the memory or the mapping flags could not be applied.
  */
-[[nodiscard]] ScratchAllocator* create(const std::size_t capacity, const std::size_t alignment);
+[[nodiscard]] ScratchAllocator* create(const std::size_t capacity, const std::size_t alignment,
+                                       const MappingFlags mapping = MappingFlags::None);
 
 /**
  * @brief Removes a mapping to a contiguous region of physical memory.
@@ -82,6 +89,24 @@ struct ScratchAllocator;
 [[nodiscard]] void*             alloc(ScratchAllocator* const allocator, const std::size_t allocation_size,
                                       const std::size_t alignment);
 
+/**
+ * @brief Same as `alloc`, but reports why an allocation failed.
+ *
+ * The success path does the same work as `alloc`; the returned pair is passed in two registers.
+ *
+ * @pre Same as `alloc`.
+ *
+ * @post On success, same as `alloc`. On failure the allocator is unchanged apart from its exhaustion count.
+ *
+ * @param[in] allocator         ScratchAllocator from which the allocation should be made.
+ * @param[in] allocation_size   Size in bytes of the allocation that should be made.
+ * @param[in] alignment         Alignment of the returned memory region.
+ *
+ * @return `{ptr, ERR_SUCCESS}`, or `{nullptr, ERR_OUT_OF_MEMORY}` if the allocation does not fit in the capacity.
+ */
+[[nodiscard]] AllocResult       try_alloc(ScratchAllocator* const allocator, const std::size_t allocation_size,
+                                          const std::size_t alignment);
+
 /**
  * @brief Re-initialize the state of a ScratchAllocator.
  *
@@ -97,6 +122,58 @@ struct ScratchAllocator;
  */
 [[nodiscard]] Error             reset(ScratchAllocator* const allocator);
 
+/**
+ * @brief Attaches a capacity advisor that observes the allocator's per-reset peaks.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @post `reset` reports the number of bytes allocated since the previous reset.
+ *
+ * @param[in] allocator     ScratchAllocator to observe.
+ * @param[in] advisor       Advisor to inform, or `nullptr` to detach the current advisor.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error             attach_advisor(ScratchAllocator* const                   allocator,
+                                               capacity_advisor::CapacityAdvisor* const advisor);
+
+/**
+ * @brief Changes how the scratch allocator's arena is treated by fork(2) and core dumps.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @post Flags in `flags` are applied and flags not in `flags` are reverted, over the whole arena including
+ *       memory that is not committed yet, if the allocator was created with mapping flags: its arena then starts
+ *       on a page of its own. Otherwise the arena bytes that share a page with the allocator itself, fewer than
+ *       one page, keep the default treatment along with the allocator.
+ * @post With `DontFork` the arena is absent in a child and the child must not use the allocator; with
+ *       `WipeOnFork` the child sees zero-filled memory and may `reset` and reuse the allocator.
+ *
+ * @param[in] allocator     ScratchAllocator to change.
+ * @param[in] flags         Requested combination of MappingFlags.
+ *
+ * @return Error code; ERR_MEMORY_ADVICE if the kernel rejected the advice, in which case the flags are unchanged.
+ */
+[[nodiscard]] Error             set_mapping_flags(ScratchAllocator* const allocator, const MappingFlags flags);
+
+/**
+ * @brief Reports the MappingFlags currently applied to the scratch allocator's arena.
+ *
+ * @pre `allocator != nullptr`.
+ */
+[[nodiscard]] MappingFlags      mapping_flags(const ScratchAllocator* const allocator);
+
+/**
+ * @brief Reports the usage statistics of a ScratchAllocator.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @param[in] allocator     ScratchAllocator to query.
+ *
+ * @return Snapshot of the allocator's usage, including an attached advisor's recommendation.
+ */
+[[nodiscard]] AllocatorStats    stats(const ScratchAllocator* const allocator);
+
 } // namespace anvil::memory::scratch_allocator
 
 #endif // ANVIL_MEMORY_SCRATCH_ALLOCATOR_HPP
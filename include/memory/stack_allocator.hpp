@@ -18,8 +18,11 @@
 
 #ifndef ANVIL_MEMORY_STACK_ALLOCATOR_HPP
 #define ANVIL_MEMORY_STACK_ALLOCATOR_HPP
+#include "capacity_advisor.hpp"
 #include "constants.hpp"
 #include "error.hpp"
+#include "result.hpp"
+#include "stats.hpp"
 
 // Namespaced C++ API (preferred)
 namespace anvil::memory::stack_allocator {
@@ -39,12 +42,19 @@ struct StackAllocator;
  *
  * @param[in] capacity      The amount of physical memory to allocate.
  * @param[in] alignment     The alignment of all memory allocated from the StackAllocator.
- * @param[in] strategy      The allocation strategy for the StackAllocator.
+ * @param[in] strategy      The allocation strategy for the StackAllocator. `Guarded` reserves GUARD_REGION_SIZE
+ *                          more bytes and installs the process-wide SIGSEGV handler, see `alloc_unchecked`. Its
+ *                          pages are committed when first touched, also for `alloc` and `try_alloc`, so system
+ *                          calls writing into memory that was not touched yet fail with EFAULT.
+ * @param[in] mapping       Fork and core dump treatment of the arena, see `set_mapping_flags`. Anything but
+ *                          `MappingFlags::None` reserves one more page so the arena can start on a page boundary.
  *
- * @return Pointer to a StackAllocator.
+ * @return Pointer to a StackAllocator, or `nullptr` if the memory, the mapping flags or the fault handler could
+ *         not be set up.
  */
 [[nodiscard]] StackAllocator* create(const std::size_t capacity, const std::size_t alignment,
-                                     const AllocationStrategy strategy);
+                                     const AllocationStrategy strategy,
+                                     const MappingFlags       mapping = MappingFlags::None);
 
 /**
  * @brief Removes a mapping to a contiguous region of physical memory.
@@ -74,6 +84,8 @@ struct StackAllocator;
  * @post The returned memory region is zeroed.
  * @post The returned memory region is aligned to `alignment`.
  * @post Returned pointer satisfies `(uintptr_t)ptr % alignment == 0`.
+ * @post On a Guarded allocator the memory is committed when first touched; system calls writing into memory
+ *       that was not touched yet fail with EFAULT instead of faulting, so touch it first.
  *
  * @param[in] allocator         StackAllocator from which the allocation should be made.
  * @param[in] allocation_size   Size in bytes of the allocation that should be made.
@@ -87,6 +99,56 @@ struct StackAllocator;
 [[nodiscard]] void*           alloc(StackAllocator* const allocator, const std::size_t allocation_size,
                                     const std::size_t alignment);
 
+/**
+ * @brief Same as `alloc`, but reports why an allocation failed.
+ *
+ * The success path does the same work as `alloc`; the returned pair is passed in two registers.
+ *
+ * @pre Same as `alloc`.
+ *
+ * @post On success, same as `alloc`, including the EFAULT caveat of Guarded allocators. On failure the allocator
+ *       is unchanged apart from its exhaustion count.
+ *
+ * @param[in] allocator         StackAllocator from which the allocation should be made.
+ * @param[in] allocation_size   Size in bytes of the allocation that should be made.
+ * @param[in] alignment         Alignment of the returned memory region.
+ *
+ * @return `{ptr, ERR_SUCCESS}`, `{nullptr, ERR_OUT_OF_MEMORY}` if the allocation does not fit in the capacity, or
+ *         `{nullptr, ERR_BUDGET_EXHAUSTED}` if it fits in the capacity but not in the budget of the open scopes, or
+ *         the error of the commit if a lazy allocator could not make more pages readable and writable
+ *         (ERR_MEMORY_PERMISSION_CHANGE).
+ */
+[[nodiscard]] AllocResult     try_alloc(StackAllocator* const allocator, const std::size_t allocation_size,
+                                        const std::size_t alignment);
+
+/**
+ * @brief Bumps the watermark of a guarded StackAllocator without any checks.
+ *
+ * The allocation is a pointer add: the capacity is not compared and nothing is committed. Pages are committed
+ * by the SIGSEGV handler when the memory is first touched, at least `commit_chunk` bytes at a time. Touching
+ * memory past the capacity lands in the guard region; the handler then counts an exhaustion, reports the fault
+ * on stderr and chains to the previously installed SIGSEGV handler, which normally terminates the process.
+ *
+ * @pre `allocator` was created with `AllocationStrategy::Guarded`.
+ * @pre `allocation_size + alignment - 1 <= GUARD_REGION_SIZE`, so an allocation cannot skip the guard region.
+ * @pre `alignment` is a power of two in [MIN_ALIGNMENT, MAX_ALIGNMENT].
+ * @pre None of these preconditions is checked. Once the watermark passed the capacity the allocator must be
+ *      reset or unwound before `alloc` or `alloc_unchecked` is used again.
+ *
+ * @post The returned memory region is zeroed once touched.
+ * @post Memory that was not touched yet is not committed; system calls writing into it fail with EFAULT
+ *       instead of faulting, so touch it first.
+ * @post Allocations are not seen by the sampling profiler.
+ *
+ * @param[in] allocator         Guarded StackAllocator from which the allocation should be made.
+ * @param[in] allocation_size   Size in bytes of the allocation that should be made.
+ * @param[in] alignment         Alignment of the returned memory region.
+ *
+ * @return Pointer to aligned memory region of size `allocation_size` (bytes).
+ */
+[[nodiscard]] ANVIL_ATTR_HOT void* alloc_unchecked(StackAllocator* const allocator, const std::size_t allocation_size,
+                                                   const std::size_t alignment);
+
 /**
  * @brief Re-initialize the state of a StackAllocator.
  *
@@ -103,18 +165,26 @@ struct StackAllocator;
 [[nodiscard]] Error           reset(StackAllocator* const allocator);
 
 /**
- * @brief Records the current allocation state for later unwinding
+ * @brief Records the current allocation state for later unwinding, optionally capping what the new scope may use
+ *
+ * A budget bounds the bytes, padding included, that can be allocated until the matching `unwind`, even when the
+ * arena has room, so one scope cannot starve the others sharing the allocator. Nested scopes inherit what is
+ * left of the enclosing budget and can only narrow it. The budget is folded into the bound the allocation fast
+ * path already compares against, so it costs nothing per allocation; `record` and `unwind` adjust that bound.
  *
  * @pre `allocator != nullptr`.
  * @pre `allocator->stack_depth < MAX_STACK_DEPTH`.
  *
  * @post The current allocation state is saved on the internal stack.
+ * @post Until the matching `unwind`, allocations fail with ERR_BUDGET_EXHAUSTED once the scope would exceed
+ *       `budget` bytes or the remaining budget of an enclosing scope.
  *
  * @param[in] allocator     StackAllocator whose state should be recorded.
+ * @param[in] budget        Bytes the new scope may allocate; NO_BUDGET keeps the enclosing scope's budget.
  *
  * @return Error code, zero indicates success while other values indicate error.
  */
-[[nodiscard]] Error           record(StackAllocator* const allocator);
+[[nodiscard]] Error           record(StackAllocator* const allocator, const std::size_t budget = NO_BUDGET);
 
 /**
  * @brief Unwinds allocations back to the last recorded state
@@ -124,6 +194,7 @@ struct StackAllocator;
  *
  * @post Allocations made after the last record are invalidated.
  * @post The allocator returns to the state at the time of the last record.
+ * @post The budget in effect before the last record applies again.
  *
  * @param[in] allocator     StackAllocator that should be unwound.
  *
@@ -131,6 +202,78 @@ struct StackAllocator;
  */
 [[nodiscard]] Error           unwind(StackAllocator* const allocator);
 
+/**
+ * @brief Sets the minimum number of bytes a lazy StackAllocator commits at once.
+ *
+ * @pre `allocator != nullptr`.
+ * @pre `commit_chunk > 0`.
+ *
+ * @post Every later commit makes at least `commit_chunk` bytes (page rounded) readable and writable,
+ *       bounded by the remaining capacity.
+ *
+ * @param[in] allocator     StackAllocator whose commit granularity should change.
+ * @param[in] commit_chunk  Minimum number of bytes committed when an allocation crosses the committed range.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ *
+ * @note Has no effect on eager allocators, which commit their whole capacity at creation.
+ */
+[[nodiscard]] Error           set_commit_chunk(StackAllocator* const allocator, const std::size_t commit_chunk);
+
+/**
+ * @brief Attaches a capacity advisor that observes the allocator's per-scope and per-reset peaks.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @post `unwind` reports the peak of the unwound scope and `reset` reports the peak since the previous reset.
+ * @post An adaptive advisor adjusts the commit chunk and releases committed memory beyond the recommended
+ *       capacity on every `reset` of a lazy allocator.
+ *
+ * @param[in] allocator     StackAllocator to observe.
+ * @param[in] advisor       Advisor to inform, or `nullptr` to detach the current advisor.
+ *
+ * @return Error code, zero indicates success while other values indicate error.
+ */
+[[nodiscard]] Error           attach_advisor(StackAllocator* const                     allocator,
+                                             capacity_advisor::CapacityAdvisor* const advisor);
+
+/**
+ * @brief Changes how the stack allocator's arena is treated by fork(2) and core dumps.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @post Flags in `flags` are applied and flags not in `flags` are reverted, over the whole arena including
+ *       memory that is not committed yet, if the allocator was created with mapping flags: its arena then starts
+ *       on a page of its own. Otherwise the arena bytes that share a page with the allocator itself, fewer than
+ *       one page, keep the default treatment along with the allocator.
+ * @post With `DontFork` the arena is absent in a child and the child must not use the allocator; with
+ *       `WipeOnFork` the child sees zero-filled memory and may `reset` and reuse the allocator.
+ *
+ * @param[in] allocator     StackAllocator to change.
+ * @param[in] flags         Requested combination of MappingFlags.
+ *
+ * @return Error code; ERR_MEMORY_ADVICE if the kernel rejected the advice, in which case the flags are unchanged.
+ */
+[[nodiscard]] Error           set_mapping_flags(StackAllocator* const allocator, const MappingFlags flags);
+
+/**
+ * @brief Reports the MappingFlags currently applied to the stack allocator's arena.
+ *
+ * @pre `allocator != nullptr`.
+ */
+[[nodiscard]] MappingFlags    mapping_flags(const StackAllocator* const allocator);
+
+/**
+ * @brief Reports the usage statistics of a StackAllocator.
+ *
+ * @pre `allocator != nullptr`.
+ *
+ * @param[in] allocator     StackAllocator to query.
+ *
+ * @return Snapshot of the allocator's usage, including an attached advisor's recommendation.
+ */
+[[nodiscard]] AllocatorStats  stats(const StackAllocator* const allocator);
+
 } // namespace anvil::memory::stack_allocator
 
 #endif // ANVIL_MEMORY_STACK_ALLOCATOR_HPP
@@ -0,0 +1,68 @@
+/**
+ * @file stats.hpp
+ * @brief Usage statistics reported by Anvil allocators
+ *
+ * This header defines the snapshot type returned by the `stats` operation of every
+ * allocator. The counters are maintained on the slow paths of the allocators
+ * (exhaustion, reset, unwind) so that collecting them adds no work to a successful
+ * allocation.
+ *
+ * It also exposes the process-wide latency histogram of lazy commits, which is
+ * updated with relaxed atomic increments around the `mprotect` of every commit.
+ */
+
+#ifndef ANVIL_MEMORY_STATS_HPP
+#define ANVIL_MEMORY_STATS_HPP
+#include "constants.hpp"
+
+namespace anvil::memory {
+
+/**
+ * @brief Point in time snapshot of an allocator's usage.
+ *
+ * Field                    | Description
+ * ------------------------ | ------------------------------------------------------------------------
+ * capacity                 | Usable bytes requested at creation
+ * allocated                | Current allocation watermark in bytes
+ * committed                | Bytes of the usable region backed by readable and writable pages
+ * peak                     | Highest allocation watermark since the last reset
+ * reset_count              | Number of resets since creation
+ * exhaustion_count         | Number of allocations that failed for lack of capacity
+ * recommended_capacity     | Capacity suggested by an attached advisor, zero without one
+ * recommended_commit_chunk | Commit chunk suggested by an attached advisor, zero without one
+ */
+struct AllocatorStats {
+        std::size_t capacity;
+        std::size_t allocated;
+        std::size_t committed;
+        std::size_t peak;
+        std::size_t reset_count;
+        std::size_t exhaustion_count;
+        std::size_t recommended_capacity;
+        std::size_t recommended_commit_chunk;
+};
+
+inline constexpr std::size_t COMMIT_LATENCY_BUCKETS = 16;
+
+/**
+ * @brief Process-wide histogram of lazy commit latencies.
+ *
+ * Bucket `i < COMMIT_LATENCY_BUCKETS - 1` counts commits that took less than `2^i` microseconds and at
+ * least `2^(i-1)` microseconds; the last bucket counts every slower commit. Counts are not cumulative.
+ */
+struct CommitLatencyHistogram {
+        std::size_t counts[COMMIT_LATENCY_BUCKETS];
+        std::size_t count;
+        std::size_t sum_ns;
+};
+
+/**
+ * @brief Snapshot of the commit latency histogram.
+ *
+ * @return Histogram of all commits made by lazy allocators since process start.
+ */
+[[nodiscard]] CommitLatencyHistogram commit_latency();
+
+} // namespace anvil::memory
+
+#endif // ANVIL_MEMORY_STATS_HPP
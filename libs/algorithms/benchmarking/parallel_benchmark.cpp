@@ -0,0 +1,225 @@
+// parallel_benchmark.cpp
+// Anvil parallel algorithms against the standard library's std::execution::par equivalents.
+// - Workloads: radix sort (u32, u64) vs std::sort, merge sort vs std::stable_sort, stable partition,
+//   exclusive scan, and a 256-bin histogram vs std::for_each with relaxed atomic counters.
+// - --iters is the number of elements; every run sorts/scans a fresh copy of the same random input.
+// - --threads N sizes the Anvil worker pool (default hardware_concurrency); the std baselines use TBB's.
+// - Counts heap allocations per call by interposing malloc: after warm-up the Anvil algorithms must not
+//   allocate, their temporaries come from per-thread StackAllocator scopes.
+// - --strict fails on a wrong result or a heap allocation after warm-up; speedups are only reported,
+//   they depend on the core count.
+// - Without TBB (ANVIL_WITH_PAR_BASELINE undefined) the baselines are the sequential std algorithms.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp).
+//
+// Run  :  ./algorithms_benchmark --runs 10 --iters 4000000 [--threads N] [--strict]
+
+#include "algorithms/parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+#include <numeric>
+#include <random>
+#include <vector>
+#ifdef ANVIL_WITH_PAR_BASELINE
+#include <execution>
+#define PAR std::execution::par,
+#define BASELINE "std::execution::par"
+#else
+#define PAR
+#define BASELINE "std (sequential)"
+#endif
+
+#include "benchmark_report.hpp"
+
+namespace alg = anvil::algorithms;
+
+// -------- Heap allocation counting --------
+
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void  __libc_free(void*);
+
+static std::atomic<uint64_t> heap_allocations{0};
+
+extern "C" void* malloc(size_t size) {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* p, size_t size) {
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(p, size);
+}
+extern "C" void free(void* p) {
+        __libc_free(p);
+}
+
+// Heap allocations per call of `op`, measured after one warm-up call.
+template <class F>
+static double allocations_per_call(F&& op, int calls = 3) {
+        op();
+        const uint64_t before = heap_allocations.load(std::memory_order_relaxed);
+        for (int i = 0; i < calls; ++i)
+                op();
+        return double(heap_allocations.load(std::memory_order_relaxed) - before) / calls;
+}
+
+// -------- Rows --------
+
+struct Row {
+        std::string name;
+        Stats       base, anvil;
+        double      speedup{1};
+        double      anvil_allocs{0}, base_allocs{0};
+        bool        correct{true};
+        bool        pass{true};
+};
+
+static void print_row(const Row& r) {
+        auto fmt = [&](double v) {
+                std::ostringstream o;
+                o << std::fixed << std::setprecision(0) << v;
+                return o.str();
+        };
+        std::cout << r.name << ": " << (r.pass ? "PASS" : "FAIL") << " - speedup " << std::fixed << std::setprecision(2)
+                  << r.speedup << "x";
+        if (!r.correct)
+                std::cout << " (wrong result)";
+        std::cout << "\n  " << std::setw(20) << std::left << BASELINE << std::right << ": " << fmt(r.base.ops_per_sec)
+                  << " elements/s [" << fmt(r.base.ci_lo) << "–" << fmt(r.base.ci_hi) << "], heap allocations/call "
+                  << std::setprecision(1) << r.base_allocs << "\n";
+        std::cout << "  " << std::setw(20) << std::left << "anvil" << std::right << ": " << fmt(r.anvil.ops_per_sec)
+                  << " elements/s [" << fmt(r.anvil.ci_lo) << "–" << fmt(r.anvil.ci_hi) << "], heap allocations/call "
+                  << std::setprecision(1) << r.anvil_allocs << "\n";
+        print_counters("baseline", r.base);
+        print_counters("anvil   ", r.anvil);
+}
+
+// Times `base` and `anvil` on a fresh copy of `input` each run and checks that both leave the same result.
+template <class T, class FBase, class FAnvil>
+static Row compare(const Config& cfg, const char* name, const std::vector<T>& input, FBase&& base, FAnvil&& anvil) {
+        const size_t   n = input.size();
+        std::vector<T> work(n), expected(n);
+        Row            row;
+        row.name = name;
+        row.base = time_runs(cfg, [&] { work = input; }, [&] { base(work); }, [] {}, double(n));
+        expected = work;
+        row.anvil = time_runs(cfg, [&] { work = input; }, [&] { anvil(work); }, [] {}, double(n));
+        row.correct = work == expected;
+
+        row.base_allocs  = allocations_per_call([&] {
+                work = input;
+                base(work);
+        });
+        row.anvil_allocs = allocations_per_call([&] {
+                std::copy(input.begin(), input.end(), work.begin());
+                anvil(work);
+        });
+        // `work = input` reuses the vector's storage, so copying adds no allocation to either count.
+        row.speedup = (row.base.ops_per_sec > 0) ? row.anvil.ops_per_sec / row.base.ops_per_sec : 1.0;
+        row.pass    = !cfg.strict || (row.correct && row.anvil_allocs == 0);
+        return row;
+}
+
+static bool is_even(uint64_t value, void*) {
+        return (value & 1) == 0;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        if (!parse_config(cfg, argc, argv))
+                return 0;
+        for (int i = 1; i + 1 < argc; ++i)
+                if (std::string(argv[i]) == "--threads")
+                        (void)alg::set_concurrency(size_t(std::max(1, std::atoi(argv[i + 1]))));
+
+        const size_t n = size_t(std::max(2, cfg.iters));
+        std::cout << "=== Anvil Parallel Algorithms Benchmark ===\n";
+        std::cout << "(" << n << " elements, " << alg::concurrency() << " anvil workers, baseline " << BASELINE
+                  << ")\n";
+        if (!perf_counters().hardware())
+                std::cout << "(hardware counters unavailable; reporting getrusage page faults only)\n";
+
+        std::mt19937_64       rng(42);
+        std::vector<uint64_t> u64(n);
+        std::vector<uint32_t> u32(n);
+        std::vector<double>   f64(n);
+        for (size_t i = 0; i < n; ++i) {
+                u64[i] = rng();
+                u32[i] = uint32_t(rng());
+                f64[i] = double(rng() % 1000000) / 7.0; // duplicates exercise stability
+        }
+
+        std::vector<Row> rows;
+        rows.push_back(compare(
+            cfg, "radix_sort_u64", u64, [](std::vector<uint64_t>& v) { std::sort(PAR v.begin(), v.end()); },
+            [](std::vector<uint64_t>& v) { (void)alg::radix_sort(v.data(), v.size()); }));
+        rows.push_back(compare(
+            cfg, "radix_sort_u32", u32, [](std::vector<uint32_t>& v) { std::sort(PAR v.begin(), v.end()); },
+            [](std::vector<uint32_t>& v) { (void)alg::radix_sort(v.data(), v.size()); }));
+        rows.push_back(compare(
+            cfg, "merge_sort", f64, [](std::vector<double>& v) { std::stable_sort(PAR v.begin(), v.end()); },
+            [](std::vector<double>& v) { (void)alg::merge_sort(v.data(), v.size()); }));
+        rows.push_back(compare(
+            cfg, "stable_partition", u64,
+            [](std::vector<uint64_t>& v) {
+                    (void)std::stable_partition(PAR v.begin(), v.end(), [](uint64_t x) { return is_even(x, nullptr); });
+            },
+            [](std::vector<uint64_t>& v) {
+                    size_t split = 0;
+                    (void)alg::stable_partition(v.data(), v.size(), is_even, nullptr, &split);
+            }));
+        // The parallel std::exclusive_scan of libstdc++ is wrong in place, so the baseline scans into a second buffer.
+        std::vector<uint64_t> scanned(n);
+        rows.push_back(compare(
+            cfg, "exclusive_scan", u64,
+            [&](std::vector<uint64_t>& v) {
+                    std::exclusive_scan(PAR v.begin(), v.end(), scanned.begin(), uint64_t(7));
+                    v.swap(scanned);
+            },
+            [](std::vector<uint64_t>& v) { (void)alg::exclusive_scan(v.data(), v.data(), v.size(), 7); }));
+
+        // The histogram result is the counters, not the input; compare those and pass the input through.
+        std::vector<uint32_t> bytes(n);
+        for (size_t i = 0; i < n; ++i)
+                bytes[i] = u32[i] & 0xFF;
+        std::vector<uint64_t>              anvil_counts(256);
+        std::vector<std::atomic<uint64_t>> std_counts(256);
+        Row                                hist = compare(
+            cfg, "histogram_256", bytes,
+            [&](std::vector<uint32_t>& v) {
+                    for (auto& c : std_counts)
+                            c.store(0, std::memory_order_relaxed);
+                    std::for_each(PAR v.begin(), v.end(),
+                                  [&](uint32_t x) { std_counts[x].fetch_add(1, std::memory_order_relaxed); });
+            },
+            [&](std::vector<uint32_t>& v) { (void)alg::histogram(v.data(), v.size(), anvil_counts.data(), 256); });
+        for (size_t b = 0; b < 256; ++b)
+                hist.correct = hist.correct && anvil_counts[b] == std_counts[b].load();
+        hist.pass = !cfg.strict || (hist.correct && hist.anvil_allocs == 0);
+        rows.push_back(hist);
+
+        int passes = 0, fails = 0;
+        for (const auto& r : rows) {
+                print_row(r);
+                report_series(r.name, "baseline", r.base);
+                report_series(r.name, "anvil", r.anvil);
+                if (r.pass)
+                        ++passes;
+                else
+                        ++fails;
+        }
+
+        std::cout << "\nSummary: " << passes << " PASS, " << fails << " FAIL";
+        if (cfg.strict)
+                std::cout << " (strict mode)";
+        std::cout << "\n";
+        const bool report_failed = finish_report(cfg, "algorithms_benchmark");
+        return ((cfg.strict && fails > 0) || report_failed) ? 1 : 0;
+}
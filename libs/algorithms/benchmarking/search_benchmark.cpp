@@ -0,0 +1,142 @@
+// search_benchmark.cpp
+// Static search tables (Eytzinger and B-tree order) against std::lower_bound on the sorted keys.
+// - Tables of 2^10, 2^16 and 2^22 keys: fitting in L1, in L2, and well past the last level cache.
+// - --iters is the number of lookups per run; the keys looked up are random, about half of them present.
+// - Every table is checked against std::lower_bound for all lookups and the edge keys 0 and UINT64_MAX.
+// - Tables are rebuilt every run into a reset ScratchAllocator, as an epoch would; the build is not timed.
+// - --strict fails on a wrong result; speedups are only reported, wall-clock ratios on a shared machine are
+//   too noisy to gate a test run on.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp).
+//
+// Run  :  ./algorithms_search_benchmark --runs 10 --iters 1000000 [--strict]
+
+#include "algorithms/search.hpp"
+#include "memory/scratch_allocator.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "benchmark_report.hpp"
+
+namespace alg     = anvil::algorithms;
+namespace scratch = anvil::memory::scratch_allocator;
+
+static volatile uint64_t sink;
+
+struct Row {
+        std::string name;
+        Stats       stats;
+        double      speedup{1};
+        bool        correct{true};
+        bool        pass{true};
+};
+
+static void print_row(const Row& r) {
+        auto fmt = [&](double v) {
+                std::ostringstream o;
+                o << std::fixed << std::setprecision(0) << v;
+                return o.str();
+        };
+        std::cout << r.name << ": " << (r.pass ? "PASS" : "FAIL") << " - " << fmt(r.stats.ops_per_sec)
+                  << " lookups/s [" << fmt(r.stats.ci_lo) << "–" << fmt(r.stats.ci_hi) << "], speedup "
+                  << std::fixed << std::setprecision(2) << r.speedup << "x";
+        if (!r.correct)
+                std::cout << " (wrong result)";
+        std::cout << "\n";
+        print_counters("        ", r.stats);
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        cfg.runs  = 10;
+        cfg.iters = 1000000;
+        if (!parse_config(cfg, argc, argv))
+                return 0;
+
+        std::cout << "=== Anvil Static Search Benchmark ===\n";
+        std::cout << "(" << cfg.iters << " lookups per run)\n";
+        if (!perf_counters().hardware())
+                std::cout << "(hardware counters unavailable; reporting getrusage page faults only)\n";
+
+        const size_t                     sizes[] = {size_t(1) << 10, size_t(1) << 16, size_t(1) << 22};
+        const size_t                     largest = sizes[std::size(sizes) - 1];
+        scratch::ScratchAllocator*       arena   = scratch::create(largest * 20, 64);
+        std::mt19937_64                  rng(42);
+        std::vector<Row>                 rows;
+
+        for (const size_t n : sizes) {
+                // Even keys with duplicates; odd lookups are absent.
+                std::vector<uint64_t> keys(n);
+                for (auto& k : keys)
+                        k = (rng() % (n * 4)) & ~uint64_t(1);
+                std::sort(keys.begin(), keys.end());
+                std::vector<uint64_t> queries(size_t(std::max(1, cfg.iters)));
+                for (auto& q : queries)
+                        q = rng() % (n * 4 + 2);
+                queries[0] = 0;
+                queries[1 % queries.size()] = UINT64_MAX;
+
+                std::vector<size_t> expected(queries.size());
+                for (size_t i = 0; i < queries.size(); ++i)
+                        expected[i] = size_t(std::lower_bound(keys.begin(), keys.end(), queries[i]) - keys.begin());
+
+                const std::string suffix = " (" + std::to_string(n) + " keys)";
+                Row               base;
+                base.name  = "std::lower_bound" + suffix;
+                base.stats = time_runs(
+                    cfg, [] {},
+                    [&] {
+                            uint64_t sum = 0;
+                            for (const uint64_t q : queries)
+                                    sum += uint64_t(std::lower_bound(keys.begin(), keys.end(), q) - keys.begin());
+                            sink = sum;
+                    },
+                    [] {}, double(queries.size()));
+                rows.push_back(base);
+
+                for (const auto& [layout, label] : {std::pair{alg::SearchLayout::Eytzinger, "eytzinger"},
+                                                    std::pair{alg::SearchLayout::BTree, "btree"}}) {
+                        const alg::SearchTable* table = nullptr;
+                        Row                     row;
+                        row.name  = label + suffix;
+                        row.stats = time_runs(
+                            cfg,
+                            [&] {
+                                    (void)scratch::reset(arena);
+                                    table = alg::build_search_table(arena, keys.data(), n, layout);
+                            },
+                            [&] {
+                                    uint64_t sum = 0;
+                                    for (const uint64_t q : queries)
+                                            sum += alg::lower_bound(table, q);
+                                    sink = sum;
+                            },
+                            [] {}, double(queries.size()));
+                        for (size_t i = 0; i < queries.size() && row.correct; ++i)
+                                row.correct = table && alg::lower_bound(table, queries[i]) == expected[i];
+                        row.speedup = (base.stats.ops_per_sec > 0) ? row.stats.ops_per_sec / base.stats.ops_per_sec
+                                                                   : 1.0;
+                        row.pass    = !cfg.strict || row.correct;
+                        rows.push_back(row);
+                }
+        }
+        (void)scratch::destroy(&arena);
+
+        int passes = 0, fails = 0;
+        for (const auto& r : rows) {
+                print_row(r);
+                report_series(r.name, "lookup", r.stats);
+                if (r.pass)
+                        ++passes;
+                else
+                        ++fails;
+        }
+
+        std::cout << "\nSummary: " << passes << " PASS, " << fails << " FAIL";
+        if (cfg.strict)
+                std::cout << " (strict mode)";
+        std::cout << "\n";
+        const bool report_failed = finish_report(cfg, "algorithms_search_benchmark");
+        return ((cfg.strict && fails > 0) || report_failed) ? 1 : 0;
+}
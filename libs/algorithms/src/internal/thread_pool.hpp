@@ -0,0 +1,47 @@
+#ifndef ANVIL_THREAD_POOL_INTERNAL_HPP
+#define ANVIL_THREAD_POOL_INTERNAL_HPP
+
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/stack_allocator.hpp"
+
+namespace anvil::algorithms::internal {
+
+/**
+ * @brief Share of a parallel step; `worker` is in [0, workers) and the caller of `run` always runs share zero.
+ */
+using Task = void (*)(void* context, std::size_t worker, std::size_t workers);
+
+/**
+ * @brief Number of pool threads, the calling thread included; the share count callers should size for.
+ *
+ * Only a hint: `set_concurrency` may resize the pool before the next `run`, which is why `run` takes the share
+ * count explicitly.
+ */
+std::size_t                      workers();
+
+/**
+ * @brief Resizes the pool, starting or joining threads as needed.
+ */
+[[nodiscard]] Error              resize(const std::size_t workers);
+
+/**
+ * @brief Runs shares 0 .. shares - 1 of `task` on the pool and returns when all of them are done.
+ *
+ * Every share is run exactly once and is told `shares` as the worker count, whatever the pool size is by then,
+ * so temporaries sized from an earlier `workers()` always match. Shares are dealt round robin over the threads.
+ * Holds the pool for the whole call, so concurrent callers run one after the other. Waking the workers and
+ * waiting for them takes a mutex and a condition variable but never allocates.
+ */
+void                             run(Task task, void* context, std::size_t shares);
+
+/**
+ * @brief The calling thread's temporary arena, created on first use and destroyed when the thread exits.
+ *
+ * @return The arena, or `nullptr` if it could not be created.
+ */
+memory::stack_allocator::StackAllocator* scratch();
+
+} // namespace anvil::algorithms::internal
+
+#endif // ANVIL_THREAD_POOL_INTERNAL_HPP
@@ -0,0 +1,531 @@
+#include "algorithms/parallel.hpp"
+#include "internal/thread_pool.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/stack_allocator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+
+namespace anvil::algorithms {
+
+namespace {
+
+namespace stack_allocator = memory::stack_allocator;
+
+constexpr size_t RADIX_BITS    = 8;
+constexpr size_t RADIX_BUCKETS = size_t(1) << RADIX_BITS;
+constexpr size_t INSERTION_RUN = 32; // merge sort sorts runs of this many values by insertion first.
+
+/**
+ * @brief Records a scope on an arena and unwinds it when leaving the C++ scope.
+ */
+class Scope {
+public:
+        explicit Scope(stack_allocator::StackAllocator* const arena)
+            : arena_(arena), open_(arena && stack_allocator::record(arena) == ERR_SUCCESS) {}
+
+        ~Scope() {
+                if (open_) {
+                        static_cast<void>(stack_allocator::unwind(arena_));
+                }
+        }
+
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Allocates `count` objects of type T from the scope, `nullptr` if the arena is exhausted.
+         */
+        template <class T>
+        T* alloc(const size_t count) {
+                if (!open_) {
+                        return nullptr;
+                }
+                return static_cast<T*>(stack_allocator::alloc(arena_, count * sizeof(T), alignof(T)));
+        }
+
+private:
+        stack_allocator::StackAllocator* arena_;
+        bool                             open_;
+};
+
+/**
+ * @brief Bounds of the slice of `count` elements handled by `worker`; slices differ in size by at most one.
+ */
+struct Slice {
+        size_t begin;
+        size_t end;
+};
+
+Slice slice(const size_t count, const size_t worker, const size_t workers) {
+        const size_t base  = count / workers;
+        const size_t extra = count % workers;
+        const size_t begin = worker * base + std::min(worker, extra);
+        return {begin, begin + base + (worker < extra ? 1 : 0)};
+}
+
+/**
+ * @brief Runs `workers` shares of `task` on the pool, or on the calling thread alone for a single share.
+ */
+void dispatch(const internal::Task task, void* const context, const size_t workers) {
+        if (workers == 1) {
+                task(context, 0, 1);
+        } else {
+                internal::run(task, context, workers);
+        }
+}
+
+// ---------- Radix sort ----------
+
+template <class Key>
+struct RadixContext {
+        Key*       src;
+        Key*       dst;
+        size_t     count;
+        size_t     shift;
+        size_t*    counts; ///< RADIX_BUCKETS counters per worker; offsets once `radix_sort` summed them.
+        Key*       any_set; ///< Per worker OR of its keys.
+        Key*       all_set; ///< Per worker AND of its keys.
+};
+
+template <class Key>
+void radix_bits(void* const context, const size_t worker, const size_t workers) {
+        RadixContext<Key>& c = *static_cast<RadixContext<Key>*>(context);
+        const Slice        s = slice(c.count, worker, workers);
+        Key                any = 0, all = static_cast<Key>(~Key(0));
+        for (size_t i = s.begin; i < s.end; ++i) {
+                any |= c.src[i];
+                all &= c.src[i];
+        }
+        c.any_set[worker] = any;
+        c.all_set[worker] = all;
+}
+
+template <class Key>
+void radix_count(void* const context, const size_t worker, const size_t workers) {
+        RadixContext<Key>& c      = *static_cast<RadixContext<Key>*>(context);
+        const Slice        s      = slice(c.count, worker, workers);
+        size_t* const      counts = c.counts + worker * RADIX_BUCKETS;
+        std::memset(counts, 0, RADIX_BUCKETS * sizeof(size_t));
+        for (size_t i = s.begin; i < s.end; ++i) {
+                counts[(c.src[i] >> c.shift) & (RADIX_BUCKETS - 1)]++;
+        }
+}
+
+template <class Key>
+void radix_scatter(void* const context, const size_t worker, const size_t workers) {
+        RadixContext<Key>& c       = *static_cast<RadixContext<Key>*>(context);
+        const Slice        s       = slice(c.count, worker, workers);
+        size_t* const      offsets = c.counts + worker * RADIX_BUCKETS;
+        for (size_t i = s.begin; i < s.end; ++i) {
+                c.dst[offsets[(c.src[i] >> c.shift) & (RADIX_BUCKETS - 1)]++] = c.src[i];
+        }
+}
+
+template <class Key>
+void radix_copy(void* const context, const size_t worker, const size_t workers) {
+        RadixContext<Key>& c = *static_cast<RadixContext<Key>*>(context);
+        const Slice        s = slice(c.count, worker, workers);
+        std::memcpy(c.dst + s.begin, c.src + s.begin, (s.end - s.begin) * sizeof(Key));
+}
+
+template <class Key>
+Error radix_sort_keys(Key* const data, const size_t count) {
+        ANVIL_INVARIANT(data || count == 0, INV_NULL_POINTER, "data is null but count is %zu", count);
+        if (count < SERIAL_CUTOFF) {
+                std::sort(data, data + count);
+                return ERR_SUCCESS;
+        }
+
+        Scope             scope(internal::scratch());
+        const size_t      workers = internal::workers();
+        Key* const        buffer  = scope.alloc<Key>(count);
+        size_t* const     counts  = scope.alloc<size_t>(workers * RADIX_BUCKETS);
+        Key* const        any_set = scope.alloc<Key>(workers);
+        Key* const        all_set = scope.alloc<Key>(workers);
+        if (!buffer || !counts || !any_set || !all_set) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        RadixContext<Key> c{data, buffer, count, 0, counts, any_set, all_set};
+        internal::run(radix_bits<Key>, &c, workers);
+        Key any = 0, all = static_cast<Key>(~Key(0));
+        for (size_t w = 0; w < workers; ++w) {
+                any |= any_set[w];
+                all &= all_set[w];
+        }
+        const Key varying = any ^ all; // bits that differ between at least two keys
+
+        for (size_t shift = 0; shift < 8 * sizeof(Key); shift += RADIX_BITS) {
+                if (((varying >> shift) & (RADIX_BUCKETS - 1)) == 0) {
+                        continue;
+                }
+                c.shift = shift;
+                internal::run(radix_count<Key>, &c, workers);
+                size_t running = 0;
+                for (size_t digit = 0; digit < RADIX_BUCKETS; ++digit) {
+                        for (size_t w = 0; w < workers; ++w) {
+                                const size_t n                  = counts[w * RADIX_BUCKETS + digit];
+                                counts[w * RADIX_BUCKETS + digit] = running;
+                                running += n;
+                        }
+                }
+                internal::run(radix_scatter<Key>, &c, workers);
+                std::swap(c.src, c.dst);
+        }
+
+        if (c.src != data) {
+                c.dst = data;
+                internal::run(radix_copy<Key>, &c, workers);
+        }
+        return ERR_SUCCESS;
+}
+
+// ---------- Merge sort ----------
+
+/**
+ * @brief Merges the sorted ranges [a, a + na) and [b, b + nb) into `out`, taking from `a` on ties.
+ */
+void merge(const double* a, const size_t na, const double* b, const size_t nb, double* out) {
+        const double* const a_end = a + na;
+        const double* const b_end = b + nb;
+        while (a != a_end && b != b_end) {
+                *out++ = (*b < *a) ? *b++ : *a++;
+        }
+        std::memcpy(out, a, static_cast<size_t>(a_end - a) * sizeof(double));
+        std::memcpy(out + (a_end - a), b, static_cast<size_t>(b_end - b) * sizeof(double));
+}
+
+/**
+ * @brief Sorts `data[0..count)` stably with insertion-sorted runs merged bottom up through `buffer`.
+ */
+void merge_sort_serial(double* const data, double* const buffer, const size_t count) {
+        for (size_t run = 0; run < count; run += INSERTION_RUN) {
+                const size_t end = std::min(run + INSERTION_RUN, count);
+                for (size_t i = run + 1; i < end; ++i) {
+                        const double value = data[i];
+                        size_t       j     = i;
+                        for (; j > run && value < data[j - 1]; --j) {
+                                data[j] = data[j - 1];
+                        }
+                        data[j] = value;
+                }
+        }
+
+        double* src = data;
+        double* dst = buffer;
+        for (size_t width = INSERTION_RUN; width < count; width *= 2) {
+                for (size_t left = 0; left < count; left += 2 * width) {
+                        const size_t mid   = std::min(left + width, count);
+                        const size_t right = std::min(left + 2 * width, count);
+                        merge(src + left, mid - left, src + mid, right - mid, dst + left);
+                }
+                std::swap(src, dst);
+        }
+        if (src != data) {
+                std::memcpy(data, src, count * sizeof(double));
+        }
+}
+
+struct MergeContext {
+        double*           src;
+        double*           dst;
+        size_t            count;
+        size_t            workers; ///< Number of sorted slices, one per worker.
+        size_t            width;   ///< Slices per sorted run in the current round.
+        std::atomic<bool> failed{false};
+};
+
+void merge_sort_slices(void* const context, const size_t worker, const size_t workers) {
+        MergeContext& c = *static_cast<MergeContext*>(context);
+        const Slice   s = slice(c.count, worker, workers);
+        if (s.end == s.begin) {
+                return;
+        }
+        Scope         scope(internal::scratch());
+        double* const buffer = scope.alloc<double>(s.end - s.begin);
+        if (!buffer) {
+                c.failed.store(true, std::memory_order_relaxed);
+                return;
+        }
+        merge_sort_serial(c.src + s.begin, buffer, s.end - s.begin);
+}
+
+void merge_round(void* const context, const size_t worker, const size_t) {
+        MergeContext& c     = *static_cast<MergeContext*>(context);
+        const size_t  first = worker * 2 * c.width; // first slice of the pair merged by this worker
+        if (first >= c.workers) {
+                return;
+        }
+        const size_t left  = slice(c.count, first, c.workers).begin;
+        const size_t mid   = first + c.width < c.workers ? slice(c.count, first + c.width, c.workers).begin : c.count;
+        const size_t right = first + 2 * c.width < c.workers ? slice(c.count, first + 2 * c.width, c.workers).begin
+                                                              : c.count;
+        merge(c.src + left, mid - left, c.src + mid, right - mid, c.dst + left);
+}
+
+// ---------- Stable partition ----------
+
+struct PartitionContext {
+        std::uint64_t*    data;
+        std::uint64_t*    buffer; ///< Every worker's slice, selected values first.
+        size_t            count;
+        Predicate         predicate;
+        void*             predicate_context;
+        size_t*           selected; ///< Per worker number of selected values.
+        size_t*           offsets;  ///< Per worker destination of its selected values.
+        size_t            total;    ///< Number of selected values over all workers.
+        std::atomic<bool> failed{false};
+};
+
+void partition_slices(void* const context, const size_t worker, const size_t workers) {
+        PartitionContext& c = *static_cast<PartitionContext*>(context);
+        const Slice       s = slice(c.count, worker, workers);
+        c.selected[worker]  = 0;
+        if (s.end == s.begin) {
+                return;
+        }
+        Scope                scope(internal::scratch());
+        std::uint64_t* const rejected = scope.alloc<std::uint64_t>(s.end - s.begin);
+        if (!rejected) {
+                c.failed.store(true, std::memory_order_relaxed);
+                return;
+        }
+        size_t selected = 0, others = 0;
+        for (size_t i = s.begin; i < s.end; ++i) {
+                const std::uint64_t value = c.data[i];
+                if (c.predicate(value, c.predicate_context)) {
+                        c.buffer[s.begin + selected++] = value;
+                } else {
+                        rejected[others++] = value;
+                }
+        }
+        std::memcpy(c.buffer + s.begin + selected, rejected, others * sizeof(std::uint64_t));
+        c.selected[worker] = selected;
+}
+
+void partition_gather(void* const context, const size_t worker, const size_t workers) {
+        PartitionContext& c        = *static_cast<PartitionContext*>(context);
+        const Slice       s        = slice(c.count, worker, workers);
+        const size_t      selected = c.selected[worker];
+        const size_t      others   = s.end - s.begin - selected;
+        // Rejected values of earlier workers precede ours: total + (begin - selected values before us).
+        std::memcpy(c.data + c.offsets[worker], c.buffer + s.begin, selected * sizeof(std::uint64_t));
+        std::memcpy(c.data + c.total + (s.begin - c.offsets[worker]), c.buffer + s.begin + selected,
+                    others * sizeof(std::uint64_t));
+}
+
+// ---------- Exclusive scan ----------
+
+struct ScanContext {
+        const std::uint64_t* input;
+        std::uint64_t*       output;
+        size_t               count;
+        std::uint64_t*       sums; ///< Per worker sum, then per worker starting value.
+};
+
+void scan_sums(void* const context, const size_t worker, const size_t workers) {
+        ScanContext&  c   = *static_cast<ScanContext*>(context);
+        const Slice   s   = slice(c.count, worker, workers);
+        std::uint64_t sum = 0;
+        for (size_t i = s.begin; i < s.end; ++i) {
+                sum += c.input[i];
+        }
+        c.sums[worker] = sum;
+}
+
+void scan_slices(void* const context, const size_t worker, const size_t workers) {
+        ScanContext&  c       = *static_cast<ScanContext*>(context);
+        const Slice   s       = slice(c.count, worker, workers);
+        std::uint64_t running = c.sums[worker];
+        for (size_t i = s.begin; i < s.end; ++i) {
+                const std::uint64_t value = c.input[i]; // read first, `output` may alias `input`
+                c.output[i]               = running;
+                running += value;
+        }
+}
+
+// ---------- Histogram ----------
+
+struct HistogramContext {
+        const std::uint32_t* data;
+        size_t               count;
+        std::uint64_t*       counts;  ///< Result.
+        size_t               bins;
+        std::uint64_t*       partial; ///< `bins` counters per worker.
+        size_t               workers; ///< Workers that filled `partial`.
+};
+
+void histogram_slices(void* const context, const size_t worker, const size_t workers) {
+        HistogramContext&    c       = *static_cast<HistogramContext*>(context);
+        const Slice          s       = slice(c.count, worker, workers);
+        std::uint64_t* const partial = c.partial + worker * c.bins;
+        std::memset(partial, 0, c.bins * sizeof(std::uint64_t));
+        for (size_t i = s.begin; i < s.end; ++i) {
+                if (c.data[i] < c.bins) {
+                        partial[c.data[i]]++;
+                }
+        }
+}
+
+void histogram_reduce(void* const context, const size_t worker, const size_t workers) {
+        HistogramContext& c = *static_cast<HistogramContext*>(context);
+        const Slice       s = slice(c.bins, worker, workers);
+        for (size_t bin = s.begin; bin < s.end; ++bin) {
+                std::uint64_t total = 0;
+                for (size_t w = 0; w < c.workers; ++w) {
+                        total += c.partial[w * c.bins + bin];
+                }
+                c.counts[bin] = total;
+        }
+}
+
+} // namespace
+
+size_t concurrency() {
+        return internal::workers();
+}
+
+Error set_concurrency(const size_t workers) {
+        ANVIL_INVARIANT_POSITIVE(workers);
+
+        return internal::resize(workers);
+}
+
+Error radix_sort(uint32_t* const data, const size_t count) {
+        return radix_sort_keys(data, count);
+}
+
+Error radix_sort(uint64_t* const data, const size_t count) {
+        return radix_sort_keys(data, count);
+}
+
+Error merge_sort(double* const data, const size_t count) {
+        ANVIL_INVARIANT(data || count == 0, INV_NULL_POINTER, "data is null but count is %zu", count);
+        if (count < 2) {
+                return ERR_SUCCESS;
+        }
+
+        Scope         scope(internal::scratch());
+        const size_t  workers = count < SERIAL_CUTOFF ? 1 : internal::workers();
+        double* const buffer  = workers > 1 ? scope.alloc<double>(count) : nullptr;
+        if (workers > 1 && !buffer) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        MergeContext c;
+        c.src     = data;
+        c.dst     = buffer;
+        c.count   = count;
+        c.workers = workers;
+        dispatch(merge_sort_slices, &c, workers);
+        if (c.failed.load(std::memory_order_relaxed)) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        for (c.width = 1; c.width < workers; c.width *= 2) {
+                internal::run(merge_round, &c, workers);
+                std::swap(c.src, c.dst);
+        }
+        if (c.src != data) {
+                std::memcpy(data, c.src, count * sizeof(double));
+        }
+        return ERR_SUCCESS;
+}
+
+Error stable_partition(std::uint64_t* const data, const size_t count, const Predicate predicate, void* const context,
+                       size_t* const split) {
+        ANVIL_INVARIANT(data || count == 0, INV_NULL_POINTER, "data is null but count is %zu", count);
+        ANVIL_INVARIANT_NOT_NULL(predicate);
+        ANVIL_INVARIANT_NOT_NULL(split);
+        *split = 0;
+        if (count == 0) {
+                return ERR_SUCCESS;
+        }
+
+        Scope                scope(internal::scratch());
+        const size_t         workers  = count < SERIAL_CUTOFF ? 1 : internal::workers();
+        std::uint64_t* const buffer   = scope.alloc<std::uint64_t>(count);
+        size_t* const        selected = scope.alloc<size_t>(workers);
+        size_t* const        offsets  = scope.alloc<size_t>(workers);
+        if (!buffer || !selected || !offsets) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        PartitionContext c;
+        c.data              = data;
+        c.buffer            = buffer;
+        c.count             = count;
+        c.predicate         = predicate;
+        c.predicate_context = context;
+        c.selected          = selected;
+        c.offsets           = offsets;
+        dispatch(partition_slices, &c, workers);
+        if (c.failed.load(std::memory_order_relaxed)) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        size_t total = 0;
+        for (size_t w = 0; w < workers; ++w) {
+                offsets[w] = total;
+                total += selected[w];
+        }
+        c.total = total;
+        dispatch(partition_gather, &c, workers);
+
+        *split = total;
+        return ERR_SUCCESS;
+}
+
+Error exclusive_scan(const std::uint64_t* const input, std::uint64_t* const output, const size_t count,
+                     const std::uint64_t init) {
+        ANVIL_INVARIANT((input && output) || count == 0, INV_NULL_POINTER, "null array but count is %zu", count);
+        if (count == 0) {
+                return ERR_SUCCESS;
+        }
+
+        Scope                scope(internal::scratch());
+        const size_t         workers = count < SERIAL_CUTOFF ? 1 : internal::workers();
+        std::uint64_t* const sums    = scope.alloc<std::uint64_t>(workers);
+        if (!sums) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        ScanContext c{input, output, count, sums};
+        dispatch(scan_sums, &c, workers);
+        std::uint64_t running = init;
+        for (size_t w = 0; w < workers; ++w) {
+                const std::uint64_t sum = sums[w];
+                sums[w]                 = running;
+                running += sum;
+        }
+        dispatch(scan_slices, &c, workers);
+
+        return ERR_SUCCESS;
+}
+
+Error histogram(const std::uint32_t* const data, const size_t count, std::uint64_t* const counts, const size_t bins) {
+        ANVIL_INVARIANT(data || count == 0, INV_NULL_POINTER, "data is null but count is %zu", count);
+        ANVIL_INVARIANT_NOT_NULL(counts);
+        ANVIL_INVARIANT_POSITIVE(bins);
+
+        Scope                scope(internal::scratch());
+        const size_t         workers = count < SERIAL_CUTOFF ? 1 : internal::workers();
+        std::uint64_t* const partial = scope.alloc<std::uint64_t>(workers * bins);
+        if (!partial) {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        HistogramContext c{data, count, counts, bins, partial, workers};
+        dispatch(histogram_slices, &c, workers);
+        dispatch(histogram_reduce, &c, workers);
+
+        return ERR_SUCCESS;
+}
+
+} // namespace anvil::algorithms
@@ -0,0 +1,220 @@
+#include "algorithms/search.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/scratch_allocator.hpp"
+#include <bit>
+#include <cstdint>
+#include <limits>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+using std::size_t;
+using std::uint64_t;
+
+namespace anvil::algorithms {
+
+/**
+ * @brief Header of a search table, followed in the same region by its keys and ranks.
+ *
+ * Field        | Description
+ * ------------ | ---------------------------------------------------------------------
+ * magic        | SEARCH_TABLE_MAGIC, checked by every lookup
+ * layout       | Order of the keys
+ * count        | Number of keys in the sorted input
+ * slots        | Length of the key array, padding included
+ * bytes        | Size of the whole region
+ * ranks_offset | Offset of the rank array from the header; the keys start right after the header
+ *
+ * Every field is an offset or a size, so the region can be copied to any 64 byte aligned address.
+ */
+struct alignas(64) SearchTable {
+        std::uint32_t magic;
+        SearchLayout  layout;
+        uint64_t      count;
+        uint64_t      slots;
+        uint64_t      bytes;
+        uint64_t      ranks_offset;
+};
+
+namespace {
+
+namespace scratch_allocator = memory::scratch_allocator;
+
+constexpr std::uint32_t SEARCH_TABLE_MAGIC = 0x53544142; // "STAB"
+constexpr size_t        CACHE_LINE         = 64;
+constexpr size_t        BLOCK_KEYS         = CACHE_LINE / sizeof(uint64_t); // keys per B-tree block
+constexpr size_t        BLOCK_CHILDREN     = BLOCK_KEYS + 1;
+constexpr uint64_t      SIGN_BIT           = uint64_t(1) << 63; // B-tree keys are stored biased for signed compares
+
+static_assert(sizeof(SearchTable) == CACHE_LINE, "the keys must start on a cache line");
+
+uint64_t* keys_of(SearchTable* const table) {
+        return reinterpret_cast<uint64_t*>(table + 1);
+}
+
+const uint64_t* keys_of(const SearchTable* const table) {
+        return reinterpret_cast<const uint64_t*>(table + 1);
+}
+
+const uint64_t* ranks_of(const SearchTable* const table) {
+        return reinterpret_cast<const uint64_t*>(reinterpret_cast<const char*>(table) + table->ranks_offset);
+}
+
+/**
+ * @brief Fills the tables from the sorted input by an in-order walk of the implicit tree.
+ */
+struct Builder {
+        const uint64_t* input;
+        size_t          count;
+        uint64_t*       keys;
+        uint64_t*       ranks;
+        size_t          blocks; ///< B-tree only.
+        size_t          next = 0;
+
+        void eytzinger(const size_t node) {
+                if (node > count) {
+                        return;
+                }
+                eytzinger(2 * node);
+                keys[node]  = input[next];
+                ranks[node] = next++;
+                eytzinger(2 * node + 1);
+        }
+
+        // Slots past the input are padded with the largest key and rank `count`; being last in order, a padding
+        // slot is only ever the answer when no real key is.
+        void btree(const size_t block) {
+                if (block >= blocks) {
+                        return;
+                }
+                for (size_t i = 0; i < BLOCK_KEYS; ++i) {
+                        btree(block * BLOCK_CHILDREN + i + 1);
+                        const size_t   slot = block * BLOCK_KEYS + i;
+                        const uint64_t key  = next < count ? input[next] : std::numeric_limits<uint64_t>::max();
+                        keys[slot]          = key ^ SIGN_BIT;
+                        ranks[slot]         = next < count ? next : count;
+                        next++;
+                }
+                btree(block * BLOCK_CHILDREN + BLOCK_KEYS + 1);
+        }
+};
+
+/**
+ * @brief Number of keys in the block at `block` that are less than `needle`, both biased.
+ */
+size_t count_less(const uint64_t* const block, const uint64_t needle) {
+#ifdef __AVX2__
+        const __m256i broadcast = _mm256_set1_epi64x(static_cast<long long>(needle));
+        const __m256i low       = _mm256_load_si256(reinterpret_cast<const __m256i*>(block));
+        const __m256i high      = _mm256_load_si256(reinterpret_cast<const __m256i*>(block + 4));
+        const int     mask_low  = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(broadcast, low)));
+        const int     mask_high = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(broadcast, high)));
+        return static_cast<size_t>(std::popcount(static_cast<unsigned>(mask_low | (mask_high << 4))));
+#else
+        size_t less = 0;
+        for (size_t i = 0; i < BLOCK_KEYS; ++i) {
+                less += static_cast<std::int64_t>(block[i]) < static_cast<std::int64_t>(needle) ? 1 : 0;
+        }
+        return less;
+#endif
+}
+
+size_t eytzinger_lower_bound(const SearchTable* const table, const uint64_t key) {
+        const uint64_t* const keys  = keys_of(table);
+        const uint64_t        count = table->count;
+        size_t                node  = 1;
+        while (node <= count) {
+                // Descendants three levels down share one cache line; the address may lie past the table, which a
+                // prefetch tolerates.
+                const uintptr_t descendants = reinterpret_cast<uintptr_t>(keys) + node * CACHE_LINE;
+                __builtin_prefetch(reinterpret_cast<const void*>(descendants));
+                node = 2 * node + (keys[node] < key ? 1 : 0);
+        }
+        // Undo the right turns taken after the last left turn; that left turn was at the answer.
+        node >>= std::countr_zero(~node) + 1;
+        return ranks_of(table)[node];
+}
+
+size_t btree_lower_bound(const SearchTable* const table, const uint64_t key) {
+        const uint64_t* const keys   = keys_of(table);
+        const uint64_t* const ranks  = ranks_of(table);
+        const size_t          blocks = table->slots / BLOCK_KEYS;
+        const uint64_t        needle = key ^ SIGN_BIT;
+        size_t                rank   = table->count;
+        size_t                block  = 0;
+        while (block < blocks) {
+                const size_t less      = count_less(keys + block * BLOCK_KEYS, needle);
+                // When every key is less, this reads the next block's first rank, or the trailing one, and drops it.
+                const size_t candidate = ranks[block * BLOCK_KEYS + less];
+                rank                   = less < BLOCK_KEYS ? candidate : rank;
+                block                  = block * BLOCK_CHILDREN + less + 1;
+        }
+        return rank;
+}
+
+} // namespace
+
+const SearchTable* build_search_table(scratch_allocator::ScratchAllocator* const arena, const uint64_t* const keys,
+                                      const size_t count, const SearchLayout layout) {
+        ANVIL_INVARIANT_NOT_NULL(arena);
+        ANVIL_INVARIANT(keys || count == 0, INV_NULL_POINTER, "keys is null but count is %zu", count);
+        ANVIL_INVARIANT(layout == SearchLayout::Eytzinger || layout == SearchLayout::BTree, INV_INVALID_STATE,
+                        "unknown layout %u", static_cast<unsigned>(layout));
+
+        if (count > (std::numeric_limits<size_t>::max() - 4 * CACHE_LINE) / (4 * sizeof(uint64_t))) {
+                return nullptr;
+        }
+        const size_t blocks    = (count + BLOCK_KEYS - 1) / BLOCK_KEYS;
+        // Eytzinger slot zero is unused and holds the rank of "not found"; the B-tree keeps one trailing rank.
+        const size_t slots     = layout == SearchLayout::Eytzinger ? count + 1 : blocks * BLOCK_KEYS;
+        const size_t ranks     = layout == SearchLayout::Eytzinger ? slots : slots + 1;
+        const size_t key_bytes = (slots * sizeof(uint64_t) + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+        const size_t bytes     = sizeof(SearchTable) + key_bytes + ranks * sizeof(uint64_t);
+
+        auto* const table = static_cast<SearchTable*>(scratch_allocator::alloc(arena, bytes, CACHE_LINE));
+        if (!table) {
+                return nullptr;
+        }
+        table->magic        = SEARCH_TABLE_MAGIC;
+        table->layout       = layout;
+        table->count        = count;
+        table->slots        = slots;
+        table->bytes        = bytes;
+        table->ranks_offset = sizeof(SearchTable) + key_bytes;
+
+        uint64_t* const rank_array = reinterpret_cast<uint64_t*>(reinterpret_cast<char*>(table) + table->ranks_offset);
+        Builder         builder{keys, count, keys_of(table), rank_array, blocks};
+        if (layout == SearchLayout::Eytzinger) {
+                keys_of(table)[0] = 0;
+                rank_array[0]     = count;
+                builder.eytzinger(1);
+        } else {
+                builder.btree(0);
+                rank_array[slots] = count;
+        }
+
+        return table;
+}
+
+size_t lower_bound(const SearchTable* const table, const uint64_t key) {
+        ANVIL_INVARIANT_NOT_NULL(table);
+        ANVIL_INVARIANT(table->magic == SEARCH_TABLE_MAGIC, INV_INVALID_STATE, "not a search table");
+
+        return table->layout == SearchLayout::Eytzinger ? eytzinger_lower_bound(table, key)
+                                                         : btree_lower_bound(table, key);
+}
+
+size_t search_table_count(const SearchTable* const table) {
+        ANVIL_INVARIANT_NOT_NULL(table);
+
+        return table->count;
+}
+
+size_t search_table_bytes(const SearchTable* const table) {
+        ANVIL_INVARIANT_NOT_NULL(table);
+
+        return table->bytes;
+}
+
+} // namespace anvil::algorithms
@@ -0,0 +1,198 @@
+#include "internal/thread_pool.hpp"
+#include "algorithms/parallel.hpp"
+#include "memory/config.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/stack_allocator.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::size_t;
+
+namespace anvil::algorithms::internal {
+
+namespace {
+
+namespace stack_allocator = memory::stack_allocator;
+
+/**
+ * @brief Process-wide worker pool.
+ *
+ * Field      | Description
+ * ---------- | ---------------------------------------------------------------------
+ * run_mutex  | Held by `run` and `resize` for their whole duration
+ * mutex      | Guards every field below
+ * wake       | Signalled when `generation` advances or the workers must stop
+ * done       | Signalled when `pending` drops to zero
+ * threads    | Workers 1 .. size - 1; the caller of `run` is worker zero
+ * size       | Number of workers, zero until the pool is first used
+ * generation | Advanced once per `run`; a worker runs the task when it sees a new value
+ * task       | Task of the current generation
+ * context    | Context of the current generation
+ * shares     | Shares of the current generation, dealt round robin over the workers
+ * pending    | Threads that have not finished the current generation
+ * stopping   | Set while `resize` joins the threads
+ */
+struct Pool {
+        std::mutex               run_mutex;
+        std::mutex               mutex;
+        std::condition_variable  wake;
+        std::condition_variable  done;
+        std::vector<std::thread> threads;
+        size_t                   size       = 0;
+        std::uint64_t            generation = 0;
+        Task                     task       = nullptr;
+        void*                    context    = nullptr;
+        size_t                   shares     = 0;
+        size_t                   pending    = 0;
+        bool                     stopping   = false;
+
+        ~Pool() { stop(); }
+
+        void stop() {
+                {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        stopping = true;
+                }
+                wake.notify_all();
+                for (std::thread& thread : threads) {
+                        thread.join();
+                }
+                threads.clear();
+                stopping = false;
+                size     = 0;
+        }
+
+        void start(const size_t workers);
+};
+
+/**
+ * @brief Runs the shares of `task` dealt to worker `index` of `workers`.
+ */
+void run_shares(const Task task, void* const context, const size_t index, const size_t workers,
+                const size_t shares) {
+        for (size_t share = index; share < shares; share += workers) {
+                task(context, share, shares);
+        }
+}
+
+void work(Pool& pool, const size_t index, std::uint64_t seen) {
+        std::unique_lock<std::mutex> lock(pool.mutex);
+        for (;;) {
+                pool.wake.wait(lock, [&] { return pool.stopping || pool.generation != seen; });
+                if (pool.stopping) {
+                        return;
+                }
+                seen                 = pool.generation;
+                const Task   task    = pool.task;
+                void* const  context = pool.context;
+                const size_t shares  = pool.shares;
+                const size_t workers = pool.size;
+                lock.unlock();
+                run_shares(task, context, index, workers, shares);
+                lock.lock();
+                if (--pool.pending == 0) {
+                        pool.done.notify_one();
+                }
+        }
+}
+
+void Pool::start(const size_t workers) {
+        threads.reserve(workers - 1);
+        size = workers;
+        for (size_t index = 1; index < workers; ++index) {
+                // The generation is passed in, a thread that read it itself could miss a `run` issued meanwhile.
+                threads.emplace_back(work, std::ref(*this), index, generation);
+        }
+}
+
+Pool& pool() {
+        static Pool instance;
+        return instance;
+}
+
+size_t default_workers() {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        return hardware > 0 ? hardware : 1;
+}
+
+/**
+ * @brief Owns the calling thread's arena; destroyed with the thread.
+ */
+struct Scratch {
+        stack_allocator::StackAllocator* arena = nullptr;
+
+        ~Scratch() {
+                if (arena) {
+                        static_cast<void>(stack_allocator::destroy(&arena));
+                }
+        }
+};
+
+thread_local Scratch local;
+
+} // namespace
+
+size_t workers() {
+        Pool&                       p = pool();
+        std::lock_guard<std::mutex> lock(p.run_mutex);
+        return p.size > 0 ? p.size : default_workers();
+}
+
+Error resize(const size_t workers) {
+        ANVIL_INVARIANT_POSITIVE(workers);
+
+        Pool&                       p = pool();
+        std::lock_guard<std::mutex> lock(p.run_mutex);
+        p.stop();
+        p.start(workers);
+
+        return ERR_SUCCESS;
+}
+
+void run(const Task task, void* const context, const size_t shares) {
+        ANVIL_INVARIANT_NOT_NULL(task);
+        ANVIL_INVARIANT_POSITIVE(shares);
+
+        Pool&                       p = pool();
+        std::lock_guard<std::mutex> run_lock(p.run_mutex);
+        if (p.size == 0) {
+                p.start(default_workers());
+        }
+        if (p.size == 1 || shares == 1) {
+                run_shares(task, context, 0, 1, shares);
+                return;
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(p.mutex);
+                p.task    = task;
+                p.context = context;
+                p.shares  = shares;
+                p.pending = p.size - 1;
+                p.generation++;
+        }
+        p.wake.notify_all();
+
+        run_shares(task, context, 0, p.size, shares);
+
+        std::unique_lock<std::mutex> lock(p.mutex);
+        p.done.wait(lock, [&] { return p.pending == 0; });
+}
+
+stack_allocator::StackAllocator* scratch() {
+        if (!local.arena) {
+                const memory::config::ArenaConfig defaults{DEFAULT_SCRATCH_CAPACITY, 64,
+                                                           memory::AllocationStrategy::Lazy, std::size_t(1) << 20,
+                                                           memory::MappingFlags::None};
+                // One name for every worker: the config lookup stays `ANVIL_ARENA_ALGORITHMS_*` and the exporter
+                // sums the arenas into one series.
+                local.arena = memory::config::create_stack("algorithms", defaults);
+        }
+        return local.arena;
+}
+
+} // namespace anvil::algorithms::internal
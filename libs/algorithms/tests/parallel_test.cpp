@@ -0,0 +1,142 @@
+// parallel_test.cpp
+// Correctness of the parallel algorithms against their std counterparts, run by ctest.
+// - Every algorithm is checked at the sizes where the work is split differently: empty, one element, just
+//   below, at and just above SERIAL_CUTOFF, and a size that leaves uneven slices.
+// - Every size runs with one, three and eight workers, so slices are both fewer and more than the cores.
+// - Inputs include all-equal keys, which skip every radix pass, and values outside the histogram's bins.
+//
+// Run  :  ./algorithms_parallel_test
+
+#include "algorithms/parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace alg = anvil::algorithms;
+
+static int failures = 0;
+
+#define CHECK(condition, ...)                                                                                        \
+        do {                                                                                                         \
+                if (!(condition)) {                                                                                  \
+                        ++failures;                                                                                  \
+                        std::printf("FAIL %s:%d: %s - ", __FILE__, __LINE__, #condition);                          \
+                        std::printf(__VA_ARGS__);                                                                    \
+                        std::printf("\n");                                                                           \
+                }                                                                                                    \
+        } while (0)
+
+static const size_t SIZES[] = {0, 1, 2, alg::SERIAL_CUTOFF - 1, alg::SERIAL_CUTOFF, alg::SERIAL_CUTOFF + 1,
+                               3 * alg::SERIAL_CUTOFF + 7};
+static const size_t WORKERS[] = {1, 3, 8};
+
+template <class Key>
+static void check_radix_sort(std::mt19937_64& rng, const size_t n, const size_t workers) {
+        for (const bool equal : {false, true}) {
+                std::vector<Key> data(n);
+                for (Key& key : data) {
+                        key = equal ? Key(0x5A5A5A5A) : static_cast<Key>(rng());
+                }
+                std::vector<Key> expected = data;
+                std::sort(expected.begin(), expected.end());
+                CHECK(alg::radix_sort(data.data(), n) == ERR_SUCCESS, "n=%zu workers=%zu", n, workers);
+                CHECK(data == expected, "%zu bit keys, n=%zu workers=%zu equal=%d", 8 * sizeof(Key), n, workers,
+                      equal);
+        }
+}
+
+static void check_merge_sort(std::mt19937_64& rng, const size_t n, const size_t workers) {
+        // Few distinct values with both signs of zero, so stability is visible in the sign bits.
+        std::vector<double> data(n);
+        for (double& value : data) {
+                const uint64_t draw = rng() % 8;
+                value               = draw == 0 ? -0.0 : static_cast<double>(draw % 4);
+        }
+        std::vector<double> expected = data;
+        std::stable_sort(expected.begin(), expected.end());
+        CHECK(alg::merge_sort(data.data(), n) == ERR_SUCCESS, "n=%zu workers=%zu", n, workers);
+        bool same = true;
+        for (size_t i = 0; i < n && same; ++i) {
+                same = data[i] == expected[i] && std::signbit(data[i]) == std::signbit(expected[i]);
+        }
+        CHECK(same, "n=%zu workers=%zu", n, workers);
+}
+
+static void check_stable_partition(std::mt19937_64& rng, const size_t n, const size_t workers) {
+        std::vector<uint64_t> data(n);
+        for (uint64_t& value : data) {
+                value = rng();
+        }
+        std::vector<uint64_t> expected = data;
+        const auto            odd      = [](const uint64_t value) { return (value & 1) != 0; };
+        const auto            split_at = std::stable_partition(expected.begin(), expected.end(), odd);
+
+        size_t split = ~size_t(0);
+        CHECK(alg::stable_partition(data.data(), n, [](uint64_t value, void*) { return (value & 1) != 0; }, nullptr,
+                                    &split) == ERR_SUCCESS,
+              "n=%zu workers=%zu", n, workers);
+        CHECK(split == static_cast<size_t>(split_at - expected.begin()), "split=%zu n=%zu workers=%zu", split, n,
+              workers);
+        CHECK(data == expected, "n=%zu workers=%zu", n, workers);
+}
+
+static void check_exclusive_scan(std::mt19937_64& rng, const size_t n, const size_t workers) {
+        std::vector<uint64_t> input(n);
+        for (uint64_t& value : input) {
+                value = rng(); // sums wrap modulo 2^64
+        }
+        const uint64_t        init = 42;
+        std::vector<uint64_t> expected(n);
+        std::exclusive_scan(input.begin(), input.end(), expected.begin(), init);
+
+        std::vector<uint64_t> output(n);
+        CHECK(alg::exclusive_scan(input.data(), output.data(), n, init) == ERR_SUCCESS, "n=%zu workers=%zu", n,
+              workers);
+        CHECK(output == expected, "n=%zu workers=%zu", n, workers);
+        CHECK(alg::exclusive_scan(input.data(), input.data(), n, init) == ERR_SUCCESS, "n=%zu workers=%zu", n,
+              workers);
+        CHECK(input == expected, "in place, n=%zu workers=%zu", n, workers);
+}
+
+static void check_histogram(std::mt19937_64& rng, const size_t n, const size_t workers) {
+        // Bins well past the value range, a range past the bins, and a single bin.
+        for (const auto& [range, bins] : {std::pair<uint32_t, size_t>{10, 1000}, {1000, 10}, {4, 1}}) {
+                std::vector<uint32_t> data(n);
+                for (uint32_t& value : data) {
+                        value = static_cast<uint32_t>(rng() % range);
+                }
+                std::vector<uint64_t> expected(bins, 0);
+                for (const uint32_t value : data) {
+                        if (value < bins) {
+                                expected[value]++;
+                        }
+                }
+                std::vector<uint64_t> counts(bins, ~uint64_t(0));
+                CHECK(alg::histogram(data.data(), n, counts.data(), bins) == ERR_SUCCESS, "n=%zu workers=%zu", n,
+                      workers);
+                CHECK(counts == expected, "range=%u bins=%zu n=%zu workers=%zu", range, bins, n, workers);
+        }
+}
+
+int main() {
+        std::mt19937_64 rng(7);
+        for (const size_t workers : WORKERS) {
+                CHECK(alg::set_concurrency(workers) == ERR_SUCCESS, "workers=%zu", workers);
+                CHECK(alg::concurrency() == workers, "concurrency=%zu", alg::concurrency());
+                for (const size_t n : SIZES) {
+                        check_radix_sort<uint32_t>(rng, n, workers);
+                        check_radix_sort<uint64_t>(rng, n, workers);
+                        check_merge_sort(rng, n, workers);
+                        check_stable_partition(rng, n, workers);
+                        check_exclusive_scan(rng, n, workers);
+                        check_histogram(rng, n, workers);
+                }
+        }
+
+        std::printf("%s: %d failure(s)\n", failures == 0 ? "PASS" : "FAIL", failures);
+        return failures == 0 ? 0 : 1;
+}
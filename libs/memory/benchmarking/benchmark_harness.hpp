@@ -0,0 +1,473 @@
+// benchmark_harness.hpp
+// Shared timing harness for the Anvil allocator benchmarks.
+// - time_runs: whole-body wall-clock timing per run, reduced to median ± MAD ops/sec.
+// - PerfCounters: per-run hardware counters via perf_event_open, getrusage fault fallback.
+// - TscClock + LatencyHistogram: per-operation rdtsc/rdtscp latencies in an HDR-style
+//   log-linear histogram (< 1.6% relative error), reported as p50/p99/p99.9/p99.99/max.
+
+#ifndef ANVIL_BENCHMARK_HARNESS_HPP
+#define ANVIL_BENCHMARK_HARNESS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HAVE_PERF_EVENTS 1
+#else
+#define HAVE_PERF_EVENTS 0
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+using Clock = std::chrono::steady_clock;
+using ns    = std::chrono::nanoseconds;
+
+inline void barrier() {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+// -------- Hardware counters --------
+
+enum Counter : size_t {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        MINOR_FAULTS,
+        MAJOR_FAULTS,
+        COUNTER_COUNT
+};
+
+inline constexpr const char* COUNTER_NAMES[COUNTER_COUNT] = {"cycles",    "instr",       "L1d-miss", "LLC-miss",
+                                                             "dTLB-miss", "minor-fault", "major-fault"};
+
+struct CounterSample {
+        double value[COUNTER_COUNT]{};
+        bool   valid[COUNTER_COUNT]{};
+};
+
+// One counting fd per event rather than a group: a group fails as a whole when a single event is not
+// supported, separate fds keep whatever the PMU (or perf_event_paranoid) allows. Multiplexed counters
+// are scaled by time_enabled / time_running.
+class PerfCounters {
+      public:
+        PerfCounters() {
+#if HAVE_PERF_EVENTS
+                const uint64_t cache_read_miss =
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                open_event(CYCLES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+                open_event(INSTRUCTIONS, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+                open_event(L1D_MISSES, PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_read_miss);
+                open_event(LLC_MISSES, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+                open_event(DTLB_MISSES, PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_read_miss);
+                open_event(MINOR_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN);
+                open_event(MAJOR_FAULTS, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MAJ);
+#endif
+        }
+        ~PerfCounters() {
+#if HAVE_PERF_EVENTS
+                for (int fd : fd_)
+                        if (fd >= 0)
+                                close(fd);
+#endif
+        }
+        PerfCounters(const PerfCounters&)            = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+
+        bool hardware() const {
+                return fd_[CYCLES] >= 0;
+        }
+
+        void start() {
+#if HAVE_PERF_EVENTS
+                getrusage(RUSAGE_THREAD, &usage_);
+                for (int fd : fd_) {
+                        if (fd >= 0) {
+                                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                        }
+                }
+#endif
+        }
+
+        CounterSample stop() {
+                CounterSample out;
+#if HAVE_PERF_EVENTS
+                for (int fd : fd_)
+                        if (fd >= 0)
+                                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                rusage after{};
+                getrusage(RUSAGE_THREAD, &after);
+                for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                        uint64_t v[3] = {}; // value, time_enabled, time_running
+                        if (fd_[c] < 0 || read(fd_[c], v, sizeof(v)) != (ssize_t)sizeof(v))
+                                continue;
+                        out.value[c] = (v[2] > 0 && v[2] < v[1]) ? (double)v[0] * (double)v[1] / (double)v[2]
+                                                                 : (double)v[0];
+                        out.valid[c] = true;
+                }
+                // getrusage fallback for the software fault counters.
+                if (!out.valid[MINOR_FAULTS]) {
+                        out.value[MINOR_FAULTS] = (double)(after.ru_minflt - usage_.ru_minflt);
+                        out.valid[MINOR_FAULTS] = true;
+                }
+                if (!out.valid[MAJOR_FAULTS]) {
+                        out.value[MAJOR_FAULTS] = (double)(after.ru_majflt - usage_.ru_majflt);
+                        out.valid[MAJOR_FAULTS] = true;
+                }
+#endif
+                return out;
+        }
+
+      private:
+#if HAVE_PERF_EVENTS
+        void open_event(Counter c, uint32_t type, uint64_t config) {
+                perf_event_attr attr{};
+                attr.size           = sizeof(attr);
+                attr.type           = type;
+                attr.config         = config;
+                attr.disabled       = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv     = 1;
+                attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                fd_[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        }
+        rusage usage_{};
+#endif
+        int fd_[COUNTER_COUNT] = {-1, -1, -1, -1, -1, -1, -1};
+};
+
+inline PerfCounters& perf_counters() {
+        static PerfCounters counters;
+        return counters;
+}
+
+struct Stats {
+        std::vector<double> samples_ns;
+        double              median_ns{0}, mad_ns{0};
+        double              ops_per_sec{0}, ci_lo{0}, ci_hi{0};
+        double              ops_per_run{0};
+        CounterSample       per_op; // median over runs, divided by ops per run
+};
+
+inline double median_of(std::vector<double> v) {
+        if (v.empty())
+                return 0.0;
+        std::sort(v.begin(), v.end());
+        size_t n = v.size();
+        return (n & 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+inline double mad_of(const std::vector<double>& v, double med) {
+        if (v.empty())
+                return 0.0;
+        std::vector<double> d;
+        d.reserve(v.size());
+        for (double x : v)
+                d.push_back(std::fabs(x - med));
+        return median_of(std::move(d));
+}
+inline Stats make_stats(std::vector<double> s, std::vector<CounterSample> counters, double ops_per_run) {
+        if (s.size() > 1) {
+                s.erase(s.begin()); // drop warm-up
+                counters.erase(counters.begin());
+        }
+        Stats st;
+        for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                std::vector<double> values;
+                values.reserve(counters.size());
+                for (const CounterSample& sample : counters)
+                        if (sample.valid[c])
+                                values.push_back(sample.value[c]);
+                if (values.size() == counters.size() && !values.empty()) {
+                        st.per_op.value[c] = median_of(std::move(values)) / ops_per_run;
+                        st.per_op.valid[c] = true;
+                }
+        }
+        st.samples_ns  = s;
+        st.ops_per_run = ops_per_run;
+        st.median_ns   = std::max(1.0, median_of(s));
+        st.mad_ns      = std::max(1.0, mad_of(s, st.median_ns));
+        double secs    = st.median_ns * 1e-9;
+        st.ops_per_sec = (secs > 0) ? (ops_per_run / secs) : 0.0;
+        double lo_ns   = std::max(1.0, st.median_ns - 1.58 * st.mad_ns);
+        double hi_ns   = std::max(lo_ns * 1.0001, st.median_ns + 1.58 * st.mad_ns);
+        st.ci_lo       = ops_per_run / (hi_ns * 1e-9);
+        st.ci_hi       = ops_per_run / (lo_ns * 1e-9);
+        return st;
+}
+
+struct Config {
+        int         runs = 100, iters = 200000;
+        int         latency_sample = 1; // time every op in 1 of N outer iterations
+        bool        strict         = false;
+        std::string json_path, csv_path; // machine-readable results, empty = not written
+        std::string compare_path;        // previous JSON results to test for regressions against
+        double      alpha      = 0.01;   // significance level of the regression test
+        double      min_effect = 2.0;    // smallest median change, in percent, reported as a regression
+};
+
+// Fixed speedup gates apply in --strict mode unless --compare tests against a baseline instead.
+inline bool gates_enabled(const Config& cfg) {
+        return cfg.strict && cfg.compare_path.empty();
+}
+
+// Returns false when the program should exit (after --help).
+inline bool parse_config(Config& cfg, int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+                std::string a    = argv[i];
+                auto        next = [&](int& i) { return (i + 1 < argc) ? argv[++i] : nullptr; };
+                if (a == "--runs") {
+                        if (auto v = next(i))
+                                cfg.runs = std::atoi(v);
+                } else if (a == "--iters") {
+                        if (auto v = next(i))
+                                cfg.iters = std::atoi(v);
+                } else if (a == "--latency-sample") {
+                        if (auto v = next(i))
+                                cfg.latency_sample = std::max(1, std::atoi(v));
+                } else if (a == "--strict") {
+                        cfg.strict = true;
+                } else if (a == "--json") {
+                        if (auto v = next(i))
+                                cfg.json_path = v;
+                } else if (a == "--csv") {
+                        if (auto v = next(i))
+                                cfg.csv_path = v;
+                } else if (a == "--compare") {
+                        if (auto v = next(i))
+                                cfg.compare_path = v;
+                } else if (a == "--alpha") {
+                        if (auto v = next(i))
+                                cfg.alpha = std::atof(v);
+                } else if (a == "--min-effect") {
+                        if (auto v = next(i))
+                                cfg.min_effect = std::atof(v);
+                } else if (a == "--help") {
+                        std::cout << "Usage: " << argv[0]
+                                  << " [--runs N] [--iters N] [--latency-sample N] [--strict]\n"
+                                     "       [--json PATH] [--csv PATH] [--compare BASELINE.json] [--alpha P]\n"
+                                     "       [--min-effect PERCENT]\n";
+                        return false;
+                }
+        }
+        if (cfg.runs < 2)
+                cfg.runs = 2;
+        return true;
+}
+
+inline void print_counters(const char* label, const Stats& st) {
+        std::cout << "  " << label << " per op:" << std::fixed << std::setprecision(3);
+        for (size_t c = 0; c < COUNTER_COUNT; ++c)
+                if (st.per_op.valid[c])
+                        std::cout << " " << COUNTER_NAMES[c] << " " << st.per_op.value[c];
+        if (st.per_op.valid[CYCLES] && st.per_op.valid[INSTRUCTIONS] && st.per_op.value[CYCLES] > 0)
+                std::cout << " IPC " << std::setprecision(2) << st.per_op.value[INSTRUCTIONS] / st.per_op.value[CYCLES];
+        std::cout << "\n";
+}
+template <class FSetup, class FBody, class FTeardown>
+inline Stats time_runs(const Config& cfg, FSetup&& setup, FBody&& body, FTeardown&& teardown, double ops_per_run) {
+        std::vector<double>        s;
+        std::vector<CounterSample> counters;
+        s.reserve(cfg.runs);
+        counters.reserve(cfg.runs);
+        PerfCounters& perf = perf_counters();
+        for (int run = 0; run < cfg.runs; ++run) {
+                setup();
+                barrier();
+                perf.start();
+                auto t0 = Clock::now();
+                body();
+                auto t1 = Clock::now();
+                counters.push_back(perf.stop());
+                barrier();
+                teardown();
+                s.push_back((double)std::chrono::duration_cast<ns>(t1 - t0).count());
+        }
+        return make_stats(std::move(s), std::move(counters), ops_per_run);
+}
+
+// -------- Per-operation latency --------
+
+// Cycle counter calibrated to nanoseconds against steady_clock. `start` fences with lfence so earlier
+// work cannot drift into the measured window; `stop` uses rdtscp, which waits for the measured op to
+// retire. The cost of an empty start/stop pair is subtracted from every sample.
+class TscClock {
+      public:
+        TscClock() {
+#if HAVE_TSC
+                const auto     t0 = Clock::now();
+                const uint64_t c0 = start();
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                const uint64_t c1 = stop();
+                const auto     t1 = Clock::now();
+                ns_per_tick_      = (double)std::chrono::duration_cast<ns>(t1 - t0).count() / (double)(c1 - c0);
+#endif
+                std::vector<double> empty(1000);
+                for (double& e : empty) {
+                        const uint64_t a = start();
+                        e                = (double)(stop() - a);
+                }
+                overhead_ticks_ = *std::min_element(empty.begin(), empty.end());
+        }
+
+        static inline uint64_t start() {
+#if HAVE_TSC
+                _mm_lfence();
+                return __rdtsc();
+#else
+                return (uint64_t)std::chrono::duration_cast<ns>(Clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        static inline uint64_t stop() {
+#if HAVE_TSC
+                unsigned aux;
+                const uint64_t t = __rdtscp(&aux);
+                _mm_lfence();
+                return t;
+#else
+                return (uint64_t)std::chrono::duration_cast<ns>(Clock::now().time_since_epoch()).count();
+#endif
+        }
+
+        uint64_t to_ns(uint64_t ticks) const {
+                const double t = std::max(0.0, (double)ticks - overhead_ticks_);
+                return (uint64_t)std::llround(t * ns_per_tick_);
+        }
+
+      private:
+        double ns_per_tick_{1.0};
+        double overhead_ticks_{0.0};
+};
+
+inline TscClock& tsc_clock() {
+        static TscClock clock;
+        return clock;
+}
+
+// HDR-style log-linear histogram of nanosecond values: exact below 2^SUB_BITS, then 2^(SUB_BITS-1)
+// linear sub-buckets per power of two, i.e. < 1.6% relative error over the full uint64 range.
+class LatencyHistogram {
+      public:
+        static constexpr unsigned SUB_BITS  = 7;
+        static constexpr size_t   SUB_COUNT = size_t{1} << SUB_BITS;
+        static constexpr size_t   SUB_HALF  = SUB_COUNT / 2;
+        static constexpr size_t   BUCKETS   = SUB_COUNT + (64 - SUB_BITS) * SUB_HALF;
+
+        LatencyHistogram() : counts_(BUCKETS, 0) {}
+
+        void record(uint64_t v) {
+                ++counts_[index_of(v)];
+                ++count_;
+                max_ = std::max(max_, v);
+        }
+
+        void merge(const LatencyHistogram& other) {
+                for (size_t i = 0; i < BUCKETS; ++i)
+                        counts_[i] += other.counts_[i];
+                count_ += other.count_;
+                max_ = std::max(max_, other.max_);
+        }
+
+        uint64_t count() const {
+                return count_;
+        }
+        uint64_t max() const {
+                return max_;
+        }
+
+        // Highest value equivalent to the bucket holding the q-quantile (q in [0, 1]).
+        uint64_t percentile(double q) const {
+                if (count_ == 0)
+                        return 0;
+                const uint64_t rank = std::max<uint64_t>(1, (uint64_t)std::ceil(q * (double)count_));
+                uint64_t       seen = 0;
+                for (size_t i = 0; i < BUCKETS; ++i) {
+                        seen += counts_[i];
+                        if (seen >= rank)
+                                return std::min(max_, highest_of(i));
+                }
+                return max_;
+        }
+
+      private:
+        static size_t index_of(uint64_t v) {
+                if (v < SUB_COUNT)
+                        return (size_t)v;
+                const unsigned shift = (unsigned)std::bit_width(v) - SUB_BITS;
+                return SUB_COUNT + (shift - 1) * SUB_HALF + (size_t)((v >> shift) - SUB_HALF);
+        }
+        static uint64_t highest_of(size_t i) {
+                if (i < SUB_COUNT)
+                        return i;
+                const unsigned shift = (unsigned)((i - SUB_COUNT) / SUB_HALF) + 1;
+                const uint64_t top   = (i - SUB_COUNT) % SUB_HALF + SUB_HALF;
+                return ((top + 1) << shift) - 1;
+        }
+
+        std::vector<uint64_t> counts_;
+        uint64_t              count_{0};
+        uint64_t              max_{0};
+};
+
+// Times `op` into `h` when `timed`, otherwise just runs it; returns op's result.
+template <class F>
+inline auto timed_op(LatencyHistogram& h, bool timed, F&& op) {
+        if (!timed)
+                return op();
+        const uint64_t t0 = TscClock::start();
+        auto           r  = op();
+        const uint64_t t1 = TscClock::stop();
+        h.record(tsc_clock().to_ns(t1 - t0));
+        return r;
+}
+
+struct LatencyRow {
+        std::string      name;
+        LatencyHistogram hist;
+};
+
+inline void print_latency_table(const char* title, const Config& cfg, const std::vector<LatencyRow>& rows) {
+        std::cout << "\n=== " << title << " latency (ns, ";
+        if (cfg.latency_sample > 1)
+                std::cout << "every op in 1 of " << cfg.latency_sample << " iterations";
+        else
+                std::cout << "every op";
+        std::cout << ") ===\n";
+        std::cout << std::left << std::setw(24) << "operation" << std::right << std::setw(10) << "count" << std::setw(9)
+                  << "p50" << std::setw(9) << "p99" << std::setw(9) << "p99.9" << std::setw(9) << "p99.99"
+                  << std::setw(11) << "max" << "\n";
+        for (const LatencyRow& r : rows) {
+                const LatencyHistogram& h = r.hist;
+                std::cout << std::left << std::setw(24) << r.name << std::right << std::setw(10) << h.count()
+                          << std::setw(9) << h.percentile(0.50) << std::setw(9) << h.percentile(0.99) << std::setw(9)
+                          << h.percentile(0.999) << std::setw(9) << h.percentile(0.9999) << std::setw(11) << h.max()
+                          << "\n";
+        }
+}
+
+#endif // ANVIL_BENCHMARK_HARNESS_HPP
@@ -0,0 +1,417 @@
+// benchmark_report.hpp
+// Machine-readable benchmark results and baseline regression comparison.
+// - Benchmarks add every (workload, series) Stats and latency table to the process-wide report.
+// - --json PATH writes all samples, stats, counters, latency percentiles, machine info and the git
+//   revision; --csv PATH writes one line per run sample.
+// - --compare BASELINE.json loads a previous JSON result and runs a two-sided Mann-Whitney U test on
+//   the per-op times of every series present in both files. A series regresses when p < --alpha and
+//   its median got slower by at least --min-effect percent (with many runs the test alone flags shifts
+//   well below run-to-run noise); the verdict replaces the fixed speedup gates in --strict mode.
+
+#ifndef ANVIL_BENCHMARK_REPORT_HPP
+#define ANVIL_BENCHMARK_REPORT_HPP
+
+#include "benchmark_harness.hpp"
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sys/utsname.h>
+
+#ifndef ANVIL_GIT_REVISION
+#define ANVIL_GIT_REVISION "unknown"
+#endif
+
+struct SeriesResult {
+        std::string workload, series;
+        Stats       stats;
+};
+
+struct LatencyResult {
+        std::string table;
+        LatencyRow  row;
+};
+
+struct Report {
+        std::vector<SeriesResult>  series;
+        std::vector<LatencyResult> latencies;
+};
+
+inline Report& report() {
+        static Report r;
+        return r;
+}
+
+inline void report_series(const std::string& workload, const std::string& series, const Stats& stats) {
+        report().series.push_back({workload, series, stats});
+}
+
+inline void report_latencies(const std::string& table, const std::vector<LatencyRow>& rows) {
+        for (const LatencyRow& r : rows)
+                report().latencies.push_back({table, r});
+}
+
+// -------- JSON writing --------
+
+inline std::string json_string(const std::string& s) {
+        std::string out = "\"";
+        for (char c : s) {
+                switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                        if ((unsigned char)c < 0x20) {
+                                char esc[8];
+                                std::snprintf(esc, sizeof(esc), "\\u%04x", (unsigned)c);
+                                out += esc;
+                        } else {
+                                out += c;
+                        }
+                }
+        }
+        return out + "\"";
+}
+
+inline std::string json_number(double v) {
+        if (!std::isfinite(v))
+                return "null";
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.17g", v);
+        return buf;
+}
+
+inline std::string cpu_model() {
+        std::ifstream in("/proc/cpuinfo");
+        std::string   line;
+        while (std::getline(in, line))
+                if (line.rfind("model name", 0) == 0 && line.find(':') != std::string::npos)
+                        return line.substr(line.find(':') + 2);
+        return "unknown";
+}
+
+inline void write_machine(std::ostream& o) {
+        utsname u{};
+        uname(&u);
+        o << "  \"machine\": {\"os\": " << json_string(u.sysname) << ", \"release\": " << json_string(u.release)
+          << ", \"arch\": " << json_string(u.machine) << ", \"cpu\": " << json_string(cpu_model())
+          << ", \"cpus\": " << std::thread::hardware_concurrency() << ", \"compiler\": " << json_string(__VERSION__)
+          << ", \"hardware_counters\": " << (perf_counters().hardware() ? "true" : "false") << "},\n";
+}
+
+inline bool write_json(const Config& cfg, const std::string& benchmark) {
+        std::ofstream o(cfg.json_path);
+        if (!o)
+                return false;
+        char        timestamp[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+        o << "{\n  \"schema\": 1,\n  \"benchmark\": " << json_string(benchmark) << ",\n  \"git_revision\": "
+          << json_string(ANVIL_GIT_REVISION) << ",\n  \"timestamp\": " << json_string(timestamp) << ",\n";
+        write_machine(o);
+        o << "  \"config\": {\"runs\": " << cfg.runs << ", \"iters\": " << cfg.iters
+          << ", \"latency_sample\": " << cfg.latency_sample << "},\n";
+
+        o << "  \"results\": [";
+        const auto& series = report().series;
+        for (size_t i = 0; i < series.size(); ++i) {
+                const Stats& st = series[i].stats;
+                o << (i ? ",\n" : "\n") << "    {\"workload\": " << json_string(series[i].workload)
+                  << ", \"series\": " << json_string(series[i].series) << ", \"ops_per_run\": "
+                  << json_number(st.ops_per_run) << ", \"median_ns\": " << json_number(st.median_ns)
+                  << ", \"mad_ns\": " << json_number(st.mad_ns) << ", \"ops_per_sec\": " << json_number(st.ops_per_sec)
+                  << ", \"ci_lo\": " << json_number(st.ci_lo) << ", \"ci_hi\": " << json_number(st.ci_hi)
+                  << ", \"counters_per_op\": {";
+                bool first = true;
+                for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                        if (!st.per_op.valid[c])
+                                continue;
+                        o << (first ? "" : ", ") << json_string(COUNTER_NAMES[c]) << ": "
+                          << json_number(st.per_op.value[c]);
+                        first = false;
+                }
+                o << "}, \"samples_ns\": [";
+                for (size_t k = 0; k < st.samples_ns.size(); ++k)
+                        o << (k ? ", " : "") << json_number(st.samples_ns[k]);
+                o << "]}";
+        }
+        o << "\n  ],\n";
+
+        o << "  \"latency_ns\": [";
+        const auto& latencies = report().latencies;
+        for (size_t i = 0; i < latencies.size(); ++i) {
+                const LatencyHistogram& h = latencies[i].row.hist;
+                o << (i ? ",\n" : "\n") << "    {\"table\": " << json_string(latencies[i].table)
+                  << ", \"operation\": " << json_string(latencies[i].row.name) << ", \"count\": " << h.count()
+                  << ", \"p50\": " << h.percentile(0.50) << ", \"p99\": " << h.percentile(0.99)
+                  << ", \"p999\": " << h.percentile(0.999) << ", \"p9999\": " << h.percentile(0.9999)
+                  << ", \"max\": " << h.max() << "}";
+        }
+        o << "\n  ]\n}\n";
+        return (bool)o;
+}
+
+inline bool write_csv(const Config& cfg, const std::string& benchmark) {
+        std::ofstream o(cfg.csv_path);
+        if (!o)
+                return false;
+        o << "benchmark,git_revision,workload,series,run,sample_ns,ns_per_op,median_ns,mad_ns,ops_per_sec\n";
+        for (const SeriesResult& r : report().series) {
+                const Stats& st = r.stats;
+                for (size_t k = 0; k < st.samples_ns.size(); ++k)
+                        o << benchmark << "," << ANVIL_GIT_REVISION << ",\"" << r.workload << "\",\"" << r.series
+                          << "\"," << k << "," << json_number(st.samples_ns[k]) << ","
+                          << json_number(st.samples_ns[k] / st.ops_per_run) << "," << json_number(st.median_ns) << ","
+                          << json_number(st.mad_ns) << "," << json_number(st.ops_per_sec) << "\n";
+        }
+        return (bool)o;
+}
+
+// -------- JSON reading (just enough for the files written above) --------
+
+struct JsonValue {
+        enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+        double                           number{0};
+        std::string                      string;
+        std::vector<JsonValue>           array;
+        std::map<std::string, JsonValue> object;
+
+        const JsonValue* get(const std::string& key) const {
+                auto it = object.find(key);
+                return it == object.end() ? nullptr : &it->second;
+        }
+};
+
+class JsonParser {
+      public:
+        explicit JsonParser(std::string text) : text_(std::move(text)) {}
+
+        bool parse(JsonValue& out) {
+                pos_ = 0;
+                return value(out) && (skip(), pos_ == text_.size());
+        }
+
+      private:
+        void skip() {
+                while (pos_ < text_.size() && std::isspace((unsigned char)text_[pos_]))
+                        ++pos_;
+        }
+        bool eat(char c) {
+                skip();
+                if (pos_ < text_.size() && text_[pos_] == c) {
+                        ++pos_;
+                        return true;
+                }
+                return false;
+        }
+        bool literal(const char* word) {
+                const size_t n = std::strlen(word);
+                if (text_.compare(pos_, n, word) != 0)
+                        return false;
+                pos_ += n;
+                return true;
+        }
+        bool str(std::string& out) {
+                if (!eat('"'))
+                        return false;
+                while (pos_ < text_.size() && text_[pos_] != '"') {
+                        char c = text_[pos_++];
+                        if (c == '\\' && pos_ < text_.size()) {
+                                char e = text_[pos_++];
+                                switch (e) {
+                                case 'n': out += '\n'; break;
+                                case 't': out += '\t'; break;
+                                case 'u':
+                                        if (pos_ + 4 > text_.size())
+                                                return false;
+                                        out += (char)std::strtol(text_.substr(pos_, 4).c_str(), nullptr, 16);
+                                        pos_ += 4;
+                                        break;
+                                default: out += e; break;
+                                }
+                        } else {
+                                out += c;
+                        }
+                }
+                return eat('"');
+        }
+        bool value(JsonValue& out) {
+                skip();
+                if (pos_ >= text_.size())
+                        return false;
+                const char c = text_[pos_];
+                if (c == '{') {
+                        out.kind = JsonValue::Object;
+                        ++pos_;
+                        if (eat('}'))
+                                return true;
+                        do {
+                                std::string key;
+                                if (!str(key) || !eat(':') || !value(out.object[key]))
+                                        return false;
+                        } while (eat(','));
+                        return eat('}');
+                }
+                if (c == '[') {
+                        out.kind = JsonValue::Array;
+                        ++pos_;
+                        if (eat(']'))
+                                return true;
+                        do {
+                                out.array.emplace_back();
+                                if (!value(out.array.back()))
+                                        return false;
+                        } while (eat(','));
+                        return eat(']');
+                }
+                if (c == '"') {
+                        out.kind = JsonValue::String;
+                        return str(out.string);
+                }
+                if (literal("true") || literal("false")) {
+                        out.kind   = JsonValue::Bool;
+                        out.number = text_[pos_ - 1] == 'e' && text_[pos_ - 2] == 'u'; // "true" ends in "ue"
+                        return true;
+                }
+                if (literal("null")) {
+                        out.kind = JsonValue::Null;
+                        return true;
+                }
+                char*        end = nullptr;
+                const double v   = std::strtod(text_.c_str() + pos_, &end);
+                if (end == text_.c_str() + pos_)
+                        return false;
+                out.kind   = JsonValue::Number;
+                out.number = v;
+                pos_       = (size_t)(end - text_.c_str());
+                return true;
+        }
+
+        std::string text_;
+        size_t      pos_{0};
+};
+
+// -------- Mann-Whitney U --------
+
+struct UTest {
+        double u{0}, z{0}, p{1};
+};
+
+// Two-sided test with midranks for ties and the normal approximation (with tie and continuity
+// corrections); adequate for the >= 10 runs per series the benchmarks take.
+inline UTest mann_whitney_u(const std::vector<double>& a, const std::vector<double>& b) {
+        const size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+        UTest        t;
+        if (n1 == 0 || n2 == 0)
+                return t;
+        std::vector<std::pair<double, int>> all;
+        all.reserve(n);
+        for (double x : a)
+                all.push_back({x, 0});
+        for (double x : b)
+                all.push_back({x, 1});
+        std::sort(all.begin(), all.end());
+
+        double r1 = 0, ties = 0;
+        for (size_t i = 0; i < n;) {
+                size_t j = i;
+                while (j < n && all[j].first == all[i].first)
+                        ++j;
+                const double rank = 0.5 * (double)(i + 1 + j); // midrank of positions i+1 .. j
+                const double tn   = (double)(j - i);
+                ties += tn * tn * tn - tn;
+                for (size_t k = i; k < j; ++k)
+                        if (all[k].second == 0)
+                                r1 += rank;
+                i = j;
+        }
+        const double dn1 = (double)n1, dn2 = (double)n2, dn = (double)n;
+        t.u                = r1 - dn1 * (dn1 + 1) / 2;
+        const double mean  = dn1 * dn2 / 2;
+        const double sigma = std::sqrt(dn1 * dn2 / 12 * ((dn + 1) - ties / (dn * (dn - 1))));
+        if (sigma <= 0)
+                return t;
+        const double diff = t.u - mean;
+        t.z               = (diff - (diff > 0 ? 0.5 : diff < 0 ? -0.5 : 0.0)) / sigma;
+        t.p               = std::erfc(std::fabs(t.z) / std::sqrt(2.0));
+        return t;
+}
+
+// Returns the number of significant regressions, or -1 when the baseline cannot be read.
+inline int compare_with_baseline(const Config& cfg) {
+        std::ifstream in(cfg.compare_path);
+        if (!in) {
+                std::cout << "\ncompare: cannot open " << cfg.compare_path << "\n";
+                return -1;
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        JsonValue root;
+        if (!JsonParser(text.str()).parse(root) || !root.get("results")) {
+                std::cout << "\ncompare: " << cfg.compare_path << " is not a benchmark results file\n";
+                return -1;
+        }
+        const JsonValue* revision = root.get("git_revision");
+        std::cout << "\n=== Comparison against " << cfg.compare_path << " ("
+                  << (revision ? revision->string : "unknown") << " -> " << ANVIL_GIT_REVISION
+                  << ", Mann-Whitney U, alpha " << cfg.alpha << ", min effect " << cfg.min_effect << "%) ===\n";
+
+        int regressions = 0;
+        for (const SeriesResult& r : report().series) {
+                const JsonValue* base = nullptr;
+                for (const JsonValue& b : root.get("results")->array) {
+                        const JsonValue* w = b.get("workload");
+                        const JsonValue* s = b.get("series");
+                        if (w && s && w->string == r.workload && s->string == r.series) {
+                                base = &b;
+                                break;
+                        }
+                }
+                if (!base || !base->get("samples_ns") || !base->get("ops_per_run"))
+                        continue;
+
+                // Per-op times, so baselines taken with a different --iters remain comparable.
+                std::vector<double> before, after;
+                for (const JsonValue& v : base->get("samples_ns")->array)
+                        before.push_back(v.number / base->get("ops_per_run")->number);
+                for (double v : r.stats.samples_ns)
+                        after.push_back(v / r.stats.ops_per_run);
+
+                const UTest  t       = mann_whitney_u(after, before);
+                const double m0      = median_of(before), m1 = median_of(after);
+                const double change  = m0 > 0 ? (m1 - m0) / m0 * 100 : 0;
+                const bool   sig     = t.p < cfg.alpha && std::fabs(change) >= cfg.min_effect;
+                const char*  verdict = !sig ? "same" : (m1 > m0 ? "REGRESSION" : "improved");
+                if (sig && m1 > m0)
+                        ++regressions;
+                std::cout << "  " << std::left << std::setw(44) << (r.workload + "/" + r.series) << std::right
+                          << std::fixed << std::setprecision(2) << std::setw(10) << m0 << " -> " << std::setw(10)
+                          << m1 << " ns/op " << std::showpos << std::setw(8) << change << std::noshowpos << "%  p="
+                          << std::scientific << std::setprecision(1) << t.p << std::fixed << "  " << verdict << "\n";
+        }
+        std::cout << "Regressions: " << regressions << "\n";
+        return regressions;
+}
+
+// Writes the requested outputs and runs the comparison. Returns true when the run should fail:
+// an output could not be written, or --strict with --compare found a regression.
+inline bool finish_report(const Config& cfg, const std::string& benchmark) {
+        bool failed = false;
+        if (!cfg.json_path.empty() && !write_json(cfg, benchmark)) {
+                std::cout << "failed to write " << cfg.json_path << "\n";
+                failed = true;
+        }
+        if (!cfg.csv_path.empty() && !write_csv(cfg, benchmark)) {
+                std::cout << "failed to write " << cfg.csv_path << "\n";
+                failed = true;
+        }
+        if (!cfg.compare_path.empty()) {
+                const int regressions = compare_with_baseline(cfg);
+                failed |= regressions < 0 || (cfg.strict && regressions > 0);
+        }
+        return failed;
+}
+
+#endif // ANVIL_BENCHMARK_REPORT_HPP
@@ -0,0 +1,552 @@
+// lifecycle_benchmark.cpp
+// Arena lifecycle costs: create/destroy, reset, and the VMAs arenas leave behind.
+// - Create/destroy: per-op TSC latency of create (mmap + madvise [+ mprotect] + header fault) and destroy
+//   (munmap) for capacities 4 KiB .. 4 GiB (--max-capacity MiB), for scratch, Eager stack and Lazy stack
+//   arenas, with transparent huge pages as the system configures them and disabled for the process
+//   (prctl PR_SET_THP_DISABLE). Each created arena makes one 64 B allocation before it is destroyed.
+// - Reset vs used size: latency of a plain reset, of zeroing the used bytes before the reset, and of
+//   decommitting the used pages (madvise MADV_DONTNEED) before the reset, plus the cost of refilling the
+//   arena afterwards, which is where zeroing and decommit pay again (cache misses, page faults).
+// - VMA churn: random create/destroy churn per arena kind (Lazy arenas commit a random prefix, which
+//   splits their mapping) while sampling the line count of /proc/self/maps; reports VMAs per live arena,
+//   the live-arena ceiling implied by vm.max_map_count, and VMAs left behind once every arena is gone.
+// - Fork: latency of fork + child _exit + waitpid with one fully touched Eager stack alive, for the default
+//   mapping and for arenas mapped DontFork / WipeOnFork, which the child does not copy page tables for.
+// - Grow: growing a touched dedicated mapping (anvil_memory_alloc_eager) to twice its size with
+//   anvil_memory_realloc (mremap, page table entries move) vs allocate + memcpy + deallocate.
+// - Per-connection arenas: create + (for a share of the connections) one 64 B allocation + destroy, with a
+//   scratch arena vs a deferred handle that maps on first allocation, for 0%, 30% and 100% of connections
+//   allocating.
+// - Exits 0 by default; use --strict to return non-zero when churn leaves VMAs behind or a deferred
+//   handle that never allocated was mapped.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp).
+//
+// Run  :  ./memory_lifecycle_benchmark --iters 20000 [--max-capacity MiB] [--strict]
+
+#include "internal/memory_allocation.hpp"
+#include "memory/constants.hpp"
+#include "memory/deferred_allocator.hpp"
+#include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
+#include <fstream>
+#include <random>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "benchmark_report.hpp"
+
+using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
+using StackAllocator   = anvil::memory::stack_allocator::StackAllocator;
+using anvil::memory::AllocationStrategy;
+using anvil::memory::MappingFlags;
+using anvil::memory::MIN_ALIGNMENT;
+namespace sa = anvil::memory::scratch_allocator;
+namespace st = anvil::memory::stack_allocator;
+namespace da = anvil::memory::deferred_allocator;
+
+static constexpr size_t KiB  = 1024;
+static constexpr size_t MiB  = 1024 * KiB;
+static constexpr size_t GiB  = 1024 * MiB;
+static constexpr size_t PAGE = 4096;
+
+static void touch(void* p) {
+        if (p)
+                *(volatile uint8_t*)p = 1;
+}
+
+static std::string size_label(size_t bytes) {
+        if (bytes >= GiB)
+                return std::to_string(bytes / GiB) + " GiB";
+        if (bytes >= MiB)
+                return std::to_string(bytes / MiB) + " MiB";
+        return std::to_string(bytes / KiB) + " KiB";
+}
+
+static std::string read_first_line(const char* path) {
+        std::ifstream in(path);
+        std::string   line;
+        std::getline(in, line);
+        return line.empty() ? "unavailable" : line;
+}
+
+// -------- Arena kinds --------
+
+enum class Kind { Scratch, Eager, Lazy };
+static constexpr Kind KINDS[] = {Kind::Scratch, Kind::Eager, Kind::Lazy};
+
+static const char* kind_name(Kind k) {
+        switch (k) {
+        case Kind::Scratch:
+                return "scratch";
+        case Kind::Eager:
+                return "eager stack";
+        case Kind::Lazy:
+                return "lazy stack";
+        }
+        return "unknown";
+}
+
+// A scratch or stack arena behind one interface; `ok` is false when create failed.
+struct Arena {
+        ScratchAllocator* scratch{nullptr};
+        StackAllocator*   stack{nullptr};
+
+        static Arena create(Kind k, size_t capacity) {
+                Arena a;
+                if (k == Kind::Scratch)
+                        a.scratch = sa::create(capacity, MIN_ALIGNMENT);
+                else
+                        a.stack = st::create(capacity, MIN_ALIGNMENT,
+                                             k == Kind::Eager ? AllocationStrategy::Eager : AllocationStrategy::Lazy);
+                return a;
+        }
+        bool ok() const {
+                return scratch || stack;
+        }
+        void* alloc(size_t size) {
+                return scratch ? sa::alloc(scratch, size, MIN_ALIGNMENT) : st::alloc(stack, size, MIN_ALIGNMENT);
+        }
+        void destroy() {
+                (void)(scratch ? sa::destroy(&scratch) : st::destroy(&stack));
+        }
+};
+
+// -------- Create / destroy --------
+
+struct LifecycleRow {
+        std::string      label;
+        LatencyHistogram create, destroy;
+        size_t           failed{0};
+};
+
+static LifecycleRow create_destroy(const Config& cfg, Kind k, size_t capacity, const char* thp) {
+        LifecycleRow row{std::string(kind_name(k)) + ", " + size_label(capacity) + ", THP " + thp, {}, {}, 0};
+        const int    pairs = std::clamp(cfg.iters / 200, 10, 200);
+        for (int i = 0; i < pairs; ++i) {
+                uint64_t t0 = TscClock::start();
+                Arena    a  = Arena::create(k, capacity);
+                uint64_t t1 = TscClock::stop();
+                if (!a.ok()) {
+                        ++row.failed;
+                        continue;
+                }
+                row.create.record(tsc_clock().to_ns(t1 - t0));
+                touch(a.alloc(64));
+                t0 = TscClock::start();
+                a.destroy();
+                t1 = TscClock::stop();
+                row.destroy.record(tsc_clock().to_ns(t1 - t0));
+        }
+        return row;
+}
+
+static void create_destroy_table(const Config& cfg, size_t max_capacity) {
+        std::vector<LifecycleRow> rows;
+        for (int thp_disabled = 0; thp_disabled <= 1; ++thp_disabled) {
+                const bool  set = prctl(PR_SET_THP_DISABLE, thp_disabled, 0, 0, 0) == 0;
+                const char* thp = thp_disabled ? (set ? "off" : "off (prctl failed)") : "system";
+                for (Kind k : KINDS)
+                        for (size_t capacity = 4 * KiB; capacity <= max_capacity; capacity *= 4)
+                                rows.push_back(create_destroy(cfg, k, capacity, thp));
+        }
+        (void)prctl(PR_SET_THP_DISABLE, 0, 0, 0, 0);
+
+        std::cout << "\n=== create / destroy latency (ns) ===\n";
+        std::cout << std::left << std::setw(36) << "arena" << std::right << std::setw(11) << "create p50"
+                  << std::setw(11) << "p99" << std::setw(12) << "destroy p50" << std::setw(11) << "p99"
+                  << std::setw(8) << "failed" << "\n";
+        std::vector<LatencyRow> report_rows;
+        for (const LifecycleRow& r : rows) {
+                std::cout << std::left << std::setw(36) << r.label << std::right << std::setw(11)
+                          << r.create.percentile(0.50) << std::setw(11) << r.create.percentile(0.99) << std::setw(12)
+                          << r.destroy.percentile(0.50) << std::setw(11) << r.destroy.percentile(0.99)
+                          << std::setw(8) << r.failed << "\n";
+                report_rows.push_back({"create " + r.label, r.create});
+                report_rows.push_back({"destroy " + r.label, r.destroy});
+        }
+        report_latencies("create/destroy", report_rows);
+}
+
+// -------- Reset vs used size --------
+
+enum class ResetMode { Plain, Zero, Decommit };
+
+static const char* reset_name(ResetMode m) {
+        switch (m) {
+        case ResetMode::Plain:
+                return "reset";
+        case ResetMode::Zero:
+                return "zero+reset";
+        case ResetMode::Decommit:
+                return "decommit+reset";
+        }
+        return "unknown";
+}
+
+struct ResetCell {
+        LatencyHistogram reset, refill;
+};
+
+// Fills `used` bytes of an Eager stack page by page, then times the reset variant and the next fill.
+static ResetCell reset_cell(size_t used, ResetMode mode) {
+        ResetCell       cell;
+        StackAllocator* a      = st::create(used + PAGE, MIN_ALIGNMENT, AllocationStrategy::Eager);
+        const int       cycles = (int)std::clamp<size_t>(256 * MiB / used, 8, 256);
+        auto            fill   = [&] {
+                uint8_t* p = (uint8_t*)st::alloc(a, used, MIN_ALIGNMENT);
+                for (size_t off = 0; off < used; off += PAGE)
+                        p[off] = 1;
+                return p;
+        };
+        uint8_t* block = fill();
+        for (int c = 0; c < cycles; ++c) {
+                uint64_t t0 = TscClock::start();
+                if (mode == ResetMode::Zero) {
+                        std::memset(block, 0, used);
+                } else if (mode == ResetMode::Decommit) {
+                        const uintptr_t lo = ((uintptr_t)block + PAGE - 1) & ~(PAGE - 1);
+                        const uintptr_t hi = ((uintptr_t)block + used) & ~(PAGE - 1);
+                        if (hi > lo)
+                                (void)madvise((void*)lo, hi - lo, MADV_DONTNEED);
+                }
+                (void)st::reset(a);
+                uint64_t t1 = TscClock::stop();
+                cell.reset.record(tsc_clock().to_ns(t1 - t0));
+
+                t0    = TscClock::start();
+                block = fill();
+                t1    = TscClock::stop();
+                cell.refill.record(tsc_clock().to_ns(t1 - t0));
+        }
+        (void)st::destroy(&a);
+        return cell;
+}
+
+static void reset_table(size_t max_used) {
+        static constexpr ResetMode MODES[] = {ResetMode::Plain, ResetMode::Zero, ResetMode::Decommit};
+        std::cout << "\n=== reset vs used size, Eager stack (p50 ns; refill = touching every used page again) ===\n";
+        std::cout << std::left << std::setw(10) << "used" << std::right;
+        for (ResetMode m : MODES)
+                std::cout << std::setw(16) << reset_name(m);
+        for (ResetMode m : MODES)
+                std::cout << std::setw(22) << std::string("refill after ") + (m == ResetMode::Plain ? "reset"
+                                                                             : m == ResetMode::Zero ? "zero"
+                                                                                                    : "decommit");
+        std::cout << "\n";
+        std::vector<LatencyRow> report_rows;
+        for (size_t used = 4 * KiB; used <= max_used; used *= 4) {
+                std::vector<ResetCell> cells;
+                for (ResetMode m : MODES)
+                        cells.push_back(reset_cell(used, m));
+                std::cout << std::left << std::setw(10) << size_label(used) << std::right;
+                for (const ResetCell& c : cells)
+                        std::cout << std::setw(16) << c.reset.percentile(0.50);
+                for (const ResetCell& c : cells)
+                        std::cout << std::setw(22) << c.refill.percentile(0.50);
+                std::cout << "\n";
+                for (size_t i = 0; i < cells.size(); ++i) {
+                        const std::string name = std::string(reset_name(MODES[i])) + " " + size_label(used);
+                        report_rows.push_back({name, cells[i].reset});
+                        report_rows.push_back({"refill after " + name, cells[i].refill});
+                }
+        }
+        report_latencies("reset", report_rows);
+}
+
+// -------- VMA churn --------
+
+static size_t vma_count() {
+        std::ifstream in("/proc/self/maps");
+        size_t        n = 0;
+        for (std::string line; std::getline(in, line);)
+                ++n;
+        return n;
+}
+
+struct ChurnResult {
+        size_t baseline, peak, peak_live, final_count;
+        double vmas_per_arena;
+};
+
+// Random create/destroy with up to LIVE arenas alive; Lazy arenas commit a random prefix of their capacity.
+static ChurnResult churn(Kind k, int steps) {
+        static constexpr size_t LIVE = 64;
+        std::mt19937_64         rng(11);
+        std::vector<Arena>      live;
+        live.reserve(LIVE);
+        ChurnResult r{vma_count(), 0, 0, 0, 0};
+        r.peak = r.baseline;
+        for (int s = 0; s < steps; ++s) {
+                const bool grow = live.empty() || (live.size() < LIVE && rng() % 2 == 0);
+                if (grow) {
+                        const size_t capacity = (size_t)1 << (12 + rng() % 15); // 4 KiB .. 64 MiB
+                        Arena        a        = Arena::create(k, capacity);
+                        if (!a.ok())
+                                continue;
+                        if (k == Kind::Lazy && capacity > PAGE)
+                                touch(a.alloc(1 + rng() % (capacity / 2)));
+                        live.push_back(a);
+                } else {
+                        const size_t victim = rng() % live.size();
+                        live[victim].destroy();
+                        live[victim] = live.back();
+                        live.pop_back();
+                }
+                const size_t vmas = vma_count();
+                if (vmas > r.peak) {
+                        r.peak      = vmas;
+                        r.peak_live = live.size();
+                }
+                if (!live.empty())
+                        r.vmas_per_arena = std::max(r.vmas_per_arena, (double)(vmas - std::min(vmas, r.baseline)) /
+                                                                          (double)live.size());
+        }
+        for (Arena& a : live)
+                a.destroy();
+        r.final_count = vma_count();
+        return r;
+}
+
+static bool churn_table(const Config& cfg) {
+        const size_t max_map_count = std::strtoull(read_first_line("/proc/sys/vm/max_map_count").c_str(), nullptr, 10);
+        const int    steps         = std::max(100, cfg.iters / 10);
+        std::cout << "\n=== VMA churn (" << steps << " random create/destroy steps, up to 64 live arenas, "
+                  << "vm.max_map_count " << max_map_count << ") ===\n";
+        std::cout << std::left << std::setw(14) << "arena" << std::right << std::setw(10) << "baseline" << std::setw(8)
+                  << "peak" << std::setw(11) << "live@peak" << std::setw(12) << "VMAs/arena" << std::setw(14)
+                  << "arena limit" << std::setw(8) << "final" << std::setw(9) << "leaked" << "\n";
+        bool leaked = false;
+        for (Kind k : KINDS) {
+                const ChurnResult r     = churn(k, steps);
+                const long        left  = (long)r.final_count - (long)r.baseline;
+                const double      limit = r.vmas_per_arena > 0 ? (double)max_map_count / r.vmas_per_arena : 0;
+                std::cout << std::left << std::setw(14) << kind_name(k) << std::right << std::setw(10) << r.baseline
+                          << std::setw(8) << r.peak << std::setw(11) << r.peak_live << std::setw(12) << std::fixed
+                          << std::setprecision(2) << r.vmas_per_arena << std::setw(14) << std::setprecision(0) << limit
+                          << std::setw(8) << r.final_count << std::setw(9) << std::max(0L, left) << "\n";
+                leaked |= left > 0;
+        }
+        return leaked;
+}
+
+// -------- Fork --------
+
+static const char* mapping_name(MappingFlags m) {
+        switch (m) {
+        case MappingFlags::None:
+                return "default";
+        case MappingFlags::DontFork:
+                return "DontFork";
+        case MappingFlags::WipeOnFork:
+                return "WipeOnFork";
+        default:
+                return "mixed";
+        }
+}
+
+// Times fork + child _exit + waitpid with a fully touched Eager stack of `used` bytes mapped with `m`.
+static bool fork_cell(size_t used, MappingFlags m, LatencyHistogram& h) {
+        StackAllocator* a = st::create(used + PAGE, MIN_ALIGNMENT, AllocationStrategy::Eager, m);
+        if (!a)
+                return false;
+        uint8_t* p = (uint8_t*)st::alloc(a, used, MIN_ALIGNMENT);
+        for (size_t off = 0; off < used; off += PAGE)
+                p[off] = 1;
+        const int forks = (int)std::clamp<size_t>(1 * GiB / used, 4, 64);
+        for (int i = 0; i < forks; ++i) {
+                uint64_t    t0  = TscClock::start();
+                const pid_t pid = fork();
+                if (pid == 0)
+                        _exit(0);
+                if (pid < 0)
+                        break;
+                int status = 0;
+                (void)waitpid(pid, &status, 0);
+                uint64_t t1 = TscClock::stop();
+                h.record(tsc_clock().to_ns(t1 - t0));
+        }
+        (void)st::destroy(&a);
+        return true;
+}
+
+static void fork_table(size_t max_used) {
+        static constexpr MappingFlags MODES[] = {MappingFlags::None, MappingFlags::DontFork, MappingFlags::WipeOnFork};
+        std::cout << "\n=== fork + _exit + waitpid with one touched Eager stack alive (p50 ns) ===\n";
+        std::cout << std::left << std::setw(10) << "used" << std::right;
+        for (MappingFlags m : MODES)
+                std::cout << std::setw(14) << mapping_name(m);
+        std::cout << "\n";
+        std::vector<LatencyRow> report_rows;
+        for (size_t used = 1 * MiB; used <= max_used; used *= 4) {
+                std::cout << std::left << std::setw(10) << size_label(used) << std::right;
+                for (MappingFlags m : MODES) {
+                        LatencyHistogram h;
+                        if (!fork_cell(used, m, h)) {
+                                std::cout << std::setw(14) << "n/a";
+                                continue;
+                        }
+                        std::cout << std::setw(14) << h.percentile(0.50);
+                        report_rows.push_back({std::string("fork ") + mapping_name(m) + " " + size_label(used), h});
+                }
+                std::cout << "\n";
+        }
+        report_latencies("fork", report_rows);
+}
+
+// -------- Grow a dedicated mapping --------
+
+struct GrowCell {
+        LatencyHistogram remap, copy;
+};
+
+// Times doubling a touched mapping of `size` bytes both ways; each sample starts from a fresh mapping.
+static GrowCell grow_cell(size_t size) {
+        GrowCell  cell;
+        const int samples = (int)std::clamp<size_t>(512 * MiB / size, 3, 32);
+        auto      fresh   = [&] {
+                uint8_t* p = (uint8_t*)anvil_memory_alloc_eager(size, MIN_ALIGNMENT);
+                if (p)
+                        std::memset(p, 1, size);
+                return p;
+        };
+        for (int i = 0; i < samples; ++i) {
+                uint8_t* p = fresh();
+                if (!p)
+                        break;
+                uint64_t t0    = TscClock::start();
+                void*    grown = anvil_memory_realloc(p, 2 * size);
+                uint64_t t1    = TscClock::stop();
+                if (!grown) {
+                        (void)anvil_memory_dealloc(p);
+                        break;
+                }
+                cell.remap.record(tsc_clock().to_ns(t1 - t0));
+                (void)anvil_memory_dealloc(grown);
+
+                p     = fresh();
+                t0    = TscClock::start();
+                grown = anvil_memory_alloc_eager(2 * size, MIN_ALIGNMENT);
+                if (grown) {
+                        std::memcpy(grown, p, size);
+                        (void)anvil_memory_dealloc(p);
+                }
+                t1 = TscClock::stop();
+                if (!grown) {
+                        (void)anvil_memory_dealloc(p);
+                        break;
+                }
+                cell.copy.record(tsc_clock().to_ns(t1 - t0));
+                (void)anvil_memory_dealloc(grown);
+        }
+        return cell;
+}
+
+static void grow_table(size_t max_size) {
+        std::cout << "\n=== grow a touched dedicated mapping to twice its size (p50 ns) ===\n";
+        std::cout << std::left << std::setw(10) << "from" << std::right << std::setw(16) << "mremap" << std::setw(20)
+                  << "alloc+memcpy+free" << std::setw(10) << "ratio" << "\n";
+        std::vector<LatencyRow> report_rows;
+        for (size_t size = 1 * MiB; size <= max_size; size *= 4) {
+                const GrowCell cell  = grow_cell(size);
+                const size_t   remap = cell.remap.percentile(0.50);
+                const size_t   copy  = cell.copy.percentile(0.50);
+                std::cout << std::left << std::setw(10) << size_label(size) << std::right << std::setw(16) << remap
+                          << std::setw(20) << copy << std::setw(9) << std::fixed << std::setprecision(1)
+                          << (remap ? (double)copy / (double)remap : 0.0) << "x\n";
+                report_rows.push_back({"grow mremap " + size_label(size), cell.remap});
+                report_rows.push_back({"grow copy " + size_label(size), cell.copy});
+        }
+        report_latencies("grow", report_rows);
+}
+
+// -------- Per-connection arenas --------
+
+// Times a connection's arena lifetime with a scratch arena and with a deferred handle, `percent` of the
+// connections allocating. Returns the number of deferred handles that were mapped without allocating.
+static size_t connection_cell(const Config& cfg, int percent, LatencyHistogram& scratch, LatencyHistogram& deferred) {
+        const int       connections = std::clamp(cfg.iters / 10, 100, 2000);
+        std::mt19937_64 rng(7);
+        size_t          mapped_unused = 0;
+        for (int i = 0; i < connections; ++i) {
+                const bool uses = int(rng() % 100) < percent;
+
+                uint64_t          t0 = TscClock::start();
+                ScratchAllocator* a  = sa::create(64 * KiB, MIN_ALIGNMENT);
+                if (uses)
+                        touch(sa::alloc(a, 64, MIN_ALIGNMENT));
+                (void)sa::destroy(&a);
+                uint64_t t1 = TscClock::stop();
+                scratch.record(tsc_clock().to_ns(t1 - t0));
+
+                t0                      = TscClock::start();
+                da::DeferredAllocator d = da::create(64 * KiB, MIN_ALIGNMENT);
+                if (uses)
+                        touch(da::alloc(&d, 64, MIN_ALIGNMENT));
+                const bool was_mapped = da::mapped(&d);
+                (void)da::destroy(&d);
+                t1 = TscClock::stop();
+                deferred.record(tsc_clock().to_ns(t1 - t0));
+                mapped_unused += (!uses && was_mapped) ? 1 : 0;
+        }
+        return mapped_unused;
+}
+
+static bool connection_table(const Config& cfg) {
+        std::cout << "\n=== per-connection arena: create [+ alloc 64 B] + destroy (ns) ===\n";
+        std::cout << std::left << std::setw(12) << "allocating" << std::right << std::setw(14) << "scratch p50"
+                  << std::setw(11) << "p99" << std::setw(15) << "deferred p50" << std::setw(11) << "p99"
+                  << std::setw(10) << "ratio" << "\n";
+        std::vector<LatencyRow> report_rows;
+        size_t                  mapped_unused = 0;
+        for (const int percent : {0, 30, 100}) {
+                LatencyHistogram scratch, deferred;
+                mapped_unused += connection_cell(cfg, percent, scratch, deferred);
+                const size_t s50 = scratch.percentile(0.50), d50 = deferred.percentile(0.50);
+                std::cout << std::left << std::setw(12) << (std::to_string(percent) + "%") << std::right
+                          << std::setw(14) << s50 << std::setw(11) << scratch.percentile(0.99) << std::setw(15)
+                          << d50 << std::setw(11) << deferred.percentile(0.99) << std::setw(9) << std::fixed
+                          << std::setprecision(1) << (d50 ? (double)s50 / (double)d50 : 0.0) << "x\n";
+                report_rows.push_back({"connection scratch " + std::to_string(percent) + "%", scratch});
+                report_rows.push_back({"connection deferred " + std::to_string(percent) + "%", deferred});
+        }
+        report_latencies("connection", report_rows);
+        if (mapped_unused > 0)
+                std::cout << mapped_unused << " deferred handles were mapped without allocating\n";
+        return mapped_unused > 0;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        size_t max_capacity = 4 * GiB;
+        for (int i = 1; i + 1 < argc; ++i)
+                if (std::string(argv[i]) == "--max-capacity")
+                        max_capacity = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10)) * MiB;
+        if (!parse_config(cfg, argc, argv)) {
+                std::cout << "       [--max-capacity MiB]\n";
+                return 0;
+        }
+
+        std::cout << "=== Anvil Arena Lifecycle Benchmark ===\n";
+        std::cout << "(transparent_hugepage: " << read_first_line("/sys/kernel/mm/transparent_hugepage/enabled")
+                  << ")\n";
+
+        create_destroy_table(cfg, max_capacity);
+        reset_table(std::min<size_t>(max_capacity, 64 * MiB));
+        const bool leaked = churn_table(cfg);
+        fork_table(std::min<size_t>(max_capacity, 1 * GiB));
+        grow_table(std::min<size_t>(max_capacity / 2, 256 * MiB));
+        const bool mapped_unused = connection_table(cfg);
+
+        bool failed = false;
+        if (leaked && gates_enabled(cfg)) {
+                std::cout << "\nFAIL: arena churn left VMAs behind\n";
+                failed = true;
+        }
+        if (mapped_unused && gates_enabled(cfg)) {
+                std::cout << "\nFAIL: deferred handles were mapped without allocating\n";
+                failed = true;
+        }
+        return finish_report(cfg, "memory_lifecycle_benchmark") || failed ? 1 : 0;
+}
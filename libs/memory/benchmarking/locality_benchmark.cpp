@@ -0,0 +1,530 @@
+// locality_benchmark.cpp
+// Traversal speed of pointer-linked structures by where their nodes were placed.
+// - Structures: a singly linked list walked front to back, an unbalanced binary search tree and a chained
+//   hash table, both probed with every key in random order; node sizes 32, 64 and 256 B.
+// - Sources: ScratchAllocator, StackAllocator (Eager), malloc on the current heap and malloc after a
+//   fragmentation warm-up (mixed-size blocks allocated, then a random half freed and the rest kept alive
+//   for the build), which scatters nodes across the heap the way a long-running process does.
+// - Only traversals are timed; builds happen once per row. Results are per node visited: ns, bytes of
+//   address space the structure spans, and L1d/LLC misses when hardware counters are available.
+// - Alignment: 48 B nodes at natural (8 B) vs cache-line (64 B) alignment, sequential and random access.
+// - Hot/cold split: 256 B nodes inline vs a 24 B hot node pointing at its cold payload, with the cold
+//   parts interleaved in the same arena or kept in a second arena; 1 in 16 visits reads the payload.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp); --iters is the node count.
+//
+// Run  :  ./memory_locality_benchmark --runs 7 --iters 200000
+
+#include "memory/constants.hpp"
+#include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
+#include <numeric>
+#include <random>
+
+#include "benchmark_report.hpp"
+
+using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
+using StackAllocator   = anvil::memory::stack_allocator::StackAllocator;
+using anvil::memory::AllocationStrategy;
+using anvil::memory::MIN_ALIGNMENT;
+namespace sa = anvil::memory::scratch_allocator;
+namespace st = anvil::memory::stack_allocator;
+
+static constexpr size_t NATURAL_ALIGNMENT = alignof(void*);
+static constexpr size_t CACHE_LINE        = 64;
+static constexpr size_t COLD_EVERY        = 16;  // hot/cold: 1 in COLD_EVERY visits reads the payload
+static constexpr size_t COLD_OFFSET       = 128; // hot/cold: payload byte read, away from the hot fields
+
+static volatile uint64_t sink;
+
+// -------- Node placement --------
+
+enum class SourceKind { Scratch, Stack, Malloc, MallocFragmented };
+
+// Where nodes come from. `open` prepares for a build of at most `bytes` bytes, `close` releases every
+// node (and, for the fragmented heap, the warm-up survivors).
+class Source {
+      public:
+        explicit Source(SourceKind kind) : kind_(kind) {}
+
+        const char* name() const {
+                switch (kind_) {
+                case SourceKind::Scratch:
+                        return "scratch";
+                case SourceKind::Stack:
+                        return "stack";
+                case SourceKind::Malloc:
+                        return "malloc";
+                case SourceKind::MallocFragmented:
+                        return "malloc frag";
+                }
+                return "unknown";
+        }
+
+        void open(size_t bytes) {
+                if (kind_ == SourceKind::Scratch)
+                        scratch_ = sa::create(bytes, MIN_ALIGNMENT);
+                else if (kind_ == SourceKind::Stack)
+                        stack_ = st::create(bytes, MIN_ALIGNMENT, AllocationStrategy::Eager);
+                else if (kind_ == SourceKind::MallocFragmented)
+                        fragment(bytes);
+        }
+
+        void* alloc(size_t size, size_t align) {
+                void* p = nullptr;
+                if (scratch_)
+                        p = sa::alloc(scratch_, size, align);
+                else if (stack_)
+                        p = st::alloc(stack_, size, align);
+                else {
+                        p = align <= 16 ? std::malloc(size)
+                                        : std::aligned_alloc(align, (size + align - 1) / align * align);
+                        blocks_.push_back(p);
+                }
+                if (!p) {
+                        std::cerr << name() << ": out of memory\n";
+                        std::exit(1);
+                }
+                lo_ = std::min(lo_, (uintptr_t)p);
+                hi_ = std::max(hi_, (uintptr_t)p + size);
+                return p;
+        }
+
+        // Bytes of address space between the lowest and highest node handed out since `open`.
+        size_t span() const {
+                return hi_ > lo_ ? hi_ - lo_ : 0;
+        }
+
+        void close() {
+                if (scratch_)
+                        (void)sa::destroy(&scratch_);
+                if (stack_)
+                        (void)st::destroy(&stack_);
+                for (void* p : blocks_)
+                        std::free(p);
+                for (void* p : holdouts_)
+                        std::free(p);
+                blocks_.clear();
+                holdouts_.clear();
+                lo_ = UINTPTR_MAX;
+                hi_ = 0;
+        }
+
+      private:
+        // Allocates ~2x `bytes` in mixed sizes around the node sizes, then frees a random half: the
+        // builds that follow are served from free lists scattered through the heap.
+        void fragment(size_t bytes) {
+                std::mt19937_64                       rng(7);
+                std::uniform_int_distribution<size_t> size(16, 512);
+                std::vector<void*>                    warm;
+                for (size_t total = 0; total < 2 * bytes;) {
+                        const size_t s = size(rng);
+                        warm.push_back(std::malloc(s));
+                        *(volatile uint8_t*)warm.back() = 1;
+                        total += s;
+                }
+                std::shuffle(warm.begin(), warm.end(), rng);
+                for (size_t i = 0; i < warm.size(); ++i) {
+                        if (i % 2 == 0)
+                                std::free(warm[i]);
+                        else
+                                holdouts_.push_back(warm[i]);
+                }
+        }
+
+        SourceKind         kind_;
+        ScratchAllocator*  scratch_{nullptr};
+        StackAllocator*    stack_{nullptr};
+        std::vector<void*> blocks_;
+        std::vector<void*> holdouts_;
+        uintptr_t          lo_{UINTPTR_MAX};
+        uintptr_t          hi_{0};
+};
+
+// -------- Structures --------
+
+template <size_t Bytes>
+struct ListNode {
+        ListNode* next;
+        uint64_t  key;
+        uint8_t   payload[Bytes - 16];
+};
+
+template <size_t Bytes>
+struct TreeNode {
+        TreeNode* left;
+        TreeNode* right;
+        uint64_t  key;
+        uint8_t   payload[Bytes - 24];
+};
+
+template <size_t Bytes>
+struct ChainNode {
+        ChainNode* next;
+        uint64_t   key;
+        uint8_t    payload[Bytes - 16];
+};
+
+struct Cold {
+        uint8_t payload[256 - 24];
+};
+
+struct HotNode {
+        HotNode* next;
+        uint64_t key;
+        Cold*    cold;
+};
+
+template <class Node>
+static Node* make_node(Source& src, size_t align, uint64_t key) {
+        Node* n = (Node*)src.alloc(sizeof(Node), align);
+        std::memset((void*)n, 0, sizeof(Node));
+        n->key = key;
+        return n;
+}
+
+static std::vector<uint64_t> shuffled_keys(size_t n, uint64_t seed) {
+        std::vector<uint64_t> keys(n);
+        std::iota(keys.begin(), keys.end(), uint64_t{1});
+        std::mt19937_64 rng(seed);
+        std::shuffle(keys.begin(), keys.end(), rng);
+        return keys;
+}
+
+template <size_t Bytes>
+static ListNode<Bytes>* build_list(Source& src, size_t n, size_t align) {
+        ListNode<Bytes>*  head = nullptr;
+        ListNode<Bytes>** tail = &head;
+        for (size_t i = 0; i < n; ++i) {
+                *tail = make_node<ListNode<Bytes>>(src, align, i);
+                tail  = &(*tail)->next;
+        }
+        return head;
+}
+
+template <size_t Bytes>
+static uint64_t walk_list(const ListNode<Bytes>* head) {
+        uint64_t sum = 0, visited = 0;
+        for (const ListNode<Bytes>* p = head; p; p = p->next, ++visited)
+                sum += p->key;
+        sink = sum;
+        return visited;
+}
+
+template <size_t Bytes>
+static TreeNode<Bytes>* build_tree(Source& src, const std::vector<uint64_t>& keys, size_t align) {
+        TreeNode<Bytes>* root = nullptr;
+        for (uint64_t k : keys) {
+                TreeNode<Bytes>** slot = &root;
+                while (*slot)
+                        slot = k < (*slot)->key ? &(*slot)->left : &(*slot)->right;
+                *slot = make_node<TreeNode<Bytes>>(src, align, k);
+        }
+        return root;
+}
+
+template <size_t Bytes>
+static uint64_t probe_tree(const TreeNode<Bytes>* root, const std::vector<uint64_t>& probes) {
+        uint64_t found = 0, visited = 0;
+        for (uint64_t k : probes) {
+                const TreeNode<Bytes>* p = root;
+                while (p && p->key != k) {
+                        ++visited;
+                        p = k < p->key ? p->left : p->right;
+                }
+                visited += p != nullptr;
+                found += p != nullptr;
+        }
+        sink = found;
+        return visited;
+}
+
+template <size_t Bytes>
+struct HashTable {
+        ChainNode<Bytes>** buckets;
+        size_t             mask;
+};
+
+template <size_t Bytes>
+static HashTable<Bytes> build_hash(Source& src, const std::vector<uint64_t>& keys, size_t align) {
+        const size_t     count = std::bit_ceil(std::max<size_t>(1, keys.size() / 4)); // ~4 nodes per chain
+        HashTable<Bytes> h{(ChainNode<Bytes>**)src.alloc(count * sizeof(void*), CACHE_LINE), count - 1};
+        std::memset((void*)h.buckets, 0, count * sizeof(void*));
+        for (uint64_t k : keys) {
+                ChainNode<Bytes>*& bucket = h.buckets[(k * 0x9E3779B97F4A7C15ull >> 20) & h.mask];
+                ChainNode<Bytes>*  n      = make_node<ChainNode<Bytes>>(src, align, k);
+                n->next                   = bucket;
+                bucket                    = n;
+        }
+        return h;
+}
+
+template <size_t Bytes>
+static uint64_t probe_hash(const HashTable<Bytes>& h, const std::vector<uint64_t>& probes) {
+        uint64_t found = 0, visited = 0;
+        for (uint64_t k : probes) {
+                const ChainNode<Bytes>* p = h.buckets[(k * 0x9E3779B97F4A7C15ull >> 20) & h.mask];
+                while (p && p->key != k) {
+                        ++visited;
+                        p = p->next;
+                }
+                visited += p != nullptr;
+                found += p != nullptr;
+        }
+        sink = found;
+        return visited;
+}
+
+// -------- Measurement --------
+
+struct Row {
+        std::string label;
+        Stats       stats;
+        double      span_per_node;
+};
+
+// Builds once, then times `walk` (which returns the nodes it visited) over cfg.runs traversals.
+template <class Build, class Walk>
+static Row measure(const Config& cfg, std::string label, size_t nodes, Build&& build, Walk&& walk) {
+        const size_t span    = build();
+        const double visited = (double)walk();
+        const Stats  stats   = time_runs(cfg, [] {}, [&] { (void)walk(); }, [] {}, visited);
+        return {std::move(label), stats, (double)span / (double)nodes};
+}
+
+static void print_table(const std::string& title, const std::vector<Row>& rows) {
+        std::cout << "\n" << title << "\n";
+        std::cout << std::left << std::setw(26) << "  placement" << std::right << std::setw(10) << "ns/node"
+                  << std::setw(9) << "± MAD" << std::setw(13) << "span B/node" << std::setw(11) << "L1d-miss"
+                  << std::setw(11) << "LLC-miss" << std::setw(12) << "vs first" << "\n";
+        auto counter = [](const Stats& s, Counter c) {
+                std::ostringstream o;
+                if (s.per_op.valid[c])
+                        o << std::fixed << std::setprecision(3) << s.per_op.value[c];
+                else
+                        o << "-";
+                return o.str();
+        };
+        for (const Row& r : rows) {
+                report_series(title, r.label, r.stats);
+                const double per_node = r.stats.median_ns / r.stats.ops_per_run;
+                const double first    = rows.front().stats.median_ns / rows.front().stats.ops_per_run;
+                std::cout << "  " << std::left << std::setw(24) << r.label << std::right << std::fixed
+                          << std::setprecision(2) << std::setw(10) << per_node << std::setw(9)
+                          << r.stats.mad_ns / r.stats.ops_per_run << std::setw(13) << std::setprecision(1)
+                          << r.span_per_node << std::setw(11) << counter(r.stats, L1D_MISSES) << std::setw(11)
+                          << counter(r.stats, LLC_MISSES) << std::setw(11) << std::setprecision(2)
+                          << first / per_node << "x\n";
+        }
+}
+
+static constexpr SourceKind SOURCES[] = {SourceKind::MallocFragmented, SourceKind::Malloc, SourceKind::Scratch,
+                                         SourceKind::Stack};
+
+// Arena capacity for `n` nodes of `bytes` at `align`, plus room for a hash table's bucket array.
+static size_t capacity_for(size_t n, size_t bytes, size_t align) {
+        return n * ((bytes + align - 1) / align * align) + n * sizeof(void*) + (1 << 20);
+}
+
+template <size_t Bytes>
+static void list_rows(const Config& cfg, size_t n) {
+        std::vector<Row> rows;
+        for (SourceKind kind : SOURCES) {
+                Source           src(kind);
+                ListNode<Bytes>* head = nullptr;
+                src.open(capacity_for(n, Bytes, NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, src.name(), n,
+                    [&] {
+                            head = build_list<Bytes>(src, n, NATURAL_ALIGNMENT);
+                            return src.span();
+                    },
+                    [&] { return walk_list(head); }));
+                src.close();
+        }
+        print_table("list walk, " + std::to_string(Bytes) + " B nodes", rows);
+}
+
+template <size_t Bytes>
+static void tree_rows(const Config& cfg, size_t n) {
+        const std::vector<uint64_t> keys   = shuffled_keys(n, 1);
+        const std::vector<uint64_t> probes = shuffled_keys(n, 2);
+        std::vector<Row>            rows;
+        for (SourceKind kind : SOURCES) {
+                Source           src(kind);
+                TreeNode<Bytes>* root = nullptr;
+                src.open(capacity_for(n, Bytes, NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, src.name(), n,
+                    [&] {
+                            root = build_tree<Bytes>(src, keys, NATURAL_ALIGNMENT);
+                            return src.span();
+                    },
+                    [&] { return probe_tree(root, probes); }));
+                src.close();
+        }
+        print_table("tree lookup, " + std::to_string(Bytes) + " B nodes", rows);
+}
+
+template <size_t Bytes>
+static void hash_rows(const Config& cfg, size_t n) {
+        const std::vector<uint64_t> keys   = shuffled_keys(n, 3);
+        const std::vector<uint64_t> probes = shuffled_keys(n, 4);
+        std::vector<Row>            rows;
+        for (SourceKind kind : SOURCES) {
+                Source           src(kind);
+                HashTable<Bytes> table{};
+                src.open(capacity_for(n, Bytes, NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, src.name(), n,
+                    [&] {
+                            table = build_hash<Bytes>(src, keys, NATURAL_ALIGNMENT);
+                            return src.span();
+                    },
+                    [&] { return probe_hash(table, probes); }));
+                src.close();
+        }
+        print_table("hash chain lookup, " + std::to_string(Bytes) + " B nodes", rows);
+}
+
+// 48 B nodes: at 8 B alignment they pack 4 to 3 cache lines and every other node straddles a line; at
+// 64 B alignment each node owns a line, wasting a quarter of it.
+static void alignment_rows(const Config& cfg, size_t n) {
+        const std::vector<uint64_t> keys   = shuffled_keys(n, 5);
+        const std::vector<uint64_t> probes = shuffled_keys(n, 6);
+        std::vector<Row>            list, tree;
+        for (size_t align : {NATURAL_ALIGNMENT, CACHE_LINE}) {
+                Source        src(SourceKind::Stack);
+                ListNode<48>* head = nullptr;
+                src.open(capacity_for(n, 48, align));
+                list.push_back(measure(
+                    cfg, "align " + std::to_string(align), n,
+                    [&] {
+                            head = build_list<48>(src, n, align);
+                            return src.span();
+                    },
+                    [&] { return walk_list(head); }));
+                src.close();
+        }
+        for (size_t align : {NATURAL_ALIGNMENT, CACHE_LINE}) {
+                Source        src(SourceKind::Stack);
+                TreeNode<48>* root = nullptr;
+                src.open(capacity_for(n, 48, align));
+                tree.push_back(measure(
+                    cfg, "align " + std::to_string(align), n,
+                    [&] {
+                            root = build_tree<48>(src, keys, align);
+                            return src.span();
+                    },
+                    [&] { return probe_tree(root, probes); }));
+                src.close();
+        }
+        print_table("alignment, list walk, 48 B nodes in a stack arena", list);
+        print_table("alignment, tree lookup, 48 B nodes in a stack arena", tree);
+}
+
+// Walks reading every key and 1 in COLD_EVERY payloads.
+static uint64_t walk_inline(const ListNode<256>* head) {
+        uint64_t sum = 0, visited = 0;
+        for (const ListNode<256>* p = head; p; p = p->next, ++visited) {
+                sum += p->key;
+                if (visited % COLD_EVERY == 0)
+                        sum += p->payload[COLD_OFFSET];
+        }
+        sink = sum;
+        return visited;
+}
+
+static uint64_t walk_split(const HotNode* head) {
+        uint64_t sum = 0, visited = 0;
+        for (const HotNode* p = head; p; p = p->next, ++visited) {
+                sum += p->key;
+                if (visited % COLD_EVERY == 0)
+                        sum += p->cold->payload[COLD_OFFSET];
+        }
+        sink = sum;
+        return visited;
+}
+
+static HotNode* build_split(Source& hot, Source& cold, size_t n) {
+        HotNode*  head = nullptr;
+        HotNode** tail = &head;
+        for (size_t i = 0; i < n; ++i) {
+                HotNode* h = make_node<HotNode>(hot, NATURAL_ALIGNMENT, i);
+                h->cold    = (Cold*)cold.alloc(sizeof(Cold), NATURAL_ALIGNMENT);
+                std::memset((void*)h->cold, 0, sizeof(Cold));
+                *tail = h;
+                tail  = &h->next;
+        }
+        return head;
+}
+
+static void hot_cold_rows(const Config& cfg, size_t n) {
+        std::vector<Row> rows;
+        {
+                Source         src(SourceKind::Stack);
+                ListNode<256>* head = nullptr;
+                src.open(capacity_for(n, 256, NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, "inline 256 B", n,
+                    [&] {
+                            head = build_list<256>(src, n, NATURAL_ALIGNMENT);
+                            return src.span();
+                    },
+                    [&] { return walk_inline(head); }));
+                src.close();
+        }
+        {
+                Source   src(SourceKind::Stack);
+                HotNode* head = nullptr;
+                src.open(capacity_for(n, 256, NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, "split, cold interleaved", n,
+                    [&] {
+                            head = build_split(src, src, n);
+                            return src.span();
+                    },
+                    [&] { return walk_split(head); }));
+                src.close();
+        }
+        {
+                Source   hot(SourceKind::Stack), cold(SourceKind::Stack);
+                HotNode* head = nullptr;
+                hot.open(capacity_for(n, sizeof(HotNode), NATURAL_ALIGNMENT));
+                cold.open(capacity_for(n, sizeof(Cold), NATURAL_ALIGNMENT));
+                rows.push_back(measure(
+                    cfg, "split, cold arena", n,
+                    [&] {
+                            head = build_split(hot, cold, n);
+                            return hot.span();
+                    },
+                    [&] { return walk_split(head); }));
+                hot.close();
+                cold.close();
+        }
+        print_table("hot/cold split, list walk in stack arenas (span is the hot arena's)", rows);
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        cfg.runs = 7;
+        if (!parse_config(cfg, argc, argv))
+                return 0;
+        const size_t n = (size_t)std::max(1, cfg.iters);
+
+        std::cout << "=== Anvil Data Locality Benchmark ===\n";
+        std::cout << "(" << n << " nodes per structure, " << cfg.runs << " traversals per row; vs first = speedup"
+                  << " over the first row)\n";
+
+        list_rows<32>(cfg, n);
+        list_rows<64>(cfg, n);
+        list_rows<256>(cfg, n);
+        tree_rows<32>(cfg, n);
+        tree_rows<64>(cfg, n);
+        tree_rows<256>(cfg, n);
+        hash_rows<32>(cfg, n);
+        hash_rows<64>(cfg, n);
+        hash_rows<256>(cfg, n);
+        alignment_rows(cfg, n);
+        hot_cold_rows(cfg, n);
+        return finish_report(cfg, "memory_locality_benchmark") ? 1 : 0;
+}
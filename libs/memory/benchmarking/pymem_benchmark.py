@@ -0,0 +1,179 @@
+"""PyMem allocator benchmark: pyperformance-style microbenchmarks under the system allocator and the Anvil hook.
+
+Every (benchmark, allocator) pair runs in a fresh interpreter so that neither the hook nor a warmed-up heap
+leaks between measurements. The parent prints median wall time per benchmark and the speedup of the Anvil
+hook, and optionally writes the raw samples as JSON.
+
+    python pymem_benchmark.py [--domain obj|mem|raw] [--runs N] [--scale F] [--json out.json]
+"""
+
+import argparse
+import copy
+import json
+import os
+import statistics
+import subprocess
+import sys
+import time
+
+DOMAINS = {"raw": "PYMEM_DOMAIN_RAW", "mem": "PYMEM_DOMAIN_MEM", "obj": "PYMEM_DOMAIN_OBJ"}
+
+
+# ---------- Microbenchmarks ----------
+# Each takes a size factor and returns a value so the work cannot be skipped.
+
+def bench_dict_churn(n):
+    total = 0
+    for i in range(n):
+        d = {"id": i, "name": "item%d" % i, "tags": ["a", "b"], "score": i * 0.5}
+        total += len(d["name"]) + len(d["tags"])
+    return total
+
+
+def bench_list_growth(n):
+    total = 0
+    for i in range(n // 100):
+        values = []
+        for j in range(100):
+            values.append((i, j))
+        total += len(values)
+    return total
+
+
+def bench_tuple_churn(n):
+    total = 0
+    for i in range(n):
+        a, b, c = (i, i + 1, i + 2)
+        total += a + b + c
+    return total
+
+
+class Body:
+    __slots__ = ("x", "y", "vx", "vy")
+
+    def __init__(self, x, y, vx, vy):
+        self.x, self.y, self.vx, self.vy = x, y, vx, vy
+
+
+def bench_nbody_floats(n):
+    bodies = [Body(float(i), float(-i), 0.1, -0.1) for i in range(32)]
+    for _ in range(n // 32):
+        for b in bodies:
+            b.x += b.vx * 0.01
+            b.y += b.vy * 0.01
+    return sum(b.x + b.y for b in bodies)
+
+
+class Record:
+    def __init__(self, key, payload):
+        self.key = key
+        self.payload = payload
+
+
+def bench_instances(n):
+    return sum(len(Record(i, [i]).payload) for i in range(n))
+
+
+def bench_json_roundtrip(n):
+    doc = [{"id": i, "values": list(range(8)), "name": "n%d" % i} for i in range(100)]
+    total = 0
+    for _ in range(max(1, n // 2000)):
+        total += len(json.loads(json.dumps(doc)))
+    return total
+
+
+def bench_string_build(n):
+    parts = []
+    for i in range(n):
+        parts.append("%d:%s" % (i, "x" * (i % 16)))
+    return len(",".join(parts))
+
+
+def bench_deepcopy(n):
+    tree = {"a": [1, 2, {"b": (3, 4)}], "c": {"d": [5] * 8}}
+    return sum(len(copy.deepcopy(tree)) for _ in range(max(1, n // 50)))
+
+
+BENCHMARKS = {
+    "dict_churn": bench_dict_churn,
+    "list_growth": bench_list_growth,
+    "tuple_churn": bench_tuple_churn,
+    "nbody_floats": bench_nbody_floats,
+    "instances": bench_instances,
+    "json_roundtrip": bench_json_roundtrip,
+    "string_build": bench_string_build,
+    "deepcopy": bench_deepcopy,
+}
+
+
+# ---------- Worker ----------
+
+def run_worker(args):
+    stats = None
+    if args.allocator == "anvil":
+        import anvil_memory as am
+
+        domain = getattr(am, DOMAINS[args.domain])
+        if am.pymem_install(domain, args.capacity << 20) != am.ERR_SUCCESS:
+            raise SystemExit("pymem_install failed")
+    bench = BENCHMARKS[args.worker]
+    n = int(200000 * args.scale)
+    bench(n // 10)  # warm up caches and pools
+    samples = []
+    for _ in range(args.runs):
+        start = time.perf_counter()
+        bench(n)
+        samples.append(time.perf_counter() - start)
+    if args.allocator == "anvil":
+        stats = am.pymem_stats(domain)
+    print(json.dumps({"samples": samples, "stats": stats}))
+
+
+# ---------- Driver ----------
+
+def run_pair(args, name, allocator):
+    cmd = [sys.executable, os.path.abspath(__file__), "--worker", name, "--allocator", allocator,
+           "--domain", args.domain, "--runs", str(args.runs), "--scale", str(args.scale),
+           "--capacity", str(args.capacity)]
+    result = subprocess.run(cmd, capture_output=True, text=True, check=False)
+    if result.returncode != 0:
+        raise SystemExit("%s/%s failed:\n%s" % (name, allocator, result.stderr))
+    return json.loads(result.stdout.strip().splitlines()[-1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--domain", choices=sorted(DOMAINS), default="obj")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--scale", type=float, default=1.0, help="multiplier on the work per run")
+    parser.add_argument("--capacity", type=int, default=1024, help="Anvil arena reservation in MiB")
+    parser.add_argument("--only", action="append", choices=sorted(BENCHMARKS), help="run only these benchmarks")
+    parser.add_argument("--json", help="write raw samples to this file")
+    parser.add_argument("--worker", choices=sorted(BENCHMARKS), help=argparse.SUPPRESS)
+    parser.add_argument("--allocator", choices=["system", "anvil"], default="system", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    if args.worker:
+        run_worker(args)
+        return
+
+    names = args.only or list(BENCHMARKS)
+    report = {"domain": args.domain, "runs": args.runs, "scale": args.scale, "benchmarks": {}}
+    print("domain=%s runs=%d scale=%g" % (args.domain, args.runs, args.scale))
+    print("%-16s %12s %12s %9s %12s" % ("benchmark", "system ms", "anvil ms", "speedup", "pooled"))
+    for name in names:
+        system = run_pair(args, name, "system")
+        anvil = run_pair(args, name, "anvil")
+        system_ms = statistics.median(system["samples"]) * 1e3
+        anvil_ms = statistics.median(anvil["samples"]) * 1e3
+        pooled = anvil["stats"]["pooled_allocs"]
+        print("%-16s %12.2f %12.2f %8.2fx %12d" % (name, system_ms, anvil_ms, system_ms / anvil_ms, pooled))
+        report["benchmarks"][name] = {"system": system, "anvil": anvil}
+
+    if args.json:
+        with open(args.json, "w", encoding="utf-8") as out:
+            json.dump(report, out, indent=2)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,255 @@
+// scaling_benchmark.cpp
+// Multithreaded scaling of Anvil allocators against glibc malloc.
+// - Runs every workload at 1, 2, 4 ... N threads (N = --max-threads, default hardware_concurrency),
+//   each thread pinned to its own CPU from the process affinity mask (wrapping when N exceeds it).
+// - Weak scaling: every thread performs --iters operations; threads start together behind a barrier.
+// - Reports aggregate throughput (median over runs), scaling efficiency relative to one thread and the
+//   p99 latency of the worst thread, sampled with the shared TSC histogram (--latency-sample N).
+// - Workloads: per-thread scratch and stack arenas vs malloc/free, create/destroy churn (mmap/munmap
+//   contention on the mm lock) and commit-heavy Lazy arenas (mprotect + first-touch faults).
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp); series are thread counts.
+//
+// Run  :  ./memory_scaling_benchmark --runs 5 --iters 200000 [--max-threads N] [--latency-sample N]
+
+#include "memory/constants.hpp"
+#include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
+#include <barrier>
+#include <functional>
+#include <pthread.h>
+#include <sched.h>
+
+#include "benchmark_report.hpp"
+
+using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
+using StackAllocator   = anvil::memory::stack_allocator::StackAllocator;
+using anvil::memory::AllocationStrategy;
+using anvil::memory::MIN_ALIGNMENT;
+namespace sa = anvil::memory::scratch_allocator;
+namespace st = anvil::memory::stack_allocator;
+
+static void touch(void* p) {
+        if (p)
+                *(volatile uint8_t*)p = 1;
+}
+
+// A worker performs `iters` operations on its own allocator and records sampled op latencies.
+// Returns the number of operations performed.
+using Worker = std::function<size_t(int iters, int every, LatencyHistogram& h)>;
+
+struct Workload {
+        const char* name;
+        Worker      worker;
+};
+
+struct Point {
+        int      threads;
+        double   ops_per_sec;
+        double   efficiency;
+        uint64_t worst_p99_ns;
+};
+
+static std::vector<int> allowed_cpus() {
+        std::vector<int> cpus;
+        cpu_set_t        set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                for (int c = 0; c < CPU_SETSIZE; ++c)
+                        if (CPU_ISSET(c, &set))
+                                cpus.push_back(c);
+        if (cpus.empty())
+                cpus.push_back(0);
+        return cpus;
+}
+
+static void pin_self(int cpu) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+struct RunResult {
+        double ns;
+        size_t ops;
+};
+
+// One run at `threads` threads; returns wall time and total ops and fills the per-thread histograms. The
+// wall time spans the earliest worker start to the latest worker finish, taken by the workers themselves.
+static RunResult run_once(const Config& cfg, const Worker& worker, int threads, const std::vector<int>& cpus,
+                       std::vector<LatencyHistogram>& hists) {
+        std::barrier<>                 start(threads);
+        std::vector<size_t>            ops(threads, 0);
+        std::vector<Clock::time_point> begin(threads), end(threads);
+        std::vector<std::thread>       pool;
+        pool.reserve(threads);
+        for (int t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t] {
+                        pin_self(cpus[t % cpus.size()]);
+                        start.arrive_and_wait();
+                        begin[t] = Clock::now();
+                        ops[t]   = worker(cfg.iters, cfg.latency_sample, hists[t]);
+                        end[t]   = Clock::now();
+                });
+        }
+        for (std::thread& t : pool)
+                t.join();
+        size_t total = 0;
+        for (size_t n : ops)
+                total += n;
+        const auto t0 = *std::min_element(begin.begin(), begin.end());
+        const auto t1 = *std::max_element(end.begin(), end.end());
+        return {(double)std::chrono::duration_cast<ns>(t1 - t0).count(), total};
+}
+
+static std::vector<Point> scale(const Config& cfg, const Workload& w, const std::vector<int>& counts,
+                                const std::vector<int>& cpus) {
+        std::vector<Point> points;
+        double             single = 0;
+        for (int threads : counts) {
+                std::vector<double>           samples;
+                std::vector<LatencyHistogram> hists(threads);
+                size_t                        ops = 0;
+                for (int run = 0; run < cfg.runs; ++run) {
+                        const RunResult r = run_once(cfg, w.worker, threads, cpus, hists);
+                        samples.push_back(r.ns);
+                        ops = r.ops;
+                }
+                const Stats stats = make_stats(samples, std::vector<CounterSample>(samples.size()), (double)ops);
+                report_series(w.name, std::to_string(threads) + " threads", stats);
+
+                Point p{threads, stats.ops_per_sec, 1.0, 0};
+                if (threads == 1)
+                        single = p.ops_per_sec;
+                if (single > 0)
+                        p.efficiency = p.ops_per_sec / (single * threads);
+                for (const LatencyHistogram& h : hists)
+                        p.worst_p99_ns = std::max(p.worst_p99_ns, h.percentile(0.99));
+                points.push_back(p);
+        }
+        return points;
+}
+
+static void print_points(const Workload& w, const std::vector<Point>& points) {
+        std::cout << "\n" << w.name << "\n";
+        std::cout << std::right << std::setw(9) << "threads" << std::setw(14) << "Mops/s" << std::setw(12)
+                  << "efficiency" << std::setw(18) << "worst p99 (ns)" << "\n";
+        for (const Point& p : points)
+                std::cout << std::setw(9) << p.threads << std::setw(14) << std::fixed << std::setprecision(2)
+                          << p.ops_per_sec * 1e-6 << std::setw(11) << std::setprecision(0) << p.efficiency * 100
+                          << "%" << std::setw(18) << p.worst_p99_ns << "\n";
+}
+
+// -------- Workloads --------
+
+static constexpr int BATCH = 1000;
+
+static size_t malloc_arena(int iters, int every, LatencyHistogram& h) {
+        std::vector<void*> ptrs(BATCH);
+        const int          cycles = std::max(1, iters / BATCH);
+        for (int c = 0; c < cycles; ++c) {
+                const bool timed = c % every == 0;
+                for (void*& p : ptrs) {
+                        p = timed_op(h, timed, [] { return std::malloc(64); });
+                        touch(p);
+                }
+                for (void* p : ptrs)
+                        std::free(p);
+        }
+        return (size_t)cycles * BATCH;
+}
+
+static size_t scratch_arena(int iters, int every, LatencyHistogram& h) {
+        const int         cycles = std::max(1, iters / BATCH);
+        ScratchAllocator* a      = sa::create((size_t)BATCH * 64 + 4096, MIN_ALIGNMENT);
+        for (int c = 0; c < cycles; ++c) {
+                const bool timed = c % every == 0;
+                for (int i = 0; i < BATCH; ++i)
+                        touch(timed_op(h, timed, [&] { return sa::alloc(a, 64, MIN_ALIGNMENT); }));
+                (void)sa::reset(a);
+        }
+        (void)sa::destroy(&a);
+        return (size_t)cycles * BATCH;
+}
+
+static size_t stack_arena(int iters, int every, LatencyHistogram& h) {
+        const int       cycles = std::max(1, iters / BATCH);
+        StackAllocator* a      = st::create((size_t)BATCH * 64 + 4096, MIN_ALIGNMENT, AllocationStrategy::Eager);
+        for (int c = 0; c < cycles; ++c) {
+                const bool timed = c % every == 0;
+                (void)st::record(a);
+                for (int i = 0; i < BATCH; ++i)
+                        touch(timed_op(h, timed, [&] { return st::alloc(a, 64, MIN_ALIGNMENT); }));
+                (void)st::unwind(a);
+        }
+        (void)st::destroy(&a);
+        return (size_t)cycles * BATCH;
+}
+
+// Every create maps and every destroy unmaps; threads contend on the process mm lock.
+static size_t create_destroy_churn(int iters, int every, LatencyHistogram& h) {
+        const int pairs = std::max(1, iters / 100);
+        for (int c = 0; c < pairs; ++c) {
+                const bool timed = c % every == 0;
+                timed_op(h, timed, [] {
+                        ScratchAllocator* a = sa::create(1 << 20, MIN_ALIGNMENT);
+                        touch(sa::alloc(a, 64, MIN_ALIGNMENT));
+                        return sa::destroy(&a);
+                });
+        }
+        return (size_t)pairs;
+}
+
+// Fresh Lazy arenas filled page by page: every commit chunk is an mprotect and every page a fault.
+static size_t lazy_commit_heavy(int iters, int every, LatencyHistogram& h) {
+        const size_t PAGE   = 4096;
+        const size_t ARENA  = 4 << 20;
+        const int    pages  = (int)(ARENA / PAGE) - 1;
+        const int    arenas = std::max(1, iters / 1000);
+        for (int c = 0; c < arenas; ++c) {
+                const bool      timed = c % every == 0;
+                StackAllocator* a     = st::create(ARENA, MIN_ALIGNMENT, AllocationStrategy::Lazy);
+                for (int i = 0; i < pages; ++i)
+                        touch(timed_op(h, timed, [&] { return st::alloc(a, PAGE, MIN_ALIGNMENT); }));
+                (void)st::destroy(&a);
+        }
+        return (size_t)arenas * (size_t)pages;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        cfg.runs        = 5;
+        int max_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 1; i + 1 < argc; ++i)
+                if (std::string(argv[i]) == "--max-threads")
+                        max_threads = std::max(1, std::atoi(argv[i + 1]));
+        if (!parse_config(cfg, argc, argv)) {
+                std::cout << "       [--max-threads N]\n";
+                return 0;
+        }
+
+        std::vector<int> counts;
+        for (int t = 1; t < max_threads; t *= 2)
+                counts.push_back(t);
+        counts.push_back(max_threads);
+
+        const std::vector<int> cpus = allowed_cpus();
+        std::cout << "=== Anvil Allocator Scaling Benchmark ===\n";
+        std::cout << "(" << cpus.size() << " CPUs in affinity mask, up to " << max_threads
+                  << " pinned threads, p99 sampled ";
+        if (cfg.latency_sample > 1)
+                std::cout << "in 1 of " << cfg.latency_sample << " iterations)\n";
+        else
+                std::cout << "on every op)\n";
+
+        const Workload workloads[] = {
+            {"malloc/free (64 B)", malloc_arena},
+            {"scratch per-thread arena (alloc 64 B)", scratch_arena},
+            {"stack per-thread arena (alloc 64 B)", stack_arena},
+            {"scratch create/destroy churn (1 MiB, per pair)", create_destroy_churn},
+            {"stack lazy commit-heavy (alloc 4 KiB)", lazy_commit_heavy},
+        };
+        for (const Workload& w : workloads)
+                print_points(w, scale(cfg, w, counts, cpus));
+        return finish_report(cfg, "memory_scaling_benchmark") ? 1 : 0;
+}
@@ -4,9 +4,17 @@
 // - Moves create/destroy outside timed regions; includes reset() inside reset test timing.
 // - Prints BOTH baseline and scratch ops/sec with median ± MAD CI.
 // - Exits 0 by default; use --strict to return non-zero when gates fail.
+// - Reports per-op hardware counters (cycles, instructions, L1d/LLC/dTLB misses, page faults) via
+//   perf_event_open; falls back to getrusage fault counts when counters are unavailable.
+// - Reports per-operation tail latency (p50..p99.99, max) for create/alloc/reset/destroy and
+//   record/unwind and try_alloc; --latency-sample N times ops only in 1 of N iterations.
+// - Reports the allocation rate with the sampling profiler off and on, against its 1% budget.
+// - --json/--csv write machine-readable results; --compare BASELINE.json tests every series for a
+//   statistically significant regression, which replaces the speedup gates under --strict.
 //
 // Build:  g++ -O3 -std=c++17 bench_anvil_improved.cpp -o bench_anvil_improved
-// Run  :  ./bench_anvil_improved --runs 12 --iters 200000 [--strict]
+// Run  :  ./bench_anvil_improved --runs 12 --iters 200000 [--latency-sample N] [--strict]
+//         [--json PATH] [--csv PATH] [--compare BASELINE.json] [--alpha P]
 //
 // If the Anvil headers are missing, the file still compiles and runs baseline paths.
 
@@ -21,12 +29,15 @@
 #include <iomanip>
 #include <iostream>
 #include <random>
+#include <sstream>
 #include <string>
 #include <vector>
 
 #if __has_include("memory/scratch_allocator.hpp")
 #include "memory/constants.hpp"
+#include "memory/profiler.hpp"
 #include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
 #define HAVE_ANVIL 1
 using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
 using anvil::memory::MIN_ALIGNMENT;
@@ -56,55 +67,7 @@ using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
 using anvil::memory::MIN_ALIGNMENT;
 #endif
 
-using Clock = std::chrono::steady_clock;
-using ns    = std::chrono::nanoseconds;
-
-static inline void barrier() {
-        std::atomic_signal_fence(std::memory_order_seq_cst);
-}
-
-struct Stats {
-        std::vector<double> samples_ns;
-        double              median_ns{0}, mad_ns{0};
-        double              ops_per_sec{0}, ci_lo{0}, ci_hi{0};
-};
-
-static double median_of(std::vector<double> v) {
-        if (v.empty())
-                return 0.0;
-        std::sort(v.begin(), v.end());
-        size_t n = v.size();
-        return (n & 1) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
-}
-static double mad_of(const std::vector<double>& v, double med) {
-        if (v.empty())
-                return 0.0;
-        std::vector<double> d;
-        d.reserve(v.size());
-        for (double x : v)
-                d.push_back(std::fabs(x - med));
-        return median_of(std::move(d));
-}
-static Stats make_stats(std::vector<double> s, double ops_per_run) {
-        if (s.size() > 1)
-                s.erase(s.begin()); // drop warm-up
-        Stats st;
-        st.samples_ns  = s;
-        st.median_ns   = std::max(1.0, median_of(s));
-        st.mad_ns      = std::max(1.0, mad_of(s, st.median_ns));
-        double secs    = st.median_ns * 1e-9;
-        st.ops_per_sec = (secs > 0) ? (ops_per_run / secs) : 0.0;
-        double lo_ns   = std::max(1.0, st.median_ns - 1.58 * st.mad_ns);
-        double hi_ns   = std::max(lo_ns * 1.0001, st.median_ns + 1.58 * st.mad_ns);
-        st.ci_lo       = ops_per_run / (hi_ns * 1e-9);
-        st.ci_hi       = ops_per_run / (lo_ns * 1e-9);
-        return st;
-}
-
-struct Config {
-        int  runs = 100, iters = 200000;
-        bool strict = false;
-};
+#include "benchmark_report.hpp"
 
 struct Row {
         std::string name;
@@ -128,23 +91,8 @@ static void print_row(const Row& r) {
                   << fmt(r.base.ci_hi) << "]\n";
         std::cout << "  scratch : " << fmt(r.scratch.ops_per_sec) << " ops/s [" << fmt(r.scratch.ci_lo) << "–"
                   << fmt(r.scratch.ci_hi) << "]\n";
-}
-
-template <class FSetup, class FBody, class FTeardown>
-static Stats time_runs(const Config& cfg, FSetup&& setup, FBody&& body, FTeardown&& teardown, double ops_per_run) {
-        std::vector<double> s;
-        s.reserve(cfg.runs);
-        for (int run = 0; run < cfg.runs; ++run) {
-                setup();
-                barrier();
-                auto t0 = Clock::now();
-                body();
-                auto t1 = Clock::now();
-                barrier();
-                teardown();
-                s.push_back((double)std::chrono::duration_cast<ns>(t1 - t0).count());
-        }
-        return make_stats(std::move(s), ops_per_run);
+        print_counters("baseline", r.base);
+        print_counters("scratch ", r.scratch);
 }
 
 // -------- Tests using Anvil API style (create/alloc/reset/destroy) --------
@@ -177,7 +125,7 @@ static Row tiny_allocations(const Config& cfg) {
             [] {}, N);
         double sp   = (base.ops_per_sec > 0) ? (scratch.ops_per_sec / base.ops_per_sec) : 1.0;
         double gate = 3.0;
-        bool   pass = !cfg.strict || sp >= gate;
+        bool   pass = !gates_enabled(cfg) || sp >= gate;
         return {"tiny_allocations", base, scratch, sp, pass, gate};
 }
 
@@ -216,7 +164,7 @@ static Row reset_performance(const Config& cfg) {
             [] {}, (double)CYCLES * ALLOCS);
         double sp   = (base.ops_per_sec > 0) ? (scratch.ops_per_sec / base.ops_per_sec) : 1.0;
         double gate = 3.0;
-        bool   pass = !cfg.strict || sp >= gate;
+        bool   pass = !gates_enabled(cfg) || sp >= gate;
         return {"reset_performance", base, scratch, sp, pass, gate};
 }
 
@@ -253,7 +201,7 @@ static Row alignment_patterns(const Config& cfg) {
             [] {}, N);
         double sp   = (base.ops_per_sec > 0) ? (scratch.ops_per_sec / base.ops_per_sec) : 1.0;
         double gate = 1.5;
-        bool   pass = !cfg.strict || sp >= gate;
+        bool   pass = !gates_enabled(cfg) || sp >= gate;
         return {"alignment_patterns", base, scratch, sp, pass, gate};
 }
 
@@ -292,7 +240,7 @@ static Row interleaved_patterns(const Config& cfg) {
             [] {}, (double)N);
         double sp   = (base.ops_per_sec > 0) ? (scratch.ops_per_sec / base.ops_per_sec) : 1.0;
         double gate = 1.0;
-        bool   pass = !cfg.strict || sp >= gate;
+        bool   pass = !gates_enabled(cfg) || sp >= gate;
         return {"interleaved_patterns", base, scratch, sp, pass, gate};
 }
 
@@ -337,30 +285,161 @@ static Row mixed_workloads(const Config& cfg) {
             [] {}, (double)N);
         double sp   = (base.ops_per_sec > 0) ? (scratch.ops_per_sec / base.ops_per_sec) : 1.0;
         double gate = 1.2;
-        bool   pass = !cfg.strict || sp >= gate;
+        bool   pass = !gates_enabled(cfg) || sp >= gate;
         return {"mixed_workloads", base, scratch, sp, pass, gate};
 }
 
-int main(int argc, char** argv) {
-        Config cfg;
-        for (int i = 1; i < argc; ++i) {
-                std::string a    = argv[i];
-                auto        next = [&](int& i) { return (i + 1 < argc) ? argv[++i] : nullptr; };
-                if (a == "--runs") {
-                        if (auto v = next(i))
-                                cfg.runs = std::atoi(v);
-                } else if (a == "--iters") {
-                        if (auto v = next(i))
-                                cfg.iters = std::atoi(v);
-                } else if (a == "--strict") {
-                        cfg.strict = true;
-                } else if (a == "--help") {
-                        std::cout << "Usage: " << argv[0] << " [--runs N] [--iters N] [--strict]\n";
-                        return 0;
+// -------- Profiler off/on --------
+
+#if HAVE_ANVIL
+// The same 16 B allocation loop with the profiler disabled and sampling at the default rate. Runs alternate so
+// clock drift hits both sides, and like --compare the overhead is only called over the 1% budget when it is
+// significant (Mann-Whitney U at --alpha). Both series go to --json, so --compare also tracks the disabled path
+// across revisions.
+static void profiler_overhead(const Config& cfg) {
+        namespace sa             = anvil::memory::scratch_allocator;
+        namespace pf             = anvil::memory::profiler;
+        const int         N      = cfg.iters, CYCLES = 16;
+        const size_t      SZ     = 16;
+        const double      BUDGET = 1.0; // percent
+        ScratchAllocator* a      = sa::create((size_t)N * SZ + 1024, MIN_ALIGNMENT);
+        auto              run    = [&](std::vector<double>& samples, std::vector<CounterSample>& counters) {
+                PerfCounters& perf = perf_counters();
+                barrier();
+                perf.start();
+                auto t0 = Clock::now();
+                for (int c = 0; c < CYCLES; ++c) {
+                        for (int i = 0; i < N; ++i) {
+                                void* p               = sa::alloc(a, SZ, MIN_ALIGNMENT);
+                                *(volatile uint8_t*)p = 1;
+                        }
+                        (void)sa::reset(a);
                 }
+                auto t1 = Clock::now();
+                counters.push_back(perf.stop());
+                barrier();
+                samples.push_back((double)std::chrono::duration_cast<ns>(t1 - t0).count());
+        };
+
+        std::vector<double>        off_ns, on_ns;
+        std::vector<CounterSample> off_counters, on_counters;
+        for (int r = 0; r < cfg.runs; ++r) {
+                pf::disable();
+                run(off_ns, off_counters);
+                pf::enable(pf::DEFAULT_SAMPLE_RATE);
+                run(on_ns, on_counters);
         }
-        if (cfg.runs < 2)
-                cfg.runs = 2;
+        pf::disable();
+        pf::clear();
+        (void)sa::destroy(&a);
+
+        const Stats  off      = make_stats(std::move(off_ns), std::move(off_counters), (double)N * CYCLES);
+        const Stats  on       = make_stats(std::move(on_ns), std::move(on_counters), (double)N * CYCLES);
+        const UTest  t        = mann_whitney_u(on.samples_ns, off.samples_ns);
+        const double overhead = (on.median_ns - off.median_ns) / off.median_ns * 100;
+        const bool   over     = t.p < cfg.alpha && overhead > BUDGET;
+
+        auto fmt = [](double v) {
+                std::ostringstream o;
+                o << std::fixed << std::setprecision(0) << v;
+                return o.str();
+        };
+        std::cout << "\n=== Profiler off/on (" << SZ << " B allocations, sampling every "
+                  << pf::DEFAULT_SAMPLE_RATE / 1024 << " KiB) ===\n";
+        std::cout << "  off: " << fmt(off.ops_per_sec) << " ops/s [" << fmt(off.ci_lo) << "–" << fmt(off.ci_hi)
+                  << "]\n";
+        std::cout << "  on : " << fmt(on.ops_per_sec) << " ops/s [" << fmt(on.ci_lo) << "–" << fmt(on.ci_hi)
+                  << "]\n";
+        std::cout << "  overhead " << std::showpos << std::fixed << std::setprecision(2) << overhead << std::noshowpos
+                  << "% p=" << std::scientific << std::setprecision(1) << t.p << std::fixed << " (budget "
+                  << std::setprecision(0) << BUDGET << "%): " << (over ? "OVER BUDGET" : "within budget") << "\n";
+        report_series("profiler", "off", off);
+        report_series("profiler", "on", on);
+}
+#endif
+
+// -------- Per-operation tail latency --------
+
+static std::vector<LatencyRow> operation_latencies(const Config& cfg) {
+        namespace sa         = anvil::memory::scratch_allocator;
+        const int CYCLES     = std::max(1, cfg.iters / 200);
+        const int ALLOCS     = 1000;
+        const int LIFECYCLES = std::max(1, cfg.iters / 100);
+        const int every      = cfg.latency_sample;
+
+        LatencyHistogram create_h, destroy_h, alloc_h, reset_h;
+        for (int c = 0; c < LIFECYCLES; ++c) {
+                const bool        timed = c % every == 0;
+                ScratchAllocator* a     = timed_op(create_h, timed, [&] { return sa::create(1 << 20, MIN_ALIGNMENT); });
+                (void)timed_op(destroy_h, timed, [&] { return sa::destroy(&a); });
+        }
+
+        ScratchAllocator* a = sa::create((size_t)ALLOCS * 64 + 1024, MIN_ALIGNMENT);
+        for (int c = 0; c < CYCLES; ++c) {
+                const bool timed = c % every == 0;
+                for (int i = 0; i < ALLOCS; ++i) {
+                        void* p = timed_op(alloc_h, timed, [&] { return sa::alloc(a, 64, MIN_ALIGNMENT); });
+                        if (p)
+                                *(volatile uint8_t*)p = 1;
+                }
+                (void)timed_op(reset_h, timed, [&] { return sa::reset(a); });
+        }
+        (void)sa::destroy(&a);
+
+        std::vector<LatencyRow> rows;
+        rows.push_back({"scratch create (1 MiB)", create_h});
+        rows.push_back({"scratch destroy", destroy_h});
+        rows.push_back({"scratch alloc (64 B)", alloc_h});
+        rows.push_back({"scratch reset", reset_h});
+
+#if HAVE_ANVIL
+        // Lazy stack: the first pass through each depth commits pages, which is what drives the tail.
+        namespace st = anvil::memory::stack_allocator;
+        const int           DEPTH = 8, PER_SCOPE = 16;
+        LatencyHistogram    stack_alloc_h, record_h, unwind_h;
+        st::StackAllocator* s = st::create(64 << 20, MIN_ALIGNMENT, anvil::memory::AllocationStrategy::Lazy);
+        for (int c = 0; c < CYCLES; ++c) {
+                const bool timed = c % every == 0;
+                for (int d = 0; d < DEPTH; ++d) {
+                        (void)timed_op(record_h, timed, [&] { return st::record(s); });
+                        for (int i = 0; i < PER_SCOPE; ++i) {
+                                void* p = timed_op(stack_alloc_h, timed,
+                                                   [&] { return st::alloc(s, 4096, MIN_ALIGNMENT); });
+                                if (p)
+                                        *(volatile uint8_t*)p = 1;
+                        }
+                }
+                for (int d = 0; d < DEPTH; ++d)
+                        (void)timed_op(unwind_h, timed, [&] { return st::unwind(s); });
+        }
+        (void)st::destroy(&s);
+        rows.push_back({"stack alloc (4 KiB, lazy)", stack_alloc_h});
+        rows.push_back({"stack record", record_h});
+        rows.push_back({"stack unwind", unwind_h});
+
+        // try_alloc returns its pointer/error pair in registers; its latency should match "scratch alloc (64 B)".
+        LatencyHistogram try_alloc_h;
+        a = sa::create((size_t)ALLOCS * 64 + 1024, MIN_ALIGNMENT);
+        for (int c = 0; c < CYCLES; ++c) {
+                const bool timed = c % every == 0;
+                for (int i = 0; i < ALLOCS; ++i) {
+                        const anvil::memory::AllocResult r =
+                            timed_op(try_alloc_h, timed, [&] { return sa::try_alloc(a, 64, MIN_ALIGNMENT); });
+                        if (r.ok())
+                                *(volatile uint8_t*)r.ptr = 1;
+                }
+                (void)sa::reset(a);
+        }
+        (void)sa::destroy(&a);
+        rows.push_back({"scratch try_alloc (64 B)", try_alloc_h});
+#endif
+        return rows;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        if (!parse_config(cfg, argc, argv))
+                return 0;
 
         std::cout << "=== Anvil Scratch Allocator Benchmark (improved) ===\n";
 #if HAVE_ANVIL
@@ -368,6 +447,8 @@ int main(int argc, char** argv) {
 #else
         std::cout << "(anvil headers NOT found; baseline-compatible shims in use)\n";
 #endif
+        if (!perf_counters().hardware())
+                std::cout << "(hardware counters unavailable; reporting getrusage page faults only)\n";
 
         std::vector<Row> rows;
         rows.push_back(tiny_allocations(cfg));
@@ -379,14 +460,24 @@ int main(int argc, char** argv) {
         int passes = 0, fails = 0;
         for (const auto& r : rows) {
                 print_row(r);
+                report_series(r.name, "baseline", r.base);
+                report_series(r.name, "scratch", r.scratch);
                 if (r.pass)
                         ++passes;
                 else
                         ++fails;
         }
+#if HAVE_ANVIL
+        profiler_overhead(cfg);
+#endif
+        const std::vector<LatencyRow> latencies = operation_latencies(cfg);
+        print_latency_table("Scratch/stack operation", cfg, latencies);
+        report_latencies("Scratch/stack operation", latencies);
+
         std::cout << "\nSummary: " << passes << " PASS, " << fails << " FAIL";
-        if (cfg.strict)
+        if (gates_enabled(cfg))
                 std::cout << " (strict mode)";
         std::cout << "\n";
-        return (cfg.strict && fails > 0) ? 1 : 0;
+        const bool report_failed = finish_report(cfg, "memory_benchmark");
+        return ((gates_enabled(cfg) && fails > 0) || report_failed) ? 1 : 0;
 }
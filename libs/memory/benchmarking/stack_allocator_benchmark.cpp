@@ -0,0 +1,488 @@
+// stack_allocator_benchmark.cpp
+// StackAllocator benchmark suite: record/unwind scopes and the lazy commit path.
+// - Baselines: malloc/free (frees at scope exit) and std::pmr::monotonic_buffer_resource
+//   (one resource per scope over the default resource, released at scope exit). Chaining the
+//   scope resources instead makes a parent grow its buffers geometrically for every child scope.
+// - Workloads: deep record/unwind nesting, recursive scope trees, Eager vs Lazy steady-state
+//   throughput, first-touch page fault cost, and a mixed alloc/record/unwind workload. The steady-state and
+//   first-touch rows add a Guarded stack driven by alloc_unchecked, whose tail is committed from the
+//   SIGSEGV handler (one signal per commit chunk instead of a capacity compare per allocation).
+//   deep_nesting also reports every scope opened with a byte budget, which should match the plain stack series.
+// - Uses the shared harness: median ± MAD ops/sec, per-op hardware counters, and tail latency.
+// - Exits 0 by default; use --strict to return non-zero when gates against malloc fail.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp).
+//
+// Run  :  ./memory_stack_benchmark --runs 12 --iters 200000 [--latency-sample N] [--strict]
+
+#include "memory/constants.hpp"
+#include "memory/stack_allocator.hpp"
+#include <memory>
+#include <memory_resource>
+#include <random>
+
+#include "benchmark_report.hpp"
+
+using StackAllocator = anvil::memory::stack_allocator::StackAllocator;
+using anvil::memory::AllocationStrategy;
+using anvil::memory::MIN_ALIGNMENT;
+namespace st = anvil::memory::stack_allocator;
+
+struct Series {
+        std::string label;
+        Stats       stats;
+};
+
+struct Row {
+        std::string         name;
+        std::vector<Series> series; // series.front() is the malloc baseline, series.back() the gated stack series
+        double              speedup{1};
+        bool                pass{true};
+        double              gate{1};
+};
+
+static Row make_row(const Config& cfg, std::string name, std::vector<Series> series, double gate) {
+        const Stats& base    = series.front().stats;
+        const Stats& stack   = series.back().stats;
+        double       speedup = (base.ops_per_sec > 0) ? (stack.ops_per_sec / base.ops_per_sec) : 1.0;
+        bool         pass    = !gates_enabled(cfg) || speedup >= gate;
+        return {std::move(name), std::move(series), speedup, pass, gate};
+}
+
+static void print_row(const Row& r) {
+        auto fmt = [&](double v) {
+                std::ostringstream o;
+                o << std::fixed << std::setprecision(0) << v;
+                return o.str();
+        };
+        std::cout << r.name << ": " << (r.pass ? "PASS" : "FAIL") << " - " << r.series.back().label
+                  << " vs malloc " << std::fixed << std::setprecision(2) << r.speedup << "x";
+        if (!r.pass)
+                std::cout << " (gate " << r.gate << "x)";
+        std::cout << "\n";
+        for (const Series& s : r.series)
+                std::cout << "  " << std::left << std::setw(8) << s.label << std::right << ": "
+                          << fmt(s.stats.ops_per_sec) << " ops/s [" << fmt(s.stats.ci_lo) << "–"
+                          << fmt(s.stats.ci_hi) << "]\n";
+        for (const Series& s : r.series) {
+                std::string label = s.label;
+                label.resize(std::max<size_t>(label.size(), 8), ' ');
+                print_counters(label.c_str(), s.stats);
+        }
+}
+
+static void touch(void* p) {
+        if (p)
+                *(volatile uint8_t*)p = 1;
+}
+
+// -------- Workloads --------
+
+static Row deep_nesting(const Config& cfg) {
+        const int    DEPTH     = 32; // MAX_STACK_DEPTH - 1 scopes are available
+        const int    PER_SCOPE = 8;
+        const int    CYCLES    = std::max(1, cfg.iters / (DEPTH * PER_SCOPE));
+        const double ops       = (double)CYCLES * DEPTH * PER_SCOPE;
+
+        auto malloc_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::vector<void*> live;
+                    live.reserve(DEPTH * PER_SCOPE);
+                    for (int c = 0; c < CYCLES; ++c) {
+                            for (int d = 0; d < DEPTH; ++d)
+                                    for (int i = 0; i < PER_SCOPE; ++i) {
+                                            live.push_back(std::malloc(64));
+                                            touch(live.back());
+                                    }
+                            while (!live.empty()) {
+                                    std::free(live.back());
+                                    live.pop_back();
+                            }
+                    }
+            },
+            [] {}, ops);
+
+        auto pmr_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> scopes;
+                    scopes.reserve(DEPTH);
+                    for (int c = 0; c < CYCLES; ++c) {
+                            for (int d = 0; d < DEPTH; ++d) {
+                                    scopes.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+                                    for (int i = 0; i < PER_SCOPE; ++i)
+                                            touch(scopes.back()->allocate(64, MIN_ALIGNMENT));
+                            }
+                            while (!scopes.empty())
+                                    scopes.pop_back();
+                    }
+            },
+            [] {}, ops);
+
+        StackAllocator* a     = nullptr;
+        auto            stack = time_runs(
+            cfg, [&] { a = st::create(1 << 20, MIN_ALIGNMENT, AllocationStrategy::Eager); },
+            [&] {
+                    for (int c = 0; c < CYCLES; ++c) {
+                            for (int d = 0; d < DEPTH; ++d) {
+                                    (void)st::record(a);
+                                    for (int i = 0; i < PER_SCOPE; ++i)
+                                            touch(st::alloc(a, 64, MIN_ALIGNMENT));
+                            }
+                            for (int d = 0; d < DEPTH; ++d)
+                                    (void)st::unwind(a);
+                    }
+            },
+            [&] { (void)st::destroy(&a); }, ops);
+
+        // Same scopes, each capped at what it allocates; the budget is applied by record and unwind only.
+        auto budget = time_runs(
+            cfg, [&] { a = st::create(1 << 20, MIN_ALIGNMENT, AllocationStrategy::Eager); },
+            [&] {
+                    for (int c = 0; c < CYCLES; ++c) {
+                            for (int d = 0; d < DEPTH; ++d) {
+                                    (void)st::record(a, (size_t)(DEPTH - d) * PER_SCOPE * 64);
+                                    for (int i = 0; i < PER_SCOPE; ++i)
+                                            touch(st::alloc(a, 64, MIN_ALIGNMENT));
+                            }
+                            for (int d = 0; d < DEPTH; ++d)
+                                    (void)st::unwind(a);
+                    }
+            },
+            [&] { (void)st::destroy(&a); }, ops);
+
+        return make_row(cfg, "deep_nesting",
+                        {{"malloc", malloc_s}, {"pmr", pmr_s}, {"budget", budget}, {"stack", stack}}, 2.0);
+}
+
+// Tree recursion: every call opens a scope, allocates a few variable-sized blocks and recurses.
+static constexpr int RECURSION_DEPTH  = 6;
+static constexpr int RECURSION_FANOUT = 3;
+static constexpr int RECURSION_ALLOCS = 4;
+
+static int recursion_calls() {
+        int calls = 0, level = 1;
+        for (int d = 0; d <= RECURSION_DEPTH; ++d, level *= RECURSION_FANOUT)
+                calls += level;
+        return calls;
+}
+
+static void recurse_malloc(int depth, std::mt19937& rng) {
+        std::uniform_int_distribution<int> szd(16, 512);
+        void*                              local[RECURSION_ALLOCS];
+        for (void*& p : local) {
+                p = std::malloc((size_t)szd(rng));
+                touch(p);
+        }
+        if (depth < RECURSION_DEPTH)
+                for (int f = 0; f < RECURSION_FANOUT; ++f)
+                        recurse_malloc(depth + 1, rng);
+        for (void* p : local)
+                std::free(p);
+}
+
+static void recurse_pmr(int depth, std::mt19937& rng) {
+        std::uniform_int_distribution<int>  szd(16, 512);
+        std::pmr::monotonic_buffer_resource scope;
+        for (int i = 0; i < RECURSION_ALLOCS; ++i)
+                touch(scope.allocate((size_t)szd(rng), MIN_ALIGNMENT));
+        if (depth < RECURSION_DEPTH)
+                for (int f = 0; f < RECURSION_FANOUT; ++f)
+                        recurse_pmr(depth + 1, rng);
+}
+
+static void recurse_stack(int depth, std::mt19937& rng, StackAllocator* a) {
+        std::uniform_int_distribution<int> szd(16, 512);
+        (void)st::record(a);
+        for (int i = 0; i < RECURSION_ALLOCS; ++i)
+                touch(st::alloc(a, (size_t)szd(rng), MIN_ALIGNMENT));
+        if (depth < RECURSION_DEPTH)
+                for (int f = 0; f < RECURSION_FANOUT; ++f)
+                        recurse_stack(depth + 1, rng, a);
+        (void)st::unwind(a);
+}
+
+static Row recursive_scopes(const Config& cfg) {
+        const int    TREES = std::max(1, cfg.iters / (recursion_calls() * RECURSION_ALLOCS));
+        const double ops   = (double)TREES * recursion_calls() * RECURSION_ALLOCS;
+
+        auto malloc_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::mt19937 rng(42);
+                    for (int t = 0; t < TREES; ++t)
+                            recurse_malloc(0, rng);
+            },
+            [] {}, ops);
+        auto pmr_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::mt19937 rng(42);
+                    for (int t = 0; t < TREES; ++t)
+                            recurse_pmr(0, rng);
+            },
+            [] {}, ops);
+        StackAllocator* a     = nullptr;
+        auto            stack = time_runs(
+            cfg, [&] { a = st::create(1 << 20, MIN_ALIGNMENT, AllocationStrategy::Eager); },
+            [&] {
+                    std::mt19937 rng(42);
+                    for (int t = 0; t < TREES; ++t)
+                            recurse_stack(0, rng, a);
+            },
+            [&] { (void)st::destroy(&a); }, ops);
+
+        return make_row(cfg, "recursive_scopes", {{"malloc", malloc_s}, {"pmr", pmr_s}, {"stack", stack}}, 0.7);
+}
+
+// Steady state: the lazy allocator has committed everything it needs after the first cycle.
+static Row eager_vs_lazy(const Config& cfg) {
+        const int    CYCLES = std::max(1, cfg.iters / 1000);
+        const int    ALLOCS = 1000;
+        const double ops    = (double)CYCLES * ALLOCS;
+
+        auto malloc_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::vector<void*> ptrs(ALLOCS);
+                    for (int c = 0; c < CYCLES; ++c) {
+                            for (void*& p : ptrs) {
+                                    p = std::malloc(64);
+                                    touch(p);
+                            }
+                            for (void* p : ptrs)
+                                    std::free(p);
+                    }
+            },
+            [] {}, ops);
+
+        auto run_stack = [&](AllocationStrategy strategy) {
+                StackAllocator* a = nullptr;
+                return time_runs(
+                    cfg, [&] { a = st::create((size_t)ALLOCS * 64 + 4096, MIN_ALIGNMENT, strategy); },
+                    [&] {
+                            for (int c = 0; c < CYCLES; ++c) {
+                                    for (int i = 0; i < ALLOCS; ++i)
+                                            touch(strategy == AllocationStrategy::Guarded
+                                                      ? st::alloc_unchecked(a, 64, MIN_ALIGNMENT)
+                                                      : st::alloc(a, 64, MIN_ALIGNMENT));
+                                    (void)st::reset(a);
+                            }
+                    },
+                    [&] { (void)st::destroy(&a); }, ops);
+        };
+        auto eager   = run_stack(AllocationStrategy::Eager);
+        auto guarded = run_stack(AllocationStrategy::Guarded);
+        auto lazy    = run_stack(AllocationStrategy::Lazy);
+
+        return make_row(cfg, "eager_vs_lazy",
+                        {{"malloc", malloc_s}, {"eager", eager}, {"guarded", guarded}, {"lazy", lazy}}, 2.0);
+}
+
+// Every allocation lands on a page that has never been touched; the counters report faults per op.
+static Row first_touch_faults(const Config& cfg) {
+        const size_t PAGE  = 4096;
+        const int    PAGES = std::max(16, cfg.iters / 20);
+        const double ops   = (double)PAGES;
+
+        std::vector<void*> ptrs(PAGES);
+        auto               malloc_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    for (void*& p : ptrs) {
+                            p = std::malloc(PAGE);
+                            touch(p);
+                    }
+            },
+            [&] {
+                    for (void* p : ptrs)
+                            std::free(p);
+            },
+            ops);
+
+        auto run_stack = [&](AllocationStrategy strategy) {
+                StackAllocator* a = nullptr;
+                return time_runs(
+                    cfg, [&] { a = st::create((size_t)PAGES * PAGE, MIN_ALIGNMENT, strategy); },
+                    [&] {
+                            for (int i = 0; i < PAGES; ++i)
+                                    touch(strategy == AllocationStrategy::Guarded
+                                              ? st::alloc_unchecked(a, PAGE, MIN_ALIGNMENT)
+                                              : st::alloc(a, PAGE, MIN_ALIGNMENT));
+                    },
+                    [&] { (void)st::destroy(&a); }, ops);
+        };
+        auto eager   = run_stack(AllocationStrategy::Eager);
+        auto guarded = run_stack(AllocationStrategy::Guarded);
+        auto lazy    = run_stack(AllocationStrategy::Lazy);
+
+        return make_row(cfg, "first_touch_faults",
+                        {{"malloc", malloc_s}, {"eager", eager}, {"guarded", guarded}, {"lazy", lazy}}, 0.5);
+}
+
+// Random mix of alloc (60%), record (20%) and unwind (20%) with a bounded scope depth.
+static Row mixed_alloc_unwind(const Config& cfg) {
+        const int    N         = cfg.iters;
+        const int    MAX_DEPTH = 48;
+        const double ops       = (double)N;
+
+        enum Op { ALLOC, RECORD, UNWIND };
+        std::vector<std::pair<Op, size_t>> script;
+        script.reserve(N);
+        {
+                std::mt19937                       rng(1339);
+                std::uniform_int_distribution<int> op(0, 9), szd(16, 1024);
+                int                                depth = 0;
+                for (int i = 0; i < N; ++i) {
+                        int t = op(rng);
+                        if (t < 2 && depth < MAX_DEPTH) {
+                                script.push_back({RECORD, 0});
+                                ++depth;
+                        } else if (t < 4 && depth > 0) {
+                                script.push_back({UNWIND, 0});
+                                --depth;
+                        } else {
+                                script.push_back({ALLOC, (size_t)szd(rng)});
+                        }
+                }
+                while (depth-- > 0)
+                        script.push_back({UNWIND, 0});
+        }
+
+        auto malloc_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::vector<std::vector<void*>> scopes(1);
+                    for (const auto& [op, size] : script) {
+                            if (op == RECORD) {
+                                    scopes.emplace_back();
+                            } else if (op == UNWIND) {
+                                    for (void* p : scopes.back())
+                                            std::free(p);
+                                    scopes.pop_back();
+                            } else {
+                                    scopes.back().push_back(std::malloc(size));
+                                    touch(scopes.back().back());
+                            }
+                    }
+                    for (void* p : scopes.back())
+                            std::free(p);
+            },
+            [] {}, ops);
+
+        auto pmr_s = time_runs(
+            cfg, [] {},
+            [&] {
+                    std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> scopes;
+                    scopes.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+                    for (const auto& [op, size] : script) {
+                            if (op == RECORD)
+                                    scopes.push_back(std::make_unique<std::pmr::monotonic_buffer_resource>());
+                            else if (op == UNWIND)
+                                    scopes.pop_back();
+                            else
+                                    touch(scopes.back()->allocate(size, MIN_ALIGNMENT));
+                    }
+            },
+            [] {}, ops);
+
+        StackAllocator* a     = nullptr;
+        auto            stack = time_runs(
+            cfg, [&] { a = st::create(64 << 20, MIN_ALIGNMENT, AllocationStrategy::Lazy); },
+            [&] {
+                    for (const auto& [op, size] : script) {
+                            if (op == RECORD)
+                                    (void)st::record(a);
+                            else if (op == UNWIND)
+                                    (void)st::unwind(a);
+                            else
+                                    touch(st::alloc(a, size, MIN_ALIGNMENT));
+                    }
+                    (void)st::reset(a);
+            },
+            [&] { (void)st::destroy(&a); }, ops);
+
+        return make_row(cfg, "mixed_alloc_unwind", {{"malloc", malloc_s}, {"pmr", pmr_s}, {"stack", stack}}, 1.5);
+}
+
+// -------- Per-operation tail latency --------
+
+static std::vector<LatencyRow> operation_latencies(const Config& cfg) {
+        const int  LIFECYCLES = std::max(1, cfg.iters / 100);
+        const int  CYCLES     = std::max(1, cfg.iters / 256);
+        const int  every      = cfg.latency_sample;
+        const auto strategies = {AllocationStrategy::Eager, AllocationStrategy::Lazy};
+
+        std::vector<LatencyRow> rows;
+        for (AllocationStrategy strategy : strategies) {
+                const std::string prefix = strategy == AllocationStrategy::Eager ? "eager " : "lazy ";
+                LatencyHistogram  create_h, destroy_h, alloc_h, record_h, unwind_h, reset_h;
+                for (int c = 0; c < LIFECYCLES; ++c) {
+                        const bool      timed = c % every == 0;
+                        StackAllocator* a =
+                            timed_op(create_h, timed, [&] { return st::create(1 << 20, MIN_ALIGNMENT, strategy); });
+                        (void)timed_op(destroy_h, timed, [&] { return st::destroy(&a); });
+                }
+
+                StackAllocator* a = st::create(16 << 20, MIN_ALIGNMENT, strategy);
+                for (int c = 0; c < CYCLES; ++c) {
+                        const bool timed = c % every == 0;
+                        for (int d = 0; d < 16; ++d) {
+                                (void)timed_op(record_h, timed, [&] { return st::record(a); });
+                                for (int i = 0; i < 16; ++i)
+                                        touch(timed_op(alloc_h, timed,
+                                                       [&] { return st::alloc(a, 256, MIN_ALIGNMENT); }));
+                        }
+                        for (int d = 0; d < 16; ++d)
+                                (void)timed_op(unwind_h, timed, [&] { return st::unwind(a); });
+                        (void)timed_op(reset_h, timed, [&] { return st::reset(a); });
+                }
+                (void)st::destroy(&a);
+
+                rows.push_back({prefix + "create (1 MiB)", create_h});
+                rows.push_back({prefix + "destroy", destroy_h});
+                rows.push_back({prefix + "alloc (256 B)", alloc_h});
+                rows.push_back({prefix + "record", record_h});
+                rows.push_back({prefix + "unwind", unwind_h});
+                rows.push_back({prefix + "reset", reset_h});
+        }
+        return rows;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        if (!parse_config(cfg, argc, argv))
+                return 0;
+
+        std::cout << "=== Anvil Stack Allocator Benchmark ===\n";
+        if (!perf_counters().hardware())
+                std::cout << "(hardware counters unavailable; reporting getrusage page faults only)\n";
+
+        std::vector<Row> rows;
+        rows.push_back(deep_nesting(cfg));
+        rows.push_back(recursive_scopes(cfg));
+        rows.push_back(eager_vs_lazy(cfg));
+        rows.push_back(first_touch_faults(cfg));
+        rows.push_back(mixed_alloc_unwind(cfg));
+
+        int passes = 0, fails = 0;
+        for (const auto& r : rows) {
+                print_row(r);
+                for (const Series& s : r.series)
+                        report_series(r.name, s.label, s.stats);
+                if (r.pass)
+                        ++passes;
+                else
+                        ++fails;
+        }
+        const std::vector<LatencyRow> latencies = operation_latencies(cfg);
+        print_latency_table("Stack operation", cfg, latencies);
+        report_latencies("Stack operation", latencies);
+
+        std::cout << "\nSummary: " << passes << " PASS, " << fails << " FAIL";
+        if (gates_enabled(cfg))
+                std::cout << " (strict mode)";
+        std::cout << "\n";
+        const bool report_failed = finish_report(cfg, "memory_stack_benchmark");
+        return ((gates_enabled(cfg) && fails > 0) || report_failed) ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// trace_format.hpp
+// Compact binary trace of allocator operations, replayed by memory_trace_replay.
+//
+// File layout (native little-endian):
+//   TraceHeader  { char magic[8] = "ANVTRACE"; uint32_t version = 1; uint32_t reserved = 0; }
+//   TraceRecord  [N]  16 bytes each, in recording order
+//
+// Field semantics per op:
+//   op                  | arena          | size                          | align_log2
+//   ------------------- | -------------- | ----------------------------- | ----------------------
+//   CreateScratch       | new arena id   | capacity in bytes             | alignment exponent
+//   CreateStackEager    | new arena id   | capacity in bytes             | alignment exponent
+//   CreateStackLazy     | new arena id   | capacity in bytes             | alignment exponent
+//   Alloc               | arena          | requested bytes               | alignment exponent
+//   Free                | arena          | ordinal of the freed Alloc    | 0
+//   Record/Unwind/Reset | arena          | 0                             | 0
+//   Destroy             | arena          | 0                             | 0
+//
+// Allocs are numbered in file order starting at 0; Free refers to that ordinal. Anvil arenas ignore
+// Free (memory is reclaimed by unwind/reset/destroy) while the malloc baseline frees the block. Arena
+// ids are dense, and every arena is used by the single thread that created it.
+
+#ifndef ANVIL_TRACE_FORMAT_HPP
+#define ANVIL_TRACE_FORMAT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+enum class TraceOp : uint8_t {
+        CreateScratch    = 1,
+        CreateStackEager = 2,
+        CreateStackLazy  = 3,
+        Alloc            = 4,
+        Free             = 5,
+        Record           = 6,
+        Unwind           = 7,
+        Reset            = 8,
+        Destroy          = 9,
+};
+
+struct TraceRecord {
+        TraceOp  op;
+        uint8_t  align_log2;
+        uint16_t thread;
+        uint32_t arena;
+        uint64_t size;
+};
+static_assert(sizeof(TraceRecord) == 16, "trace records are 16 bytes");
+
+struct TraceHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t reserved;
+};
+static_assert(sizeof(TraceHeader) == 16, "trace header is 16 bytes");
+
+inline constexpr char     TRACE_MAGIC[8] = {'A', 'N', 'V', 'T', 'R', 'A', 'C', 'E'};
+inline constexpr uint32_t TRACE_VERSION  = 1;
+
+inline bool is_create(TraceOp op) {
+        return op == TraceOp::CreateScratch || op == TraceOp::CreateStackEager || op == TraceOp::CreateStackLazy;
+}
+
+inline bool write_trace(const std::string& path, const std::vector<TraceRecord>& records) {
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f)
+                return false;
+        TraceHeader header{};
+        std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        header.version = TRACE_VERSION;
+        bool ok        = std::fwrite(&header, sizeof(header), 1, f) == 1 &&
+                  std::fwrite(records.data(), sizeof(TraceRecord), records.size(), f) == records.size();
+        return std::fclose(f) == 0 && ok;
+}
+
+// Returns an empty string on success, otherwise a description of the problem.
+inline std::string read_trace(const std::string& path, std::vector<TraceRecord>& records) {
+        FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f)
+                return "cannot open " + path;
+        TraceHeader header{};
+        if (std::fread(&header, sizeof(header), 1, f) != 1 || std::memcmp(header.magic, TRACE_MAGIC, 8) != 0) {
+                std::fclose(f);
+                return path + " is not an Anvil trace";
+        }
+        if (header.version != TRACE_VERSION) {
+                std::fclose(f);
+                return "unsupported trace version " + std::to_string(header.version);
+        }
+        TraceRecord r;
+        while (std::fread(&r, sizeof(r), 1, f) == 1)
+                records.push_back(r);
+        std::fclose(f);
+        return {};
+}
+
+#endif // ANVIL_TRACE_FORMAT_HPP
@@ -0,0 +1,863 @@
+// trace_replay.cpp
+// Replays compact binary allocator traces (see trace_format.hpp) against Anvil allocators and glibc malloc.
+// - replay: every thread of the trace replays its own records on its own std::thread, all started together
+//   behind a barrier. Each mode is timed over --runs replays (median wall time) and then replayed once more
+//   with every op timed by the TSC into per-op histograms.
+//   Modes: malloc baseline, Anvil as recorded, and every arena forced to an Eager or a Lazy stack
+//   (--strategy recorded|eager|lazy replays only that one next to malloc). --capacity-scale F multiplies
+//   every arena capacity to evaluate capacity choices offline; failed allocations and peak/capacity are
+//   reported per mode, and --strict fails the run when an Anvil mode failed an allocation.
+// - generate: writes a synthetic request-serving trace (per-thread Lazy stack with nested scopes and
+//   short-lived scratch arenas); used as the CTest fixture.
+// - convert: turns ltrace (`ltrace -f -e malloc+free+calloc+realloc+...`) or glibc mtrace logs into a trace
+//   with one arena per traced thread, sized for every byte that thread allocates.
+// - --json/--csv/--compare as in memory_benchmark (see benchmark_report.hpp); series are replay modes.
+//
+// Run  :  ./memory_trace_replay generate trace.bin [--threads N] [--requests N] [--seed S]
+//         ./memory_trace_replay convert app.log trace.bin [--arena scratch|eager|lazy]
+//         ./memory_trace_replay replay trace.bin [--runs N] [--strategy S] [--capacity-scale F] [--strict]
+
+#include "memory/constants.hpp"
+#include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
+#include <array>
+#include <barrier>
+#include <fstream>
+#include <map>
+#include <random>
+#include <unordered_map>
+
+#include "benchmark_report.hpp"
+#include "trace_format.hpp"
+
+using ScratchAllocator = anvil::memory::scratch_allocator::ScratchAllocator;
+using StackAllocator   = anvil::memory::stack_allocator::StackAllocator;
+using anvil::memory::AllocationStrategy;
+using anvil::memory::AllocatorStats;
+using anvil::memory::MAX_ALIGNMENT;
+using anvil::memory::MAX_STACK_DEPTH;
+using anvil::memory::MIN_ALIGNMENT;
+namespace sa = anvil::memory::scratch_allocator;
+namespace st = anvil::memory::stack_allocator;
+
+static constexpr size_t  PAGE               = 4096;
+static constexpr uint8_t DEFAULT_ALIGN_LOG2 = 4; // malloc's 16-byte guarantee
+static constexpr size_t  OP_KINDS           = (size_t)TraceOp::Destroy + 1;
+
+static const char* op_name(TraceOp op) {
+        switch (op) {
+        case TraceOp::CreateScratch:
+                return "create scratch";
+        case TraceOp::CreateStackEager:
+                return "create eager stack";
+        case TraceOp::CreateStackLazy:
+                return "create lazy stack";
+        case TraceOp::Alloc:
+                return "alloc";
+        case TraceOp::Free:
+                return "free";
+        case TraceOp::Record:
+                return "record";
+        case TraceOp::Unwind:
+                return "unwind";
+        case TraceOp::Reset:
+                return "reset";
+        case TraceOp::Destroy:
+                return "destroy";
+        }
+        return "unknown";
+}
+
+static size_t round_up(size_t v, size_t to) {
+        return (v + to - 1) / to * to;
+}
+
+// The record's alignment clamped to what Anvil allocators accept.
+static size_t alignment_of(const TraceRecord& r) {
+        return std::clamp(size_t{1} << std::min<uint8_t>(r.align_log2, 63), MIN_ALIGNMENT, MAX_ALIGNMENT);
+}
+
+// ======================= Loading and validation =======================
+
+// A record together with the global ordinal of the allocation it makes (Alloc) or frees (Free).
+struct Step {
+        TraceRecord rec;
+        uint64_t    ordinal;
+};
+
+struct Trace {
+        std::vector<std::vector<Step>> streams; // one per trace thread id, in file order
+        uint32_t                       arenas{0};
+        uint64_t                       records{0};
+        uint64_t                       allocs{0};
+        uint64_t                       bytes{0};
+        bool                           scopes_on_scratch{false}; // record/unwind on a scratch arena
+};
+
+// Checks that the trace can be replayed without tripping allocator preconditions and splits it into
+// per-thread streams. Returns an empty string on success.
+static std::string load(const std::string& path, Trace& trace) {
+        std::vector<TraceRecord> records;
+        if (std::string err = read_trace(path, records); !err.empty())
+                return err;
+
+        struct ArenaState {
+                uint16_t thread;
+                TraceOp  kind;
+                size_t   depth;
+                bool     alive;
+        };
+        std::vector<ArenaState> arenas;
+        std::vector<uint16_t>   alloc_thread;
+        auto fail = [&](uint64_t i, const std::string& what) {
+                return "record " + std::to_string(i) + " (" + op_name(records[i].op) + "): " + what;
+        };
+
+        for (uint64_t i = 0; i < records.size(); ++i) {
+                const TraceRecord& r = records[i];
+                if (r.op < TraceOp::CreateScratch || r.op > TraceOp::Destroy)
+                        return "record " + std::to_string(i) + ": unknown op " + std::to_string((int)r.op);
+                if (r.thread >= trace.streams.size())
+                        trace.streams.resize((size_t)r.thread + 1);
+
+                uint64_t ordinal = 0;
+                if (is_create(r.op)) {
+                        if (r.arena != arenas.size())
+                                return fail(i, "arena ids must be dense and created in order");
+                        if (r.size == 0)
+                                return fail(i, "zero capacity");
+                        arenas.push_back({r.thread, r.op, 0, true});
+                } else {
+                        if (r.arena >= arenas.size() || !arenas[r.arena].alive)
+                                return fail(i, "arena " + std::to_string(r.arena) + " is not alive");
+                        ArenaState& a = arenas[r.arena];
+                        if (a.thread != r.thread)
+                                return fail(i, "arena " + std::to_string(r.arena) + " belongs to another thread");
+                        switch (r.op) {
+                        case TraceOp::Alloc:
+                                ordinal = trace.allocs++;
+                                trace.bytes += r.size;
+                                alloc_thread.push_back(r.thread);
+                                break;
+                        case TraceOp::Free:
+                                if (r.size >= trace.allocs || alloc_thread[r.size] != r.thread)
+                                        return fail(i, "frees an allocation this thread has not made");
+                                ordinal = r.size;
+                                break;
+                        case TraceOp::Record:
+                                if (a.depth + 1 >= MAX_STACK_DEPTH)
+                                        return fail(i, "more than " + std::to_string(MAX_STACK_DEPTH - 1) + " scopes");
+                                ++a.depth;
+                                trace.scopes_on_scratch |= a.kind == TraceOp::CreateScratch;
+                                break;
+                        case TraceOp::Unwind:
+                                if (a.depth == 0)
+                                        return fail(i, "unwind without a matching record");
+                                --a.depth;
+                                break;
+                        case TraceOp::Reset:
+                                a.depth = 0;
+                                break;
+                        case TraceOp::Destroy:
+                                a.alive = false;
+                                break;
+                        default:
+                                break;
+                        }
+                }
+                trace.streams[r.thread].push_back({r, ordinal});
+        }
+        trace.arenas  = (uint32_t)arenas.size();
+        trace.records = records.size();
+        return {};
+}
+
+// ======================= Replay =======================
+
+enum class Mode { Malloc, Recorded, Eager, Lazy };
+
+static const char* mode_name(Mode m) {
+        switch (m) {
+        case Mode::Malloc:
+                return "malloc";
+        case Mode::Recorded:
+                return "anvil recorded";
+        case Mode::Eager:
+                return "anvil eager";
+        case Mode::Lazy:
+                return "anvil lazy";
+        }
+        return "unknown";
+}
+
+struct Arena {
+        ScratchAllocator*     scratch{nullptr};
+        StackAllocator*       stack{nullptr};
+        size_t                alignment{MIN_ALIGNMENT};
+        std::vector<uint64_t> live;  // malloc: ordinals allocated through this arena
+        std::vector<size_t>   marks; // malloc: live.size() at every record
+};
+
+// What one thread observed during a replay. Capacity figures are only collected on the latency pass, one
+// sample per arena lifetime or reset epoch, so peak/capacity is the utilisation averaged over epochs.
+struct Outcome {
+        uint64_t failed_allocs{0};
+        uint64_t failed_creates{0};
+        size_t   capacity{0};
+        size_t   peak{0};
+        std::array<LatencyHistogram, OP_KINDS> hists;
+};
+
+class Replayer {
+      public:
+        Replayer(const Trace& trace, Mode mode, double capacity_scale)
+            : trace_(trace), mode_(mode), scale_(capacity_scale), arenas_(trace.arenas), ptrs_(trace.allocs, nullptr) {}
+
+        // Replays one thread's stream; arenas the stream leaves alive are destroyed at the end.
+        void run(size_t thread, bool timed, Outcome& out) {
+                for (const Step& s : trace_.streams[thread]) {
+                        if (timed && mode_ != Mode::Malloc &&
+                            (s.rec.op == TraceOp::Reset || s.rec.op == TraceOp::Destroy))
+                                note_capacity(arenas_[s.rec.arena], out);
+                        void* p;
+                        if (timed) {
+                                const uint64_t t0 = TscClock::start();
+                                p                 = apply(s, out);
+                                const uint64_t t1 = TscClock::stop();
+                                out.hists[(size_t)s.rec.op].record(tsc_clock().to_ns(t1 - t0));
+                        } else {
+                                p = apply(s, out);
+                        }
+                        if (p)
+                                *(volatile uint8_t*)p = 1; // the application writes what it allocates
+                }
+                for (const Step& s : trace_.streams[thread])
+                        if (is_create(s.rec.op) && alive(arenas_[s.rec.arena])) {
+                                if (timed && mode_ != Mode::Malloc)
+                                        note_capacity(arenas_[s.rec.arena], out);
+                                destroy(arenas_[s.rec.arena]);
+                        }
+        }
+
+      private:
+        bool alive(const Arena& a) const {
+                return mode_ == Mode::Malloc ? !a.live.empty() : a.scratch || a.stack;
+        }
+
+        void note_capacity(const Arena& a, Outcome& out) const {
+                if (!a.scratch && !a.stack)
+                        return;
+                const AllocatorStats s = a.scratch ? sa::stats(a.scratch) : st::stats(a.stack);
+                out.capacity += s.capacity;
+                out.peak += s.peak;
+        }
+
+        void create(Arena& a, const TraceRecord& r, Outcome& out) {
+                a.alignment = alignment_of(r);
+                if (mode_ == Mode::Malloc)
+                        return;
+                const size_t capacity = std::max<size_t>(1, (size_t)((double)r.size * scale_));
+                TraceOp      kind     = r.op;
+                if (mode_ == Mode::Eager)
+                        kind = TraceOp::CreateStackEager;
+                else if (mode_ == Mode::Lazy)
+                        kind = TraceOp::CreateStackLazy;
+                if (kind == TraceOp::CreateScratch)
+                        a.scratch = sa::create(capacity, a.alignment);
+                else
+                        a.stack = st::create(capacity, a.alignment,
+                                             kind == TraceOp::CreateStackEager ? AllocationStrategy::Eager
+                                                                               : AllocationStrategy::Lazy);
+                if (!a.scratch && !a.stack)
+                        ++out.failed_creates;
+        }
+
+        void* alloc(Arena& a, const TraceRecord& r, uint64_t ordinal, Outcome& out) {
+                const size_t size  = std::max<size_t>(1, r.size);
+                const size_t align = alignment_of(r);
+                void*        p     = nullptr;
+                if (mode_ == Mode::Malloc) {
+                        p = align <= 16 ? std::malloc(size) : std::aligned_alloc(align, round_up(size, align));
+                        ptrs_[ordinal] = p;
+                        a.live.push_back(ordinal);
+                } else if (a.scratch) {
+                        p = sa::alloc(a.scratch, size, align);
+                } else if (a.stack) {
+                        p = st::alloc(a.stack, size, align);
+                }
+                if (!p)
+                        ++out.failed_allocs;
+                return p;
+        }
+
+        // malloc: frees every allocation made through `a` after the first `keep`.
+        void release(Arena& a, size_t keep) {
+                for (size_t i = keep; i < a.live.size(); ++i) {
+                        std::free(ptrs_[a.live[i]]);
+                        ptrs_[a.live[i]] = nullptr;
+                }
+                a.live.resize(keep);
+        }
+
+        void destroy(Arena& a) {
+                if (mode_ == Mode::Malloc) {
+                        release(a, 0);
+                        a.marks.clear();
+                } else if (a.scratch) {
+                        (void)sa::destroy(&a.scratch);
+                } else if (a.stack) {
+                        (void)st::destroy(&a.stack);
+                }
+        }
+
+        void* apply(const Step& s, Outcome& out) {
+                const TraceRecord& r = s.rec;
+                Arena&             a = arenas_[r.arena];
+                switch (r.op) {
+                case TraceOp::CreateScratch:
+                case TraceOp::CreateStackEager:
+                case TraceOp::CreateStackLazy:
+                        create(a, r, out);
+                        return nullptr;
+                case TraceOp::Alloc:
+                        return alloc(a, r, s.ordinal, out);
+                case TraceOp::Free:
+                        if (mode_ == Mode::Malloc) {
+                                std::free(ptrs_[s.ordinal]);
+                                ptrs_[s.ordinal] = nullptr;
+                        }
+                        return nullptr;
+                case TraceOp::Record:
+                        if (mode_ == Mode::Malloc)
+                                a.marks.push_back(a.live.size());
+                        else if (a.stack)
+                                (void)st::record(a.stack);
+                        return nullptr;
+                case TraceOp::Unwind:
+                        if (mode_ == Mode::Malloc) {
+                                release(a, a.marks.back());
+                                a.marks.pop_back();
+                        } else if (a.stack) {
+                                (void)st::unwind(a.stack);
+                        }
+                        return nullptr;
+                case TraceOp::Reset:
+                        if (mode_ == Mode::Malloc) {
+                                release(a, 0);
+                                a.marks.clear();
+                        } else if (a.scratch) {
+                                (void)sa::reset(a.scratch);
+                        } else if (a.stack) {
+                                (void)st::reset(a.stack);
+                        }
+                        return nullptr;
+                case TraceOp::Destroy:
+                        destroy(a);
+                        return nullptr;
+                }
+                return nullptr;
+        }
+
+        const Trace&       trace_;
+        Mode               mode_;
+        double             scale_;
+        std::vector<Arena> arenas_;
+        std::vector<void*> ptrs_;
+};
+
+// Replays every stream concurrently; returns the wall time from the earliest thread start to the latest
+// thread finish, as taken by the threads themselves.
+static double replay_once(const Trace& trace, Mode mode, double scale, bool timed, std::vector<Outcome>& out) {
+        Replayer                       replayer(trace, mode, scale);
+        const size_t                   threads = trace.streams.size();
+        std::barrier<>                 start((ptrdiff_t)threads);
+        std::vector<Clock::time_point> begin(threads), end(threads);
+        std::vector<std::thread>       pool;
+        pool.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t] {
+                        start.arrive_and_wait();
+                        begin[t] = Clock::now();
+                        replayer.run(t, timed, out[t]);
+                        end[t] = Clock::now();
+                });
+        }
+        for (std::thread& t : pool)
+                t.join();
+        const auto t0 = *std::min_element(begin.begin(), begin.end());
+        const auto t1 = *std::max_element(end.begin(), end.end());
+        return (double)std::chrono::duration_cast<ns>(t1 - t0).count();
+}
+
+struct ModeResult {
+        Mode    mode;
+        Stats   stats;
+        Outcome total;
+};
+
+static ModeResult replay_mode(const Config& cfg, const Trace& trace, Mode mode, double scale) {
+        std::vector<double> samples;
+        for (int run = 0; run < cfg.runs; ++run) {
+                std::vector<Outcome> out(trace.streams.size());
+                samples.push_back(replay_once(trace, mode, scale, false, out));
+        }
+        const double ops   = (double)trace.records;
+        ModeResult   res   = {mode, make_stats(samples, std::vector<CounterSample>(samples.size()), ops), {}};
+        std::vector<Outcome> out(trace.streams.size());
+        (void)replay_once(trace, mode, scale, true, out);
+        for (const Outcome& o : out) {
+                res.total.failed_allocs += o.failed_allocs;
+                res.total.failed_creates += o.failed_creates;
+                res.total.capacity += o.capacity;
+                res.total.peak += o.peak;
+                for (size_t k = 0; k < OP_KINDS; ++k)
+                        res.total.hists[k].merge(o.hists[k]);
+        }
+        return res;
+}
+
+static int replay(int argc, char** argv, Config& cfg) {
+        if (argc < 3) {
+                std::cout << "replay needs a trace file\n";
+                return 1;
+        }
+        const std::string path     = argv[2];
+        std::string       strategy = "all";
+        double            scale    = 1.0;
+        for (int i = 3; i + 1 < argc; ++i) {
+                if (std::string(argv[i]) == "--strategy")
+                        strategy = argv[i + 1];
+                else if (std::string(argv[i]) == "--capacity-scale")
+                        scale = std::atof(argv[i + 1]);
+        }
+        if (scale <= 0) {
+                std::cout << "--capacity-scale must be positive\n";
+                return 1;
+        }
+
+        Trace trace;
+        if (std::string err = load(path, trace); !err.empty()) {
+                std::cout << path << ": " << err << "\n";
+                return 1;
+        }
+        if (trace.streams.empty()) {
+                std::cout << path << ": empty trace\n";
+                return 1;
+        }
+
+        std::vector<Mode> modes = {Mode::Malloc};
+        if (strategy == "all" || strategy == "recorded") {
+                if (trace.scopes_on_scratch)
+                        std::cout << "(skipping anvil recorded: the trace records scopes on scratch arenas)\n";
+                else
+                        modes.push_back(Mode::Recorded);
+        }
+        if (strategy == "all" || strategy == "eager")
+                modes.push_back(Mode::Eager);
+        if (strategy == "all" || strategy == "lazy")
+                modes.push_back(Mode::Lazy);
+
+        std::cout << "=== Anvil Trace Replay: " << path << " ===\n";
+        std::cout << "(" << trace.records << " records, " << trace.streams.size() << " threads, " << trace.arenas
+                  << " arenas, " << trace.allocs << " allocs, " << std::fixed << std::setprecision(2)
+                  << (double)trace.bytes / (1 << 20) << " MiB requested, capacity x" << scale << ")\n\n";
+        std::cout << std::left << std::setw(18) << "mode" << std::right << std::setw(12) << "median ms" << std::setw(10)
+                  << "± MAD" << std::setw(12) << "Mrec/s" << std::setw(11) << "vs malloc" << std::setw(15)
+                  << "failed allocs" << std::setw(15) << "peak/capacity" << "\n";
+
+        const std::string    workload = "replay " + path.substr(path.find_last_of('/') + 1);
+        std::vector<ModeResult> results;
+        bool                 failed = false;
+        for (Mode m : modes) {
+                const ModeResult r = replay_mode(cfg, trace, m, scale);
+                report_series(workload, mode_name(m), r.stats);
+                const double base = results.empty() ? r.stats.median_ns : results.front().stats.median_ns;
+                std::cout << std::left << std::setw(18) << mode_name(m) << std::right << std::fixed
+                          << std::setprecision(3) << std::setw(12) << r.stats.median_ns * 1e-6 << std::setw(10)
+                          << r.stats.mad_ns * 1e-6 << std::setw(12) << std::setprecision(2)
+                          << r.stats.ops_per_sec * 1e-6 << std::setw(10) << base / r.stats.median_ns << "x"
+                          << std::setw(15) << r.total.failed_allocs + r.total.failed_creates;
+                if (m == Mode::Malloc || r.total.capacity == 0)
+                        std::cout << std::setw(15) << "-";
+                else
+                        std::cout << std::setw(14) << std::setprecision(1)
+                                  << 100.0 * (double)r.total.peak / (double)r.total.capacity << "%";
+                std::cout << "\n";
+                failed |= m != Mode::Malloc && (r.total.failed_allocs + r.total.failed_creates) > 0;
+                results.push_back(r);
+        }
+
+        Config every_op = cfg;
+        every_op.latency_sample = 1;
+        for (const ModeResult& r : results) {
+                std::vector<LatencyRow> rows;
+                for (size_t k = 1; k < OP_KINDS; ++k)
+                        if (r.total.hists[k].count() > 0)
+                                rows.push_back({op_name((TraceOp)k), r.total.hists[k]});
+                const std::string title = workload + ", " + mode_name(r.mode);
+                print_latency_table(title.c_str(), every_op, rows);
+                report_latencies(title, rows);
+        }
+
+        if (cfg.strict && failed)
+                std::cout << "\nFAIL: an Anvil mode ran out of capacity (see failed allocs)\n";
+        const bool report_failed = finish_report(cfg, "memory_trace_replay");
+        return (cfg.strict && failed) || report_failed ? 1 : 0;
+}
+
+// ======================= Generator =======================
+
+// Synthetic request-serving trace: every thread owns a Lazy stack in which each request is a scope with
+// small, occasionally large, allocations and an optional nested scope; some blocks are freed early (a
+// no-op for Anvil), every 8th request builds a short-lived scratch arena and every 64th resets the stack.
+static int generate(int argc, char** argv) {
+        if (argc < 3) {
+                std::cout << "generate needs an output file\n";
+                return 1;
+        }
+        int      threads = 2, requests = 1000;
+        uint64_t seed    = 42;
+        for (int i = 3; i + 1 < argc; ++i) {
+                const std::string a = argv[i];
+                if (a == "--threads")
+                        threads = std::clamp(std::atoi(argv[i + 1]), 1, (int)UINT16_MAX);
+                else if (a == "--requests")
+                        requests = std::max(1, std::atoi(argv[i + 1]));
+                else if (a == "--seed")
+                        seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+
+        std::mt19937_64                     rng(seed);
+        std::lognormal_distribution<double> small(4.5, 1.0); // median ~90 B
+        std::vector<TraceRecord>            out;
+        uint32_t                            arenas = 0;
+        uint64_t                            allocs = 0;
+        auto emit = [&](TraceOp op, uint16_t thread, uint32_t arena, uint64_t size, uint8_t align_log2 = 0) {
+                out.push_back({op, align_log2, thread, arena, size});
+        };
+        auto alloc = [&](uint16_t thread, uint32_t arena, std::vector<uint64_t>& made, bool may_be_large = true) {
+                const bool     large = may_be_large && rng() % 50 == 0;
+                const uint64_t size  = large ? 64 * 1024 : std::clamp<uint64_t>((uint64_t)small(rng), 8, 4096);
+                const uint8_t  align = rng() % 16 == 0 ? 6 : DEFAULT_ALIGN_LOG2; // some cache-line aligned blocks
+                emit(TraceOp::Alloc, thread, arena, size, align);
+                made.push_back(allocs++);
+        };
+
+        for (int t = 0; t < threads; ++t) {
+                const uint16_t thread = (uint16_t)t;
+                const uint32_t stack  = arenas++;
+                emit(TraceOp::CreateStackLazy, thread, stack, 8 << 20, DEFAULT_ALIGN_LOG2);
+                for (int r = 0; r < requests; ++r) {
+                        std::vector<uint64_t> made;
+                        emit(TraceOp::Record, thread, stack, 0);
+                        const int n = 4 + (int)(rng() % 28);
+                        for (int i = 0; i < n; ++i)
+                                alloc(thread, stack, made);
+                        if (rng() % 10 < 3) {
+                                emit(TraceOp::Record, thread, stack, 0);
+                                for (int i = 0; i < 4; ++i)
+                                        alloc(thread, stack, made);
+                                emit(TraceOp::Unwind, thread, stack, 0);
+                        }
+                        for (uint64_t ordinal : made)
+                                if (rng() % 4 == 0)
+                                        emit(TraceOp::Free, thread, stack, ordinal);
+                        if (r % 8 == 0) {
+                                const uint32_t scratch = arenas++;
+                                std::vector<uint64_t> tmp;
+                                emit(TraceOp::CreateScratch, thread, scratch, 64 * 1024, DEFAULT_ALIGN_LOG2);
+                                for (int i = 0; i < 8; ++i)
+                                        alloc(thread, scratch, tmp, false);
+                                emit(TraceOp::Destroy, thread, scratch, 0);
+                        }
+                        emit(TraceOp::Unwind, thread, stack, 0);
+                        if (r % 64 == 63)
+                                emit(TraceOp::Reset, thread, stack, 0);
+                }
+                emit(TraceOp::Destroy, thread, stack, 0);
+        }
+        if (!write_trace(argv[2], out)) {
+                std::cout << "cannot write " << argv[2] << "\n";
+                return 1;
+        }
+        std::cout << "wrote " << out.size() << " records (" << threads << " threads, " << arenas << " arenas, "
+                  << allocs << " allocs) to " << argv[2] << "\n";
+        return 0;
+}
+
+// ======================= Converter =======================
+
+// Builds a trace from malloc-family events: one arena per traced thread, created up front with room for
+// every byte the thread allocates (the arena never reuses freed memory) and destroyed at the end.
+class TraceBuilder {
+      public:
+        void alloc(long pid, uint64_t size, size_t align, uint64_t address) {
+                Thread&        t       = thread(pid);
+                const uint64_t ordinal = allocs_++;
+                const size_t   a       = std::clamp<size_t>(align, MIN_ALIGNMENT, MAX_ALIGNMENT);
+                size                   = std::max<uint64_t>(1, size);
+                t.bytes += round_up(size, a) + a;
+                body_.push_back({TraceOp::Alloc, (uint8_t)std::countr_zero(a), t.id, t.id, size});
+                if (address)
+                        live_[address] = {ordinal, t.id};
+        }
+
+        void free(long pid, uint64_t address) {
+                if (!address)
+                        return;
+                auto it = live_.find(address);
+                if (it == live_.end()) {
+                        ++unmatched_;
+                        return;
+                }
+                const auto [ordinal, owner] = it->second;
+                live_.erase(it);
+                Thread& t = thread(pid);
+                if (owner != t.id) { // arenas are single-threaded; the block lives until its arena dies
+                        ++cross_thread_;
+                        return;
+                }
+                body_.push_back({TraceOp::Free, 0, t.id, t.id, ordinal});
+                ++frees_;
+        }
+
+        std::vector<TraceRecord> finish(TraceOp kind) const {
+                std::vector<const Thread*> order(threads_.size());
+                for (const auto& [pid, t] : threads_)
+                        order[t.id] = &t;
+                std::vector<TraceRecord> out;
+                out.reserve(body_.size() + 2 * order.size());
+                for (const Thread* t : order) {
+                        const uint64_t capacity = round_up(std::max<uint64_t>(t->bytes, 1), PAGE);
+                        out.push_back({kind, DEFAULT_ALIGN_LOG2, t->id, t->id, capacity});
+                }
+                out.insert(out.end(), body_.begin(), body_.end());
+                for (const Thread* t : order)
+                        out.push_back({TraceOp::Destroy, 0, t->id, t->id, 0});
+                return out;
+        }
+
+        void summary(std::ostream& o) const {
+                o << allocs_ << " allocs, " << frees_ << " frees (" << unmatched_ << " of unknown blocks, "
+                  << cross_thread_ << " cross-thread dropped), " << threads_.size() << " threads";
+        }
+
+        bool too_many_threads() const {
+                return threads_.size() > UINT16_MAX;
+        }
+
+      private:
+        struct Thread {
+                uint16_t id;
+                uint64_t bytes;
+        };
+
+        Thread& thread(long pid) {
+                auto it = threads_.find(pid);
+                if (it == threads_.end())
+                        it = threads_.emplace(pid, Thread{(uint16_t)threads_.size(), 0}).first;
+                return it->second;
+        }
+
+        std::map<long, Thread>                                         threads_;
+        std::unordered_map<uint64_t, std::pair<uint64_t, uint16_t>> live_;
+        std::vector<TraceRecord>                                       body_;
+        uint64_t                                                       allocs_{0};
+        uint64_t                                                       frees_{0};
+        uint64_t                                                       unmatched_{0};
+        uint64_t                                                       cross_thread_{0};
+};
+
+static uint64_t number(const std::string& s) {
+        const size_t b = s.find_first_not_of(" \t");
+        if (b == std::string::npos)
+                return 0;
+        return std::strtoull(s.c_str() + b, nullptr, 0); // decimal or 0x-prefixed; "nil"/"NULL" parse as 0
+}
+
+static std::vector<std::string> split_args(const std::string& s) {
+        std::vector<std::string> args;
+        std::stringstream        ss(s);
+        for (std::string a; std::getline(ss, a, ',');)
+                args.push_back(a);
+        return args;
+}
+
+// Applies one completed malloc-family call; `ret` is the returned value text.
+static void apply_call(TraceBuilder& b, long pid, const std::string& fn, const std::string& arg_text,
+                       const std::string& ret) {
+        const std::vector<std::string> args   = split_args(arg_text);
+        auto                           arg    = [&](size_t i) { return i < args.size() ? number(args[i]) : 0; };
+        const uint64_t                 result = number(ret);
+        if (fn == "free") {
+                b.free(pid, arg(0));
+        } else if (fn == "posix_memalign") { // the block is written through the first argument; never freed
+                if (result == 0)
+                        b.alloc(pid, arg(2), arg(1), 0);
+        } else if (!result) {
+                return; // failed call
+        } else if (fn == "malloc") {
+                b.alloc(pid, arg(0), 16, result);
+        } else if (fn == "calloc") {
+                b.alloc(pid, arg(0) * arg(1), 16, result);
+        } else if (fn == "realloc") {
+                b.alloc(pid, arg(1), 16, result);
+                b.free(pid, arg(0));
+        } else if (fn == "aligned_alloc" || fn == "memalign") {
+                b.alloc(pid, arg(1), arg(0), result);
+        } else if (fn == "valloc") {
+                b.alloc(pid, arg(0), PAGE, result);
+        }
+}
+
+// ltrace -f lines: "[pid 42] malloc(24) = 0x55d0c0a012a0", "42 libc.so.6->free(0x55d0c0a012a0) = <void>",
+// split calls "[pid 42] malloc(24 <unfinished ...>" ... "[pid 42] <... malloc resumed> ) = 0x...".
+static bool parse_ltrace(TraceBuilder& b, const std::string& line,
+                         std::map<long, std::pair<std::string, std::string>>& pending) {
+        static const char* const FUNCTIONS[] = {"posix_memalign", "aligned_alloc", "memalign", "realloc",
+                                                "calloc",         "malloc",        "valloc",   "free"};
+        long   pid = 0;
+        size_t pos = 0;
+        if (line.rfind("[pid ", 0) == 0) {
+                pid = std::atol(line.c_str() + 5);
+                pos = line.find(']') + 1;
+        } else if (!line.empty() && std::isdigit((unsigned char)line[0])) {
+                const size_t end = line.find_first_not_of("0123456789");
+                if (end != std::string::npos && line[end] == ' ') {
+                        pid = std::atol(line.c_str());
+                        pos = end;
+                }
+        }
+        const size_t eq     = line.rfind(" = "); // ltrace pads the return value into a column
+        const auto   result = [&] { return eq == std::string::npos ? std::string() : line.substr(eq + 3); };
+
+        if (const size_t resumed = line.find("<... ", pos); resumed != std::string::npos) {
+                const size_t name_end = line.find(' ', resumed + 5);
+                auto         it       = pending.find(pid);
+                if (name_end == std::string::npos || it == pending.end())
+                        return false;
+                const size_t      tail_begin = line.find("resumed>", name_end) + 8;
+                const size_t      tail_end   = line.rfind(')', eq);
+                const std::string tail       = tail_end != std::string::npos && tail_begin < tail_end
+                                                   ? line.substr(tail_begin, tail_end - tail_begin)
+                                                   : "";
+                apply_call(b, pid, it->second.first, it->second.second + tail, result());
+                pending.erase(it);
+                return true;
+        }
+
+        for (const char* fn : FUNCTIONS) {
+                const std::string call = std::string(fn) + "(";
+                for (size_t at = line.find(call, pos); at != std::string::npos; at = line.find(call, at + 1)) {
+                        if (at > 0 && (std::isalnum((unsigned char)line[at - 1]) || line[at - 1] == '_'))
+                                continue;
+                        const size_t open = at + call.size();
+                        if (const size_t cut = line.find(" <unfinished", open); cut != std::string::npos) {
+                                pending[pid] = {fn, line.substr(open, cut - open)};
+                                return true;
+                        }
+                        const size_t close = line.find(')', open);
+                        if (close == std::string::npos)
+                                return false;
+                        apply_call(b, pid, fn, line.substr(open, close - open), result());
+                        return true;
+                }
+        }
+        return false;
+}
+
+// glibc mtrace lines: "@ ./app:[0x4005b6] + 0x1a3c460 0x64", "- 0x1a3c460", realloc as "< old" then "> new size".
+static bool parse_mtrace(TraceBuilder& b, const std::string& line, uint64_t& realloc_old) {
+        std::stringstream ss(line);
+        std::string       tok;
+        ss >> tok;
+        if (tok == "@")
+                ss >> tok >> tok; // caller, then the op
+        std::string address, size;
+        ss >> address >> size;
+        if (tok.size() != 1 || address.rfind("0x", 0) != 0)
+                return false;
+        switch (tok[0]) {
+        case '+':
+                b.alloc(0, number(size), 16, number(address));
+                return true;
+        case '-':
+                b.free(0, number(address));
+                return true;
+        case '<':
+                realloc_old = number(address);
+                return true;
+        case '>':
+                b.alloc(0, number(size), 16, number(address));
+                b.free(0, realloc_old);
+                realloc_old = 0;
+                return true;
+        default:
+                return false;
+        }
+}
+
+static int convert(int argc, char** argv) {
+        if (argc < 4) {
+                std::cout << "convert needs an input log and an output file\n";
+                return 1;
+        }
+        TraceOp kind = TraceOp::CreateStackLazy;
+        for (int i = 4; i + 1 < argc; ++i)
+                if (std::string(argv[i]) == "--arena") {
+                        const std::string a = argv[i + 1];
+                        kind = a == "scratch" ? TraceOp::CreateScratch
+                               : a == "eager" ? TraceOp::CreateStackEager
+                                              : TraceOp::CreateStackLazy;
+                }
+
+        std::ifstream in(argv[2]);
+        if (!in) {
+                std::cout << "cannot open " << argv[2] << "\n";
+                return 1;
+        }
+        TraceBuilder                                        builder;
+        std::map<long, std::pair<std::string, std::string>> pending;
+        uint64_t                                            realloc_old = 0, lines = 0, skipped = 0;
+        for (std::string line; std::getline(in, line); ++lines) {
+                const bool mtrace = line.rfind("@ ", 0) == 0 || (line.size() > 3 && std::strchr("+-<>", line[0]) &&
+                                                                 line.compare(1, 3, " 0x") == 0);
+                if (!(mtrace ? parse_mtrace(builder, line, realloc_old) : parse_ltrace(builder, line, pending)))
+                        ++skipped;
+        }
+        if (builder.too_many_threads()) {
+                std::cout << "more than " << UINT16_MAX << " threads\n";
+                return 1;
+        }
+        const std::vector<TraceRecord> out = builder.finish(kind);
+        if (!write_trace(argv[3], out)) {
+                std::cout << "cannot write " << argv[3] << "\n";
+                return 1;
+        }
+        std::cout << "converted " << lines << " lines (" << skipped << " skipped): ";
+        builder.summary(std::cout);
+        std::cout << "; wrote " << out.size() << " records to " << argv[3] << "\n";
+        return 0;
+}
+
+int main(int argc, char** argv) {
+        Config cfg;
+        cfg.runs = 5;
+        if (argc < 2)
+                std::cout << "Usage: " << argv[0] << " COMMAND ...\n";
+        if (argc < 2 || !parse_config(cfg, argc, argv)) {
+                std::cout << "       generate OUT [--threads N] [--requests N] [--seed S]\n"
+                             "       convert LOG OUT [--arena scratch|eager|lazy]\n"
+                             "       replay TRACE [--strategy recorded|eager|lazy] [--capacity-scale F]\n";
+                return 0;
+        }
+        const std::string command = argv[1];
+        if (command == "generate")
+                return generate(argc, argv);
+        if (command == "convert")
+                return convert(argc, argv);
+        if (command == "replay")
+                return replay(argc, argv, cfg);
+        std::cout << "unknown command " << command << "\n";
+        return 1;
+}
@@ -1,9 +1,28 @@
+#include "memory/capacity_advisor.hpp"
+#include "memory/config.hpp"
 #include "memory/constants.hpp"
+#include "memory/deferred_allocator.hpp"
 #include "memory/error.hpp"
+#include "memory/generational_allocator.hpp"
+#include "memory/metrics_exporter.hpp"
+#include "memory/profiler.hpp"
+#include "memory/registry.hpp"
 #include "memory/scratch_allocator.hpp"
 #include "memory/stack_allocator.hpp"
+#include "pymem_allocator.hpp"
+#include <array>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <unordered_map>
+#include <vector>
+#ifdef ANVIL_WITH_NUMPY
+#include "numpy_handler.hpp"
+#endif
 
 namespace py = pybind11;
 
@@ -11,6 +30,10 @@ namespace {
 constexpr const char* SCRATCH_TAG = "ScratchAllocator";
 constexpr const char* STACK_TAG   = "StackAllocator";
 constexpr const char* MEM_TAG     = "memory";
+constexpr const char* ADVISOR_TAG = "CapacityAdvisor";
+constexpr const char* EXPORTER_TAG = "MetricsExporter";
+constexpr const char* GENERATIONAL_TAG = "GenerationalAllocator";
+constexpr const char* DEFERRED_TAG = "DeferredAllocator";
 
 inline void* checked_ptr(const py::capsule& cap, const char* tag) {
     if (!cap) return nullptr;
@@ -21,6 +44,16 @@ inline void* checked_ptr(const py::capsule& cap, const char* tag) {
     return cap.get_pointer(); // no-arg in pybind11
 }
 
+// Accepts either allocator kind; used by APIs that key on the allocator's address.
+inline const void* allocator_ptr(const py::capsule& cap) {
+    if (!cap) return nullptr;
+    const char* name = cap.name();
+    if (!name || (std::strcmp(name, SCRATCH_TAG) != 0 && std::strcmp(name, STACK_TAG) != 0)) {
+        throw py::type_error("Invalid capsule tag; expected an allocator");
+    }
+    return cap.get_pointer();
+}
+
 template <class T>
 T* from_capsule(const py::capsule& cap, const char* tag) {
     return static_cast<T*>(checked_ptr(cap, tag));
@@ -31,9 +64,487 @@ inline py::object to_mem_capsule(void* p) {
     return py::none();
 }
 
+// Runs a Python callable as a generational Tracer; an exception is kept and re-raised once the C++ call returns.
+struct PyTracer {
+    py::function       function;
+    std::exception_ptr error;
+
+    static void trampoline(anvil::memory::generational_allocator::GenerationalAllocator*, void* context) {
+        auto* tracer = static_cast<PyTracer*>(context);
+        if (tracer->error) return;
+        try {
+            tracer->function();
+        } catch (...) {
+            tracer->error = std::current_exception();
+        }
+    }
+};
+
+inline py::dict to_stats_dict(const anvil::memory::AllocatorStats& stats) {
+    py::dict d;
+    d["capacity"]                 = stats.capacity;
+    d["allocated"]                = stats.allocated;
+    d["committed"]                = stats.committed;
+    d["peak"]                     = stats.peak;
+    d["reset_count"]              = stats.reset_count;
+    d["exhaustion_count"]         = stats.exhaustion_count;
+    d["recommended_capacity"]     = stats.recommended_capacity;
+    d["recommended_commit_chunk"] = stats.recommended_commit_chunk;
+    return d;
+}
+
+inline anvil::memory::capacity_advisor::CapacityAdvisor* advisor_or_null(const py::object& advisor) {
+    using CA = anvil::memory::capacity_advisor::CapacityAdvisor;
+    return advisor.is_none() ? nullptr : from_capsule<CA>(advisor.cast<py::capsule>(), ADVISOR_TAG);
+}
+
 inline int log2_exact(std::size_t v) {
     int e = 0; while ((std::size_t(1) << e) < v) ++e; return e;
 }
+
+// ---------- Buffer views ----------
+
+// Bookkeeping for the views of one allocator. `generation` advances on reset and destroy, `scope_serial[d]`
+// when the scope at depth `d` is unwound; `exports[d]` counts buffers currently exported from views that
+// were created at depth `d`.
+struct ViewState {
+    bool                                                      alive      = true;
+    std::size_t                                               depth      = 0;
+    std::uint64_t                                             generation = 0;
+    std::array<std::uint64_t, anvil::memory::MAX_STACK_DEPTH> scope_serial{};
+    std::array<std::size_t, anvil::memory::MAX_STACK_DEPTH>   exports{};
+};
+
+std::unordered_map<const void*, std::shared_ptr<ViewState>>& view_states() {
+    static std::unordered_map<const void*, std::shared_ptr<ViewState>> states;
+    return states;
+}
+
+inline void track_views(const void* allocator) {
+    if (allocator) view_states()[allocator] = std::make_shared<ViewState>();
+}
+
+inline ViewState* find_views(const void* allocator) {
+    auto it = view_states().find(allocator);
+    return it == view_states().end() ? nullptr : it->second.get();
+}
+
+// Refuses (BufferError) an operation that would invalidate views created at `from_depth` or deeper while
+// they have exported buffers, like resizing a bytearray with live memoryviews.
+inline void check_exports(const ViewState* state, std::size_t from_depth, const char* operation) {
+    if (!state) return;
+    for (std::size_t d = from_depth; d < state->exports.size(); ++d) {
+        if (state->exports[d] != 0) {
+            throw py::buffer_error(std::string("cannot ") + operation +
+                                   ": allocations are exported through memoryviews; release them first");
+        }
+    }
+}
+
+inline void views_reset(const void* allocator) {
+    if (ViewState* state = find_views(allocator)) {
+        state->generation++;
+        state->depth = 0;
+    }
+}
+
+inline void views_destroyed(const void* allocator) {
+    auto it = view_states().find(allocator);
+    if (it == view_states().end()) return;
+    it->second->alive = false;
+    view_states().erase(it);
+}
+
+inline void views_recorded(const void* allocator) {
+    if (ViewState* state = find_views(allocator)) state->depth++;
+}
+
+inline void views_unwound(const void* allocator) {
+    ViewState* state = find_views(allocator);
+    if (!state || state->depth == 0) return;
+    state->scope_serial[state->depth]++;
+    state->depth--;
+}
+
+// Writable, C-contiguous view of an allocation. Keeps the allocator capsule alive; becomes invalid once the
+// allocation is released by reset, unwind or destroy, after which exporting a buffer raises BufferError.
+struct AllocationView {
+    std::shared_ptr<ViewState> state;
+    py::object                 allocator;
+    void*                      ptr;
+    std::size_t                depth;
+    std::uint64_t              generation;
+    std::uint64_t              serial;
+    std::string                format;
+    Py_ssize_t                 itemsize;
+    std::vector<Py_ssize_t>    shape;
+    std::vector<Py_ssize_t>    strides;
+    std::size_t                exports = 0;
+
+    bool valid() const {
+        return state->alive && state->generation == generation && depth <= state->depth &&
+               state->scope_serial[depth] == serial;
+    }
+
+    Py_ssize_t nbytes() const {
+        Py_ssize_t n = itemsize;
+        for (Py_ssize_t extent : shape) n *= extent;
+        return n;
+    }
+};
+
+AllocationView make_view(const void* allocator, py::object keep_alive, void* p, std::size_t size,
+                         const std::string& format, const py::object& shape) {
+    auto it = view_states().find(allocator);
+    if (it == view_states().end()) throw py::value_error("allocator was destroyed");
+    if (!p) throw py::value_error("null allocation");
+
+    const ViewState& state = *it->second;
+    AllocationView   view{it->second, std::move(keep_alive), p, state.depth, state.generation,
+                          state.scope_serial[state.depth], format,
+                          py::module_::import("struct").attr("calcsize")(format).cast<Py_ssize_t>(), {}, {}};
+    if (view.itemsize <= 0) throw py::value_error("format has no size");
+    if (shape.is_none()) {
+        view.shape.push_back(static_cast<Py_ssize_t>(size) / view.itemsize);
+    } else {
+        for (py::handle extent : shape) view.shape.push_back(extent.cast<Py_ssize_t>());
+    }
+    if (view.shape.empty()) throw py::value_error("shape must have at least one dimension");
+    for (Py_ssize_t extent : view.shape) {
+        if (extent < 0) throw py::value_error("negative extent in shape");
+    }
+    if (view.nbytes() > static_cast<Py_ssize_t>(size)) throw py::value_error("shape and format exceed the allocation");
+    view.strides.resize(view.shape.size());
+    Py_ssize_t stride = view.itemsize;
+    for (std::size_t d = view.shape.size(); d-- > 0;) {
+        view.strides[d] = stride;
+        stride *= view.shape[d];
+    }
+    return view;
+}
+
+// Buffer protocol slots installed over pybind11's so that exports are counted and stale views refuse.
+int view_getbuffer(PyObject* obj, Py_buffer* buffer, int flags) {
+    AllocationView* view = py::handle(obj).cast<AllocationView*>();
+    if (!view->valid()) {
+        buffer->obj = nullptr;
+        PyErr_SetString(PyExc_BufferError, "allocation was released by reset, unwind or destroy");
+        return -1;
+    }
+    buffer->buf        = view->ptr;
+    buffer->obj        = obj;
+    buffer->len        = view->nbytes();
+    buffer->readonly   = 0;
+    buffer->itemsize   = view->itemsize;
+    buffer->format     = (flags & PyBUF_FORMAT) ? const_cast<char*>(view->format.c_str()) : nullptr;
+    buffer->ndim       = static_cast<int>(view->shape.size());
+    buffer->shape      = (flags & PyBUF_ND) ? view->shape.data() : nullptr;
+    buffer->strides    = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? view->strides.data() : nullptr;
+    buffer->suboffsets = nullptr;
+    buffer->internal   = nullptr;
+    Py_INCREF(obj);
+    view->exports++;
+    view->state->exports[view->depth]++;
+    return 0;
+}
+
+void view_releasebuffer(PyObject* obj, Py_buffer*) {
+    AllocationView* view = py::handle(obj).cast<AllocationView*>();
+    view->exports--;
+    view->state->exports[view->depth]--;
+}
+
+// ---------- Native allocator classes ----------
+
+// Creating, destroying or resetting an arena at least this large releases the GIL while the kernel works.
+constexpr std::size_t GIL_RELEASE_BYTES = std::size_t(1) << 20;
+
+inline void check_alignment(std::size_t alignment) {
+    if (alignment < anvil::memory::MIN_ALIGNMENT || alignment > anvil::memory::MAX_ALIGNMENT ||
+        (alignment & (alignment - 1)) != 0) {
+        throw py::value_error("alignment must be a power of two in [MIN_ALIGNMENT, MAX_ALIGNMENT]");
+    }
+}
+
+inline void check_mapping_flags(std::size_t flags) {
+    if (flags & ~anvil::memory::MAPPING_FLAGS_MASK) {
+        throw py::value_error("mapping_flags must combine MAPPING_DONTFORK, MAPPING_WIPEONFORK and MAPPING_DONTDUMP");
+    }
+}
+
+struct ScratchOps {
+    using Allocator                  = anvil::memory::scratch_allocator::ScratchAllocator;
+    static constexpr const char* tag = SCRATCH_TAG;
+    static void       check_strategy(std::size_t) {}
+    static Allocator* create(std::size_t capacity, std::size_t alignment, std::size_t,
+                             anvil::memory::MappingFlags mapping) {
+        return anvil::memory::scratch_allocator::create(capacity, alignment, mapping);
+    }
+    static Error destroy(Allocator** a) { return anvil::memory::scratch_allocator::destroy(a); }
+    static Error reset(Allocator* a) { return anvil::memory::scratch_allocator::reset(a); }
+    static void* alloc(Allocator* a, std::size_t size, std::size_t alignment) {
+        return anvil::memory::scratch_allocator::alloc(a, size, alignment);
+    }
+    static anvil::memory::AllocResult try_alloc(Allocator* a, std::size_t size, std::size_t alignment) {
+        return anvil::memory::scratch_allocator::try_alloc(a, size, alignment);
+    }
+    static anvil::memory::AllocatorStats stats(const Allocator* a) {
+        return anvil::memory::scratch_allocator::stats(a);
+    }
+    static Error attach_advisor(Allocator* a, anvil::memory::capacity_advisor::CapacityAdvisor* advisor) {
+        return anvil::memory::scratch_allocator::attach_advisor(a, advisor);
+    }
+    static Error set_mapping_flags(Allocator* a, anvil::memory::MappingFlags flags) {
+        return anvil::memory::scratch_allocator::set_mapping_flags(a, flags);
+    }
+    static anvil::memory::MappingFlags mapping_flags(const Allocator* a) {
+        return anvil::memory::scratch_allocator::mapping_flags(a);
+    }
+};
+
+struct StackOps {
+    using Allocator                  = anvil::memory::stack_allocator::StackAllocator;
+    static constexpr const char* tag = STACK_TAG;
+    static void       check_strategy(std::size_t strategy) {
+        if (strategy != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Eager) &&
+            strategy != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Lazy) &&
+            strategy != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Guarded)) {
+            throw py::value_error("strategy must be EAGER, LAZY or GUARDED");
+        }
+    }
+    static Allocator* create(std::size_t capacity, std::size_t alignment, std::size_t strategy,
+                             anvil::memory::MappingFlags mapping) {
+        return anvil::memory::stack_allocator::create(
+            capacity, alignment, static_cast<anvil::memory::AllocationStrategy>(strategy), mapping);
+    }
+    static Error destroy(Allocator** a) { return anvil::memory::stack_allocator::destroy(a); }
+    static Error reset(Allocator* a) { return anvil::memory::stack_allocator::reset(a); }
+    static void* alloc(Allocator* a, std::size_t size, std::size_t alignment) {
+        return anvil::memory::stack_allocator::alloc(a, size, alignment);
+    }
+    static anvil::memory::AllocResult try_alloc(Allocator* a, std::size_t size, std::size_t alignment) {
+        return anvil::memory::stack_allocator::try_alloc(a, size, alignment);
+    }
+    static anvil::memory::AllocatorStats stats(const Allocator* a) {
+        return anvil::memory::stack_allocator::stats(a);
+    }
+    static Error attach_advisor(Allocator* a, anvil::memory::capacity_advisor::CapacityAdvisor* advisor) {
+        return anvil::memory::stack_allocator::attach_advisor(a, advisor);
+    }
+    static Error set_mapping_flags(Allocator* a, anvil::memory::MappingFlags flags) {
+        return anvil::memory::stack_allocator::set_mapping_flags(a, flags);
+    }
+    static anvil::memory::MappingFlags mapping_flags(const Allocator* a) {
+        return anvil::memory::stack_allocator::mapping_flags(a);
+    }
+};
+
+// Owns one allocator; the Python object is the handle, so there is no capsule or tag check per call.
+// Like the allocators themselves these objects are not thread-safe; an operation that released the GIL
+// marks the object busy so that a concurrent call fails instead of racing.
+template <class Ops>
+class NativeAllocator {
+public:
+    using Allocator = typename Ops::Allocator;
+
+    NativeAllocator(std::size_t capacity, std::size_t alignment, std::size_t strategy, std::size_t mapping_flags)
+        : capacity_(capacity), strategy_(strategy) {
+        check_alignment(alignment);
+        if (capacity == 0) throw py::value_error("capacity must be positive");
+        Ops::check_strategy(strategy);
+        check_mapping_flags(mapping_flags);
+        const auto mapping = static_cast<anvil::memory::MappingFlags>(mapping_flags);
+        without_gil([&] { allocator_ = Ops::create(capacity, alignment, strategy, mapping); });
+        if (!allocator_) throw std::bad_alloc();
+        track_views(allocator_);
+    }
+
+    ~NativeAllocator() {
+        // Views keep this object alive, so none can still be exported here.
+        if (allocator_) {
+            views_destroyed(allocator_);
+            static_cast<void>(Ops::destroy(&allocator_));
+        }
+    }
+
+    NativeAllocator(const NativeAllocator&)            = delete;
+    NativeAllocator& operator=(const NativeAllocator&) = delete;
+
+    Allocator* get() const {
+        if (!allocator_) throw py::value_error("allocator is closed");
+        if (busy_.load(std::memory_order_acquire)) throw std::runtime_error("allocator is busy in another thread");
+        return allocator_;
+    }
+
+    int close() {
+        if (!allocator_) return static_cast<int>(ERR_SUCCESS);
+        Allocator* a = get();
+        check_exports(find_views(a), 0, "destroy");
+        views_destroyed(a);
+        Error result = ERR_SUCCESS;
+        without_gil([&] { result = Ops::destroy(&allocator_); });
+        return static_cast<int>(result);
+    }
+
+    int reset() {
+        Allocator* a = get();
+        check_exports(find_views(a), 0, "reset");
+        views_reset(a);
+        Error result = ERR_SUCCESS;
+        without_gil([&] { result = Ops::reset(a); });
+        return static_cast<int>(result);
+    }
+
+    py::object alloc(std::size_t size, std::size_t alignment) {
+        check_alignment(alignment);
+        if (size == 0) throw py::value_error("size must be positive");
+        void* p = Ops::alloc(get(), size, alignment);
+        return p ? py::int_(reinterpret_cast<std::uintptr_t>(p)) : py::none();
+    }
+
+    py::tuple try_alloc(std::size_t size, std::size_t alignment) {
+        check_alignment(alignment);
+        if (size == 0) throw py::value_error("size must be positive");
+        const anvil::memory::AllocResult r = Ops::try_alloc(get(), size, alignment);
+        py::object address = r.ok() ? py::object(py::int_(reinterpret_cast<std::uintptr_t>(r.ptr))) : py::none();
+        return py::make_tuple(address, static_cast<int>(r.error));
+    }
+
+    // Addresses of the allocations, 0 where the allocator ran out; sizes are validated up front so a bad
+    // entry cannot leave a partial batch behind.
+    py::array_t<std::uint64_t> alloc_many(py::array_t<std::size_t, py::array::c_style | py::array::forcecast> sizes,
+                                          std::size_t alignment) {
+        check_alignment(alignment);
+        if (sizes.ndim() != 1) throw py::value_error("sizes must be one-dimensional");
+        const auto in = sizes.template unchecked<1>();
+        for (py::ssize_t i = 0; i < in.shape(0); ++i) {
+            if (in(i) == 0) throw py::value_error("sizes must be positive");
+        }
+        Allocator*                 a = get();
+        py::array_t<std::uint64_t> addresses(in.shape(0));
+        auto                       out = addresses.template mutable_unchecked<1>();
+        for (py::ssize_t i = 0; i < in.shape(0); ++i) {
+            out(i) = reinterpret_cast<std::uintptr_t>(Ops::alloc(a, in(i), alignment));
+        }
+        return addresses;
+    }
+
+    py::dict stats() const { return to_stats_dict(Ops::stats(get())); }
+
+    int attach_advisor(const py::object& advisor) {
+        return static_cast<int>(Ops::attach_advisor(get(), advisor_or_null(advisor)));
+    }
+
+    int set_mapping_flags(std::size_t flags) {
+        check_mapping_flags(flags);
+        return static_cast<int>(Ops::set_mapping_flags(get(), static_cast<anvil::memory::MappingFlags>(flags)));
+    }
+
+    std::size_t mapping_flags() const { return static_cast<std::size_t>(Ops::mapping_flags(get())); }
+
+    // Borrowed capsule for the capsule-based functions (registry, profiler, views); never destroy through it.
+    py::capsule capsule() const { return py::capsule(get(), Ops::tag); }
+
+    bool        closed() const { return allocator_ == nullptr; }
+    std::size_t capacity() const { return capacity_; }
+
+protected:
+    template <class F>
+    void without_gil(F&& operation) {
+        if (capacity_ < GIL_RELEASE_BYTES) {
+            operation();
+            return;
+        }
+        busy_.store(true, std::memory_order_release);
+        {
+            py::gil_scoped_release release;
+            operation();
+        }
+        busy_.store(false, std::memory_order_release);
+    }
+
+    Allocator*        allocator_ = nullptr;
+    std::size_t       capacity_;
+    std::size_t       strategy_;
+    std::atomic<bool> busy_{false};
+};
+
+class NativeStackAllocator : public NativeAllocator<StackOps> {
+public:
+    using NativeAllocator<StackOps>::NativeAllocator;
+
+    int record(std::optional<std::size_t> budget) {
+        Allocator*  a      = get();
+        const Error result = anvil::memory::stack_allocator::record(a, budget.value_or(anvil::memory::NO_BUDGET));
+        if (result == ERR_SUCCESS) views_recorded(a);
+        return static_cast<int>(result);
+    }
+
+    int unwind() {
+        Allocator*       a     = get();
+        const ViewState* state = find_views(a);
+        if (!state || state->depth == 0) throw py::value_error("unwind without a matching record");
+        check_exports(state, state->depth, "unwind");
+        const Error result = anvil::memory::stack_allocator::unwind(a);
+        if (result == ERR_SUCCESS) views_unwound(a);
+        return static_cast<int>(result);
+    }
+
+    // The library leaves every precondition of alloc_unchecked to the caller; from Python they are checked here,
+    // and allocations must also fit in the capacity so the watermark never runs past it.
+    std::uintptr_t alloc_unchecked(std::size_t size, std::size_t alignment) {
+        check_alignment(alignment);
+        if (strategy_ != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Guarded)) {
+            throw py::value_error("alloc_unchecked needs a GUARDED allocator");
+        }
+        if (size == 0 || size + alignment - 1 > anvil::memory::GUARD_REGION_SIZE) {
+            throw py::value_error("size must be positive and fit in GUARD_REGION_SIZE with its alignment");
+        }
+        const anvil::memory::AllocatorStats stats = anvil::memory::stack_allocator::stats(get());
+        if (stats.allocated + size + alignment - 1 > stats.capacity) {
+            throw py::value_error("allocation does not fit in the remaining capacity; reset or unwind first");
+        }
+        void* p = anvil::memory::stack_allocator::alloc_unchecked(get(), size, alignment);
+        return reinterpret_cast<std::uintptr_t>(p);
+    }
+
+    int set_commit_chunk(std::size_t commit_chunk) {
+        if (commit_chunk == 0) throw py::value_error("commit_chunk must be positive");
+        return static_cast<int>(anvil::memory::stack_allocator::set_commit_chunk(get(), commit_chunk));
+    }
+};
+
+template <class Native>
+AllocationView native_view(py::object self, std::uintptr_t address, std::size_t size, const std::string& format,
+                           const py::object& shape) {
+    auto& native = self.cast<Native&>();
+    return make_view(native.get(), self, reinterpret_cast<void*>(address), size, format, shape);
+}
+
+// Methods shared by both classes.
+template <class Native, class Class>
+void bind_native_common(Class& cls) {
+    cls.def("alloc", &Native::alloc, py::arg("size"), py::arg("alignment") = anvil::memory::MIN_ALIGNMENT,
+            "Allocate; returns the address, or None when the arena is exhausted")
+        .def("try_alloc", &Native::try_alloc, py::arg("size"), py::arg("alignment") = anvil::memory::MIN_ALIGNMENT,
+             "Allocate; returns (address, ERR_SUCCESS), or (None, error) naming why the allocation failed")
+        .def("alloc_many", &Native::alloc_many, py::arg("sizes"), py::arg("alignment") = anvil::memory::MIN_ALIGNMENT,
+             "Allocate a batch; returns a uint64 NumPy array of addresses (0 where the arena ran out)")
+        .def("reset", &Native::reset)
+        .def("close", &Native::close, "Destroy the allocator; further calls raise ValueError")
+        .def("stats", &Native::stats)
+        .def("attach_advisor", &Native::attach_advisor, py::arg("advisor"))
+        .def("set_mapping_flags", &Native::set_mapping_flags, py::arg("flags"),
+             "Change fork and core dump treatment of the arena (MAPPING_* flags)")
+        .def("view", &native_view<Native>, py::arg("address"), py::arg("size"), py::arg("format") = "B",
+             py::arg("shape") = py::none(), "Zero-copy buffer view of an allocation made by this allocator")
+        .def("__enter__", [](py::object self) { return self; })
+        .def("__exit__", [](Native& self, const py::args&) { static_cast<void>(self.close()); })
+        .def_property_readonly("capsule", &Native::capsule)
+        .def_property_readonly("closed", &Native::closed)
+        .def_property_readonly("capacity", &Native::capacity)
+        .def_property_readonly("mapping_flags", &Native::mapping_flags);
+}
 } // namespace
 
 PYBIND11_MODULE(anvil_memory, m) {
@@ -44,24 +555,67 @@ PYBIND11_MODULE(anvil_memory, m) {
     m.attr("ERR_OUT_OF_MEMORY")            = py::int_(ERR_OUT_OF_MEMORY);
     m.attr("ERR_MEMORY_PERMISSION_CHANGE") = py::int_(ERR_MEMORY_PERMISSION_CHANGE);
     m.attr("ERR_MEMORY_DEALLOCATION")      = py::int_(ERR_MEMORY_DEALLOCATION);
+    m.attr("ERR_IO_FAILURE")               = py::int_(ERR_IO_FAILURE);
+    m.attr("ERR_MEMORY_ADVICE")            = py::int_(ERR_MEMORY_ADVICE);
+    m.attr("ERR_FAULT_HANDLER")            = py::int_(ERR_FAULT_HANDLER);
+    m.attr("ERR_BUDGET_EXHAUSTED")         = py::int_(ERR_BUDGET_EXHAUSTED);
+    m.attr("ERR_INVALID_CONFIG")           = py::int_(ERR_INVALID_CONFIG);
 
     // Constants
     m.attr("EAGER") = py::int_(static_cast<std::size_t>(anvil::memory::AllocationStrategy::Eager));
     m.attr("LAZY")  = py::int_(static_cast<std::size_t>(anvil::memory::AllocationStrategy::Lazy));
+    m.attr("GUARDED") = py::int_(static_cast<std::size_t>(anvil::memory::AllocationStrategy::Guarded));
+    m.attr("ADVISORY") = py::int_(static_cast<std::size_t>(anvil::memory::capacity_advisor::Mode::Advisory));
+    m.attr("ADAPTIVE") = py::int_(static_cast<std::size_t>(anvil::memory::capacity_advisor::Mode::Adaptive));
+    m.attr("DEFAULT_COMMIT_CHUNK") = py::int_(anvil::memory::DEFAULT_COMMIT_CHUNK);
+    m.attr("GUARD_REGION_SIZE") = py::int_(anvil::memory::GUARD_REGION_SIZE);
+    m.attr("MAPPING_NONE")       = py::int_(static_cast<std::size_t>(anvil::memory::MappingFlags::None));
+    m.attr("MAPPING_DONTFORK")   = py::int_(static_cast<std::size_t>(anvil::memory::MappingFlags::DontFork));
+    m.attr("MAPPING_WIPEONFORK") = py::int_(static_cast<std::size_t>(anvil::memory::MappingFlags::WipeOnFork));
+    m.attr("MAPPING_DONTDUMP")   = py::int_(static_cast<std::size_t>(anvil::memory::MappingFlags::DontDump));
     m.attr("MIN_ALIGNMENT") = py::int_(anvil::memory::MIN_ALIGNMENT);
     m.attr("MAX_ALIGNMENT") = py::int_(anvil::memory::MAX_ALIGNMENT);
+    m.attr("PROFILER_DEFAULT_SAMPLE_RATE") = py::int_(anvil::memory::profiler::DEFAULT_SAMPLE_RATE);
 
     // Exponent ranges for testing (derived)
     m.attr("MIN_ALIGNMENT_EXPONENT") = py::int_(log2_exact(anvil::memory::MIN_ALIGNMENT));
     m.attr("MAX_ALIGNMENT_EXPONENT") = py::int_(log2_exact(anvil::memory::MAX_ALIGNMENT));
 
+    // ========== Buffer views ==========
+    auto view_class = py::class_<AllocationView>(m, "AllocationView", py::buffer_protocol())
+        .def_property_readonly("valid", &AllocationView::valid,
+                               "False once reset, unwind or destroy released the allocation")
+        .def_property_readonly("nbytes", &AllocationView::nbytes)
+        .def_property_readonly("format", [](const AllocationView& v) { return v.format; })
+        .def_property_readonly("shape", [](const AllocationView& v) {
+            py::tuple t(v.shape.size());
+            for (std::size_t i = 0; i < v.shape.size(); ++i) t[i] = v.shape[i];
+            return t;
+        })
+        .def_property_readonly("exports", [](const AllocationView& v) { return v.exports; },
+                               "Number of buffers currently exported from this view");
+    auto* view_type                           = reinterpret_cast<PyTypeObject*>(view_class.ptr());
+    view_type->tp_as_buffer->bf_getbuffer     = view_getbuffer;
+    view_type->tp_as_buffer->bf_releasebuffer = view_releasebuffer;
+
+    // ========== PyMem allocator hook ==========
+    bind_pymem_allocator(m);
+
+#ifdef ANVIL_WITH_NUMPY
+    // ========== NumPy data-memory handler ==========
+    bind_numpy_handler(m);
+#endif
+
     // ========== ScratchAllocator ==========
     m.def("scratch_allocator_create",
-          [](size_t capacity, size_t alignment) -> py::capsule {
-              auto* a = anvil::memory::scratch_allocator::create(capacity, alignment);
+          [](size_t capacity, size_t alignment, size_t mapping_flags) -> py::capsule {
+              check_mapping_flags(mapping_flags);
+              auto* a = anvil::memory::scratch_allocator::create(
+                  capacity, alignment, static_cast<anvil::memory::MappingFlags>(mapping_flags));
+              track_views(a);
               return a ? py::capsule(a, SCRATCH_TAG) : py::capsule();
           },
-          py::arg("capacity"), py::arg("alignment"),
+          py::arg("capacity"), py::arg("alignment"), py::arg("mapping_flags") = 0,
           "Create a scratch allocator");
 
     m.def("scratch_allocator_destroy",
@@ -69,6 +623,8 @@ PYBIND11_MODULE(anvil_memory, m) {
               using SA = anvil::memory::scratch_allocator::ScratchAllocator;
               SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
               if (!a) return -1;
+              check_exports(find_views(a), 0, "destroy");
+              views_destroyed(a);
               return static_cast<int>(anvil::memory::scratch_allocator::destroy(&a));
           },
           py::arg("allocator"), "Destroy a scratch allocator");
@@ -89,18 +645,69 @@ PYBIND11_MODULE(anvil_memory, m) {
               using SA = anvil::memory::scratch_allocator::ScratchAllocator;
               SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
               if (!a) return -1;
+              check_exports(find_views(a), 0, "reset");
+              views_reset(a);
               return static_cast<int>(anvil::memory::scratch_allocator::reset(a));
           },
           py::arg("allocator"), "Reset scratch allocator");
 
+    m.def("scratch_allocator_view",
+          [](py::capsule cap, py::capsule ptr, size_t size, const std::string& format, py::object shape) {
+              return make_view(checked_ptr(cap, SCRATCH_TAG), cap, checked_ptr(ptr, MEM_TAG), size, format, shape);
+          },
+          py::arg("allocator"), py::arg("ptr"), py::arg("size"), py::arg("format") = "B",
+          py::arg("shape") = py::none(),
+          "Zero-copy buffer view of a scratch allocation; use memoryview() or numpy.asarray() on it");
+
+    m.def("scratch_allocator_attach_advisor",
+          [](py::capsule cap, py::object advisor) -> int {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
+              if (!a) return -1;
+              return static_cast<int>(anvil::memory::scratch_allocator::attach_advisor(a, advisor_or_null(advisor)));
+          },
+          py::arg("allocator"), py::arg("advisor"), "Attach (or detach with None) a capacity advisor");
+
+    m.def("scratch_allocator_stats",
+          [](py::capsule cap) -> py::object {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
+              if (!a) return py::none();
+              return to_stats_dict(anvil::memory::scratch_allocator::stats(a));
+          },
+          py::arg("allocator"), "Usage statistics of a scratch allocator");
+
+    m.def("scratch_allocator_set_mapping_flags",
+          [](py::capsule cap, size_t flags) -> int {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
+              if (!a) return -1;
+              check_mapping_flags(flags);
+              const auto mapping = static_cast<anvil::memory::MappingFlags>(flags);
+              return static_cast<int>(anvil::memory::scratch_allocator::set_mapping_flags(a, mapping));
+          },
+          py::arg("allocator"), py::arg("flags"), "Change fork and core dump treatment of a scratch arena");
+
+    m.def("scratch_allocator_mapping_flags",
+          [](py::capsule cap) -> py::object {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              SA* a = from_capsule<SA>(cap, SCRATCH_TAG);
+              if (!a) return py::none();
+              return py::int_(static_cast<size_t>(anvil::memory::scratch_allocator::mapping_flags(a)));
+          },
+          py::arg("allocator"), "MAPPING_* flags applied to a scratch arena");
+
     // ========== StackAllocator ==========
     m.def("stack_allocator_create",
-          [](size_t capacity, size_t alignment, size_t alloc_mode) -> py::capsule {
+          [](size_t capacity, size_t alignment, size_t alloc_mode, size_t mapping_flags) -> py::capsule {
+              check_mapping_flags(mapping_flags);
               auto mode = static_cast<anvil::memory::AllocationStrategy>(alloc_mode);
-              auto* a = anvil::memory::stack_allocator::create(capacity, alignment, mode);
+              auto* a = anvil::memory::stack_allocator::create(
+                  capacity, alignment, mode, static_cast<anvil::memory::MappingFlags>(mapping_flags));
+              track_views(a);
               return a ? py::capsule(a, STACK_TAG) : py::capsule();
           },
-          py::arg("capacity"), py::arg("alignment"), py::arg("alloc_mode"),
+          py::arg("capacity"), py::arg("alignment"), py::arg("alloc_mode"), py::arg("mapping_flags") = 0,
           "Create a stack allocator");
 
     m.def("stack_allocator_destroy",
@@ -108,6 +715,8 @@ PYBIND11_MODULE(anvil_memory, m) {
               using ST = anvil::memory::stack_allocator::StackAllocator;
               ST* a = from_capsule<ST>(cap, STACK_TAG);
               if (!a) return -1;
+              check_exports(find_views(a), 0, "destroy");
+              views_destroyed(a);
               return static_cast<int>(anvil::memory::stack_allocator::destroy(&a));
           },
           py::arg("allocator"), "Destroy a stack allocator");
@@ -128,28 +737,439 @@ PYBIND11_MODULE(anvil_memory, m) {
               using ST = anvil::memory::stack_allocator::StackAllocator;
               ST* a = from_capsule<ST>(cap, STACK_TAG);
               if (!a) return -1;
+              check_exports(find_views(a), 0, "reset");
+              views_reset(a);
               return static_cast<int>(anvil::memory::stack_allocator::reset(a));
           },
           py::arg("allocator"), "Reset stack allocator");
 
     m.def("stack_allocator_record",
-          [](py::capsule cap) -> int {
+          [](py::capsule cap, std::optional<std::size_t> budget) -> int {
               using ST = anvil::memory::stack_allocator::StackAllocator;
               ST* a = from_capsule<ST>(cap, STACK_TAG);
               if (!a) return -1;
-              return static_cast<int>(anvil::memory::stack_allocator::record(a));
+              const Error result =
+                  anvil::memory::stack_allocator::record(a, budget.value_or(anvil::memory::NO_BUDGET));
+              if (result == ERR_SUCCESS) views_recorded(a);
+              return static_cast<int>(result);
           },
-          py::arg("allocator"), "Record current allocation state");
+          py::arg("allocator"), py::arg("budget") = py::none(),
+          "Record current allocation state, optionally capping the bytes the new scope may allocate");
 
     m.def("stack_allocator_unwind",
           [](py::capsule cap) -> int {
               using ST = anvil::memory::stack_allocator::StackAllocator;
               ST* a = from_capsule<ST>(cap, STACK_TAG);
               if (!a) return -1;
-              return static_cast<int>(anvil::memory::stack_allocator::unwind(a));
+              const ViewState* state = find_views(a);
+              if (state && state->depth > 0) check_exports(state, state->depth, "unwind");
+              const Error result = anvil::memory::stack_allocator::unwind(a);
+              if (result == ERR_SUCCESS) views_unwound(a);
+              return static_cast<int>(result);
           },
           py::arg("allocator"), "Unwind to last recorded state");
 
+    m.def("stack_allocator_view",
+          [](py::capsule cap, py::capsule ptr, size_t size, const std::string& format, py::object shape) {
+              return make_view(checked_ptr(cap, STACK_TAG), cap, checked_ptr(ptr, MEM_TAG), size, format, shape);
+          },
+          py::arg("allocator"), py::arg("ptr"), py::arg("size"), py::arg("format") = "B",
+          py::arg("shape") = py::none(),
+          "Zero-copy buffer view of a stack allocation; use memoryview() or numpy.asarray() on it");
+
+    m.def("stack_allocator_set_commit_chunk",
+          [](py::capsule cap, size_t commit_chunk) -> int {
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              ST* a = from_capsule<ST>(cap, STACK_TAG);
+              if (!a) return -1;
+              return static_cast<int>(anvil::memory::stack_allocator::set_commit_chunk(a, commit_chunk));
+          },
+          py::arg("allocator"), py::arg("commit_chunk"), "Set the minimum commit size of a lazy stack allocator");
+
+    m.def("stack_allocator_attach_advisor",
+          [](py::capsule cap, py::object advisor) -> int {
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              ST* a = from_capsule<ST>(cap, STACK_TAG);
+              if (!a) return -1;
+              return static_cast<int>(anvil::memory::stack_allocator::attach_advisor(a, advisor_or_null(advisor)));
+          },
+          py::arg("allocator"), py::arg("advisor"), "Attach (or detach with None) a capacity advisor");
+
+    m.def("stack_allocator_stats",
+          [](py::capsule cap) -> py::object {
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              ST* a = from_capsule<ST>(cap, STACK_TAG);
+              if (!a) return py::none();
+              return to_stats_dict(anvil::memory::stack_allocator::stats(a));
+          },
+          py::arg("allocator"), "Usage statistics of a stack allocator");
+
+    m.def("stack_allocator_set_mapping_flags",
+          [](py::capsule cap, size_t flags) -> int {
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              ST* a = from_capsule<ST>(cap, STACK_TAG);
+              if (!a) return -1;
+              check_mapping_flags(flags);
+              const auto mapping = static_cast<anvil::memory::MappingFlags>(flags);
+              return static_cast<int>(anvil::memory::stack_allocator::set_mapping_flags(a, mapping));
+          },
+          py::arg("allocator"), py::arg("flags"), "Change fork and core dump treatment of a stack arena");
+
+    m.def("stack_allocator_mapping_flags",
+          [](py::capsule cap) -> py::object {
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              ST* a = from_capsule<ST>(cap, STACK_TAG);
+              if (!a) return py::none();
+              return py::int_(static_cast<size_t>(anvil::memory::stack_allocator::mapping_flags(a)));
+          },
+          py::arg("allocator"), "MAPPING_* flags applied to a stack arena");
+
+    // ========== GenerationalAllocator ==========
+    using GA = anvil::memory::generational_allocator::GenerationalAllocator;
+    m.def("generational_allocator_create",
+          [](size_t young_capacity, size_t old_capacity, size_t alignment, size_t mapping_flags) -> py::capsule {
+              check_mapping_flags(mapping_flags);
+              auto* a = anvil::memory::generational_allocator::create(
+                  young_capacity, old_capacity, alignment, static_cast<anvil::memory::MappingFlags>(mapping_flags));
+              return a ? py::capsule(a, GENERATIONAL_TAG) : py::capsule();
+          },
+          py::arg("young_capacity"), py::arg("old_capacity"), py::arg("alignment"), py::arg("mapping_flags") = 0,
+          "Create a generational allocator");
+
+    m.def("generational_allocator_destroy",
+          [](py::capsule cap) -> int {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              if (!a) return -1;
+              return static_cast<int>(anvil::memory::generational_allocator::destroy(&a));
+          },
+          py::arg("allocator"), "Destroy a generational allocator");
+
+    m.def("generational_allocator_alloc",
+          [](py::capsule cap, size_t size, size_t alignment) -> py::object {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              if (!a) return py::none();
+              return to_mem_capsule(anvil::memory::generational_allocator::alloc(a, size, alignment));
+          },
+          py::arg("allocator"), py::arg("size"), py::arg("alignment"),
+          "Allocate from the young generation");
+
+    m.def("generational_allocator_promote",
+          [](py::capsule cap, py::capsule ptr, size_t size) -> py::object {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              void* p = checked_ptr(ptr, MEM_TAG);
+              if (!a || !p) return py::none();
+              return to_mem_capsule(anvil::memory::generational_allocator::promote(a, p, size));
+          },
+          py::arg("allocator"), py::arg("ptr"), py::arg("size"),
+          "Copy an object into the old generation; returns the copy, or None if the old generation is full");
+
+    m.def("generational_allocator_forward",
+          [](py::capsule cap, py::capsule ptr) -> py::object {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              void* p = checked_ptr(ptr, MEM_TAG);
+              if (!a || !p) return py::none();
+              return to_mem_capsule(anvil::memory::generational_allocator::forward(a, p));
+          },
+          py::arg("allocator"), py::arg("ptr"), "New address of a promoted or evacuated object, else the same one");
+
+    m.def("generational_allocator_advance",
+          [](py::capsule cap, py::object tracer) -> int {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              if (!a) return -1;
+              if (tracer.is_none()) {
+                  return static_cast<int>(anvil::memory::generational_allocator::advance(a, nullptr, nullptr));
+              }
+              PyTracer context{tracer.cast<py::function>(), nullptr};
+              const Error result = anvil::memory::generational_allocator::advance(a, PyTracer::trampoline, &context);
+              if (context.error) std::rethrow_exception(context.error);
+              return static_cast<int>(result);
+          },
+          py::arg("allocator"), py::arg("tracer") = py::none(),
+          "End a frame: call tracer() to promote survivors, then reset the young generation");
+
+    m.def("generational_allocator_compact",
+          [](py::capsule cap, py::function tracer) -> int {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              if (!a) return -1;
+              PyTracer context{tracer, nullptr};
+              const Error result = anvil::memory::generational_allocator::compact(a, PyTracer::trampoline, &context);
+              if (context.error) std::rethrow_exception(context.error);
+              return static_cast<int>(result);
+          },
+          py::arg("allocator"), py::arg("tracer"),
+          "Compact the old generation: call tracer() to promote every live old object, then drop the rest");
+
+    m.def("generational_allocator_stats",
+          [](py::capsule cap) -> py::object {
+              GA* a = from_capsule<GA>(cap, GENERATIONAL_TAG);
+              if (!a) return py::none();
+              const auto stats = anvil::memory::generational_allocator::stats(a);
+              py::dict d;
+              d["young"]            = to_stats_dict(stats.young);
+              d["old"]              = to_stats_dict(stats.old);
+              d["promoted_count"]   = stats.promoted_count;
+              d["promoted_bytes"]   = stats.promoted_bytes;
+              d["evacuated_count"]  = stats.evacuated_count;
+              d["evacuated_bytes"]  = stats.evacuated_bytes;
+              d["compaction_count"] = stats.compaction_count;
+              return d;
+          },
+          py::arg("allocator"), "Usage statistics of both generations and the volume of copying");
+
+    // ========== DeferredAllocator ==========
+    // The handle is a value type in C++; Python holds it in a heap cell that destroy frees.
+    using DA = anvil::memory::deferred_allocator::DeferredAllocator;
+    m.def("deferred_allocator_create",
+          [](size_t capacity, size_t alignment, size_t mapping_flags) -> py::capsule {
+              check_mapping_flags(mapping_flags);
+              auto* handle = new DA(anvil::memory::deferred_allocator::create(
+                  capacity, alignment, static_cast<anvil::memory::MappingFlags>(mapping_flags)));
+              return py::capsule(handle, DEFERRED_TAG);
+          },
+          py::arg("capacity"), py::arg("alignment"), py::arg("mapping_flags") = 0,
+          "Create a deferred arena handle; nothing is mapped until the first allocation");
+
+    m.def("deferred_allocator_destroy",
+          [](py::capsule cap) -> int {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              if (!handle) return -1;
+              const Error result = anvil::memory::deferred_allocator::destroy(handle);
+              if (result == ERR_SUCCESS) delete handle;
+              return static_cast<int>(result);
+          },
+          py::arg("allocator"), "Unmap the arena, if it was mapped, and free the handle");
+
+    m.def("deferred_allocator_alloc",
+          [](py::capsule cap, size_t size, size_t alignment) -> py::object {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              if (!handle) return py::none();
+              return to_mem_capsule(anvil::memory::deferred_allocator::alloc(handle, size, alignment));
+          },
+          py::arg("allocator"), py::arg("size"), py::arg("alignment"),
+          "Allocate, mapping the arena on the first call");
+
+    m.def("deferred_allocator_try_alloc",
+          [](py::capsule cap, size_t size, size_t alignment) -> py::tuple {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              if (!handle) return py::make_tuple(py::none(), -1);
+              const auto result = anvil::memory::deferred_allocator::try_alloc(handle, size, alignment);
+              return py::make_tuple(to_mem_capsule(result.ptr), static_cast<int>(result.error));
+          },
+          py::arg("allocator"), py::arg("size"), py::arg("alignment"),
+          "Allocate; returns (ptr, ERR_SUCCESS), or (None, error) naming why the allocation failed");
+
+    m.def("deferred_allocator_reset",
+          [](py::capsule cap) -> int {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              if (!handle) return -1;
+              return static_cast<int>(anvil::memory::deferred_allocator::reset(handle));
+          },
+          py::arg("allocator"), "Release all allocations; the arena stays mapped");
+
+    m.def("deferred_allocator_mapped",
+          [](py::capsule cap) -> bool {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              return handle && anvil::memory::deferred_allocator::mapped(handle);
+          },
+          py::arg("allocator"), "Whether the handle's arena has been mapped");
+
+    m.def("deferred_allocator_stats",
+          [](py::capsule cap) -> py::object {
+              DA* handle = from_capsule<DA>(cap, DEFERRED_TAG);
+              if (!handle) return py::none();
+              return to_stats_dict(anvil::memory::deferred_allocator::stats(handle));
+          },
+          py::arg("allocator"), "Usage statistics of a deferred arena");
+
+    // ========== Native allocator classes ==========
+    using NativeScratchAllocator = NativeAllocator<ScratchOps>;
+    auto scratch_class = py::class_<NativeScratchAllocator>(m, "ScratchAllocator")
+        .def(py::init([](std::size_t capacity, std::size_t alignment, std::size_t mapping_flags) {
+                 return std::make_unique<NativeScratchAllocator>(capacity, alignment, 0, mapping_flags);
+             }),
+             py::arg("capacity"), py::arg("alignment") = anvil::memory::MIN_ALIGNMENT, py::arg("mapping_flags") = 0);
+    bind_native_common<NativeScratchAllocator>(scratch_class);
+
+    auto stack_class = py::class_<NativeStackAllocator>(m, "StackAllocator")
+        .def(py::init<std::size_t, std::size_t, std::size_t, std::size_t>(), py::arg("capacity"),
+             py::arg("alignment")     = anvil::memory::MIN_ALIGNMENT,
+             py::arg("strategy")      = static_cast<std::size_t>(anvil::memory::AllocationStrategy::Eager),
+             py::arg("mapping_flags") = 0)
+        .def("record", &NativeStackAllocator::record, py::arg("budget") = py::none())
+        .def("unwind", &NativeStackAllocator::unwind)
+        .def("alloc_unchecked", &NativeStackAllocator::alloc_unchecked, py::arg("size"),
+             py::arg("alignment") = anvil::memory::MIN_ALIGNMENT,
+             "Bump without a capacity check; pages are committed when first touched (GUARDED only)")
+        .def("set_commit_chunk", &NativeStackAllocator::set_commit_chunk, py::arg("commit_chunk"));
+    bind_native_common<NativeStackAllocator>(stack_class);
+
+    // ========== CapacityAdvisor ==========
+    m.def("capacity_advisor_create",
+          [](size_t window, size_t mode) -> py::capsule {
+              auto* a = anvil::memory::capacity_advisor::create(
+                  window, static_cast<anvil::memory::capacity_advisor::Mode>(mode));
+              return a ? py::capsule(a, ADVISOR_TAG) : py::capsule();
+          },
+          py::arg("window"), py::arg("mode"), "Create a capacity advisor");
+
+    m.def("capacity_advisor_destroy",
+          [](py::capsule cap) -> int {
+              using CA = anvil::memory::capacity_advisor::CapacityAdvisor;
+              CA* a = from_capsule<CA>(cap, ADVISOR_TAG);
+              if (!a) return -1;
+              return static_cast<int>(anvil::memory::capacity_advisor::destroy(&a));
+          },
+          py::arg("advisor"), "Destroy a capacity advisor");
+
+    m.def("capacity_advisor_recommend",
+          [](py::capsule cap) -> py::object {
+              using CA = anvil::memory::capacity_advisor::CapacityAdvisor;
+              CA* a = from_capsule<CA>(cap, ADVISOR_TAG);
+              if (!a) return py::none();
+              const auto r = anvil::memory::capacity_advisor::recommend(a);
+              py::dict d;
+              d["capacity"]     = r.capacity;
+              d["commit_chunk"] = r.commit_chunk;
+              d["reset_p50"]    = r.reset_p50;
+              d["reset_p99"]    = r.reset_p99;
+              d["reset_max"]    = r.reset_max;
+              d["scope_p50"]    = r.scope_p50;
+              d["scope_p99"]    = r.scope_p99;
+              d["observations"] = r.observations;
+              return d;
+          },
+          py::arg("advisor"), "Recommendation derived from the observed peaks");
+
+    // ========== Profiler ==========
+    m.def("profiler_enable",
+          [](size_t sample_rate) { anvil::memory::profiler::enable(sample_rate); },
+          py::arg("sample_rate"), "Start sampling allocation sites");
+
+    m.def("profiler_disable",
+          []() { anvil::memory::profiler::disable(); },
+          "Stop sampling allocation sites");
+
+    m.def("profiler_clear",
+          []() { anvil::memory::profiler::clear(); },
+          "Discard all recorded samples");
+
+    m.def("profiler_sample_count",
+          [](py::object allocator) -> size_t {
+              const void* a = allocator.is_none() ? nullptr : allocator_ptr(allocator.cast<py::capsule>());
+              return anvil::memory::profiler::sample_count(a);
+          },
+          py::arg("allocator") = py::none(), "Number of samples recorded for an allocator (or all)");
+
+    m.def("profiler_dump",
+          [](const std::string& path, py::object allocator) -> int {
+              const void* a = allocator.is_none() ? nullptr : allocator_ptr(allocator.cast<py::capsule>());
+              return static_cast<int>(anvil::memory::profiler::dump(path.c_str(), a));
+          },
+          py::arg("path"), py::arg("allocator") = py::none(),
+          "Write recorded samples as a pprof heap profile");
+
+    // ========== Runtime configuration ==========
+    m.def("config_load",
+          []() -> int { return static_cast<int>(anvil::memory::config::load()); },
+          "Read ANVIL_CONFIG and the ANVIL_* environment once; returns the result of that first read");
+
+    m.def("config_resolve",
+          [](const std::string& name, std::size_t capacity, std::size_t alignment, std::size_t strategy,
+             std::size_t commit_chunk, std::size_t mapping_flags) -> py::dict {
+              check_alignment(alignment);
+              check_mapping_flags(mapping_flags);
+              StackOps::check_strategy(strategy);
+              if (capacity == 0 || commit_chunk == 0) {
+                  throw py::value_error("capacity and commit_chunk must be positive");
+              }
+              const anvil::memory::config::ArenaConfig defaults{
+                  capacity, alignment, static_cast<anvil::memory::AllocationStrategy>(strategy), commit_chunk,
+                  static_cast<anvil::memory::MappingFlags>(mapping_flags)};
+              const anvil::memory::config::ArenaConfig config =
+                  anvil::memory::config::resolve(name.c_str(), defaults);
+              py::dict d;
+              d["capacity"]      = config.capacity;
+              d["alignment"]     = config.alignment;
+              d["strategy"]      = static_cast<std::size_t>(config.strategy);
+              d["commit_chunk"]  = config.commit_chunk;
+              d["mapping_flags"] = static_cast<std::size_t>(config.mapping);
+              return d;
+          },
+          py::arg("name"), py::arg("capacity"), py::arg("alignment") = anvil::memory::MIN_ALIGNMENT,
+          py::arg("strategy")      = static_cast<std::size_t>(anvil::memory::AllocationStrategy::Eager),
+          py::arg("commit_chunk")  = anvil::memory::DEFAULT_COMMIT_CHUNK, py::arg("mapping_flags") = 0,
+          "Creation parameters of the arena `name` after applying the runtime configuration");
+
+    // ========== Registry & metrics ==========
+    m.def("registry_add",
+          [](py::capsule cap, const std::string& name) -> int {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              if (!allocator_ptr(cap)) return -1;
+              if (std::strcmp(cap.name(), SCRATCH_TAG) == 0) {
+                  return static_cast<int>(anvil::memory::registry::add(from_capsule<SA>(cap, SCRATCH_TAG), name.c_str()));
+              }
+              return static_cast<int>(anvil::memory::registry::add(from_capsule<ST>(cap, STACK_TAG), name.c_str()));
+          },
+          py::arg("allocator"), py::arg("name"), "Register (or rename) an allocator for metrics export");
+
+    m.def("registry_remove",
+          [](py::capsule cap) -> int {
+              using SA = anvil::memory::scratch_allocator::ScratchAllocator;
+              using ST = anvil::memory::stack_allocator::StackAllocator;
+              if (!allocator_ptr(cap)) return -1;
+              if (std::strcmp(cap.name(), SCRATCH_TAG) == 0) {
+                  return static_cast<int>(anvil::memory::registry::remove(from_capsule<SA>(cap, SCRATCH_TAG)));
+              }
+              return static_cast<int>(anvil::memory::registry::remove(from_capsule<ST>(cap, STACK_TAG)));
+          },
+          py::arg("allocator"), "Remove an allocator from the registry");
+
+    m.def("registry_size",
+          []() -> size_t { return anvil::memory::registry::size(); },
+          "Number of registered allocators");
+
+    m.def("metrics_render",
+          []() -> std::string {
+              std::string text(anvil::memory::metrics_exporter::render(nullptr, 0), '\0');
+              text.resize(anvil::memory::metrics_exporter::render(text.data(), text.size()));
+              return text;
+          },
+          "Prometheus exposition of the registered allocators");
+
+    m.def("metrics_exporter_start_unix",
+          [](const std::string& path) -> py::capsule {
+              auto* e = anvil::memory::metrics_exporter::start_unix(path.c_str());
+              return e ? py::capsule(e, EXPORTER_TAG) : py::capsule();
+          },
+          py::arg("path"), "Serve metrics on a Unix domain socket");
+
+    m.def("metrics_exporter_start_tcp",
+          [](std::uint16_t port) -> py::capsule {
+              auto* e = anvil::memory::metrics_exporter::start_tcp(port);
+              return e ? py::capsule(e, EXPORTER_TAG) : py::capsule();
+          },
+          py::arg("port") = 0, "Serve metrics on 127.0.0.1:port");
+
+    m.def("metrics_exporter_port",
+          [](py::capsule cap) -> int {
+              using ME = anvil::memory::metrics_exporter::MetricsExporter;
+              ME* e = from_capsule<ME>(cap, EXPORTER_TAG);
+              if (!e) return -1;
+              return static_cast<int>(anvil::memory::metrics_exporter::port(e));
+          },
+          py::arg("exporter"), "TCP port of a metrics exporter");
+
+    m.def("metrics_exporter_stop",
+          [](py::capsule cap) -> int {
+              using ME = anvil::memory::metrics_exporter::MetricsExporter;
+              ME* e = from_capsule<ME>(cap, EXPORTER_TAG);
+              if (!e) return -1;
+              py::gil_scoped_release release;
+              return static_cast<int>(anvil::memory::metrics_exporter::stop(&e));
+          },
+          py::arg("exporter"), "Stop a metrics exporter");
+
     // ========== Helpers ==========
     m.def("read_bytes",
           [](py::capsule cap, size_t size) -> py::bytes {
@@ -0,0 +1,262 @@
+// NumPy data-memory handler (NEP 49) that places array data buffers in an Anvil StackAllocator.
+//
+// Every block carries a 16-byte header recording its size and origin, because NumPy's realloc does not pass
+// the old size and because a block may be freed long after the scope that created it:
+//   Arena    - bump-allocated from the arena; released in bulk when the arena is reset.
+//   Mapped   - arrays of at least `threshold` bytes get a dedicated mapping that is unmapped on free and
+//              resized with mremap, so growing a large array moves page table entries instead of bytes.
+//   Fallback - malloc, used when the arena is exhausted or when no scope is active (e.g. an array that
+//              outlived its scope is resized).
+// The arena is reset when the last scope exits. If arena blocks are still alive at that point the reset is
+// deferred until the last of them is freed, so arrays that outlive the scope stay valid and freeing them is
+// always safe. Arrays hold a reference to the handler capsule, which owns the arena.
+
+#define NPY_NO_DEPRECATED_API NPY_1_22_API_VERSION
+#define NPY_TARGET_VERSION    NPY_1_22_API_VERSION
+
+#include "numpy_handler.hpp"
+#include "internal/memory_allocation.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/stack_allocator.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <numpy/arrayobject.h>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+using ST = anvil::memory::stack_allocator::StackAllocator;
+
+constexpr const char*   HANDLER_TAG   = "mem_handler"; // capsule name required by PyDataMem_SetHandler
+constexpr std::uint32_t BLOCK_MAGIC   = 0x414E564C;    // "ANVL"
+constexpr std::size_t   BLOCK_ALIGN   = 16;            // what NumPy expects from malloc
+constexpr std::size_t   MAPPING_ALIGN = 64;
+
+enum class BlockKind : std::uint32_t { Arena = 1, Mapped = 2, Fallback = 3 };
+
+struct alignas(BLOCK_ALIGN) BlockHeader {
+    std::uint64_t size;
+    BlockKind     kind;
+    std::uint32_t magic;
+};
+static_assert(sizeof(BlockHeader) == BLOCK_ALIGN);
+
+struct ArenaContext {
+    std::mutex    lock;
+    ST*           allocator;
+    std::size_t   threshold;
+    std::size_t   scopes          = 0; // active `with` blocks
+    std::size_t   arena_blocks    = 0; // live blocks per kind
+    std::size_t   mapped_blocks   = 0;
+    std::size_t   fallback_blocks = 0;
+    std::uint64_t resets          = 0;
+};
+
+struct ArenaHandler {
+    PyDataMem_Handler handler;
+    ArenaContext      context;
+};
+
+inline BlockHeader* header_of(void* ptr) {
+    return static_cast<BlockHeader*>(ptr) - 1;
+}
+
+inline void* publish(void* block, std::size_t size, BlockKind kind) {
+    auto* header = static_cast<BlockHeader*>(block);
+    *header      = BlockHeader{size, kind, BLOCK_MAGIC};
+    return header + 1;
+}
+
+// Caller holds `context.lock`.
+inline void reset_if_idle(ArenaContext& context) {
+    if (context.scopes != 0 || context.arena_blocks != 0) return;
+    if (anvil::memory::stack_allocator::stats(context.allocator).allocated == 0) return;
+    if (anvil::memory::stack_allocator::reset(context.allocator) == ERR_SUCCESS) context.resets++;
+}
+
+void* arena_malloc(void* ctx, std::size_t size) {
+    auto&             context = *static_cast<ArenaContext*>(ctx);
+    const std::size_t total   = size + sizeof(BlockHeader);
+    if (total < size) return nullptr;
+
+    if (size >= context.threshold) {
+        void* block = anvil_memory_alloc_eager(total, MAPPING_ALIGN);
+        if (!block) return nullptr;
+        std::lock_guard<std::mutex> guard(context.lock);
+        context.mapped_blocks++;
+        return publish(block, size, BlockKind::Mapped);
+    }
+
+    std::lock_guard<std::mutex> guard(context.lock);
+    if (context.scopes != 0) {
+        if (void* block = anvil::memory::stack_allocator::alloc(context.allocator, total, BLOCK_ALIGN)) {
+            context.arena_blocks++;
+            return publish(block, size, BlockKind::Arena);
+        }
+    }
+    void* block = std::malloc(total);
+    if (!block) return nullptr;
+    context.fallback_blocks++;
+    return publish(block, size, BlockKind::Fallback);
+}
+
+void arena_free(void* ctx, void* ptr, std::size_t) {
+    if (!ptr) return;
+    auto&        context = *static_cast<ArenaContext*>(ctx);
+    BlockHeader* header  = header_of(ptr);
+
+    std::lock_guard<std::mutex> guard(context.lock);
+    switch (header->kind) {
+    case BlockKind::Arena:
+        context.arena_blocks--;
+        reset_if_idle(context);
+        break;
+    case BlockKind::Mapped:
+        context.mapped_blocks--;
+        static_cast<void>(anvil_memory_dealloc(header));
+        break;
+    case BlockKind::Fallback:
+        context.fallback_blocks--;
+        std::free(header);
+        break;
+    }
+}
+
+void* arena_calloc(void* ctx, std::size_t count, std::size_t element_size) {
+    std::size_t size = 0;
+    if (__builtin_mul_overflow(count, element_size, &size)) return nullptr;
+    void* ptr = arena_malloc(ctx, size);
+    // Dedicated mappings are fresh anonymous pages; arena and malloc memory may be recycled.
+    if (ptr && header_of(ptr)->kind != BlockKind::Mapped) std::memset(ptr, 0, size);
+    return ptr;
+}
+
+void* arena_realloc(void* ctx, void* ptr, std::size_t new_size) {
+    if (!ptr) return arena_malloc(ctx, new_size);
+    BlockHeader* header = header_of(ptr);
+    if (header->kind == BlockKind::Mapped && new_size >= static_cast<ArenaContext*>(ctx)->threshold) {
+        if (new_size > SIZE_MAX - sizeof(BlockHeader)) return nullptr;
+        auto* block = static_cast<BlockHeader*>(anvil_memory_realloc(header, new_size + sizeof(BlockHeader)));
+        if (!block) return nullptr;
+        block->size = new_size;
+        return block + 1;
+    }
+    if (header->kind == BlockKind::Fallback && new_size < static_cast<ArenaContext*>(ctx)->threshold) {
+        auto* block = static_cast<BlockHeader*>(std::realloc(header, new_size + sizeof(BlockHeader)));
+        if (!block) return nullptr;
+        block->size = new_size;
+        return block + 1;
+    }
+    void* moved = arena_malloc(ctx, new_size);
+    if (!moved) return nullptr;
+    std::memcpy(moved, ptr, header->size < new_size ? header->size : new_size);
+    arena_free(ctx, ptr, header->size);
+    return moved;
+}
+
+void destroy_handler(PyObject* capsule) {
+    auto* handler = static_cast<ArenaHandler*>(PyCapsule_GetPointer(capsule, HANDLER_TAG));
+    if (!handler) return;
+    static_cast<void>(anvil::memory::stack_allocator::destroy(&handler->context.allocator));
+    delete handler;
+}
+
+void ensure_numpy() {
+    static bool imported = false;
+    if (imported) return;
+    if (_import_array() < 0) throw py::error_already_set();
+    imported = true;
+}
+
+// Python-facing context manager. Entering installs the handler for the current context (NumPy keeps it in a
+// contextvar) and exiting restores the previous one, so scopes nest and are per thread / per task.
+class NumpyArena {
+public:
+    NumpyArena(std::size_t capacity, std::size_t threshold, std::size_t strategy) {
+        ensure_numpy();
+        if (strategy != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Eager) &&
+            strategy != static_cast<std::size_t>(anvil::memory::AllocationStrategy::Lazy)) {
+            throw py::value_error("strategy must be EAGER or LAZY");
+        }
+        ST* allocator = anvil::memory::stack_allocator::create(
+            capacity, BLOCK_ALIGN, static_cast<anvil::memory::AllocationStrategy>(strategy));
+        if (!allocator) throw std::bad_alloc();
+
+        handler_ = new ArenaHandler{};
+        std::snprintf(handler_->handler.name, sizeof(handler_->handler.name), "anvil_arena");
+        handler_->handler.version   = 1;
+        handler_->handler.allocator = PyDataMemAllocator{&handler_->context, arena_malloc, arena_calloc,
+                                                         arena_realloc, arena_free};
+        handler_->context.allocator = allocator;
+        handler_->context.threshold = threshold;
+        capsule_ = py::reinterpret_steal<py::object>(PyCapsule_New(handler_, HANDLER_TAG, destroy_handler));
+        if (!capsule_) {
+            static_cast<void>(anvil::memory::stack_allocator::destroy(&allocator));
+            delete handler_;
+            throw py::error_already_set();
+        }
+    }
+
+    NumpyArena& enter() {
+        PyObject* previous = PyDataMem_SetHandler(capsule_.ptr());
+        if (!previous) throw py::error_already_set();
+        previous_.push_back(py::reinterpret_steal<py::object>(previous));
+        std::lock_guard<std::mutex> guard(handler_->context.lock);
+        handler_->context.scopes++;
+        return *this;
+    }
+
+    void exit(const py::args&) {
+        if (previous_.empty()) throw py::value_error("NumpyArena exited more often than entered");
+        PyObject* ours = PyDataMem_SetHandler(previous_.back().ptr());
+        if (!ours) throw py::error_already_set();
+        Py_DECREF(ours);
+        previous_.pop_back();
+        std::lock_guard<std::mutex> guard(handler_->context.lock);
+        handler_->context.scopes--;
+        reset_if_idle(handler_->context);
+    }
+
+    py::dict stats() {
+        const ArenaContext& context = handler_->context;
+        std::lock_guard<std::mutex> guard(handler_->context.lock);
+        const anvil::memory::AllocatorStats arena = anvil::memory::stack_allocator::stats(context.allocator);
+        py::dict d;
+        d["capacity"]        = arena.capacity;
+        d["allocated"]       = arena.allocated;
+        d["committed"]       = arena.committed;
+        d["peak"]            = arena.peak;
+        d["resets"]          = context.resets;
+        d["arena_arrays"]    = context.arena_blocks;
+        d["mapped_arrays"]   = context.mapped_blocks;
+        d["fallback_arrays"] = context.fallback_blocks;
+        d["pending_reset"]   = context.scopes == 0 && context.arena_blocks != 0;
+        return d;
+    }
+
+    py::object handler() const { return capsule_; }
+
+private:
+    ArenaHandler*           handler_; // owned by capsule_
+    py::object              capsule_;
+    std::vector<py::object> previous_;
+};
+} // namespace
+
+void bind_numpy_handler(py::module_& m) {
+    py::class_<NumpyArena>(m, "NumpyArena",
+                           "Context manager placing NumPy array data in an Anvil arena that is reset on exit")
+        .def(py::init<std::size_t, std::size_t, std::size_t>(), py::arg("capacity"),
+             py::arg("threshold") = std::size_t(1) << 20,
+             py::arg("strategy")  = static_cast<std::size_t>(anvil::memory::AllocationStrategy::Lazy))
+        .def("__enter__", &NumpyArena::enter, py::return_value_policy::reference)
+        .def("__exit__", &NumpyArena::exit)
+        .def("stats", &NumpyArena::stats, "Arena counters and live array counts per block kind")
+        .def_property_readonly("handler", &NumpyArena::handler, "The `mem_handler` capsule given to NumPy");
+}
@@ -0,0 +1,20 @@
+/**
+ * @file numpy_handler.hpp
+ * @brief NumPy data-memory handler (NEP 49) backed by Anvil arenas
+ *
+ * Only compiled when the NumPy headers are found at configure time, in which case
+ * `ANVIL_WITH_NUMPY` is defined for the bindings.
+ */
+
+#ifndef ANVIL_BINDINGS_NUMPY_HANDLER_HPP
+#define ANVIL_BINDINGS_NUMPY_HANDLER_HPP
+#include <pybind11/pybind11.h>
+
+/**
+ * @brief Adds the `NumpyArena` context manager to the bindings module.
+ *
+ * @param[in,out] m    The `anvil_memory` module.
+ */
+void bind_numpy_handler(pybind11::module_& m);
+
+#endif // ANVIL_BINDINGS_NUMPY_HANDLER_HPP
@@ -0,0 +1,295 @@
+// PyMem allocator hook for the RAW, MEM or OBJ domain that serves small requests from size-classed pools.
+//
+// The hook wraps the allocator that was installed before it, the same way tracemalloc does, so it can be
+// installed into a running interpreter: requests above `max_size` and requests made while the arena is
+// exhausted are forwarded to the previous allocator, and so are frees and reallocs of blocks that the
+// previous allocator handed out before the hook was installed.
+//
+// Pools are 16 KiB chunks bump-allocated from one lazy StackAllocator, each dedicated to one size class
+// (multiples of 16 bytes up to `max_size`). Chunks are carved contiguously, so a pointer belongs to the
+// pools exactly when it falls inside [lo, hi) of the carved range, and its chunk index names its class.
+// Freed blocks go onto a per-class free list. The arena is never reset while the hook is installed.
+//
+// Uninstalling stops new requests from reaching the pools; the hook is only removed from the domain once no
+// pooled block is alive and no other hook was installed on top of it. Until then it keeps forwarding.
+
+#include "pymem_allocator.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/stack_allocator.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+using ST = anvil::memory::stack_allocator::StackAllocator;
+
+constexpr std::size_t CLASS_GRANULE = 16; // CPython expects 16-byte aligned blocks on 64-bit targets
+constexpr std::size_t MAX_CLASSES   = 32; // classes up to 512 bytes
+constexpr std::size_t CHUNK_SIZE    = 1 << 14;
+constexpr std::size_t DOMAIN_COUNT  = 3;
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct SizeClass {
+    FreeBlock*    free_list = nullptr;
+    std::uint8_t* cursor    = nullptr; // bump pointer into the class' current chunk
+    std::uint8_t* chunk_end = nullptr;
+};
+
+struct DomainPool {
+    PyMemAllocatorDomain               domain;
+    PyMemAllocatorEx                   previous{};
+    std::mutex                         lock; // only taken for the RAW domain, which may run without the GIL
+    bool                               locked    = false;
+    bool                               installed = false;
+    bool                               enabled   = false;
+    ST*                                arena     = nullptr;
+    std::uintptr_t                     lo        = 0;
+    std::uintptr_t                     hi        = 0;
+    std::size_t                        max_size  = 0;
+    std::vector<std::uint8_t>          chunk_class;
+    std::array<SizeClass, MAX_CLASSES> classes{};
+    std::size_t                        live_blocks      = 0;
+    std::size_t                        pooled_allocs    = 0;
+    std::size_t                        forwarded_allocs = 0;
+};
+
+// Never destroyed: the interpreter may still free pooled blocks while static destructors run.
+std::array<DomainPool, DOMAIN_COUNT>& pools() {
+    static auto* domains = new std::array<DomainPool, DOMAIN_COUNT>();
+    return *domains;
+}
+
+inline std::size_t class_of(std::size_t size) {
+    return size == 0 ? 0 : (size - 1) / CLASS_GRANULE;
+}
+
+inline std::size_t class_size(std::size_t cls) {
+    return (cls + 1) * CLASS_GRANULE;
+}
+
+inline bool owns(const DomainPool& pool, const void* ptr) {
+    const auto address = reinterpret_cast<std::uintptr_t>(ptr);
+    return address >= pool.lo && address < pool.hi;
+}
+
+inline std::size_t owner_class(const DomainPool& pool, const void* ptr) {
+    return pool.chunk_class[(reinterpret_cast<std::uintptr_t>(ptr) - pool.lo) / CHUNK_SIZE];
+}
+
+inline std::unique_lock<std::mutex> guard(DomainPool& pool) {
+    return pool.locked ? std::unique_lock<std::mutex>(pool.lock) : std::unique_lock<std::mutex>();
+}
+
+// Caller holds the pool guard. Returns nullptr when the request must be forwarded.
+void* pool_alloc(DomainPool& pool, std::size_t size) {
+    if (!pool.enabled || size > pool.max_size) return nullptr;
+    const std::size_t cls   = class_of(size);
+    SizeClass&        klass = pool.classes[cls];
+
+    if (FreeBlock* block = klass.free_list) {
+        klass.free_list = block->next;
+        pool.live_blocks++;
+        pool.pooled_allocs++;
+        return block;
+    }
+    if (klass.cursor == klass.chunk_end) {
+        auto* chunk = static_cast<std::uint8_t*>(anvil::memory::stack_allocator::alloc(pool.arena, CHUNK_SIZE,
+                                                                                       CLASS_GRANULE));
+        if (!chunk) return nullptr;
+        const auto address = reinterpret_cast<std::uintptr_t>(chunk);
+        if (pool.lo == 0) pool.lo = pool.hi = address;
+        if (address != pool.hi) return nullptr; // ownership relies on a contiguous carve; never expected
+        pool.chunk_class[(address - pool.lo) / CHUNK_SIZE] = static_cast<std::uint8_t>(cls);
+        pool.hi += CHUNK_SIZE;
+        klass.cursor    = chunk;
+        klass.chunk_end = chunk + CHUNK_SIZE / class_size(cls) * class_size(cls);
+    }
+    void* block = klass.cursor;
+    klass.cursor += class_size(cls);
+    pool.live_blocks++;
+    pool.pooled_allocs++;
+    return block;
+}
+
+// Caller holds the pool guard.
+void pool_free(DomainPool& pool, void* ptr) {
+    SizeClass& klass = pool.classes[owner_class(pool, ptr)];
+    auto*      block = static_cast<FreeBlock*>(ptr);
+    block->next      = klass.free_list;
+    klass.free_list  = block;
+    pool.live_blocks--;
+}
+
+void* hook_malloc(void* ctx, std::size_t size) {
+    auto& pool = *static_cast<DomainPool*>(ctx);
+    {
+        auto lock = guard(pool);
+        if (void* ptr = pool_alloc(pool, size)) return ptr;
+        pool.forwarded_allocs++;
+    }
+    return pool.previous.malloc(pool.previous.ctx, size);
+}
+
+void* hook_calloc(void* ctx, std::size_t count, std::size_t element_size) {
+    auto&       pool = *static_cast<DomainPool*>(ctx);
+    std::size_t size = 0;
+    if (__builtin_mul_overflow(count, element_size, &size)) return nullptr;
+    {
+        auto lock = guard(pool);
+        if (void* ptr = pool_alloc(pool, size)) {
+            std::memset(ptr, 0, size);
+            return ptr;
+        }
+        pool.forwarded_allocs++;
+    }
+    return pool.previous.calloc(pool.previous.ctx, count, element_size);
+}
+
+void* hook_realloc(void* ctx, void* ptr, std::size_t new_size) {
+    auto&       pool     = *static_cast<DomainPool*>(ctx);
+    std::size_t old_size = 0;
+    {
+        auto lock = guard(pool);
+        if (owns(pool, ptr)) old_size = class_size(owner_class(pool, ptr));
+    }
+    if (old_size == 0) {
+        if (ptr) return pool.previous.realloc(pool.previous.ctx, ptr, new_size);
+        return hook_malloc(ctx, new_size);
+    }
+    // Keep the block unless it would waste more than half of its class.
+    if (new_size <= old_size && (new_size > old_size / 2 || old_size == CLASS_GRANULE)) return ptr;
+
+    void* moved = hook_malloc(ctx, new_size);
+    if (!moved) return nullptr;
+    std::memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    auto lock = guard(pool);
+    pool_free(pool, ptr);
+    return moved;
+}
+
+void hook_free(void* ctx, void* ptr) {
+    auto& pool = *static_cast<DomainPool*>(ctx);
+    {
+        auto lock = guard(pool);
+        if (owns(pool, ptr)) {
+            pool_free(pool, ptr);
+            return;
+        }
+    }
+    pool.previous.free(pool.previous.ctx, ptr);
+}
+
+DomainPool& pool_for(int domain) {
+    if (domain != PYMEM_DOMAIN_RAW && domain != PYMEM_DOMAIN_MEM && domain != PYMEM_DOMAIN_OBJ) {
+        throw py::value_error("domain must be PYMEM_DOMAIN_RAW, PYMEM_DOMAIN_MEM or PYMEM_DOMAIN_OBJ");
+    }
+    DomainPool& pool = pools()[static_cast<std::size_t>(domain)];
+    pool.domain      = static_cast<PyMemAllocatorDomain>(domain);
+    pool.locked      = domain == PYMEM_DOMAIN_RAW;
+    return pool;
+}
+
+inline bool hook_is_current(const DomainPool& pool) {
+    PyMemAllocatorEx current{};
+    PyMem_GetAllocator(pool.domain, &current);
+    return current.ctx == &pool && current.malloc == hook_malloc;
+}
+
+int install(int domain, std::size_t capacity, std::size_t max_size) {
+    DomainPool& pool = pool_for(domain);
+    if (max_size == 0 || max_size > MAX_CLASSES * CLASS_GRANULE) {
+        throw py::value_error("max_size must be in [1, 512]");
+    }
+    if (pool.installed) {
+        // Re-enabling a draining hook keeps its pools and the blocks still alive in them.
+        auto lock     = guard(pool);
+        pool.max_size = max_size;
+        pool.enabled  = true;
+        return static_cast<int>(ERR_SUCCESS);
+    }
+
+    using anvil::memory::AllocationStrategy;
+    ST* arena = anvil::memory::stack_allocator::create(capacity, CLASS_GRANULE, AllocationStrategy::Lazy);
+    if (!arena) return static_cast<int>(ERR_OUT_OF_MEMORY);
+    pool.arena    = arena;
+    pool.lo       = 0;
+    pool.hi       = 0;
+    pool.max_size = max_size;
+    pool.classes  = {};
+    pool.chunk_class.assign(capacity / CHUNK_SIZE + 1, 0);
+    pool.live_blocks = pool.pooled_allocs = pool.forwarded_allocs = 0;
+
+    PyMem_GetAllocator(pool.domain, &pool.previous);
+    PyMemAllocatorEx hook{&pool, hook_malloc, hook_calloc, hook_realloc, hook_free};
+    pool.enabled   = true;
+    pool.installed = true;
+    PyMem_SetAllocator(pool.domain, &hook);
+    return static_cast<int>(ERR_SUCCESS);
+}
+
+bool uninstall(int domain) {
+    DomainPool& pool = pool_for(domain);
+    if (!pool.installed) return true;
+    {
+        auto lock    = guard(pool);
+        pool.enabled = false;
+        if (pool.live_blocks != 0 || !hook_is_current(pool)) return false;
+    }
+    PyMem_SetAllocator(pool.domain, &pool.previous);
+    pool.installed = false;
+    pool.lo = pool.hi = 0;
+    pool.chunk_class.clear();
+    pool.chunk_class.shrink_to_fit();
+    static_cast<void>(anvil::memory::stack_allocator::destroy(&pool.arena));
+    return true;
+}
+
+py::dict stats(int domain) {
+    DomainPool& pool = pool_for(domain);
+    // Snapshot under the guard: building the dict allocates, which may re-enter a RAW hook.
+    std::size_t                   live = 0, pooled = 0, forwarded = 0, chunks = 0;
+    bool                          installed = false, enabled = false;
+    anvil::memory::AllocatorStats arena{};
+    {
+        auto lock = guard(pool);
+        installed = pool.installed;
+        enabled   = pool.enabled;
+        live      = pool.live_blocks;
+        pooled    = pool.pooled_allocs;
+        forwarded = pool.forwarded_allocs;
+        chunks    = (pool.hi - pool.lo) / CHUNK_SIZE;
+        if (pool.arena) arena = anvil::memory::stack_allocator::stats(pool.arena);
+    }
+    py::dict d;
+    d["installed"]        = installed;
+    d["enabled"]          = enabled;
+    d["live_blocks"]      = live;
+    d["pooled_allocs"]    = pooled;
+    d["forwarded_allocs"] = forwarded;
+    d["chunks"]           = chunks;
+    d["allocated"]        = arena.allocated;
+    d["committed"]        = arena.committed;
+    return d;
+}
+} // namespace
+
+void bind_pymem_allocator(py::module_& m) {
+    m.attr("PYMEM_DOMAIN_RAW") = py::int_(static_cast<int>(PYMEM_DOMAIN_RAW));
+    m.attr("PYMEM_DOMAIN_MEM") = py::int_(static_cast<int>(PYMEM_DOMAIN_MEM));
+    m.attr("PYMEM_DOMAIN_OBJ") = py::int_(static_cast<int>(PYMEM_DOMAIN_OBJ));
+
+    m.def("pymem_install", &install, py::arg("domain"), py::arg("capacity") = std::size_t(1) << 30,
+          py::arg("max_size") = MAX_CLASSES * CLASS_GRANULE,
+          "Serve requests of at most max_size bytes in a PyMem domain from Anvil pools");
+    m.def("pymem_uninstall", &uninstall, py::arg("domain"),
+          "Stop pooling; returns True once the hook is removed, False while pooled blocks are still alive");
+    m.def("pymem_stats", &stats, py::arg("domain"));
+}
@@ -0,0 +1,17 @@
+/**
+ * @file pymem_allocator.hpp
+ * @brief CPython PyMem allocator hook backed by size-classed Anvil pools
+ */
+
+#ifndef ANVIL_BINDINGS_PYMEM_ALLOCATOR_HPP
+#define ANVIL_BINDINGS_PYMEM_ALLOCATOR_HPP
+#include <pybind11/pybind11.h>
+
+/**
+ * @brief Adds `pymem_install`, `pymem_uninstall` and `pymem_stats` to the bindings module.
+ *
+ * @param[in,out] m    The `anvil_memory` module.
+ */
+void bind_pymem_allocator(pybind11::module_& m);
+
+#endif // ANVIL_BINDINGS_PYMEM_ALLOCATOR_HPP
@@ -0,0 +1,157 @@
+#include "memory/capacity_advisor.hpp"
+#include "internal/memory_allocation.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <algorithm>
+#include <bit>
+#include <unistd.h>
+
+namespace anvil::memory::capacity_advisor {
+
+namespace {
+
+constexpr size_t MAX_COMMIT_CHUNK = 2 * 1024 * 1024; // one transparent huge page.
+
+} // namespace
+
+/**
+ * @brief Internal representation of a capacity advisor.
+ *
+ * Memory layout: [CapacityAdvisor][reset window][scope window][workspace]
+ *
+ * @invariant window > 0
+ * @invariant reset_head < window && scope_head < window
+ * @invariant reset_size <= window && scope_size <= window
+ *
+ * Field          | Type    | Description
+ * -------------- | ------- | ------------------------------------------------------------
+ * window         | size_t  | Capacity of each ring buffer
+ * mode           | Mode    | Advisory or adaptive
+ * page_size      | size_t  | System page size used to round recommendations
+ * reset_head     | size_t  | Next slot written in the reset ring buffer
+ * reset_size     | size_t  | Number of valid observations in the reset ring buffer
+ * scope_head     | size_t  | Next slot written in the scope ring buffer
+ * scope_size     | size_t  | Number of valid observations in the scope ring buffer
+ * reset_marks    | size_t* | Ring buffer of per-reset high-water marks
+ * scope_marks    | size_t* | Ring buffer of per-scope high-water marks
+ * workspace      | size_t* | Scratch space for percentile selection
+ */
+struct CapacityAdvisor {
+        size_t  window;
+        Mode    mode;
+        size_t  page_size;
+        size_t  reset_head;
+        size_t  reset_size;
+        size_t  scope_head;
+        size_t  scope_size;
+        size_t* reset_marks;
+        size_t* scope_marks;
+        size_t* workspace;
+};
+static_assert(sizeof(Mode) == sizeof(std::size_t), "Mode must match size_t size");
+static_assert(alignof(CapacityAdvisor) == alignof(void*), "CapacityAdvisor alignment must match void* alignment");
+
+namespace {
+
+size_t percentile(CapacityAdvisor* const advisor, const size_t* values, const size_t count, const size_t per_mille) {
+        if (count == 0) {
+                return 0;
+        }
+        std::copy(values, values + count, advisor->workspace);
+        const size_t rank = std::min(count - 1, (count * per_mille + 999) / 1000 - 1);
+        std::nth_element(advisor->workspace, advisor->workspace + rank, advisor->workspace + count);
+        return advisor->workspace[rank];
+}
+
+} // namespace
+
+CapacityAdvisor* create(const size_t window, const Mode mode) {
+        ANVIL_INVARIANT_POSITIVE(window);
+        ANVIL_INVARIANT((mode == Mode::Advisory) || (mode == Mode::Adaptive), INV_PRECONDITION,
+                        "advisor mode, not advisory nor adaptive, but was %zu", static_cast<size_t>(mode));
+
+        const size_t     total_memory_needed = sizeof(CapacityAdvisor) + 3 * window * sizeof(size_t);
+        CapacityAdvisor* advisor =
+            static_cast<CapacityAdvisor*>(anvil_memory_alloc_eager(total_memory_needed, alignof(CapacityAdvisor)));
+        if (!advisor) {
+                return nullptr;
+        }
+
+        advisor->window      = window;
+        advisor->mode        = mode;
+        advisor->page_size   = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        advisor->reset_head  = 0;
+        advisor->reset_size  = 0;
+        advisor->scope_head  = 0;
+        advisor->scope_size  = 0;
+        advisor->reset_marks = reinterpret_cast<size_t*>(advisor + 1);
+        advisor->scope_marks = advisor->reset_marks + window;
+        advisor->workspace   = advisor->scope_marks + window;
+
+        return advisor;
+}
+
+Error destroy(CapacityAdvisor** advisor) {
+        ANVIL_INVARIANT_NOT_NULL(advisor);
+        ANVIL_INVARIANT_NOT_NULL(*advisor);
+
+        const Error dealloc_result = anvil_memory_dealloc(*advisor);
+        if (::anvil::error::is_error(dealloc_result)) [[unlikely]] {
+                return dealloc_result;
+        }
+        *advisor = nullptr;
+
+        return ERR_SUCCESS;
+}
+
+void observe_reset(CapacityAdvisor* const advisor, const size_t high_water) {
+        ANVIL_INVARIANT_NOT_NULL(advisor);
+
+        advisor->reset_marks[advisor->reset_head] = high_water;
+        advisor->reset_head                       = (advisor->reset_head + 1) % advisor->window;
+        advisor->reset_size                       = std::min(advisor->reset_size + 1, advisor->window);
+}
+
+void observe_scope(CapacityAdvisor* const advisor, const size_t high_water) {
+        ANVIL_INVARIANT_NOT_NULL(advisor);
+
+        advisor->scope_marks[advisor->scope_head] = high_water;
+        advisor->scope_head                       = (advisor->scope_head + 1) % advisor->window;
+        advisor->scope_size                       = std::min(advisor->scope_size + 1, advisor->window);
+}
+
+Recommendation recommend(CapacityAdvisor* const advisor) {
+        ANVIL_INVARIANT_NOT_NULL(advisor);
+
+        Recommendation recommendation{};
+        if (advisor->reset_size == 0) {
+                return recommendation;
+        }
+
+        const size_t page_size      = advisor->page_size;
+        recommendation.observations = advisor->reset_size;
+        recommendation.reset_p50    = percentile(advisor, advisor->reset_marks, advisor->reset_size, 500);
+        recommendation.reset_p99    = percentile(advisor, advisor->reset_marks, advisor->reset_size, 990);
+        recommendation.reset_max = *std::max_element(advisor->reset_marks, advisor->reset_marks + advisor->reset_size);
+        recommendation.scope_p50 = percentile(advisor, advisor->scope_marks, advisor->scope_size, 500);
+        recommendation.scope_p99 = percentile(advisor, advisor->scope_marks, advisor->scope_size, 990);
+
+        // Headroom absorbs growth between observations; the 1% beyond p99 is expected to hit the slow path.
+        const size_t headroom       = recommendation.reset_p99 + recommendation.reset_p99 / 4;
+        recommendation.capacity     = std::max(page_size, (headroom + (page_size - 1)) & ~(page_size - 1));
+
+        // Committing a typical scope at once keeps most scopes to a single commit. Without scopes the
+        // typical frame is committed in eight steps.
+        const size_t typical = advisor->scope_size ? recommendation.scope_p50 : recommendation.reset_p50 / 8;
+        const size_t chunk   = std::bit_ceil(std::max<size_t>(typical, 1));
+        recommendation.commit_chunk = std::clamp(chunk, page_size, MAX_COMMIT_CHUNK);
+
+        return recommendation;
+}
+
+Mode mode(const CapacityAdvisor* const advisor) {
+        ANVIL_INVARIANT_NOT_NULL(advisor);
+        return advisor->mode;
+}
+
+} // namespace anvil::memory::capacity_advisor
@@ -0,0 +1,359 @@
+#include "memory/config.hpp"
+#include "internal/utility.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/registry.hpp"
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using std::size_t;
+
+namespace anvil::memory::config {
+
+namespace {
+
+enum Field : size_t {
+        FIELD_CAPACITY     = 1u << 0,
+        FIELD_ALIGNMENT    = 1u << 1,
+        FIELD_STRATEGY     = 1u << 2,
+        FIELD_COMMIT_CHUNK = 1u << 3,
+        FIELD_MAPPING      = 1u << 4,
+};
+
+/**
+ * @brief Values set by one source for one scope; `fields` holds the FIELD_* bits of the values present.
+ */
+struct Overrides {
+        size_t      fields = 0;
+        ArenaConfig values{};
+};
+
+/**
+ * @brief Everything one source (file or environment) sets, keyed by normalized arena name.
+ */
+struct Layer {
+        Overrides                                      global;
+        std::vector<std::pair<std::string, Overrides>> arenas;
+};
+
+constexpr std::string_view ENV_PREFIX       = "ANVIL_";
+constexpr std::string_view ENV_ARENA_PREFIX = "ANVIL_ARENA_";
+constexpr std::string_view KEYS[]           = {"capacity", "alignment", "strategy", "commit_chunk", "mapping"};
+
+// Written once under `loaded`, read-only afterwards.
+std::once_flag             loaded;
+Layer                      file_layer;
+Layer                      env_layer;
+Error                      status = ERR_SUCCESS;
+
+std::string                normalize(const std::string_view name) {
+        std::string result(name);
+        for (char& c : result) {
+                const unsigned char u = static_cast<unsigned char>(c);
+                c                     = std::isalnum(u) ? static_cast<char>(std::toupper(u)) : '_';
+        }
+        return result;
+}
+
+std::string lower(const std::string_view text) {
+        std::string result(text);
+        for (char& c : result) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return result;
+}
+
+std::string_view trim(std::string_view text) {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+                text.remove_prefix(1);
+        }
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+                text.remove_suffix(1);
+        }
+        return text;
+}
+
+/**
+ * @brief Parses a positive byte count with an optional K, M or G suffix.
+ */
+bool parse_size(std::string_view text, size_t& out) {
+        size_t shift = 0;
+        if (!text.empty()) {
+                switch (std::toupper(static_cast<unsigned char>(text.back()))) {
+                case 'K': shift = 10; break;
+                case 'M': shift = 20; break;
+                case 'G': shift = 30; break;
+                default: break;
+                }
+        }
+        if (shift != 0) {
+                text.remove_suffix(1);
+        }
+        if (text.empty()) {
+                return false;
+        }
+
+        size_t value = 0;
+        for (const char c : text) {
+                if (c < '0' || c > '9' || value > (SIZE_MAX - 9) / 10) {
+                        return false;
+                }
+                value = value * 10 + static_cast<size_t>(c - '0');
+        }
+        if (value == 0 || value > (SIZE_MAX >> shift)) {
+                return false;
+        }
+        out = value << shift;
+        return true;
+}
+
+bool parse_strategy(const std::string_view text, AllocationStrategy& out) {
+        const std::string value = lower(text);
+        if (value == "eager") {
+                out = AllocationStrategy::Eager;
+        } else if (value == "lazy") {
+                out = AllocationStrategy::Lazy;
+        } else if (value == "guarded") {
+                out = AllocationStrategy::Guarded;
+        } else {
+                return false;
+        }
+        return true;
+}
+
+bool parse_mapping(const std::string_view text, MappingFlags& out) {
+        const std::string value = lower(text);
+        MappingFlags      flags = MappingFlags::None;
+        size_t            start = 0;
+        while (start <= value.size()) {
+                size_t end = value.find_first_of(",|", start);
+                end        = end == std::string::npos ? value.size() : end;
+                const std::string_view flag = trim(std::string_view(value).substr(start, end - start));
+                if (flag == "dontfork") {
+                        flags = flags | MappingFlags::DontFork;
+                } else if (flag == "wipeonfork") {
+                        flags = flags | MappingFlags::WipeOnFork;
+                } else if (flag == "dontdump") {
+                        flags = flags | MappingFlags::DontDump;
+                } else if (flag != "none") {
+                        return false;
+                }
+                start = end + 1;
+        }
+        out = flags;
+        return true;
+}
+
+/**
+ * @brief Stores `key = value` in `overrides`; returns false for an unknown key or a malformed value.
+ */
+bool set(Overrides& overrides, const std::string_view key, const std::string_view value) {
+        ArenaConfig& v         = overrides.values;
+        size_t       alignment = 0;
+        if (key == "capacity" && parse_size(value, v.capacity)) {
+                overrides.fields |= FIELD_CAPACITY;
+        } else if (key == "alignment" && parse_size(value, alignment) && is_power_of_two(alignment) &&
+                   alignment >= MIN_ALIGNMENT && alignment <= MAX_ALIGNMENT) {
+                // Validated before it is stored, so a malformed value cannot replace an earlier valid one.
+                v.alignment       = alignment;
+                overrides.fields |= FIELD_ALIGNMENT;
+        } else if (key == "strategy" && parse_strategy(value, v.strategy)) {
+                overrides.fields |= FIELD_STRATEGY;
+        } else if (key == "commit_chunk" && parse_size(value, v.commit_chunk)) {
+                overrides.fields |= FIELD_COMMIT_CHUNK;
+        } else if (key == "mapping" && parse_mapping(value, v.mapping)) {
+                overrides.fields |= FIELD_MAPPING;
+        } else {
+                return false;
+        }
+        return true;
+}
+
+Overrides& arena(Layer& layer, const std::string& name) {
+        for (auto& [arena_name, overrides] : layer.arenas) {
+                if (arena_name == name) {
+                        return overrides;
+                }
+        }
+        layer.arenas.emplace_back(name, Overrides{});
+        return layer.arenas.back().second;
+}
+
+const Overrides* find(const Layer& layer, const std::string& name) {
+        for (const auto& [arena_name, overrides] : layer.arenas) {
+                if (arena_name == name) {
+                        return &overrides;
+                }
+        }
+        return nullptr;
+}
+
+void reject() {
+        if (status == ERR_SUCCESS) {
+                status = ERR_INVALID_CONFIG;
+        }
+}
+
+void read_file(const char* path) {
+        std::ifstream in(path);
+        if (!in) {
+                status = ERR_IO_FAILURE;
+                return;
+        }
+
+        Overrides*  scope = &file_layer.global;
+        std::string line;
+        while (std::getline(in, line)) {
+                std::string_view text = line;
+                text                  = trim(text.substr(0, text.find('#')));
+                if (text.empty()) {
+                        continue;
+                }
+                if (text.front() == '[') {
+                        if (text.back() != ']' || text.size() < 3) {
+                                reject();
+                                continue;
+                        }
+                        scope = &arena(file_layer, normalize(trim(text.substr(1, text.size() - 2))));
+                        continue;
+                }
+                const size_t equals = text.find('=');
+                if (equals == std::string_view::npos ||
+                    !set(*scope, lower(trim(text.substr(0, equals))), trim(text.substr(equals + 1)))) {
+                        reject();
+                }
+        }
+}
+
+void read_environment() {
+        for (char** entry = environ; *entry; ++entry) {
+                const std::string_view variable = *entry;
+                const size_t           equals   = variable.find('=');
+                if (equals == std::string_view::npos || variable.substr(0, ENV_PREFIX.size()) != ENV_PREFIX) {
+                        continue;
+                }
+                const std::string_view name  = variable.substr(0, equals);
+                const std::string_view value = variable.substr(equals + 1);
+
+                if (name.substr(0, ENV_ARENA_PREFIX.size()) == ENV_ARENA_PREFIX) {
+                        // ANVIL_ARENA_<NAME>_<KEY>: the key is the longest known suffix, the rest is the name,
+                        // normalized like the names it is compared with.
+                        const std::string_view rest = name.substr(ENV_ARENA_PREFIX.size());
+                        std::string_view       match;
+                        size_t                 match_length = 0;
+                        for (const std::string_view key : KEYS) {
+                                const std::string suffix = "_" + normalize(key);
+                                if (suffix.size() > match_length && rest.size() > suffix.size() &&
+                                    rest.substr(rest.size() - suffix.size()) == suffix) {
+                                        match        = key;
+                                        match_length = suffix.size();
+                                }
+                        }
+                        if (match_length == 0) {
+                                reject();
+                                continue;
+                        }
+                        const std::string arena_name = normalize(rest.substr(0, rest.size() - match_length));
+                        if (!set(arena(env_layer, arena_name), match, value)) {
+                                reject();
+                        }
+                        continue;
+                }
+
+                // Other ANVIL_ variables, ANVIL_CONFIG included, belong to someone else and are left alone.
+                const std::string key = lower(name.substr(ENV_PREFIX.size()));
+                for (const std::string_view known : KEYS) {
+                        if (key == known && !set(env_layer.global, key, value)) {
+                                reject();
+                        }
+                }
+        }
+}
+
+void read() {
+        if (const char* path = std::getenv("ANVIL_CONFIG"); path && *path) {
+                read_file(path);
+        }
+        read_environment();
+}
+
+void apply(const Overrides* overrides, ArenaConfig& config) {
+        if (!overrides) {
+                return;
+        }
+        const ArenaConfig& v = overrides->values;
+        if (overrides->fields & FIELD_CAPACITY) {
+                config.capacity = v.capacity;
+        }
+        if (overrides->fields & FIELD_ALIGNMENT) {
+                config.alignment = v.alignment;
+        }
+        if (overrides->fields & FIELD_STRATEGY) {
+                config.strategy = v.strategy;
+        }
+        if (overrides->fields & FIELD_COMMIT_CHUNK) {
+                config.commit_chunk = v.commit_chunk;
+        }
+        if (overrides->fields & FIELD_MAPPING) {
+                config.mapping = v.mapping;
+        }
+}
+
+} // namespace
+
+Error load() {
+        std::call_once(loaded, read);
+        return status;
+}
+
+ArenaConfig resolve(const char* name, const ArenaConfig& defaults) {
+        ANVIL_INVARIANT_NOT_NULL(name);
+
+        static_cast<void>(load());
+        const std::string key    = normalize(name);
+        ArenaConfig       result = defaults;
+        apply(&file_layer.global, result);
+        apply(find(file_layer, key), result);
+        apply(&env_layer.global, result);
+        apply(find(env_layer, key), result);
+
+        return result;
+}
+
+scratch_allocator::ScratchAllocator* create_scratch(const char* name, const ArenaConfig& defaults) {
+        const ArenaConfig                    config = resolve(name, defaults);
+
+        scratch_allocator::ScratchAllocator* allocator =
+            scratch_allocator::create(config.capacity, config.alignment, config.mapping);
+        if (!allocator) {
+                return nullptr;
+        }
+        static_cast<void>(registry::add(allocator, name));
+
+        return allocator;
+}
+
+stack_allocator::StackAllocator* create_stack(const char* name, const ArenaConfig& defaults) {
+        const ArenaConfig                config = resolve(name, defaults);
+
+        stack_allocator::StackAllocator* allocator =
+            stack_allocator::create(config.capacity, config.alignment, config.strategy, config.mapping);
+        if (!allocator) {
+                return nullptr;
+        }
+        if (config.strategy != AllocationStrategy::Eager) {
+                static_cast<void>(stack_allocator::set_commit_chunk(allocator, config.commit_chunk));
+        }
+        static_cast<void>(registry::add(allocator, name));
+
+        return allocator;
+}
+
+} // namespace anvil::memory::config
@@ -0,0 +1,155 @@
+#include "memory/deferred_allocator.hpp"
+#include "internal/memory_allocation.hpp"
+#include "internal/profiler.hpp"
+#include "internal/utility.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+
+namespace anvil::memory::deferred_allocator {
+
+static_assert(sizeof(DeferredAllocator) == 64, "DeferredAllocator size must be 64 bytes");
+
+namespace {
+
+/**
+ * @brief Maps the arena of an unmapped handle and applies its mapping flags.
+ */
+ANVIL_ATTR_COLD Error map(DeferredAllocator* const handle) {
+        const MappingFlags mapping = handle->mapping;
+        void* const        memory  = anvil_memory_alloc_eager(handle->capacity + anvil_memory_arena_padding(mapping),
+                                                              handle->alignment);
+        if (!memory) {
+                return ERR_OUT_OF_MEMORY;
+        }
+        const size_t offset = anvil_memory_arena_offset(memory, 0, mapping);
+        if (mapping != MappingFlags::None) {
+                const Error advise_result = anvil_memory_set_mapping_flags(memory, offset, mapping);
+                if (::anvil::error::is_error(advise_result)) [[unlikely]] {
+                        ANVIL_INVARIANT(anvil_memory_dealloc(memory) == ERR_SUCCESS, INV_INVALID_STATE,
+                                        "Failed to Deallocate memory");
+                        return advise_result;
+                }
+        }
+
+        handle->base   = reinterpret_cast<uintptr_t>(memory) + offset;
+        handle->offset = static_cast<uint32_t>(offset);
+        handle->limit  = handle->capacity;
+        return ERR_SUCCESS;
+}
+
+ANVIL_ATTR_ALWAYS_INLINE inline AllocResult bump(DeferredAllocator* const handle, const size_t allocation_size,
+                                                 const size_t alignment);
+
+/**
+ * @brief Slow path of `alloc` and `try_alloc`, taken when an allocation does not fit below `limit`.
+ *
+ * An unmapped handle has a zero limit, so its first allocation always ends up here: the arena is mapped and
+ * the allocation retried, unless it cannot fit even in an empty arena. Allocations that do not fit are counted
+ * as exhaustion.
+ */
+ANVIL_ATTR_COLD ANVIL_ATTR_NOINLINE AllocResult alloc_slow(DeferredAllocator* const handle,
+                                                           const size_t allocation_size, const size_t alignment) {
+        // The alignment padding is only known once mapped, so an allocation it alone pushes over still maps.
+        if (handle->base == 0 && allocation_size <= handle->capacity) {
+                const Error map_result = map(handle);
+                if (map_result != ERR_SUCCESS) {
+                        return {nullptr, map_result};
+                }
+                return bump(handle, allocation_size, alignment);
+        }
+
+        handle->exhaustion_count++;
+        return {nullptr, ERR_OUT_OF_MEMORY};
+}
+
+/**
+ * @brief Body shared by `alloc` and `try_alloc`; inlined into both so neither pays for the other.
+ */
+ANVIL_ATTR_ALWAYS_INLINE inline AllocResult bump(DeferredAllocator* const handle, const size_t allocation_size,
+                                                 const size_t alignment) {
+        ANVIL_INVARIANT_NOT_NULL(handle);
+        ANVIL_INVARIANT_POSITIVE(allocation_size);
+        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
+        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
+
+        const uintptr_t current_addr     = handle->base + handle->allocated;
+        const uintptr_t aligned_addr     = (current_addr + (alignment - 1)) & ~(alignment - 1);
+        const size_t    offset           = aligned_addr - current_addr;
+
+        const size_t    total_allocation = allocation_size + offset;
+
+        if (total_allocation > handle->limit - handle->allocated) [[unlikely]] {
+                return alloc_slow(handle, allocation_size, alignment);
+        }
+
+        handle->allocated += total_allocation;
+        profiler::internal::account(handle, allocation_size);
+        return {reinterpret_cast<void*>(aligned_addr), ERR_SUCCESS};
+}
+
+} // namespace
+
+DeferredAllocator create(const size_t capacity, const size_t alignment, const MappingFlags mapping) {
+        ANVIL_INVARIANT_POSITIVE(capacity);
+        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
+        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
+        ANVIL_INVARIANT((static_cast<size_t>(mapping) & ~MAPPING_FLAGS_MASK) == 0, INV_OUT_OF_RANGE,
+                        "unknown mapping flags %zu", static_cast<size_t>(mapping));
+
+        return DeferredAllocator{0, 0, 0, capacity, static_cast<uint32_t>(alignment), 0, mapping, 0, 0};
+}
+
+Error destroy(DeferredAllocator* const handle) {
+        ANVIL_INVARIANT_NOT_NULL(handle);
+
+        if (handle->base != 0) {
+                void* const memory         = reinterpret_cast<void*>(handle->base - handle->offset);
+                const Error dealloc_result = anvil_memory_dealloc(memory);
+                if (::anvil::error::is_error(dealloc_result)) [[unlikely]] {
+                        return dealloc_result;
+                }
+        }
+        handle->base      = 0;
+        handle->allocated = 0;
+        handle->limit     = 0;
+
+        return ERR_SUCCESS;
+}
+
+void* alloc(DeferredAllocator* const handle, const size_t allocation_size, const size_t alignment) {
+        return bump(handle, allocation_size, alignment).ptr;
+}
+
+AllocResult try_alloc(DeferredAllocator* const handle, const size_t allocation_size, const size_t alignment) {
+        return bump(handle, allocation_size, alignment);
+}
+
+Error reset(DeferredAllocator* const handle) {
+        ANVIL_INVARIANT_NOT_NULL(handle);
+
+        handle->reset_count++;
+        handle->allocated = 0;
+
+        return ERR_SUCCESS;
+}
+
+bool mapped(const DeferredAllocator* const handle) {
+        ANVIL_INVARIANT_NOT_NULL(handle);
+
+        return handle->base != 0;
+}
+
+AllocatorStats stats(const DeferredAllocator* const handle) {
+        ANVIL_INVARIANT_NOT_NULL(handle);
+
+        AllocatorStats result{};
+        result.capacity         = handle->capacity;
+        result.allocated        = handle->allocated;
+        result.committed        = handle->limit;
+        result.peak             = handle->allocated;
+        result.reset_count      = handle->reset_count;
+        result.exhaustion_count = handle->exhaustion_count;
+        return result;
+}
+
+} // namespace anvil::memory::deferred_allocator
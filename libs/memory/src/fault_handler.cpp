@@ -0,0 +1,151 @@
+#include "internal/fault_handler.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <mutex>
+#include <unistd.h>
+
+using std::size_t;
+using std::uintptr_t;
+
+namespace anvil::memory::internal {
+
+namespace {
+
+/**
+ * @brief One watched range; `owner` is published last so the handler never sees a half-written slot.
+ */
+struct Slot {
+        std::atomic<void*>         owner{nullptr};
+        std::atomic<uintptr_t>     lo{0};
+        std::atomic<uintptr_t>     hi{0};
+        std::atomic<FaultCallback> on_fault{nullptr};
+};
+
+constexpr size_t    MAX_WATCHED = 1024;
+
+Slot                slots[MAX_WATCHED];
+std::atomic<size_t> slot_count{0}; ///< Slots ever used; the handler scans only these.
+std::mutex          watch_mutex;   ///< Serializes watch, unwatch and installation; never taken by the handler.
+struct sigaction    previous {};
+bool                installed = false;
+
+/**
+ * @brief Writes "anvil: ... 0x<address>" to stderr with async-signal-safe calls only.
+ */
+void report(const uintptr_t address) {
+        static constexpr char prefix[] = "anvil: unrecoverable fault in a guarded arena at 0x";
+        static constexpr char digits[] = "0123456789abcdef";
+        constexpr size_t      nibbles  = 2 * sizeof(uintptr_t);
+        char                  line[sizeof(prefix) - 1 + nibbles + 1];
+        for (size_t i = 0; i < sizeof(prefix) - 1; ++i) {
+                line[i] = prefix[i];
+        }
+        for (size_t i = 0; i < nibbles; ++i) {
+                line[sizeof(prefix) - 1 + i] = digits[(address >> (4 * (nibbles - 1 - i))) & 0xF];
+        }
+        line[sizeof(line) - 1] = '\n';
+        [[maybe_unused]] const ssize_t written = write(STDERR_FILENO, line, sizeof(line));
+}
+
+/**
+ * @brief Hands a fault that is not ours (or that we could not resolve) to the previously installed handler.
+ */
+void chain(const int sig, siginfo_t* const info, void* const context) {
+        if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+                if (previous.sa_flags & SA_SIGINFO) {
+                        previous.sa_sigaction(sig, info, context);
+                } else {
+                        previous.sa_handler(sig);
+                }
+                return;
+        }
+        // Returning re-executes the faulting access, which now takes the default action and terminates.
+        struct sigaction fallback {};
+        fallback.sa_handler = SIG_DFL;
+        sigemptyset(&fallback.sa_mask);
+        static_cast<void>(sigaction(sig, &fallback, nullptr));
+}
+
+void on_segv(const int sig, siginfo_t* const info, void* const context) {
+        const int saved_errno = errno;
+        if (info->si_code == SEGV_ACCERR) {
+                const uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+                const size_t    count   = slot_count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; ++i) {
+                        void* const owner = slots[i].owner.load(std::memory_order_acquire);
+                        if (!owner || address < slots[i].lo.load(std::memory_order_relaxed) ||
+                            address >= slots[i].hi.load(std::memory_order_relaxed)) {
+                                continue;
+                        }
+                        if (slots[i].on_fault.load(std::memory_order_relaxed)(owner, address)) {
+                                errno = saved_errno;
+                                return;
+                        }
+                        report(address);
+                        break;
+                }
+        }
+        errno = saved_errno;
+        chain(sig, info, context);
+}
+
+bool install() {
+        if (installed) {
+                return true;
+        }
+        struct sigaction action {};
+        action.sa_sigaction = on_segv;
+        action.sa_flags     = SA_SIGINFO | SA_ONSTACK;
+        sigemptyset(&action.sa_mask);
+        installed = sigaction(SIGSEGV, &action, &previous) == 0;
+        return installed;
+}
+
+} // namespace
+
+Error watch(void* owner, const uintptr_t lo, const uintptr_t hi, FaultCallback on_fault) {
+        ANVIL_INVARIANT_NOT_NULL(owner);
+        ANVIL_INVARIANT_NOT_NULL(on_fault);
+        ANVIL_INVARIANT(lo < hi, INV_OUT_OF_RANGE, "empty range [%zu, %zu)", static_cast<size_t>(lo),
+                        static_cast<size_t>(hi));
+
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        if (!install()) {
+                return ERR_FAULT_HANDLER;
+        }
+
+        const size_t count = slot_count.load(std::memory_order_relaxed);
+        size_t       index = 0;
+        while (index < count && slots[index].owner.load(std::memory_order_relaxed) != nullptr) {
+                ++index;
+        }
+        if (index == MAX_WATCHED) {
+                return ERR_FAULT_HANDLER;
+        }
+
+        slots[index].lo.store(lo, std::memory_order_relaxed);
+        slots[index].hi.store(hi, std::memory_order_relaxed);
+        slots[index].on_fault.store(on_fault, std::memory_order_relaxed);
+        slots[index].owner.store(owner, std::memory_order_release);
+        if (index == count) {
+                slot_count.store(count + 1, std::memory_order_release);
+        }
+
+        return ERR_SUCCESS;
+}
+
+void unwatch(const void* owner) {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        const size_t                count = slot_count.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+                if (slots[i].owner.load(std::memory_order_relaxed) == owner) {
+                        slots[i].owner.store(nullptr, std::memory_order_release);
+                        return;
+                }
+        }
+}
+
+} // namespace anvil::memory::internal
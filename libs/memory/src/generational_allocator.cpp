@@ -0,0 +1,297 @@
+#include "memory/generational_allocator.hpp"
+#include "internal/registry.hpp"
+#include "internal/utility.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/scratch_allocator.hpp"
+#include <cstring>
+#include <new>
+
+namespace anvil::memory::generational_allocator {
+
+namespace {
+
+/**
+ * @brief Where a copied object went; a node of a treap ordered by `from` and heap ordered by `priority(from)`.
+ *
+ * Nodes are carved from a side scratch arena and released in bulk when the table is cleared, so inserting and
+ * finding an entry take expected O(log n) steps and no call to the heap.
+ */
+struct Forward {
+        uintptr_t from;
+        size_t    size;
+        uintptr_t to;
+        Forward*  left;
+        Forward*  right;
+};
+static_assert(sizeof(Forward) == 40, "Forward size must be 40 bytes, as documented by create");
+
+} // namespace
+
+/**
+ * @brief Encapsulates the arenas and forwarding entries of a generational allocator.
+ *
+ * @invariant young != nullptr
+ * @invariant old[0] != nullptr && old[1] != nullptr
+ * @invariant old[current ^ 1] is empty outside of `compact`
+ * @invariant the entries of forwards do not overlap and all live in forward_arena
+ *
+ * Field            | Type                  | Description
+ * ---------------- | --------------------- | -----------------------------------------------------------
+ * young            | ScratchAllocator*     | Arena of the current frame, reset by `advance`
+ * old              | ScratchAllocator*[2]  | Semispaces of the old generation
+ * current          | size_t                | Index of the semispace promotions copy into
+ * evacuating       | ScratchAllocator*     | Semispace being evacuated while `compact` runs, else nullptr
+ * alignment        | size_t                | Alignment of every copy
+ * promotion_failed | bool                  | Set when a promotion ran out of old capacity
+ * forward_arena    | ScratchAllocator*     | Holds the nodes of `forwards`, reset whenever the table is cleared
+ * forwards         | Forward*              | Root of the copies made since the last `advance` or `compact` began
+ * promoted_count   | size_t                | Objects copied out of the young arena
+ * promoted_bytes   | size_t                | Bytes copied out of the young arena
+ * evacuated_count  | size_t                | Objects copied by compactions
+ * evacuated_bytes  | size_t                | Bytes copied by compactions
+ * compaction_count | size_t                | Number of compactions
+ */
+struct GenerationalAllocator {
+        scratch_allocator::ScratchAllocator* young;
+        scratch_allocator::ScratchAllocator* old[2];
+        size_t                               current;
+        scratch_allocator::ScratchAllocator* evacuating;
+        size_t                               alignment;
+        bool                                 promotion_failed;
+        scratch_allocator::ScratchAllocator* forward_arena;
+        Forward*                             forwards;
+        size_t                               promoted_count;
+        size_t                               promoted_bytes;
+        size_t                               evacuated_count;
+        size_t                               evacuated_bytes;
+        size_t                               compaction_count;
+};
+
+namespace {
+
+/**
+ * @brief Pseudo-random heap priority of a node, derived from its key so that nodes need not store it.
+ */
+uint64_t priority(const uintptr_t from) {
+        uint64_t x = from;
+        x          = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x          = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+}
+
+Forward* insert(Forward* const root, Forward* const node) {
+        if (!root) {
+                return node;
+        }
+        if (node->from < root->from) {
+                root->left = insert(root->left, node);
+                if (priority(root->left->from) > priority(root->from)) {
+                        Forward* const top = root->left;
+                        root->left         = top->right;
+                        top->right         = root;
+                        return top;
+                }
+        } else {
+                root->right = insert(root->right, node);
+                if (priority(root->right->from) > priority(root->from)) {
+                        Forward* const top = root->right;
+                        root->right        = top->left;
+                        top->left          = root;
+                        return top;
+                }
+        }
+        return root;
+}
+
+/**
+ * @brief The new address of `address` if it lies in a copied object, else 0.
+ */
+uintptr_t find_forward(const GenerationalAllocator* const allocator, const uintptr_t address) {
+        const Forward* floor = nullptr; // entry with the greatest `from` not above `address`
+        for (const Forward* node = allocator->forwards; node;) {
+                if (node->from <= address) {
+                        floor = node;
+                        node  = node->right;
+                } else {
+                        node = node->left;
+                }
+        }
+        return floor && address - floor->from < floor->size ? floor->to + (address - floor->from) : 0;
+}
+
+void clear_forwards(GenerationalAllocator* const allocator) {
+        allocator->forwards = nullptr;
+        ANVIL_INVARIANT(scratch_allocator::reset(allocator->forward_arena) == ERR_SUCCESS, INV_INVALID_STATE,
+                        "Failed to reset the forwarding table");
+}
+
+void destroy_arenas(GenerationalAllocator* const allocator) {
+        for (scratch_allocator::ScratchAllocator** arena :
+             {&allocator->young, &allocator->old[0], &allocator->old[1], &allocator->forward_arena}) {
+                if (*arena) {
+                        ANVIL_INVARIANT(scratch_allocator::destroy(arena) == ERR_SUCCESS, INV_INVALID_STATE,
+                                        "Failed to Deallocate memory");
+                }
+        }
+}
+
+} // namespace
+
+GenerationalAllocator* create(const size_t young_capacity, const size_t old_capacity, const size_t alignment,
+                              const MappingFlags mapping) {
+        ANVIL_INVARIANT_POSITIVE(young_capacity);
+        ANVIL_INVARIANT_POSITIVE(old_capacity);
+        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
+        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
+
+        GenerationalAllocator* allocator = new (std::nothrow) GenerationalAllocator{};
+        if (!allocator) {
+                return nullptr;
+        }
+        allocator->young     = scratch_allocator::create(young_capacity, alignment, mapping);
+        allocator->old[0]    = scratch_allocator::create(old_capacity, alignment, mapping);
+        allocator->old[1]    = scratch_allocator::create(old_capacity, alignment, mapping);
+        allocator->alignment = alignment;
+        // Every copy takes at least `alignment` bytes of a semispace, which bounds the entries of one trace.
+        allocator->forward_arena =
+            scratch_allocator::create((old_capacity / alignment + 1) * sizeof(Forward), alignof(Forward), mapping);
+        if (!allocator->young || !allocator->old[0] || !allocator->old[1] || !allocator->forward_arena) {
+                destroy_arenas(allocator);
+                delete allocator;
+                return nullptr;
+        }
+
+        return allocator;
+}
+
+Error destroy(GenerationalAllocator** allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_NOT_NULL(*allocator);
+
+        for (scratch_allocator::ScratchAllocator** arena :
+             {&(*allocator)->young, &(*allocator)->old[0], &(*allocator)->old[1], &(*allocator)->forward_arena}) {
+                const Error destroy_result = scratch_allocator::destroy(arena);
+                if (::anvil::error::is_error(destroy_result)) [[unlikely]] {
+                        return destroy_result;
+                }
+        }
+        delete *allocator;
+        *allocator = nullptr;
+
+        return ERR_SUCCESS;
+}
+
+void* alloc(GenerationalAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        // New objects may reuse the addresses of promoted ones, which must no longer be forwarded.
+        if (allocator->forwards) [[unlikely]] {
+                clear_forwards(allocator);
+        }
+        return scratch_allocator::alloc(allocator->young, allocation_size, alignment);
+}
+
+void* promote(GenerationalAllocator* const allocator, void* const ptr, const size_t size) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+        ANVIL_INVARIANT_POSITIVE(size);
+
+        const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        if (const uintptr_t moved = find_forward(allocator, address)) {
+                return reinterpret_cast<void*>(moved);
+        }
+
+        // Young objects wait for `advance` while compacting, which is what makes evacuation unable to fail.
+        const bool young = !allocator->evacuating && scratch_allocator::internal::owns(allocator->young, ptr);
+        const bool old   = allocator->evacuating && scratch_allocator::internal::owns(allocator->evacuating, ptr);
+        if (!young && !old) {
+                return ptr;
+        }
+
+        // Copies take whole multiples of the alignment, so the same objects fill a semispace equally in any order.
+        const size_t alignment = allocator->alignment;
+        const size_t   footprint = (size + alignment - 1) & ~(alignment - 1);
+        Forward* const entry     = static_cast<Forward*>(
+            scratch_allocator::alloc(allocator->forward_arena, sizeof(Forward), alignof(Forward)));
+        void* const    copy      = entry ? scratch_allocator::alloc(allocator->old[allocator->current], footprint,
+                                                                    alignment)
+                                         : nullptr;
+        if (!copy) [[unlikely]] {
+                allocator->promotion_failed = true;
+                return nullptr;
+        }
+        std::memcpy(copy, ptr, size);
+
+        *entry              = Forward{address, size, reinterpret_cast<uintptr_t>(copy), nullptr, nullptr};
+        allocator->forwards = insert(allocator->forwards, entry);
+
+        if (young) {
+                allocator->promoted_count++;
+                allocator->promoted_bytes += size;
+        } else {
+                allocator->evacuated_count++;
+                allocator->evacuated_bytes += size;
+        }
+        return copy;
+}
+
+void* forward(const GenerationalAllocator* const allocator, void* const ptr) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        const uintptr_t moved = find_forward(allocator, reinterpret_cast<uintptr_t>(ptr));
+        return moved ? reinterpret_cast<void*>(moved) : ptr;
+}
+
+Error advance(GenerationalAllocator* const allocator, const Tracer tracer, void* const context) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        clear_forwards(allocator);
+        allocator->promotion_failed = false;
+        if (tracer) {
+                tracer(allocator, context);
+        }
+        if (allocator->promotion_failed) [[unlikely]] {
+                return ERR_OUT_OF_MEMORY;
+        }
+
+        return scratch_allocator::reset(allocator->young);
+}
+
+Error compact(GenerationalAllocator* const allocator, const Tracer tracer, void* const context) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_NOT_NULL(tracer);
+
+        clear_forwards(allocator);
+        allocator->promotion_failed = false;
+        allocator->evacuating       = allocator->old[allocator->current];
+        allocator->current ^= 1;
+        tracer(allocator, context);
+        allocator->evacuating = nullptr;
+        if (allocator->promotion_failed) [[unlikely]] {
+                // Keep the semispace that still holds every object and drop the partial copy.
+                clear_forwards(allocator);
+                allocator->current ^= 1;
+                const Error reset_result = scratch_allocator::reset(allocator->old[allocator->current ^ 1]);
+                return ::anvil::error::is_error(reset_result) ? reset_result : ERR_OUT_OF_MEMORY;
+        }
+        allocator->compaction_count++;
+
+        return scratch_allocator::reset(allocator->old[allocator->current ^ 1]);
+}
+
+GenerationalStats stats(const GenerationalAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        GenerationalStats result{};
+        result.young            = scratch_allocator::stats(allocator->young);
+        result.old              = scratch_allocator::stats(allocator->old[allocator->current]);
+        result.promoted_count   = allocator->promoted_count;
+        result.promoted_bytes   = allocator->promoted_bytes;
+        result.evacuated_count  = allocator->evacuated_count;
+        result.evacuated_bytes  = allocator->evacuated_bytes;
+        result.compaction_count = allocator->compaction_count;
+        return result;
+}
+
+} // namespace anvil::memory::generational_allocator
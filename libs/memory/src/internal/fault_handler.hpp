@@ -0,0 +1,34 @@
+#ifndef ANVIL_FAULT_HANDLER_INTERNAL_HPP
+#define ANVIL_FAULT_HANDLER_INTERNAL_HPP
+
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <cstdint>
+
+namespace anvil::memory::internal {
+
+/**
+ * @brief Resolves a fault inside a watched range; runs in the SIGSEGV handler on the faulting thread.
+ *
+ * Must only use async-signal-safe operations. Returns true once the faulting page is accessible, false when
+ * the fault cannot be resolved, in which case the handler reports it and chains to the previous handler.
+ */
+using FaultCallback = bool (*)(void* owner, std::uintptr_t address);
+
+/**
+ * @brief Routes access faults in [lo, hi) to `on_fault`, installing the process-wide SIGSEGV handler on first use.
+ *
+ * @pre `owner != nullptr`, `lo < hi`, and the range does not overlap another watched range.
+ *
+ * @return ERR_FAULT_HANDLER if the handler could not be installed or every slot is taken.
+ */
+[[nodiscard]] Error watch(void* owner, const std::uintptr_t lo, const std::uintptr_t hi, FaultCallback on_fault);
+
+/**
+ * @brief Stops routing faults to `owner`; must be called before its range is unmapped.
+ */
+void                unwatch(const void* owner);
+
+} // namespace anvil::memory::internal
+
+#endif // ANVIL_FAULT_HANDLER_INTERNAL_HPP
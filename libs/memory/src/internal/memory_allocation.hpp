@@ -23,6 +23,7 @@
 #ifndef ANVIL_MEMORY_ALLOCATION_HPP
 #define ANVIL_MEMORY_ALLOCATION_HPP
 
+#include "memory/constants.hpp"
 #include "memory/error.hpp"
 
 /**
@@ -93,6 +94,26 @@
  */
 [[nodiscard]] Error                      anvil_memory_dealloc(void* ptr);
 
+/**
+ * @brief Resizing of a fully committed memory mapping without copying its contents
+ *
+ * The mapping is grown or shrunk with mremap(MREMAP_MAYMOVE): when it cannot grow in place the kernel
+ * moves its page table entries to a new range, so the cost is independent of the number of bytes kept
+ * and resident memory is never doubled. The prepended metadata moves with the mapping and is updated.
+ *
+ * @pre ptr != nullptr
+ * @pre ptr must reference memory allocated with anvil_memory_alloc_eager or returned by this function
+ * @pre capacity > 0
+ *
+ * @param[in] ptr        Address returned by anvil_memory_alloc_eager or anvil_memory_realloc.
+ * @param[in] capacity   Bytes that must be usable from the returned address.
+ * @return pointer       Address with the same alignment holding the first min(old, new) bytes of `ptr`,
+ *                       or nullptr if the mapping could not be resized, in which case `ptr` stays valid.
+ *
+ * @note On success `ptr` must no longer be used, even when the returned address is equal to it.
+ */
+[[nodiscard]] void*                      anvil_memory_realloc(void* ptr, const std::size_t capacity);
+
 /**
  * @brief On demand commital of memory resources from virtual memory to physical memory
  *
@@ -113,4 +134,84 @@
  */
 [[nodiscard]] Error                      anvil_memory_commit(void* ptr, const std::size_t commit_size);
 
+/**
+ * @brief Release of committed physical memory back to the virtual reservation
+ *
+ * This operation is the inverse of `anvil_memory_commit`. Pages past `keep_size` bytes from `ptr` are
+ * returned to the operating system and their read and write permission is revoked, leaving the
+ * virtual address range reserved for a later commit.
+ *
+ * @pre ptr != nullptr
+ * @pre ptr must reference memory allocated with anvil_memory_alloc_lazy
+ *
+ * @param[in] ptr           Address denoting the commencement of the memory region.
+ * @param[in] keep_size     Number of bytes from `ptr` that must remain committed.
+ *
+ * @return Error            Error code indicating success or failure of releasing the physical memory.
+ *
+ * @note Requests that would not release a whole page succeed without effect.
+ */
+[[nodiscard]] Error                      anvil_memory_decommit(void* ptr, const std::size_t keep_size);
+
+/**
+ * @brief Fork and core dump treatment of a memory mapping
+ *
+ * Every page of the reservation that lies entirely past `header_size` bytes from `ptr` is advised
+ * according to `flags`; flags that are not set are explicitly reverted (MADV_DOFORK, MADV_KEEPONFORK,
+ * MADV_DODUMP), so the call both sets and clears. The advice covers uncommitted pages too and survives
+ * later commits and decommits. Pages holding the header stay inherited and dumped, so an allocator
+ * placed there remains readable in a child process.
+ *
+ * @pre ptr != nullptr
+ * @pre ptr must reference memory allocated with anvil_memory_alloc_lazy or anvil_memory_alloc_eager
+ *
+ * @param[in] ptr           Address denoting the commencement of the memory region.
+ * @param[in] header_size   Number of bytes from `ptr` that keep the default treatment.
+ * @param[in] flags         Requested treatment.
+ *
+ * @return Error            ERR_MEMORY_ADVICE if the kernel rejected the advice (MADV_WIPEONFORK needs Linux 4.14).
+ */
+[[nodiscard]] Error anvil_memory_set_mapping_flags(void* ptr, const std::size_t header_size,
+                                                   const anvil::memory::MappingFlags flags);
+
+/**
+ * @brief Bytes to reserve on top of an arena so that `anvil_memory_arena_offset` can move it to a page boundary
+ *
+ * @param[in] flags         Mapping flags the arena is created with.
+ *
+ * @return size             The page size if `flags` is not `MappingFlags::None`, otherwise zero.
+ */
+[[nodiscard]] std::size_t                anvil_memory_arena_padding(const anvil::memory::MappingFlags flags);
+
+/**
+ * @brief Offset from `ptr` at which the arena following a `header_size` byte header starts
+ *
+ * Arenas created with mapping flags start at the first page boundary past the header, so that
+ * anvil_memory_set_mapping_flags advises every byte of them; the others start right after the header.
+ *
+ * @pre ptr != nullptr
+ * @pre ptr must reference memory allocated with anvil_memory_alloc_lazy or anvil_memory_alloc_eager, with
+ *      `anvil_memory_arena_padding(flags)` bytes reserved past the arena.
+ *
+ * @param[in] ptr           Address denoting the commencement of the memory region.
+ * @param[in] header_size   Number of bytes from `ptr` taken by the header.
+ * @param[in] flags         Mapping flags the arena is created with.
+ *
+ * @return offset           Offset of the arena from `ptr`.
+ */
+[[nodiscard]] std::size_t                anvil_memory_arena_offset(const void* ptr, const std::size_t header_size,
+                                                                   const anvil::memory::MappingFlags flags);
+
+/**
+ * @brief Number of bytes, counted from `ptr`, that are currently readable and writable
+ *
+ * @pre ptr != nullptr
+ * @pre ptr must reference memory allocated with anvil_memory_alloc_lazy or anvil_memory_alloc_eager
+ *
+ * @param[in] ptr           Address denoting the commencement of the memory region.
+ *
+ * @return size             Committed bytes from `ptr` to the end of the committed range.
+ */
+[[nodiscard]] std::size_t                anvil_memory_committed_size(const void* ptr);
+
 #endif // ANVIL_MEMORY_ALLOCATION_HPP
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef ANVIL_PROFILER_INTERNAL_HPP
+#define ANVIL_PROFILER_INTERNAL_HPP
+
+#include "memory/constants.hpp"
+#include <atomic>
+#include <cstddef>
+
+namespace anvil::memory::profiler::internal {
+
+/// Mean number of bytes between two samples, zero while the profiler is disabled. A process-wide flag rather
+/// than a thread local one, so that disabled allocations test a plain global and never touch thread locals.
+inline std::atomic<std::size_t>    sample_rate{0};
+
+/// Bytes the calling thread may still allocate before its next sample. Starting at zero makes the first
+/// allocation of every thread while enabled enter the slow path, which arms the countdown from the rate.
+inline thread_local std::ptrdiff_t bytes_until_sample = 0;
+
+/// Whether the countdown of the calling thread was drawn from the sample rate. An unarmed countdown that
+/// runs out arms it instead of recording a sample, so the first allocation of a thread is not over-weighted.
+inline thread_local bool           sampling_armed     = false;
+
+/**
+ * @brief Slow path of the profiler, records a sample and re-arms the countdown, or arms an unarmed one.
+ *
+ * @param[in] allocator         Allocator the allocation was made from.
+ * @param[in] allocation_size   Size in bytes of the allocation that expired the countdown.
+ */
+ANVIL_ATTR_COLD ANVIL_ATTR_NOINLINE void sample(const void* allocator, const std::size_t allocation_size);
+
+/**
+ * @brief Charges an allocation against the calling thread's sample countdown while the profiler is enabled.
+ *
+ * @param[in] allocator         Allocator the allocation was made from.
+ * @param[in] allocation_size   Size in bytes of the allocation.
+ */
+ANVIL_ATTR_HOT ANVIL_ATTR_ALWAYS_INLINE inline void account(const void* allocator, const std::size_t allocation_size) {
+        if (sample_rate.load(std::memory_order_relaxed) != 0) [[unlikely]] {
+                bytes_until_sample -= static_cast<std::ptrdiff_t>(allocation_size);
+                if (bytes_until_sample < 0) [[unlikely]] {
+                        sample(allocator, allocation_size);
+                }
+        }
+}
+
+} // namespace anvil::memory::profiler::internal
+
+#endif // ANVIL_PROFILER_INTERNAL_HPP
@@ -0,0 +1,64 @@
+#ifndef ANVIL_REGISTRY_INTERNAL_HPP
+#define ANVIL_REGISTRY_INTERNAL_HPP
+
+#include "memory/constants.hpp"
+#include "memory/scratch_allocator.hpp"
+#include "memory/stack_allocator.hpp"
+#include "memory/stats.hpp"
+
+namespace anvil::memory {
+
+/// Bits of the `flags` field shared by all allocators.
+inline constexpr std::size_t ALLOCATOR_FLAG_REGISTERED = 1u << 0;
+/// The allocator's MappingFlags are kept in the `flags` field from this bit on.
+inline constexpr std::size_t ALLOCATOR_FLAG_MAPPING_SHIFT = 8;
+
+} // namespace anvil::memory
+
+namespace anvil::memory::registry::internal {
+
+/**
+ * @brief Drops an allocator from the registry; called by `destroy` of registered allocators.
+ */
+ANVIL_ATTR_COLD void forget(const void* allocator);
+
+} // namespace anvil::memory::registry::internal
+
+namespace anvil::memory::scratch_allocator::internal {
+
+/**
+ * @brief Counters of an allocator read with relaxed loads, for an observer thread.
+ *
+ * The owner stores them non-atomically, so a concurrent call is formally a data race; see registry.hpp.
+ */
+[[nodiscard]] AllocatorStats load_counters(const ScratchAllocator* const allocator);
+
+/**
+ * @brief Sets or clears bits in the allocator's flags.
+ */
+void                         set_flags(ScratchAllocator* const allocator, const std::size_t flags, const bool enabled);
+
+/**
+ * @brief Whether `ptr` lies in the allocated part of the arena, `[base, base + allocated)`.
+ */
+[[nodiscard]] bool           owns(const ScratchAllocator* const allocator, const void* const ptr);
+
+} // namespace anvil::memory::scratch_allocator::internal
+
+namespace anvil::memory::stack_allocator::internal {
+
+/**
+ * @brief Counters of an allocator read with relaxed loads, for an observer thread.
+ *
+ * The owner stores them non-atomically, so a concurrent call is formally a data race; see registry.hpp.
+ */
+[[nodiscard]] AllocatorStats load_counters(const StackAllocator* const allocator);
+
+/**
+ * @brief Sets or clears bits in the allocator's flags.
+ */
+void                         set_flags(StackAllocator* const allocator, const std::size_t flags, const bool enabled);
+
+} // namespace anvil::memory::stack_allocator::internal
+
+#endif // ANVIL_REGISTRY_INTERNAL_HPP
@@ -0,0 +1,16 @@
+#ifndef ANVIL_STATS_INTERNAL_HPP
+#define ANVIL_STATS_INTERNAL_HPP
+
+#include "memory/constants.hpp"
+#include <cstdint>
+
+namespace anvil::memory::internal {
+
+/**
+ * @brief Adds one commit of `nanoseconds` duration to the process-wide commit latency histogram.
+ */
+void record_commit_latency(const std::uint64_t nanoseconds);
+
+} // namespace anvil::memory::internal
+
+#endif // ANVIL_STATS_INTERNAL_HPP
@@ -5,4 +5,9 @@
 
 ANVIL_ATTR_PURE bool is_power_of_two(const std::size_t x);
 
+/// Reads a field another thread may be writing; the value is never torn but may be stale.
+ANVIL_ATTR_ALWAYS_INLINE inline std::size_t load_relaxed(const std::size_t& value) {
+        return __atomic_load_n(&value, __ATOMIC_RELAXED);
+}
+
 #endif // ANVIL_UTILITY_HPP
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "internal/memory_allocation.hpp"
+#include "internal/stats.hpp"
 #include "internal/utility.hpp"
 #include "memory/constants.hpp"
 #include "memory/error.hpp"
 #include "sys/mman.h"
+#include <cstdint>
+#include <ctime>
 #include <unistd.h>
 
 using std::size_t;
@@ -123,6 +126,43 @@ Error anvil_memory_dealloc(void* ptr) {
         return ERR_SUCCESS;
 }
 
+void* anvil_memory_realloc(void* ptr, const size_t capacity) {
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+        ANVIL_INVARIANT_POSITIVE(capacity);
+
+        const Metadata* metadata =
+            reinterpret_cast<const Metadata*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Metadata));
+        ANVIL_INVARIANT(metadata->capacity == metadata->virtual_capacity, INV_PRECONDITION,
+                        "only fully committed mappings can be remapped (%zu of %zu bytes committed)",
+                        metadata->capacity, metadata->virtual_capacity);
+
+        const size_t page_size = metadata->page_size;
+        const size_t offset    = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(metadata->base);
+        if (capacity > SIZE_MAX - offset - page_size) [[unlikely]] {
+                return nullptr;
+        }
+        const size_t total_size = (offset + capacity + (page_size - 1)) & ~(page_size - 1);
+        if (total_size == metadata->virtual_capacity) {
+                return ptr;
+        }
+
+        // The kernel moves page table entries instead of copying; the offset of `ptr` in the mapping is kept,
+        // so alignment and the prepended Metadata survive a move.
+        void* base = mremap(metadata->base, metadata->virtual_capacity, total_size, MREMAP_MAYMOVE);
+        if (base == MAP_FAILED) {
+                return nullptr;
+        }
+
+        const uintptr_t aligned_addr = reinterpret_cast<uintptr_t>(base) + offset;
+        Metadata*       moved        = reinterpret_cast<Metadata*>(aligned_addr - sizeof(Metadata));
+        moved->base                  = base;
+        moved->virtual_capacity      = total_size;
+        moved->capacity              = total_size;
+        moved->page_count            = moved->capacity >> __builtin_ctzl(page_size);
+
+        return reinterpret_cast<void*>(aligned_addr);
+}
+
 Error anvil_memory_commit(void* ptr, const size_t commit_size) {
         ANVIL_INVARIANT_NOT_NULL(ptr);
         ANVIL_INVARIANT_POSITIVE(commit_size);
@@ -135,6 +175,8 @@ Error anvil_memory_commit(void* ptr, const size_t commit_size) {
         if (::anvil::error::is_error(capacity_result)) [[unlikely]] {
                 return capacity_result;
         }
+        timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
         const Error protect_result =
             ::anvil::error::check(mprotect(reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(metadata->base) +
                                                                    metadata->capacity),
@@ -143,9 +185,113 @@ Error anvil_memory_commit(void* ptr, const size_t commit_size) {
         if (::anvil::error::is_error(protect_result)) [[unlikely]] {
                 return protect_result;
         }
+        timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        anvil::memory::internal::record_commit_latency(
+            static_cast<uint64_t>((end.tv_sec - start.tv_sec) * 1000000000L + (end.tv_nsec - start.tv_nsec)));
 
         metadata->capacity   += _commit_size;
         metadata->page_count  = metadata->capacity >> __builtin_ctzl(page_size);
 
         return ERR_SUCCESS;
+}
+
+Error anvil_memory_decommit(void* ptr, const size_t keep_size) {
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+
+        Metadata*       metadata   = reinterpret_cast<Metadata*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Metadata));
+        const size_t    page_size  = metadata->page_size;
+        const uintptr_t base       = reinterpret_cast<uintptr_t>(metadata->base);
+        const size_t    keep_total = (reinterpret_cast<uintptr_t>(ptr) - base + keep_size + (page_size - 1)) &
+                                  ~(page_size - 1);
+        if (keep_total >= metadata->capacity) {
+                return ERR_SUCCESS;
+        }
+
+        void* const  release_addr = reinterpret_cast<void*>(base + keep_total);
+        const size_t release_size = metadata->capacity - keep_total;
+
+        const Error  advise_result =
+            ::anvil::error::check(madvise(release_addr, release_size, MADV_DONTNEED) == 0, ERR_MEMORY_DEALLOCATION);
+        if (::anvil::error::is_error(advise_result)) [[unlikely]] {
+                return advise_result;
+        }
+        const Error protect_result = ::anvil::error::check(mprotect(release_addr, release_size, PROT_NONE) == 0,
+                                                           ERR_MEMORY_PERMISSION_CHANGE);
+        if (::anvil::error::is_error(protect_result)) [[unlikely]] {
+                return protect_result;
+        }
+
+        metadata->capacity   = keep_total;
+        metadata->page_count = metadata->capacity >> __builtin_ctzl(page_size);
+
+        return ERR_SUCCESS;
+}
+
+Error anvil_memory_set_mapping_flags(void* ptr, const size_t header_size, const anvil::memory::MappingFlags flags) {
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+        using anvil::memory::MappingFlags;
+
+        Metadata*       metadata  = reinterpret_cast<Metadata*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Metadata));
+        const size_t    page_size = metadata->page_size;
+        const uintptr_t end       = reinterpret_cast<uintptr_t>(metadata->base) + metadata->virtual_capacity;
+        const uintptr_t start     = (reinterpret_cast<uintptr_t>(ptr) + header_size + (page_size - 1)) &
+                                ~(page_size - 1);
+        if (start >= end) {
+                return ERR_SUCCESS;
+        }
+
+#ifdef MADV_WIPEONFORK
+        const int wipe_advice = anvil::memory::has_flag(flags, MappingFlags::WipeOnFork) ? MADV_WIPEONFORK
+                                                                                         : MADV_KEEPONFORK;
+#else
+        if (anvil::memory::has_flag(flags, MappingFlags::WipeOnFork)) {
+                return ERR_MEMORY_ADVICE;
+        }
+        const int wipe_advice = -1;
+#endif
+        const int advice[] = {
+            anvil::memory::has_flag(flags, MappingFlags::DontFork) ? MADV_DONTFORK : MADV_DOFORK,
+            wipe_advice,
+            anvil::memory::has_flag(flags, MappingFlags::DontDump) ? MADV_DONTDUMP : MADV_DODUMP,
+        };
+        for (const int a : advice) {
+                if (a < 0) {
+                        continue;
+                }
+                const Error advise_result = ::anvil::error::check(
+                    madvise(reinterpret_cast<void*>(start), end - start, a) == 0, ERR_MEMORY_ADVICE);
+                if (::anvil::error::is_error(advise_result)) [[unlikely]] {
+                        return advise_result;
+                }
+        }
+
+        return ERR_SUCCESS;
+}
+
+size_t anvil_memory_arena_padding(const anvil::memory::MappingFlags flags) {
+        return flags == anvil::memory::MappingFlags::None ? 0 : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+size_t anvil_memory_arena_offset(const void* ptr, const size_t header_size, const anvil::memory::MappingFlags flags) {
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+
+        if (flags == anvil::memory::MappingFlags::None) {
+                return header_size;
+        }
+        const Metadata* metadata =
+            reinterpret_cast<const Metadata*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Metadata));
+        const size_t    page_size = metadata->page_size;
+        const uintptr_t start     = reinterpret_cast<uintptr_t>(ptr);
+        return ((start + header_size + (page_size - 1)) & ~(page_size - 1)) - start;
+}
+
+size_t anvil_memory_committed_size(const void* ptr) {
+        ANVIL_INVARIANT_NOT_NULL(ptr);
+
+        const Metadata* metadata =
+            reinterpret_cast<const Metadata*>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Metadata));
+        const uintptr_t committed_end = reinterpret_cast<uintptr_t>(metadata->base) + metadata->capacity;
+
+        return committed_end - reinterpret_cast<uintptr_t>(ptr);
 }
\ No newline at end of file
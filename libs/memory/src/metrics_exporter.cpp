@@ -0,0 +1,345 @@
+#include "memory/metrics_exporter.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include "memory/registry.hpp"
+#include "memory/stats.hpp"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <new>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using std::size_t;
+
+namespace anvil::memory::metrics_exporter {
+
+/**
+ * @brief Internal representation of a metrics exporter.
+ *
+ * Field          | Type        | Description
+ * -------------- | ----------- | ------------------------------------------------------------
+ * listen_fd      | int         | Listening socket
+ * stop_pipe      | int[2]      | Pipe whose write end wakes the server thread on stop
+ * port           | uint16_t    | Bound TCP port, zero for a Unix domain socket
+ * path           | std::string | Socket path to unlink on stop, empty for TCP
+ * server         | std::thread | Thread polling `listen_fd` and `stop_pipe[0]`
+ */
+struct MetricsExporter {
+        int           listen_fd;
+        int           stop_pipe[2];
+        std::uint16_t port;
+        std::string   path;
+        std::thread   server;
+};
+
+namespace {
+
+constexpr size_t REQUEST_BUFFER_SIZE = 4096;
+constexpr int    REQUEST_TIMEOUT_MS  = 1000;
+constexpr int    RESPONSE_TIMEOUT_MS = 1000; // a client that reads nothing for this long is dropped
+
+const char* kind_label(const registry::Kind kind) {
+        return kind == registry::Kind::Scratch ? "scratch" : "stack";
+}
+
+void append_format(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+void append_format(std::string& out, const char* format, ...) {
+        char    line[256];
+        va_list args;
+        va_start(args, format);
+        const int written = std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (written > 0) {
+                out.append(line, std::min(static_cast<size_t>(written), sizeof(line) - 1));
+        }
+}
+
+// Label values escape backslash, double quote and line feed as required by the exposition format.
+void append_label_value(std::string& out, const char* value) {
+        for (const char* c = value; *c != '\0'; ++c) {
+                switch (*c) {
+                case '\\': out += "\\\\"; break;
+                case '"': out += "\\\""; break;
+                case '\n': out += "\\n"; break;
+                default: out += *c; break;
+                }
+        }
+}
+
+struct Family {
+        const char* name;
+        const char* type;
+        const char* help;
+        size_t AllocatorStats::* field;
+};
+
+constexpr Family FAMILIES[] = {
+    {"anvil_allocator_capacity_bytes", "gauge", "Usable bytes requested at creation.", &AllocatorStats::capacity},
+    {"anvil_allocator_allocated_bytes", "gauge", "Current allocation watermark.", &AllocatorStats::allocated},
+    {"anvil_allocator_committed_bytes", "gauge", "Bytes backed by readable and writable pages.",
+     &AllocatorStats::committed},
+    {"anvil_allocator_peak_bytes", "gauge", "Highest allocation watermark since the last reset.", &AllocatorStats::peak},
+    {"anvil_allocator_resets_total", "counter", "Resets since creation.", &AllocatorStats::reset_count},
+    {"anvil_allocator_exhaustions_total", "counter", "Allocations that failed for lack of capacity.",
+     &AllocatorStats::exhaustion_count},
+};
+
+/**
+ * @brief Counters of every registered allocator sharing one name and kind, summed into a single series.
+ *
+ * Per connection arenas and per thread scratch arenas are registered under a shared name, and a scrape holding
+ * two samples with the same labels is rejected as a whole.
+ */
+struct Series {
+        std::string    name;
+        registry::Kind kind;
+        size_t         instances;
+        AllocatorStats stats;
+};
+
+void accumulate(const registry::Entry& entry, void* context) {
+        std::vector<Series>& series = *static_cast<std::vector<Series>*>(context);
+        auto                 match  = std::find_if(series.begin(), series.end(), [&](const Series& s) {
+                return s.kind == entry.kind && s.name == entry.name;
+        });
+        if (match == series.end()) {
+                series.push_back(Series{entry.name, entry.kind, 1, entry.stats});
+                return;
+        }
+        match->instances++;
+        for (const Family& family : FAMILIES) {
+                match->stats.*(family.field) += entry.stats.*(family.field);
+        }
+}
+
+void append_sample(std::string& out, const char* family, const Series& series, const size_t value) {
+        out += family;
+        out += "{name=\"";
+        append_label_value(out, series.name.c_str());
+        append_format(out, "\",kind=\"%s\"} %zu\n", kind_label(series.kind), value);
+}
+
+std::string exposition() {
+        std::vector<Series> series;
+        registry::visit(accumulate, &series);
+
+        std::string out;
+        for (const Family& family : FAMILIES) {
+                append_format(out, "# HELP %s %s\n# TYPE %s %s\n", family.name, family.help, family.name, family.type);
+                for (const Series& entry : series) {
+                        append_sample(out, family.name, entry, entry.stats.*(family.field));
+                }
+        }
+        out += "# HELP anvil_allocator_instances Registered allocators summed into the series of a name and kind.\n";
+        out += "# TYPE anvil_allocator_instances gauge\n";
+        for (const Series& entry : series) {
+                append_sample(out, "anvil_allocator_instances", entry, entry.instances);
+        }
+
+        const CommitLatencyHistogram histogram = commit_latency();
+        out += "# HELP anvil_commit_latency_seconds Latency of lazy commits.\n";
+        out += "# TYPE anvil_commit_latency_seconds histogram\n";
+        size_t cumulative = 0;
+        for (size_t i = 0; i + 1 < COMMIT_LATENCY_BUCKETS; ++i) {
+                cumulative += histogram.counts[i];
+                append_format(out, "anvil_commit_latency_seconds_bucket{le=\"%g\"} %zu\n",
+                              static_cast<double>(size_t{1} << i) * 1e-6, cumulative);
+        }
+        append_format(out, "anvil_commit_latency_seconds_bucket{le=\"+Inf\"} %zu\n", histogram.count);
+        append_format(out, "anvil_commit_latency_seconds_sum %.9f\n", static_cast<double>(histogram.sum_ns) * 1e-9);
+        append_format(out, "anvil_commit_latency_seconds_count %zu\n", histogram.count);
+
+        append_format(out, "# HELP anvil_registered_allocators Allocators in the registry.\n"
+                           "# TYPE anvil_registered_allocators gauge\n"
+                           "anvil_registered_allocators %zu\n",
+                      registry::size());
+        return out;
+}
+
+/**
+ * @brief Sends `data` on the non-blocking `fd`, giving up when the client stalls or `stop_fd` becomes readable.
+ *
+ * The server thread answers one client at a time, so a client that stops reading must not hold it, nor `stop`.
+ */
+bool write_all(const int fd, const int stop_fd, const char* data, size_t size) {
+        while (size > 0) {
+                const ssize_t written = ::send(fd, data, size, MSG_NOSIGNAL);
+                if (written > 0) {
+                        data += written;
+                        size -= static_cast<size_t>(written);
+                        continue;
+                }
+                if (written == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                        return false;
+                }
+                pollfd fds[2] = {{fd, POLLOUT, 0}, {stop_fd, POLLIN, 0}};
+                const int ready = ::poll(fds, 2, RESPONSE_TIMEOUT_MS);
+                if ((ready < 0 && errno != EINTR) || ready == 0 || fds[1].revents != 0) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+// The request is read only to be discarded; every path serves the same exposition.
+void serve(const int client_fd, const int stop_fd) {
+        pollfd readable{client_fd, POLLIN, 0};
+        if (::poll(&readable, 1, REQUEST_TIMEOUT_MS) > 0) {
+                char request[REQUEST_BUFFER_SIZE];
+                (void)::recv(client_fd, request, sizeof(request), 0);
+        }
+
+        const std::string body = exposition();
+        std::string       response;
+        append_format(response,
+                      "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                      "Content-Length: %zu\r\n"
+                      "Connection: close\r\n\r\n",
+                      body.size());
+        response += body;
+        (void)write_all(client_fd, stop_fd, response.data(), response.size());
+}
+
+void run(MetricsExporter* const exporter) {
+        pollfd fds[2] = {{exporter->listen_fd, POLLIN, 0}, {exporter->stop_pipe[0], POLLIN, 0}};
+        for (;;) {
+                if (::poll(fds, 2, -1) < 0) {
+                        continue;
+                }
+                if (fds[1].revents != 0) {
+                        return;
+                }
+                if (fds[0].revents & POLLIN) {
+                        const int client_fd =
+                            ::accept4(exporter->listen_fd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                        if (client_fd >= 0) {
+                                serve(client_fd, exporter->stop_pipe[0]);
+                                ::close(client_fd);
+                        }
+                }
+        }
+}
+
+MetricsExporter* launch(const int listen_fd, const std::uint16_t port, const char* path) {
+        if (::listen(listen_fd, SOMAXCONN) != 0) {
+                ::close(listen_fd);
+                return nullptr;
+        }
+
+        MetricsExporter* exporter = new (std::nothrow) MetricsExporter{listen_fd, {-1, -1}, port, {}, {}};
+        if (!exporter) {
+                ::close(listen_fd);
+                return nullptr;
+        }
+        if (::pipe2(exporter->stop_pipe, O_CLOEXEC) != 0) {
+                ::close(listen_fd);
+                delete exporter;
+                return nullptr;
+        }
+        if (path) {
+                exporter->path = path;
+        }
+        exporter->server = std::thread(run, exporter);
+
+        return exporter;
+}
+
+} // namespace
+
+MetricsExporter* start_unix(const char* path) {
+        ANVIL_INVARIANT_NOT_NULL(path);
+
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (std::strlen(path) >= sizeof(address.sun_path)) {
+                return nullptr;
+        }
+        std::strcpy(address.sun_path, path);
+
+        const int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+                return nullptr;
+        }
+        ::unlink(path);
+        if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+                ::close(listen_fd);
+                return nullptr;
+        }
+
+        return launch(listen_fd, 0, path);
+}
+
+MetricsExporter* start_tcp(const std::uint16_t port) {
+        const int listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listen_fd < 0) {
+                return nullptr;
+        }
+        const int reuse = 1;
+        (void)::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family      = AF_INET;
+        address.sin_port        = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length        = sizeof(address);
+        if (::bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), length) != 0 ||
+            ::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+                ::close(listen_fd);
+                return nullptr;
+        }
+
+        return launch(listen_fd, ntohs(address.sin_port), nullptr);
+}
+
+std::uint16_t port(const MetricsExporter* const exporter) {
+        ANVIL_INVARIANT_NOT_NULL(exporter);
+        return exporter->port;
+}
+
+Error stop(MetricsExporter** exporter) {
+        ANVIL_INVARIANT_NOT_NULL(exporter);
+        ANVIL_INVARIANT_NOT_NULL(*exporter);
+
+        MetricsExporter* const target = *exporter;
+        const char             wake   = 1;
+        if (::write(target->stop_pipe[1], &wake, 1) != 1) [[unlikely]] {
+                return ERR_IO_FAILURE;
+        }
+        target->server.join();
+
+        ::close(target->listen_fd);
+        ::close(target->stop_pipe[0]);
+        ::close(target->stop_pipe[1]);
+        if (!target->path.empty()) {
+                ::unlink(target->path.c_str());
+        }
+        delete target;
+        *exporter = nullptr;
+
+        return ERR_SUCCESS;
+}
+
+size_t render(char* buffer, const size_t size) {
+        ANVIL_INVARIANT(buffer != nullptr || size == 0, INV_NULL_POINTER, "buffer, must not be null when size > 0");
+
+        const std::string text = exposition();
+        if (size > 0) {
+                std::memcpy(buffer, text.data(), std::min(size, text.size()));
+        }
+        return text.size();
+}
+
+} // namespace anvil::memory::metrics_exporter
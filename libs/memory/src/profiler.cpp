@@ -0,0 +1,202 @@
+#include "memory/profiler.hpp"
+#include "internal/profiler.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <execinfo.h>
+#include <mutex>
+#include <unordered_map>
+
+using std::size_t;
+
+namespace anvil::memory::profiler {
+
+namespace {
+
+constexpr int MAX_FRAMES     = 64;
+constexpr int SKIPPED_FRAMES = 1; // internal::sample; alloc stays as the leaf since it may be inlined.
+
+/**
+ * @brief Identity of an aggregation bucket: the allocator and the call stack that allocated from it.
+ */
+struct SiteKey {
+        const void* allocator;
+        int         depth;
+        void*       frames[MAX_FRAMES];
+
+        bool        operator==(const SiteKey& other) const noexcept {
+                return allocator == other.allocator && depth == other.depth &&
+                       std::memcmp(frames, other.frames, static_cast<size_t>(depth) * sizeof(void*)) == 0;
+        }
+};
+
+struct SiteKeyHash {
+        size_t operator()(const SiteKey& key) const noexcept {
+                // FNV-1a over the allocator address and the captured return addresses.
+                uint64_t hash = 0xcbf29ce484222325ull ^ reinterpret_cast<uintptr_t>(key.allocator);
+                for (int i = 0; i < key.depth; ++i) {
+                        hash ^= reinterpret_cast<uintptr_t>(key.frames[i]);
+                        hash *= 0x100000001b3ull;
+                }
+                return static_cast<size_t>(hash);
+        }
+};
+
+struct SiteCounts {
+        size_t count;
+        size_t bytes;
+};
+
+std::atomic<size_t>                                 profile_rate{DEFAULT_SAMPLE_RATE}; // rate the samples were taken at
+std::mutex                                          sites_mutex;
+std::unordered_map<SiteKey, SiteCounts, SiteKeyHash> sites;
+
+thread_local uint64_t                               rng_state = 0;
+
+uint64_t                                            next_random() {
+        if (rng_state == 0) [[unlikely]] {
+                rng_state = reinterpret_cast<uintptr_t>(&rng_state) ^ static_cast<uint64_t>(time(nullptr));
+        }
+        // splitmix64
+        uint64_t z = (rng_state += 0x9e3779b97f4a7c15ull);
+        z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z          = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+}
+
+/**
+ * @brief Draws the next sampling interval from an exponential distribution with mean `rate`.
+ *
+ * A fixed interval would alias with periodic allocation patterns and always hit the same site;
+ * a memoryless interval makes every byte equally likely to be sampled.
+ */
+std::ptrdiff_t next_interval(const size_t rate) {
+        const double uniform  = static_cast<double>((next_random() >> 11) + 1) * 0x1.0p-53; // (0, 1]
+        const double interval = -std::log(uniform) * static_cast<double>(rate);
+        const double capped   = std::fmin(interval, static_cast<double>(rate) * 64.0);
+        return static_cast<std::ptrdiff_t>(capped) + 1;
+}
+
+} // namespace
+
+namespace internal {
+
+ANVIL_ATTR_COLD ANVIL_ATTR_NOINLINE void sample(const void* allocator, const size_t allocation_size) {
+        const size_t rate = sample_rate.load(std::memory_order_relaxed);
+        if (rate == 0) { // disabled after account() checked; arm again on the first allocation once enabled
+                sampling_armed     = false;
+                bytes_until_sample = 0;
+                return;
+        }
+        if (!sampling_armed) {
+                sampling_armed     = true;
+                bytes_until_sample = next_interval(rate);
+                return;
+        }
+
+        void* frames[MAX_FRAMES + SKIPPED_FRAMES];
+        int   depth = backtrace(frames, MAX_FRAMES + SKIPPED_FRAMES);
+        depth       = depth > SKIPPED_FRAMES ? depth - SKIPPED_FRAMES : 0;
+
+        SiteKey key;
+        key.allocator = allocator;
+        key.depth     = depth;
+        std::memcpy(key.frames, frames + SKIPPED_FRAMES, static_cast<size_t>(depth) * sizeof(void*));
+
+        {
+                std::lock_guard<std::mutex> lock(sites_mutex);
+                SiteCounts&                 counts  = sites[key];
+                counts.count                       += 1;
+                counts.bytes                       += allocation_size;
+        }
+
+        bytes_until_sample = next_interval(rate);
+}
+
+} // namespace internal
+
+void enable(const size_t rate) {
+        ANVIL_INVARIANT_POSITIVE(rate);
+        profile_rate.store(rate, std::memory_order_relaxed);
+        internal::sample_rate.store(rate, std::memory_order_relaxed);
+}
+
+void disable() {
+        internal::sample_rate.store(0, std::memory_order_relaxed);
+}
+
+void clear() {
+        std::lock_guard<std::mutex> lock(sites_mutex);
+        sites.clear();
+}
+
+size_t sample_count(const void* allocator) {
+        std::lock_guard<std::mutex> lock(sites_mutex);
+        size_t                      total = 0;
+        for (const auto& [key, counts] : sites) {
+                if (allocator == nullptr || key.allocator == allocator) {
+                        total += counts.count;
+                }
+        }
+        return total;
+}
+
+Error dump(const char* path, const void* allocator) {
+        ANVIL_INVARIANT_NOT_NULL(path);
+
+        FILE* out = fopen(path, "w");
+        if (!out) {
+                return ERR_IO_FAILURE;
+        }
+
+        {
+                std::lock_guard<std::mutex> lock(sites_mutex);
+
+                size_t                      total_count = 0;
+                size_t                      total_bytes = 0;
+                for (const auto& [key, counts] : sites) {
+                        if (allocator == nullptr || key.allocator == allocator) {
+                                total_count += counts.count;
+                                total_bytes += counts.bytes;
+                        }
+                }
+
+                // Arena memory is only released in bulk, so in-use and allocated columns are identical.
+                fprintf(out, "heap profile: %zu: %zu [%zu: %zu] @ heap_v2/%zu\n", total_count, total_bytes,
+                        total_count, total_bytes, profile_rate.load(std::memory_order_relaxed));
+                for (const auto& [key, counts] : sites) {
+                        if (allocator != nullptr && key.allocator != allocator) {
+                                continue;
+                        }
+                        fprintf(out, "%zu: %zu [%zu: %zu] @", counts.count, counts.bytes, counts.count, counts.bytes);
+                        for (int i = 0; i < key.depth; ++i) {
+                                fprintf(out, " %p", key.frames[i]);
+                        }
+                        fprintf(out, "\n");
+                }
+        }
+
+        // pprof needs the mappings to symbolize the recorded return addresses.
+        fprintf(out, "\nMAPPED_LIBRARIES:\n");
+        if (FILE* maps = fopen("/proc/self/maps", "r")) {
+                char   buffer[4096];
+                size_t read = 0;
+                while ((read = fread(buffer, 1, sizeof(buffer), maps)) > 0) {
+                        fwrite(buffer, 1, read, out);
+                }
+                fclose(maps);
+        }
+
+        const bool write_failed = ferror(out) != 0;
+        if (fclose(out) != 0 || write_failed) {
+                return ERR_IO_FAILURE;
+        }
+
+        return ERR_SUCCESS;
+}
+
+} // namespace anvil::memory::profiler
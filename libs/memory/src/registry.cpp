@@ -0,0 +1,114 @@
+#include "memory/registry.hpp"
+#include "internal/registry.hpp"
+#include "memory/constants.hpp"
+#include "memory/error.hpp"
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::size_t;
+
+namespace anvil::memory::registry {
+
+namespace {
+
+struct Record {
+        const void* allocator;
+        Kind        kind;
+        std::string name;
+};
+
+std::mutex          records_mutex;
+std::vector<Record> records;
+
+void upsert(const void* allocator, const Kind kind, const char* name) {
+        std::lock_guard<std::mutex> lock(records_mutex);
+        for (Record& record : records) {
+                if (record.allocator == allocator) {
+                        record.name = name;
+                        return;
+                }
+        }
+        records.push_back(Record{allocator, kind, name});
+}
+
+} // namespace
+
+namespace internal {
+
+ANVIL_ATTR_COLD void forget(const void* allocator) {
+        std::lock_guard<std::mutex> lock(records_mutex);
+        for (auto it = records.begin(); it != records.end(); ++it) {
+                if (it->allocator == allocator) {
+                        records.erase(it);
+                        return;
+                }
+        }
+}
+
+} // namespace internal
+
+Error add(scratch_allocator::ScratchAllocator* const allocator, const char* name) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_NOT_NULL(name);
+
+        upsert(allocator, Kind::Scratch, name);
+        scratch_allocator::internal::set_flags(allocator, ALLOCATOR_FLAG_REGISTERED, true);
+
+        return ERR_SUCCESS;
+}
+
+Error add(stack_allocator::StackAllocator* const allocator, const char* name) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_NOT_NULL(name);
+
+        upsert(allocator, Kind::Stack, name);
+        stack_allocator::internal::set_flags(allocator, ALLOCATOR_FLAG_REGISTERED, true);
+
+        return ERR_SUCCESS;
+}
+
+Error remove(scratch_allocator::ScratchAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        internal::forget(allocator);
+        scratch_allocator::internal::set_flags(allocator, ALLOCATOR_FLAG_REGISTERED, false);
+
+        return ERR_SUCCESS;
+}
+
+Error remove(stack_allocator::StackAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        internal::forget(allocator);
+        stack_allocator::internal::set_flags(allocator, ALLOCATOR_FLAG_REGISTERED, false);
+
+        return ERR_SUCCESS;
+}
+
+void visit(const Visitor visitor, void* context) {
+        ANVIL_INVARIANT_NOT_NULL(visitor);
+
+        std::lock_guard<std::mutex> lock(records_mutex);
+        for (const Record& record : records) {
+                Entry entry{};
+                entry.name      = record.name.c_str();
+                entry.kind      = record.kind;
+                entry.allocator = record.allocator;
+                if (record.kind == Kind::Scratch) {
+                        entry.stats = scratch_allocator::internal::load_counters(
+                            static_cast<const scratch_allocator::ScratchAllocator*>(record.allocator));
+                } else {
+                        entry.stats = stack_allocator::internal::load_counters(
+                            static_cast<const stack_allocator::StackAllocator*>(record.allocator));
+                }
+                visitor(entry, context);
+        }
+}
+
+size_t size() {
+        std::lock_guard<std::mutex> lock(records_mutex);
+        return records.size();
+}
+
+} // namespace anvil::memory::registry
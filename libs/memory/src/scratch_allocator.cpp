@@ -1,6 +1,9 @@
 #include "memory/scratch_allocator.hpp"
 #include "internal/memory_allocation.hpp"
+#include "internal/profiler.hpp"
+#include "internal/registry.hpp"
 #include "internal/utility.hpp"
+#include "memory/capacity_advisor.hpp"
 #include "memory/constants.hpp"
 #include "memory/error.hpp"
 
@@ -17,30 +20,77 @@ namespace anvil::memory::scratch_allocator {
  * @invariant allocated <= capacity
  *
  * @note This structure is typically placed at the beginning of the allocated memory region.
+ * @note Arenas created with mapping flags start at the next page boundary instead of right after the structure.
+ * @note Allocations only grow the watermark until reset, so the peak since the last reset is `allocated`.
  *
  * Field               | Type               | Size (Bytes)   | Description
  * ------------------- | ------------------ | -------------- | -----------------------------------------------
  * base                | void*              | sizeof(void*)  | Pointer to the start of the usable memory region
  * capacity            | size_t             | sizeof(size_t) | Total capacity of the scratch allocator in bytes
  * allocated           | size_t             | sizeof(size_t) | Current number of bytes allocated from the scratch
- * allocator allocation_strategy | AllocationStrategy | sizeof(size_t) | Allocation strategy (lazy virtual / eager
- * physical)
+ * allocation_strategy | AllocationStrategy | sizeof(size_t) | Allocation strategy (lazy virtual / eager physical)
+ * reset_count         | size_t             | sizeof(size_t) | Number of resets since creation
+ * exhaustion_count    | size_t             | sizeof(size_t) | Number of allocations that ran out of capacity
+ * advisor             | CapacityAdvisor*   | sizeof(void*)  | Optional advisor informed on reset
+ * flags               | size_t             | sizeof(size_t) | ALLOCATOR_FLAG_* bits
  */
 struct ScratchAllocator {
-        void*              base;
-        size_t             capacity;
-        size_t             allocated;
-        AllocationStrategy allocation_strategy;
+        void*                              base;
+        size_t                             capacity;
+        size_t                             allocated;
+        AllocationStrategy                 allocation_strategy;
+        size_t                             reset_count;
+        size_t                             exhaustion_count;
+        capacity_advisor::CapacityAdvisor* advisor;
+        size_t                             flags;
 };
-static_assert(sizeof(ScratchAllocator) == 32, "ScratchAllocator size must be 32 bytes");
+static_assert(sizeof(ScratchAllocator) == 64, "ScratchAllocator size must be 64 bytes");
 static_assert(alignof(ScratchAllocator) == alignof(void*), "ScratchAllocator alignment must match void* alignment");
 
-ScratchAllocator* create(const size_t capacity, const size_t alignment) {
+namespace {
+
+/**
+ * @brief Distance from the allocator to its arena, the header that mapping flags leave untouched.
+ */
+size_t arena_offset(const ScratchAllocator* const allocator) {
+        return reinterpret_cast<uintptr_t>(allocator->base) - reinterpret_cast<uintptr_t>(allocator);
+}
+
+/**
+ * @brief Body shared by `alloc` and `try_alloc`; inlined into both so neither pays for the other.
+ */
+ANVIL_ATTR_ALWAYS_INLINE inline AllocResult bump(ScratchAllocator* const allocator, const size_t allocation_size,
+                                                 const size_t alignment) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_POSITIVE(allocation_size);
+        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
+        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
+
+        const uintptr_t current_addr     = reinterpret_cast<uintptr_t>(allocator->base) + allocator->allocated;
+        const uintptr_t aligned_addr     = (current_addr + (alignment - 1)) & ~(alignment - 1);
+        const size_t    offset           = aligned_addr - current_addr;
+
+        const size_t    total_allocation = allocation_size + offset;
+
+        if (total_allocation > allocator->capacity - allocator->allocated) [[unlikely]] {
+                allocator->exhaustion_count++;
+                return {nullptr, ERR_OUT_OF_MEMORY};
+        }
+
+        allocator->allocated += total_allocation;
+        profiler::internal::account(allocator, allocation_size);
+        return {reinterpret_cast<void*>(aligned_addr), ERR_SUCCESS};
+}
+
+} // namespace
+
+ScratchAllocator* create(const size_t capacity, const size_t alignment, const MappingFlags mapping) {
         ANVIL_INVARIANT_POSITIVE(capacity);
         ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
         ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
 
-        const size_t      total_memory_needed = capacity + sizeof(ScratchAllocator) + alignment - 1;
+        const size_t      total_memory_needed =
+            capacity + sizeof(ScratchAllocator) + alignment - 1 + anvil_memory_arena_padding(mapping);
 
         ScratchAllocator* allocator =
             static_cast<ScratchAllocator*>(anvil_memory_alloc_eager(total_memory_needed, alignment));
@@ -49,9 +99,9 @@ ScratchAllocator* create(const size_t capacity, const size_t alignment) {
                 return nullptr;
         }
 
-        allocator->base = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(allocator) + sizeof(*allocator));
-        const size_t actually_available_capacity = total_memory_needed - (reinterpret_cast<uintptr_t>(allocator->base) -
-                                                                          reinterpret_cast<uintptr_t>(allocator));
+        allocator->base = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(allocator) +
+                                                  anvil_memory_arena_offset(allocator, sizeof(*allocator), mapping));
+        const size_t actually_available_capacity = total_memory_needed - arena_offset(allocator);
 
         if (actually_available_capacity < capacity) {
                 ANVIL_INVARIANT(anvil_memory_dealloc(allocator) == ERR_SUCCESS, INV_INVALID_STATE,
@@ -62,6 +112,16 @@ ScratchAllocator* create(const size_t capacity, const size_t alignment) {
         allocator->capacity            = capacity;
         allocator->allocated           = 0;
         allocator->allocation_strategy = AllocationStrategy::Eager;
+        allocator->reset_count         = 0;
+        allocator->exhaustion_count    = 0;
+        allocator->advisor             = nullptr;
+        allocator->flags               = 0;
+
+        if (mapping != MappingFlags::None && set_mapping_flags(allocator, mapping) != ERR_SUCCESS) {
+                ANVIL_INVARIANT(anvil_memory_dealloc(allocator) == ERR_SUCCESS, INV_INVALID_STATE,
+                                "Failed to Deallocate memory");
+                return nullptr;
+        }
 
         return allocator;
 }
@@ -70,6 +130,10 @@ Error destroy(ScratchAllocator** allocator) {
         ANVIL_INVARIANT_NOT_NULL(allocator);
         ANVIL_INVARIANT_NOT_NULL(*allocator);
 
+        if ((*allocator)->flags & ALLOCATOR_FLAG_REGISTERED) {
+                registry::internal::forget(*allocator);
+        }
+
         const Error dealloc_result = anvil_memory_dealloc(*allocator);
         if (::anvil::error::is_error(dealloc_result)) [[unlikely]] {
                 return dealloc_result;
@@ -80,33 +144,96 @@ Error destroy(ScratchAllocator** allocator) {
 }
 
 void* alloc(ScratchAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
-        ANVIL_INVARIANT_NOT_NULL(allocator);
-        ANVIL_INVARIANT_POSITIVE(allocation_size);
-        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
-        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
-
-        const uintptr_t current_addr     = reinterpret_cast<uintptr_t>(allocator->base) + allocator->allocated;
-        const uintptr_t aligned_addr     = (current_addr + (alignment - 1)) & ~(alignment - 1);
-        const size_t    offset           = aligned_addr - current_addr;
-
-        const size_t    total_allocation = allocation_size + offset;
-
-        if (total_allocation > allocator->capacity - allocator->allocated) {
-                return nullptr;
-        }
+        return bump(allocator, allocation_size, alignment).ptr;
+}
 
-        allocator->allocated += total_allocation;
-        return reinterpret_cast<void*>(aligned_addr);
+AllocResult try_alloc(ScratchAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
+        return bump(allocator, allocation_size, alignment);
 }
 
 Error reset(ScratchAllocator* const allocator) {
         ANVIL_INVARIANT_NOT_NULL(allocator);
         ANVIL_INVARIANT_NOT_NULL(allocator->base);
 
+        allocator->reset_count++;
+        if (allocator->advisor) {
+                capacity_advisor::observe_reset(allocator->advisor, allocator->allocated);
+        }
+
         //memset(allocator->base, 0x0, allocator->allocated);
         allocator->allocated = 0;
 
         return ERR_SUCCESS;
 }
 
+Error attach_advisor(ScratchAllocator* const allocator, capacity_advisor::CapacityAdvisor* const advisor) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        allocator->advisor = advisor;
+
+        return ERR_SUCCESS;
+}
+
+Error set_mapping_flags(ScratchAllocator* const allocator, const MappingFlags flags) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT((static_cast<size_t>(flags) & ~MAPPING_FLAGS_MASK) == 0, INV_OUT_OF_RANGE,
+                        "unknown mapping flags %zu", static_cast<size_t>(flags));
+
+        const Error advise_result = anvil_memory_set_mapping_flags(allocator, arena_offset(allocator), flags);
+        if (::anvil::error::is_error(advise_result)) [[unlikely]] {
+                // Advice is applied flag by flag; restore the previous treatment so the flags stay truthful.
+                static_cast<void>(
+                    anvil_memory_set_mapping_flags(allocator, arena_offset(allocator), mapping_flags(allocator)));
+                return advise_result;
+        }
+        allocator->flags = (allocator->flags & ~(MAPPING_FLAGS_MASK << ALLOCATOR_FLAG_MAPPING_SHIFT)) |
+                           (static_cast<size_t>(flags) << ALLOCATOR_FLAG_MAPPING_SHIFT);
+
+        return ERR_SUCCESS;
+}
+
+MappingFlags mapping_flags(const ScratchAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        return static_cast<MappingFlags>((allocator->flags >> ALLOCATOR_FLAG_MAPPING_SHIFT) & MAPPING_FLAGS_MASK);
+}
+
+AllocatorStats stats(const ScratchAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        AllocatorStats result = internal::load_counters(allocator);
+        if (allocator->advisor) {
+                const capacity_advisor::Recommendation recommendation = capacity_advisor::recommend(allocator->advisor);
+                result.recommended_capacity     = recommendation.capacity;
+                result.recommended_commit_chunk = recommendation.commit_chunk;
+        }
+
+        return result;
+}
+
+namespace internal {
+
+AllocatorStats load_counters(const ScratchAllocator* const allocator) {
+        AllocatorStats result{};
+        result.capacity         = allocator->capacity;
+        result.allocated        = load_relaxed(allocator->allocated);
+        result.committed        = allocator->capacity;
+        result.peak             = result.allocated;
+        result.reset_count      = load_relaxed(allocator->reset_count);
+        result.exhaustion_count = load_relaxed(allocator->exhaustion_count);
+        return result;
+}
+
+void set_flags(ScratchAllocator* const allocator, const size_t flags, const bool enabled) {
+        allocator->flags = enabled ? (allocator->flags | flags) : (allocator->flags & ~flags);
+}
+
+bool owns(const ScratchAllocator* const allocator, const void* const ptr) {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        const uintptr_t base    = reinterpret_cast<uintptr_t>(allocator->base);
+        return address >= base && address - base < allocator->allocated;
+}
+
+} // namespace internal
+
 } // namespace anvil::memory::scratch_allocator
\ No newline at end of file
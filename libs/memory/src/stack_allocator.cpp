@@ -1,6 +1,10 @@
 #include "memory/stack_allocator.hpp"
+#include "internal/fault_handler.hpp"
 #include "internal/memory_allocation.hpp"
+#include "internal/profiler.hpp"
+#include "internal/registry.hpp"
 #include "internal/utility.hpp"
+#include "memory/capacity_advisor.hpp"
 #include "memory/constants.hpp"
 #include "memory/error.hpp"
 
@@ -15,68 +19,257 @@ namespace anvil::memory::stack_allocator {
  * The allocator maintains an internal stack of allocation markers that enable
  * efficient bulk deallocation back to any recorded checkpoint.
  *
- * Memory layout: [StackAllocator metadata][usable memory region]
+ * Memory layout: [StackAllocator metadata][usable memory region]. Arenas created with mapping flags start at the
+ * next page boundary instead, so that the flags cover all of them.
  *
  * @invariant base != nullptr (after successful initialization)
  * @invariant capacity > 0
- * @invariant 0 <= allocated <= capacity
+ * @invariant 0 <= allocated <= limit <= capacity, and limit <= committed unless the allocator is Guarded
+ * @invariant limit <= budget_end, and allocated <= budget_end
  * @invariant 0 <= stack_depth <= MAX_STACK_DEPTH
- * @invariant allocation_strategy == AllocationStrategy::Eager || allocation_strategy == AllocationStrategy::Lazy
- * @invariant For all i < stack_depth: stack[i] <= allocated
+ * @invariant allocation_strategy is Eager, Lazy or Guarded
+ * @invariant For all i < stack_depth: stack[i] <= scope_peak[i] and stack[i] <= allocated
+ * @invariant For all i < stack_depth: budget_end <= scope_budget[i]
  *
  * @note This is the internal definition. The public API uses an opaque forward declaration.
  * @note The structure is placed at the beginning of the allocated memory region.
  * @note Total memory footprint is sizeof(StackAllocator) + capacity bytes.
+ * @note `alloc` only compares against `limit`; everything else (lazy commits, exhaustion accounting, budgets)
+ *       lives in the out-of-line slow path.
+ * @note Scope budgets cap `limit` at `budget_end`, so an allocation over budget takes the slow path like one
+ *       that needs a commit, and the slow path tells the two apart.
+ * @note Guarded allocators reserve GUARD_REGION_SIZE more bytes past the capacity that are never committed.
+ *       Their limit is the capacity: `commit_on_fault` commits the tail when it is touched and treats faults
+ *       in the guard region as exhaustion. `alloc_unchecked` may leave `allocated` past the capacity.
  *
  * Field               | Type               | Size (Bytes)      | Description
- * ------------------- | ------------------ | ----------------- |
- * -------------------------------------------------------- base                | void*              | sizeof(void*) |
- * Pointer to the start of the usable memory region capacity            | size_t             | sizeof(size_t)    | Total
- * capacity of usable memory in bytes allocated           | size_t             | sizeof(size_t)    | Current number of
- * bytes allocated (allocation watermark) allocation_strategy | AllocationStrategy | sizeof(size_t)    | Allocation
- * strategy (eager physical / lazy virtual) stack_depth         | size_t             | sizeof(size_t)    | Current depth
- * of the record/unwind stack stack               | size_t[]           | MAX_STACK_DEPTH*8 | Stack of allocation markers
- * for record/unwind operations
+ * ------------------- | ------------------ | ----------------- | ------------------------------------------------
+ * base                | void*              | sizeof(void*)     | Pointer to the start of the usable memory region
+ * capacity            | size_t             | sizeof(size_t)    | Total capacity of usable memory in bytes
+ * allocated           | size_t             | sizeof(size_t)    | Current allocation watermark
+ * committed           | size_t             | sizeof(size_t)    | Usable bytes backed by read/write pages
+ * limit               | size_t             | sizeof(size_t)    | Watermark the fast path may allocate up to
+ * allocation_strategy | AllocationStrategy | sizeof(size_t)    | Allocation strategy (eager / lazy / guarded)
+ * commit_chunk        | size_t             | sizeof(size_t)    | Minimum bytes committed by one lazy commit
+ * peak                | size_t             | sizeof(size_t)    | Highest watermark since reset, settled lazily
+ * reset_count         | size_t             | sizeof(size_t)    | Number of resets since creation
+ * exhaustion_count    | size_t             | sizeof(size_t)    | Number of allocations that ran out of capacity
+ * advisor             | CapacityAdvisor*   | sizeof(void*)     | Optional advisor informed on reset and unwind
+ * flags               | size_t             | sizeof(size_t)    | ALLOCATOR_FLAG_* bits
+ * stack_depth         | size_t             | sizeof(size_t)    | Current depth of the record/unwind stack
+ * budget_end          | size_t             | sizeof(size_t)    | Watermark the open scopes may reach, or NO_BUDGET
+ * stack               | size_t[]           | MAX_STACK_DEPTH*8 | Watermarks saved by record
+ * scope_peak          | size_t[]           | MAX_STACK_DEPTH*8 | Highest watermark observed inside each scope
+ * scope_budget        | size_t[]           | MAX_STACK_DEPTH*8 | Budget ends saved by record
  *
- * @note On 64-bit systems: sizeof(StackAllocator) = 8 + 8 + 8 + 8 + 8 + (64 * 8) = 552 bytes
+ * @note On 64-bit systems: sizeof(StackAllocator) = 14 * 8 + 3 * (64 * 8) = 1648 bytes
  */
 struct StackAllocator {
-        void*              base;                                  ///< Start of usable memory region
-        size_t             capacity;                              ///< Total usable capacity in bytes
-        size_t             allocated;                             ///< Current allocation watermark
-        AllocationStrategy allocation_strategy;                   ///< Allocation strategy (eager or lazy provisioning)
-        size_t             stack_depth;                           ///< Current record/unwind stack depth
-        size_t             stack[anvil::memory::MAX_STACK_DEPTH]; ///< Array of allocation checkpoints
+        void*              base;                                         ///< Start of usable memory region
+        size_t             capacity;                                     ///< Total usable capacity in bytes
+        size_t             allocated;                                    ///< Current allocation watermark
+        size_t             committed;                                    ///< Usable bytes backed by read/write pages
+        size_t             limit;                                        ///< Fast path allocation bound
+        AllocationStrategy allocation_strategy;                          ///< Eager, Lazy or Guarded
+        size_t             commit_chunk;                                 ///< Minimum size of a lazy commit
+        size_t             peak;                                         ///< Highest watermark since the last reset
+        size_t             reset_count;                                  ///< Resets since creation
+        size_t             exhaustion_count;                             ///< Allocations that failed for capacity
+        capacity_advisor::CapacityAdvisor* advisor;                      ///< Optional capacity advisor
+        size_t             flags;                                        ///< ALLOCATOR_FLAG_* bits
+        size_t             stack_depth;                                  ///< Current record/unwind stack depth
+        size_t             budget_end;                                   ///< Watermark the open scopes may reach
+        size_t             stack[anvil::memory::MAX_STACK_DEPTH];        ///< Array of allocation checkpoints
+        size_t             scope_peak[anvil::memory::MAX_STACK_DEPTH];   ///< Peak watermark inside each scope
+        size_t             scope_budget[anvil::memory::MAX_STACK_DEPTH]; ///< Budget end before each record
 };
 static_assert(sizeof(AllocationStrategy) == sizeof(std::size_t), "AllocationStrategy must match size_t size");
-static_assert(sizeof(StackAllocator) == 552, "StackAllocator size must be 552 bytes");
+static_assert(sizeof(StackAllocator) == 1648, "StackAllocator size must be 1648 bytes");
 static_assert(alignof(StackAllocator) == alignof(void*), "StackAllocator alignment must match void* alignment");
 
-StackAllocator* create(const size_t capacity, const size_t alignment, const AllocationStrategy strategy) {
+namespace {
+
+/**
+ * @brief Distance from the allocator to its arena, the header that mapping flags leave untouched.
+ */
+size_t arena_offset(const StackAllocator* const allocator) {
+        return reinterpret_cast<uintptr_t>(allocator->base) - reinterpret_cast<uintptr_t>(allocator);
+}
+
+/**
+ * @brief Recomputes the fast path bound from the committed range and the budget of the open scopes.
+ */
+void sync_limit(StackAllocator* const allocator) {
+        const size_t limit = allocator->allocation_strategy == AllocationStrategy::Guarded ? allocator->capacity
+                                                                                           : allocator->committed;
+        allocator->limit   = limit < allocator->budget_end ? limit : allocator->budget_end;
+}
+
+/**
+ * @brief Refreshes the committed byte count of a lazy or guarded allocator from its mapping.
+ */
+void sync_committed(StackAllocator* const allocator) {
+        const size_t mapped    = anvil_memory_committed_size(allocator);
+        const size_t offset    = arena_offset(allocator);
+        const size_t committed = mapped > offset ? mapped - offset : 0;
+        allocator->committed   = committed < allocator->capacity ? committed : allocator->capacity;
+        sync_limit(allocator);
+}
+
+/**
+ * @brief Highest watermark since the last reset, including scopes that are still open.
+ */
+size_t settled_peak(const StackAllocator* const allocator) {
+        const size_t allocated = load_relaxed(allocator->allocated);
+        const size_t recorded  = load_relaxed(allocator->peak);
+        size_t       peak      = recorded > allocated ? recorded : allocated;
+        const size_t depth     = load_relaxed(allocator->stack_depth);
+        for (size_t i = 0; i < depth && i < MAX_STACK_DEPTH; ++i) {
+                const size_t scope_peak = load_relaxed(allocator->scope_peak[i]);
+                peak                    = scope_peak > peak ? scope_peak : peak;
+        }
+        return peak;
+}
+
+/**
+ * @brief Slow path of `alloc` and `try_alloc`, taken when an allocation does not fit below `limit`.
+ *
+ * Lazy allocators commit at least `commit_chunk` more bytes and retry; allocations that do not fit in
+ * the capacity are counted as exhaustion, and those that only overrun the budget of the open scopes fail
+ * without touching the counters.
+ */
+ANVIL_ATTR_COLD ANVIL_ATTR_NOINLINE AllocResult alloc_slow(StackAllocator* const allocator,
+                                                           const size_t allocation_size, const size_t total_allocation,
+                                                           const uintptr_t aligned_addr) {
+        if (total_allocation > allocator->capacity - allocator->allocated) {
+                allocator->exhaustion_count++;
+                return {nullptr, ERR_OUT_OF_MEMORY};
+        }
+        if (total_allocation > allocator->budget_end - allocator->allocated) {
+                return {nullptr, ERR_BUDGET_EXHAUSTED};
+        }
+
+        const size_t required  = allocator->allocated + total_allocation - allocator->committed;
+        const size_t remaining = allocator->capacity - allocator->committed;
+        size_t       chunk     = required > allocator->commit_chunk ? required : allocator->commit_chunk;
+        chunk                  = chunk < remaining ? chunk : remaining;
+
+        const Error commit_result = anvil_memory_commit(allocator, chunk);
+        if (commit_result != ERR_SUCCESS) {
+                return {nullptr, commit_result};
+        }
+        sync_committed(allocator);
+
+        allocator->allocated += total_allocation;
+        profiler::internal::account(allocator, allocation_size);
+        return {reinterpret_cast<void*>(aligned_addr), ERR_SUCCESS};
+}
+
+/**
+ * @brief Body shared by `alloc` and `try_alloc`; inlined into both so neither pays for the other.
+ */
+ANVIL_ATTR_ALWAYS_INLINE inline AllocResult bump(StackAllocator* const allocator, const size_t allocation_size,
+                                                 const size_t alignment) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_POSITIVE(allocation_size);
+        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
+        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
+
+        const uintptr_t current_addr     = reinterpret_cast<uintptr_t>(allocator->base) + allocator->allocated;
+        const uintptr_t aligned_addr     = (current_addr + (alignment - 1)) & ~(alignment - 1);
+        const size_t    offset           = aligned_addr - current_addr;
+
+        const size_t    total_allocation = allocation_size + offset;
+
+        if (total_allocation > allocator->limit - allocator->allocated) [[unlikely]] {
+                return alloc_slow(allocator, allocation_size, total_allocation, aligned_addr);
+        }
+
+        allocator->allocated += total_allocation;
+        profiler::internal::account(allocator, allocation_size);
+        return {reinterpret_cast<void*>(aligned_addr), ERR_SUCCESS};
+}
+
+/**
+ * @brief Fault callback of guarded allocators; commits at least `commit_chunk` bytes up to the faulting page.
+ *
+ * Runs in the SIGSEGV handler on the thread that touched the page, which is the thread using the allocator.
+ * A fault past the capacity is counted as exhaustion and left to the handler to report.
+ */
+bool commit_on_fault(void* const owner, const uintptr_t address) {
+        StackAllocator* const allocator = static_cast<StackAllocator*>(owner);
+        const uintptr_t       base      = reinterpret_cast<uintptr_t>(allocator->base);
+        if (address >= base + allocator->capacity) {
+                allocator->exhaustion_count++;
+                return false;
+        }
+        if (address < base + allocator->committed) {
+                return false;
+        }
+
+        const size_t required  = address - base + 1 - allocator->committed;
+        const size_t remaining = allocator->capacity - allocator->committed;
+        size_t       chunk     = required > allocator->commit_chunk ? required : allocator->commit_chunk;
+        chunk                  = chunk < remaining ? chunk : remaining;
+
+        if (anvil_memory_commit(allocator, chunk) != ERR_SUCCESS) {
+                return false;
+        }
+        sync_committed(allocator);
+        return true;
+}
+
+/**
+ * @brief Applies an adaptive advisor's recommendation to a lazy allocator between frames.
+ */
+void adapt(StackAllocator* const allocator) {
+        const capacity_advisor::Recommendation recommendation = capacity_advisor::recommend(allocator->advisor);
+        if (recommendation.observations == 0) {
+                return;
+        }
+
+        allocator->commit_chunk = recommendation.commit_chunk;
+        if (allocator->committed > recommendation.capacity) {
+                if (anvil_memory_decommit(allocator, arena_offset(allocator) + recommendation.capacity) ==
+                    ERR_SUCCESS) {
+                        sync_committed(allocator);
+                }
+        }
+}
+
+} // namespace
+
+StackAllocator* create(const size_t capacity, const size_t alignment, const AllocationStrategy strategy,
+                       const MappingFlags mapping) {
         ANVIL_INVARIANT_POSITIVE(capacity);
         ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
         ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
-        ANVIL_INVARIANT((strategy == AllocationStrategy::Eager) || (strategy == AllocationStrategy::Lazy),
-                        INV_PRECONDITION, "allocation strategy, not lazy nor eager, but was %zu",
+        ANVIL_INVARIANT((strategy == AllocationStrategy::Eager) || (strategy == AllocationStrategy::Lazy) ||
+                            (strategy == AllocationStrategy::Guarded),
+                        INV_PRECONDITION, "allocation strategy, not lazy, eager nor guarded, but was %zu",
                         static_cast<std::size_t>(strategy));
 
-        const size_t    total_memory_needed = capacity + sizeof(StackAllocator) + alignment - 1;
+        const size_t    total_memory_needed =
+            capacity + sizeof(StackAllocator) + alignment - 1 + anvil_memory_arena_padding(mapping);
 
         StackAllocator* allocator           = nullptr;
 
         if (strategy == AllocationStrategy::Eager) {
                 allocator = static_cast<StackAllocator*>(anvil_memory_alloc_eager(total_memory_needed, alignment));
-        } else {
+        } else if (strategy == AllocationStrategy::Lazy) {
                 allocator = static_cast<StackAllocator*>(anvil_memory_alloc_lazy(total_memory_needed, alignment));
+        } else {
+                allocator = static_cast<StackAllocator*>(
+                    anvil_memory_alloc_lazy(total_memory_needed + GUARD_REGION_SIZE, alignment));
         }
 
         if (!allocator) {
                 return nullptr;
         }
 
-        allocator->base = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(allocator) + sizeof(*allocator));
-        const size_t actual_available_capacity = total_memory_needed - (reinterpret_cast<uintptr_t>(allocator->base) -
-                                                                        reinterpret_cast<uintptr_t>(allocator));
+        allocator->base = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(allocator) +
+                                                  anvil_memory_arena_offset(allocator, sizeof(*allocator), mapping));
+        const size_t actual_available_capacity = total_memory_needed - arena_offset(allocator);
 
         if (actual_available_capacity < capacity) {
                 ANVIL_INVARIANT(anvil_memory_dealloc(allocator) == ERR_SUCCESS, INV_INVALID_STATE,
@@ -86,8 +279,36 @@ StackAllocator* create(const size_t capacity, const size_t alignment, const Allo
 
         allocator->capacity            = capacity;
         allocator->allocated           = 0;
+        allocator->committed           = capacity;
+        allocator->limit               = capacity;
         allocator->allocation_strategy = strategy;
+        allocator->commit_chunk        = DEFAULT_COMMIT_CHUNK;
+        allocator->peak                = 0;
+        allocator->reset_count         = 0;
+        allocator->exhaustion_count    = 0;
+        allocator->advisor             = nullptr;
+        allocator->flags               = 0;
         allocator->stack_depth         = 0;
+        allocator->budget_end          = NO_BUDGET;
+
+        if (strategy != AllocationStrategy::Eager) {
+                sync_committed(allocator);
+        }
+
+        if (strategy == AllocationStrategy::Guarded) {
+                const uintptr_t base = reinterpret_cast<uintptr_t>(allocator->base);
+                if (memory::internal::watch(allocator, base, base + capacity + GUARD_REGION_SIZE, commit_on_fault) !=
+                    ERR_SUCCESS) {
+                        ANVIL_INVARIANT(anvil_memory_dealloc(allocator) == ERR_SUCCESS, INV_INVALID_STATE,
+                                        "Failed to Deallocate memory");
+                        return nullptr;
+                }
+        }
+
+        if (mapping != MappingFlags::None && set_mapping_flags(allocator, mapping) != ERR_SUCCESS) {
+                ANVIL_INVARIANT(destroy(&allocator) == ERR_SUCCESS, INV_INVALID_STATE, "Failed to Deallocate memory");
+                return nullptr;
+        }
 
         return allocator;
 }
@@ -96,6 +317,13 @@ Error destroy(StackAllocator** allocator) {
         ANVIL_INVARIANT_NOT_NULL(allocator);
         ANVIL_INVARIANT_NOT_NULL(*allocator);
 
+        if ((*allocator)->flags & ALLOCATOR_FLAG_REGISTERED) {
+                registry::internal::forget(*allocator);
+        }
+        if ((*allocator)->allocation_strategy == AllocationStrategy::Guarded) {
+                memory::internal::unwatch(*allocator);
+        }
+
         const Error dealloc_result = anvil_memory_dealloc(*allocator);
         if (::anvil::error::is_error(dealloc_result)) [[unlikely]] {
                 return dealloc_result;
@@ -109,40 +337,44 @@ Error reset(StackAllocator* const allocator) {
         ANVIL_INVARIANT_NOT_NULL(allocator);
         ANVIL_INVARIANT_NOT_NULL(allocator->base);
 
+        const size_t high_water = settled_peak(allocator);
+        allocator->reset_count++;
+        if (allocator->advisor) {
+                capacity_advisor::observe_reset(allocator->advisor, high_water);
+                if (allocator->allocation_strategy == AllocationStrategy::Lazy &&
+                    capacity_advisor::mode(allocator->advisor) == capacity_advisor::Mode::Adaptive) {
+                        adapt(allocator);
+                }
+        }
+
         //memset(allocator->base, 0x0, allocator->allocated);
         allocator->allocated   = 0;
+        allocator->peak        = 0;
         allocator->stack_depth = 0;
+        allocator->budget_end  = NO_BUDGET;
+        sync_limit(allocator);
 
         return ERR_SUCCESS;
 }
 
 void* alloc(StackAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
-        ANVIL_INVARIANT_NOT_NULL(allocator);
-        ANVIL_INVARIANT_POSITIVE(allocation_size);
-        ANVIL_INVARIANT(is_power_of_two(alignment), INV_BAD_ALIGNMENT, "alignment was %zu", alignment);
-        ANVIL_INVARIANT_RANGE(alignment, MIN_ALIGNMENT, MAX_ALIGNMENT);
-
-        const uintptr_t current_addr     = reinterpret_cast<uintptr_t>(allocator->base) + allocator->allocated;
-        const uintptr_t aligned_addr     = (current_addr + (alignment - 1)) & ~(alignment - 1);
-        const size_t    offset           = aligned_addr - current_addr;
+        return bump(allocator, allocation_size, alignment).ptr;
+}
 
-        const size_t    total_allocation = allocation_size + offset;
+AllocResult try_alloc(StackAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
+        return bump(allocator, allocation_size, alignment);
+}
 
-        if (total_allocation > allocator->capacity - allocator->allocated) {
-                return nullptr;
-        }
+void* alloc_unchecked(StackAllocator* const allocator, const size_t allocation_size, const size_t alignment) {
+        const uintptr_t base         = reinterpret_cast<uintptr_t>(allocator->base);
+        const uintptr_t aligned_addr = (base + allocator->allocated + (alignment - 1)) & ~(alignment - 1);
 
-        if (allocator->allocation_strategy == AllocationStrategy::Lazy) {
-                if (anvil_memory_commit(allocator, total_allocation) != ERR_SUCCESS) {
-                        return nullptr;
-                }
-        }
-        allocator->allocated += total_allocation;
+        allocator->allocated         = aligned_addr + allocation_size - base;
         return reinterpret_cast<void*>(aligned_addr);
 }
 
 [[nodiscard]]
-Error record(StackAllocator* const allocator) {
+Error record(StackAllocator* const allocator, const size_t budget) {
         ANVIL_INVARIANT_NOT_NULL(allocator);
         ANVIL_INVARIANT_NOT_NULL(allocator->base);
 
@@ -150,9 +382,17 @@ Error record(StackAllocator* const allocator) {
                 return ERR_STACK_OVERFLOW;
         }
 
-        allocator->stack[allocator->stack_depth] = allocator->allocated;
+        allocator->stack[allocator->stack_depth]        = allocator->allocated;
+        allocator->scope_peak[allocator->stack_depth]   = allocator->allocated;
+        allocator->scope_budget[allocator->stack_depth] = allocator->budget_end;
         allocator->stack_depth++;
 
+        // A nested scope can only narrow the budget it inherits; NO_BUDGET never narrows it.
+        if (budget < allocator->budget_end - allocator->allocated) {
+                allocator->budget_end = allocator->allocated + budget;
+                sync_limit(allocator);
+        }
+
         return ERR_SUCCESS;
 }
 
@@ -162,11 +402,103 @@ Error unwind(StackAllocator* const allocator) {
                         "Cannot unwind from empty stack (stack_depth = %zu)", allocator->stack_depth);
         ANVIL_INVARIANT_RANGE(allocator->stack_depth, 1, MAX_STACK_DEPTH - 1);
 
-        uintptr_t restored_allocated = allocator->stack[allocator->stack_depth - 1];
-        allocator->allocated         = restored_allocated;
+        // The watermark only drops on unwind, so the peak of a scope is settled here and handed to its parent.
+        const size_t depth              = allocator->stack_depth - 1;
+        const size_t restored_allocated = allocator->stack[depth];
+        const size_t scope_peak         = allocator->scope_peak[depth] > allocator->allocated
+                                              ? allocator->scope_peak[depth]
+                                              : allocator->allocated;
+        if (depth > 0 && allocator->scope_peak[depth - 1] < scope_peak) {
+                allocator->scope_peak[depth - 1] = scope_peak;
+        }
+        if (allocator->peak < scope_peak) {
+                allocator->peak = scope_peak;
+        }
+        if (allocator->advisor) {
+                capacity_advisor::observe_scope(allocator->advisor, scope_peak - restored_allocated);
+        }
+
+        allocator->allocated = restored_allocated;
+        if (allocator->budget_end != allocator->scope_budget[depth]) {
+                allocator->budget_end = allocator->scope_budget[depth];
+                sync_limit(allocator);
+        }
         allocator->stack_depth--;
 
         return ERR_SUCCESS;
 }
 
+Error set_commit_chunk(StackAllocator* const allocator, const size_t commit_chunk) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT_POSITIVE(commit_chunk);
+
+        allocator->commit_chunk = commit_chunk;
+
+        return ERR_SUCCESS;
+}
+
+Error attach_advisor(StackAllocator* const allocator, capacity_advisor::CapacityAdvisor* const advisor) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        allocator->advisor = advisor;
+
+        return ERR_SUCCESS;
+}
+
+Error set_mapping_flags(StackAllocator* const allocator, const MappingFlags flags) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+        ANVIL_INVARIANT((static_cast<size_t>(flags) & ~MAPPING_FLAGS_MASK) == 0, INV_OUT_OF_RANGE,
+                        "unknown mapping flags %zu", static_cast<size_t>(flags));
+
+        const Error advise_result = anvil_memory_set_mapping_flags(allocator, arena_offset(allocator), flags);
+        if (::anvil::error::is_error(advise_result)) [[unlikely]] {
+                // Advice is applied flag by flag; restore the previous treatment so the flags stay truthful.
+                static_cast<void>(
+                    anvil_memory_set_mapping_flags(allocator, arena_offset(allocator), mapping_flags(allocator)));
+                return advise_result;
+        }
+        allocator->flags = (allocator->flags & ~(MAPPING_FLAGS_MASK << ALLOCATOR_FLAG_MAPPING_SHIFT)) |
+                           (static_cast<size_t>(flags) << ALLOCATOR_FLAG_MAPPING_SHIFT);
+
+        return ERR_SUCCESS;
+}
+
+MappingFlags mapping_flags(const StackAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        return static_cast<MappingFlags>((allocator->flags >> ALLOCATOR_FLAG_MAPPING_SHIFT) & MAPPING_FLAGS_MASK);
+}
+
+AllocatorStats stats(const StackAllocator* const allocator) {
+        ANVIL_INVARIANT_NOT_NULL(allocator);
+
+        AllocatorStats result = internal::load_counters(allocator);
+        if (allocator->advisor) {
+                const capacity_advisor::Recommendation recommendation = capacity_advisor::recommend(allocator->advisor);
+                result.recommended_capacity     = recommendation.capacity;
+                result.recommended_commit_chunk = recommendation.commit_chunk;
+        }
+
+        return result;
+}
+
+namespace internal {
+
+AllocatorStats load_counters(const StackAllocator* const allocator) {
+        AllocatorStats result{};
+        result.capacity         = allocator->capacity;
+        result.allocated        = load_relaxed(allocator->allocated);
+        result.committed        = load_relaxed(allocator->committed);
+        result.peak             = settled_peak(allocator);
+        result.reset_count      = load_relaxed(allocator->reset_count);
+        result.exhaustion_count = load_relaxed(allocator->exhaustion_count);
+        return result;
+}
+
+void set_flags(StackAllocator* const allocator, const size_t flags, const bool enabled) {
+        allocator->flags = enabled ? (allocator->flags | flags) : (allocator->flags & ~flags);
+}
+
+} // namespace internal
+
 } // namespace anvil::memory::stack_allocator
@@ -0,0 +1,42 @@
+#include "memory/stats.hpp"
+#include "internal/stats.hpp"
+#include "memory/constants.hpp"
+#include <atomic>
+
+using std::size_t;
+
+namespace anvil::memory {
+
+namespace {
+
+std::atomic<size_t>   commit_counts[COMMIT_LATENCY_BUCKETS];
+std::atomic<size_t>   commit_count{0};
+std::atomic<uint64_t> commit_sum_ns{0};
+
+} // namespace
+
+namespace internal {
+
+void record_commit_latency(const uint64_t nanoseconds) {
+        const uint64_t microseconds = nanoseconds / 1000;
+        size_t         bucket       = microseconds == 0 ? 0 : static_cast<size_t>(64 - __builtin_clzll(microseconds));
+        bucket                      = bucket < COMMIT_LATENCY_BUCKETS ? bucket : COMMIT_LATENCY_BUCKETS - 1;
+
+        commit_counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        commit_count.fetch_add(1, std::memory_order_relaxed);
+        commit_sum_ns.fetch_add(nanoseconds, std::memory_order_relaxed);
+}
+
+} // namespace internal
+
+CommitLatencyHistogram commit_latency() {
+        CommitLatencyHistogram histogram{};
+        for (size_t i = 0; i < COMMIT_LATENCY_BUCKETS; ++i) {
+                histogram.counts[i] = commit_counts[i].load(std::memory_order_relaxed);
+        }
+        histogram.count  = commit_count.load(std::memory_order_relaxed);
+        histogram.sum_ns = static_cast<size_t>(commit_sum_ns.load(std::memory_order_relaxed));
+        return histogram;
+}
+
+} // namespace anvil::memory
@@ -1,6 +1,10 @@
 """Type stubs for anvil_memory module"""
 
-from typing import Optional
+from types import TracebackType
+from typing import Callable, Dict, Optional, Sequence, Tuple, Type, TypeVar, Union
+
+import numpy as np
+import numpy.typing as npt
 
 # Constants
 ERR_SUCCESS: int
@@ -8,28 +12,168 @@ ERR_OUT_OF_MEMORY: int
 ERR_MEMORY_PERMISSION_CHANGE: int
 ERR_MEMORY_DEALLOCATION: int
 ERR_MEMORY_WRITE_ERROR: int
+ERR_IO_FAILURE: int
+ERR_MEMORY_ADVICE: int
+ERR_FAULT_HANDLER: int
+ERR_BUDGET_EXHAUSTED: int
+ERR_INVALID_CONFIG: int
 EAGER: int
 LAZY: int
+GUARDED: int
+ADVISORY: int
+ADAPTIVE: int
+DEFAULT_COMMIT_CHUNK: int
+GUARD_REGION_SIZE: int
+MAPPING_NONE: int
+MAPPING_DONTFORK: int
+MAPPING_WIPEONFORK: int
+MAPPING_DONTDUMP: int
 MIN_ALIGNMENT: int
 MAX_ALIGNMENT: int
 MIN_ALIGNMENT_EXPONENT: int
 MAX_ALIGNMENT_EXPONENT: int
+PROFILER_DEFAULT_SAMPLE_RATE: int
+PYMEM_DOMAIN_RAW: int
+PYMEM_DOMAIN_MEM: int
+PYMEM_DOMAIN_OBJ: int
+
+class AllocationView:
+    """Writable buffer over an allocation; pass it to memoryview() or numpy.asarray()."""
+    @property
+    def valid(self) -> bool: ...
+    @property
+    def nbytes(self) -> int: ...
+    @property
+    def format(self) -> str: ...
+    @property
+    def shape(self) -> Tuple[int, ...]: ...
+    @property
+    def exports(self) -> int: ...
+
+_Native = TypeVar("_Native", bound="_NativeAllocator")
+
+class _NativeAllocator:
+    """Methods shared by ScratchAllocator and StackAllocator (not exported by the module)."""
+    def alloc(self, size: int, alignment: int = ...) -> Optional[int]: ...
+    def try_alloc(self, size: int, alignment: int = ...) -> Tuple[Optional[int], int]: ...
+    def alloc_many(self, sizes: npt.ArrayLike, alignment: int = ...) -> npt.NDArray[np.uint64]: ...
+    def reset(self) -> int: ...
+    def close(self) -> int: ...
+    def stats(self) -> Dict[str, int]: ...
+    def attach_advisor(self, advisor: Optional[object]) -> int: ...
+    def set_mapping_flags(self, flags: int) -> int: ...
+    def view(self, address: int, size: int, format: str = "B",
+             shape: Optional[Sequence[int]] = None) -> AllocationView: ...
+    def __enter__(self: _Native) -> _Native: ...
+    def __exit__(self, exc_type: Optional[Type[BaseException]], exc: Optional[BaseException],
+                 tb: Optional[TracebackType]) -> None: ...
+    @property
+    def capsule(self) -> object: ...
+    @property
+    def closed(self) -> bool: ...
+    @property
+    def capacity(self) -> int: ...
+    @property
+    def mapping_flags(self) -> int: ...
+
+class ScratchAllocator(_NativeAllocator):
+    def __init__(self, capacity: int, alignment: int = ..., mapping_flags: int = 0) -> None: ...
+
+class StackAllocator(_NativeAllocator):
+    def __init__(self, capacity: int, alignment: int = ..., strategy: int = ...,
+                 mapping_flags: int = 0) -> None: ...
+    def record(self, budget: Optional[int] = None) -> int: ...
+    def unwind(self) -> int: ...
+    def alloc_unchecked(self, size: int, alignment: int = ...) -> int: ...
+    def set_commit_chunk(self, commit_chunk: int) -> int: ...
+
+class NumpyArena:
+    """Context manager placing NumPy array data in an Anvil arena that is reset on exit.
+
+    Only present when the module was built against the NumPy headers.
+    """
+    def __init__(self, capacity: int, threshold: int = 1 << 20, strategy: int = ...) -> None: ...
+    def __enter__(self) -> "NumpyArena": ...
+    def __exit__(self, exc_type: Optional[Type[BaseException]], exc: Optional[BaseException],
+                 tb: Optional[TracebackType]) -> None: ...
+    def stats(self) -> Dict[str, Union[int, bool]]: ...
+    @property
+    def handler(self) -> object: ...
 
-def scratch_allocator_create(capacity: int, alignment: int) -> Optional[object]: ...
+def scratch_allocator_create(capacity: int, alignment: int, mapping_flags: int = 0) -> Optional[object]: ...
 def scratch_allocator_destroy(allocator: object) -> int: ...
 def scratch_allocator_alloc(allocator: object, size: int, alignment: int) -> Optional[object]: ...
 def scratch_allocator_reset(allocator: object) -> int: ...
+def scratch_allocator_attach_advisor(allocator: object, advisor: Optional[object]) -> int: ...
+def scratch_allocator_stats(allocator: object) -> Optional[Dict[str, int]]: ...
+def scratch_allocator_set_mapping_flags(allocator: object, flags: int) -> int: ...
+def scratch_allocator_mapping_flags(allocator: object) -> Optional[int]: ...
 def scratch_allocator_copy(allocator: object, data: bytes, n_bytes: int) -> Optional[object]: ...
 def scratch_allocator_move(allocator: int, data: int, n_bytes: int, free_func_ptr: int) -> Optional[object]: ... 
+def scratch_allocator_view(allocator: object, ptr: object, size: int, format: str = "B",
+                           shape: Optional[Sequence[int]] = None) -> AllocationView: ...
 
-def stack_allocator_create(capacity: int, alignment: int, alloc_mode: int) -> Optional[object]: ...
+def stack_allocator_create(capacity: int, alignment: int, alloc_mode: int,
+                           mapping_flags: int = 0) -> Optional[object]: ...
 def stack_allocator_destroy(allocator: object) -> int: ...
 def stack_allocator_alloc(allocator: object, size: int, alignment: int) -> Optional[object]: ...
 def stack_allocator_reset(allocator: object) -> int: ...
 def stack_allocator_copy(allocator: object, data: bytes, n_bytes: int) -> Optional[object]: ...
 def stack_allocator_move(allocator: int, data: int, n_bytes: int, free_func_ptr: int) -> Optional[object]: ...
-def stack_allocator_record(allocator: object) -> int: ...
+def stack_allocator_record(allocator: object, budget: Optional[int] = None) -> int: ...
 def stack_allocator_unwind(allocator: object) -> int: ...
+def stack_allocator_set_commit_chunk(allocator: object, commit_chunk: int) -> int: ...
+def stack_allocator_attach_advisor(allocator: object, advisor: Optional[object]) -> int: ...
+def stack_allocator_stats(allocator: object) -> Optional[Dict[str, int]]: ...
+def stack_allocator_set_mapping_flags(allocator: object, flags: int) -> int: ...
+def stack_allocator_mapping_flags(allocator: object) -> Optional[int]: ...
+def stack_allocator_view(allocator: object, ptr: object, size: int, format: str = "B",
+                         shape: Optional[Sequence[int]] = None) -> AllocationView: ...
+
+def deferred_allocator_create(capacity: int, alignment: int, mapping_flags: int = 0) -> object: ...
+def deferred_allocator_destroy(allocator: object) -> int: ...
+def deferred_allocator_alloc(allocator: object, size: int, alignment: int) -> Optional[object]: ...
+def deferred_allocator_try_alloc(allocator: object, size: int, alignment: int) -> Tuple[Optional[object], int]: ...
+def deferred_allocator_reset(allocator: object) -> int: ...
+def deferred_allocator_mapped(allocator: object) -> bool: ...
+def deferred_allocator_stats(allocator: object) -> Optional[Dict[str, int]]: ...
+
+def generational_allocator_create(young_capacity: int, old_capacity: int, alignment: int,
+                                  mapping_flags: int = 0) -> Optional[object]: ...
+def generational_allocator_destroy(allocator: object) -> int: ...
+def generational_allocator_alloc(allocator: object, size: int, alignment: int) -> Optional[object]: ...
+def generational_allocator_promote(allocator: object, ptr: object, size: int) -> Optional[object]: ...
+def generational_allocator_forward(allocator: object, ptr: object) -> Optional[object]: ...
+def generational_allocator_advance(allocator: object, tracer: Optional[Callable[[], None]] = None) -> int: ...
+def generational_allocator_compact(allocator: object, tracer: Callable[[], None]) -> int: ...
+def generational_allocator_stats(allocator: object) -> Optional[Dict[str, Union[int, Dict[str, int]]]]: ...
+
+def capacity_advisor_create(window: int, mode: int) -> Optional[object]: ...
+def capacity_advisor_destroy(advisor: object) -> int: ...
+def capacity_advisor_recommend(advisor: object) -> Optional[Dict[str, int]]: ...
+
+def profiler_enable(sample_rate: int) -> None: ...
+def profiler_disable() -> None: ...
+def profiler_clear() -> None: ...
+def profiler_sample_count(allocator: Optional[object] = None) -> int: ...
+def profiler_dump(path: str, allocator: Optional[object] = None) -> int: ...
+
+def config_load() -> int: ...
+def config_resolve(name: str, capacity: int, alignment: int = ..., strategy: int = ...,
+                   commit_chunk: int = ..., mapping_flags: int = 0) -> Dict[str, int]: ...
+
+def registry_add(allocator: object, name: str) -> int: ...
+def registry_remove(allocator: object) -> int: ...
+def registry_size() -> int: ...
+def metrics_render() -> str: ...
+def metrics_exporter_start_unix(path: str) -> Optional[object]: ...
+def metrics_exporter_start_tcp(port: int = 0) -> Optional[object]: ...
+def metrics_exporter_port(exporter: object) -> int: ...
+def metrics_exporter_stop(exporter: object) -> int: ...
+
+def pymem_install(domain: int, capacity: int = 1 << 30, max_size: int = 512) -> int: ...
+def pymem_uninstall(domain: int) -> bool: ...
+def pymem_stats(domain: int) -> Dict[str, Union[int, bool]]: ...
 
 def read_bytes(ptr: object, size: int) -> bytes: ...
 def ptr_to_int(ptr: object) -> int: ...
@@ -0,0 +1,86 @@
+"""Tests for zero-copy buffer views over allocations."""
+
+import struct
+
+import pytest
+
+import anvil_memory as am
+
+
+def test_view_writes_are_visible_in_place():
+    allocator = am.scratch_allocator_create(1 << 16, am.MIN_ALIGNMENT)
+    ptr = am.scratch_allocator_alloc(allocator, 64, 8)
+    view = am.scratch_allocator_view(allocator, ptr, 64)
+    assert view.valid and view.nbytes == 64 and view.shape == (64,)
+
+    with memoryview(view) as mv:
+        assert not mv.readonly and mv.format == "B"
+        mv[:5] = b"hello"
+        assert view.exports == 1
+    assert view.exports == 0
+    assert am.read_bytes(ptr, 5) == b"hello"
+
+    am.write_bytes(ptr, b"world")
+    assert bytes(memoryview(view)[:5]) == b"world"
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def test_view_honours_format_and_shape():
+    allocator = am.stack_allocator_create(1 << 16, am.MIN_ALIGNMENT, am.EAGER)
+    ptr = am.stack_allocator_alloc(allocator, 48, 8)
+    view = am.stack_allocator_view(allocator, ptr, 48, "d", (2, 3))
+    assert view.shape == (2, 3) and view.nbytes == 48
+
+    with memoryview(view) as mv:
+        assert mv.format == "d" and mv.shape == (2, 3) and mv.strides == (24, 8)
+        mv[1, 2] = 2.5
+    assert struct.unpack("d", am.read_bytes(ptr, 48)[40:])[0] == 2.5
+
+    with pytest.raises(ValueError):
+        am.stack_allocator_view(allocator, ptr, 48, "d", (7,))
+    assert am.stack_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def test_reset_and_destroy_invalidate_views():
+    allocator = am.scratch_allocator_create(1 << 16, am.MIN_ALIGNMENT)
+    view = am.scratch_allocator_view(allocator, am.scratch_allocator_alloc(allocator, 32, 8), 32)
+
+    mv = memoryview(view)
+    with pytest.raises(BufferError):
+        am.scratch_allocator_reset(allocator)
+    with pytest.raises(BufferError):
+        am.scratch_allocator_destroy(allocator)
+    mv.release()
+
+    assert am.scratch_allocator_reset(allocator) == am.ERR_SUCCESS
+    assert not view.valid
+    with pytest.raises(BufferError):
+        memoryview(view)
+
+    fresh = am.scratch_allocator_view(allocator, am.scratch_allocator_alloc(allocator, 32, 8), 32)
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+    assert not fresh.valid
+    with pytest.raises(BufferError):
+        memoryview(fresh)
+
+
+def test_unwind_invalidates_only_inner_scope_views():
+    allocator = am.stack_allocator_create(1 << 16, am.MIN_ALIGNMENT, am.LAZY)
+    outer = am.stack_allocator_view(allocator, am.stack_allocator_alloc(allocator, 16, 8), 16)
+    assert am.stack_allocator_record(allocator) == am.ERR_SUCCESS
+    inner = am.stack_allocator_view(allocator, am.stack_allocator_alloc(allocator, 16, 8), 16)
+
+    with memoryview(inner):
+        with pytest.raises(BufferError):
+            am.stack_allocator_unwind(allocator)
+
+    outer_mv = memoryview(outer)  # exports from an enclosing scope do not block the unwind
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+    outer_mv.release()
+    assert outer.valid and not inner.valid
+
+    # A new scope at the same depth does not revive views from the unwound one.
+    assert am.stack_allocator_record(allocator) == am.ERR_SUCCESS
+    assert not inner.valid
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_destroy(allocator) == am.ERR_SUCCESS
@@ -0,0 +1,72 @@
+"""Tests for allocator statistics and the capacity right-sizing advisor."""
+
+import anvil_memory as am
+
+PAGE = 4096
+
+
+def test_stack_stats_track_scope_and_reset_peaks():
+    allocator = am.stack_allocator_create(1 << 20, am.MIN_ALIGNMENT, am.LAZY)
+    assert am.stack_allocator_record(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 3000, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 1000, am.MIN_ALIGNMENT) is not None
+
+    stats = am.stack_allocator_stats(allocator)
+    assert stats["allocated"] == 1000
+    assert stats["peak"] == 3000
+    assert stats["committed"] >= stats["allocated"]
+
+    assert am.stack_allocator_reset(allocator) == am.ERR_SUCCESS
+    stats = am.stack_allocator_stats(allocator)
+    assert stats["reset_count"] == 1
+    assert stats["peak"] == 0
+    assert stats["recommended_capacity"] == 0
+
+    assert am.stack_allocator_alloc(allocator, 2 << 20, am.MIN_ALIGNMENT) is None
+    assert am.stack_allocator_stats(allocator)["exhaustion_count"] == 1
+    assert am.stack_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def test_advisor_recommends_from_observed_peaks():
+    advisor = am.capacity_advisor_create(16, am.ADVISORY)
+    allocator = am.scratch_allocator_create(1 << 20, am.MIN_ALIGNMENT)
+    assert am.scratch_allocator_attach_advisor(allocator, advisor) == am.ERR_SUCCESS
+
+    for _ in range(32):
+        assert am.scratch_allocator_alloc(allocator, 10000, am.MIN_ALIGNMENT) is not None
+        assert am.scratch_allocator_reset(allocator) == am.ERR_SUCCESS
+
+    recommendation = am.capacity_advisor_recommend(advisor)
+    assert recommendation["observations"] == 16
+    assert recommendation["reset_p50"] == 10000
+    assert recommendation["reset_max"] == 10000
+    assert 10000 < recommendation["capacity"] < (1 << 20)
+    assert recommendation["capacity"] % PAGE == 0
+
+    stats = am.scratch_allocator_stats(allocator)
+    assert stats["recommended_capacity"] == recommendation["capacity"]
+    assert stats["recommended_commit_chunk"] == recommendation["commit_chunk"]
+
+    assert am.scratch_allocator_attach_advisor(allocator, None) == am.ERR_SUCCESS
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+    assert am.capacity_advisor_destroy(advisor) == am.ERR_SUCCESS
+
+
+def test_adaptive_advisor_releases_unused_commit():
+    advisor = am.capacity_advisor_create(8, am.ADAPTIVE)
+    allocator = am.stack_allocator_create(64 << 20, am.MIN_ALIGNMENT, am.LAZY)
+    assert am.stack_allocator_attach_advisor(allocator, advisor) == am.ERR_SUCCESS
+
+    assert am.stack_allocator_alloc(allocator, 16 << 20, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_reset(allocator) == am.ERR_SUCCESS
+    for _ in range(16):
+        assert am.stack_allocator_alloc(allocator, 8192, am.MIN_ALIGNMENT) is not None
+        assert am.stack_allocator_reset(allocator) == am.ERR_SUCCESS
+
+    stats = am.stack_allocator_stats(allocator)
+    assert stats["committed"] < (1 << 20)
+
+    assert am.stack_allocator_attach_advisor(allocator, None) == am.ERR_SUCCESS
+    assert am.stack_allocator_destroy(allocator) == am.ERR_SUCCESS
+    assert am.capacity_advisor_destroy(advisor) == am.ERR_SUCCESS
@@ -0,0 +1,88 @@
+"""Tests for the runtime configuration read from ANVIL_CONFIG and ANVIL_* environment variables."""
+
+import json
+import os
+import subprocess
+import sys
+import textwrap
+
+import anvil_memory as am
+
+
+def resolve_in_child(tmp_path, config, env, name="frame-scratch"):
+    # The configuration is read once per process, so every case runs in a fresh interpreter.
+    path = tmp_path / "anvil.conf"
+    path.write_text(textwrap.dedent(config))
+    script = textwrap.dedent(f"""
+        import json
+        import anvil_memory as am
+        print(json.dumps([am.config_load(), am.config_resolve({name!r}, 1 << 20, 16, am.EAGER)]))
+    """)
+    child_env = {k: v for k, v in os.environ.items() if not k.startswith("ANVIL_")}
+    child_env.update(ANVIL_CONFIG=str(path), PYTHONPATH=os.pathsep.join(sys.path))
+    child_env.update(env)
+    result = subprocess.run([sys.executable, "-c", script], env=child_env, capture_output=True, text=True,
+                            timeout=120, check=True)
+    return json.loads(result.stdout)
+
+
+def test_environment_overrides_file_and_file_overrides_call_site(tmp_path):
+    status, config = resolve_in_child(tmp_path, """
+        capacity = 2M          # every arena
+        [frame-scratch]
+        strategy = lazy
+        commit_chunk = 128K
+        mapping = dontfork, dontdump
+    """, {"ANVIL_ARENA_FRAME_SCRATCH_CAPACITY": "8M", "ANVIL_ALIGNMENT": "64"})
+    assert status == am.ERR_SUCCESS
+    assert config == {
+        "capacity": 8 << 20,
+        "alignment": 64,
+        "strategy": am.LAZY,
+        "commit_chunk": 128 << 10,
+        "mapping_flags": am.MAPPING_DONTFORK | am.MAPPING_DONTDUMP,
+    }
+
+
+def test_other_arenas_only_see_global_keys(tmp_path):
+    status, config = resolve_in_child(tmp_path, """
+        capacity = 2M
+        [frame-scratch]
+        strategy = guarded
+    """, {}, name="uploads")
+    assert status == am.ERR_SUCCESS
+    assert (config["capacity"], config["strategy"], config["alignment"]) == (2 << 20, am.EAGER, 16)
+
+
+def test_malformed_entries_are_reported_and_skipped(tmp_path):
+    status, config = resolve_in_child(tmp_path, """
+        alignment = 3
+        [frame-scratch]
+        strategy = sometimes
+        capacity = 4M
+    """, {"ANVIL_ARENA_FRAME_SCRATCH_PREFAULT": "1"})
+    assert status == am.ERR_INVALID_CONFIG
+    assert (config["capacity"], config["alignment"], config["strategy"]) == (4 << 20, 16, am.EAGER)
+
+
+def test_malformed_alignment_keeps_the_earlier_value(tmp_path):
+    status, config = resolve_in_child(tmp_path, """
+        [frame-scratch]
+        alignment = 64
+        alignment = 48
+    """, {})
+    assert status == am.ERR_INVALID_CONFIG
+    assert config["alignment"] == 64
+
+
+def test_unreadable_file_is_reported(tmp_path):
+    status, config = resolve_in_child(tmp_path, "", {"ANVIL_CONFIG": str(tmp_path / "missing.conf")})
+    assert status == am.ERR_IO_FAILURE
+    assert config["capacity"] == 1 << 20
+
+
+def test_environment_arena_names_are_normalized(tmp_path):
+    status, config = resolve_in_child(tmp_path, "", {"ANVIL_ARENA_frame_scratch_CAPACITY": "8M",
+                                                     "ANVIL_ARENA_frame_scratch_COMMIT_CHUNK": "64K"})
+    assert status == am.ERR_SUCCESS
+    assert (config["capacity"], config["commit_chunk"]) == (8 << 20, 64 << 10)
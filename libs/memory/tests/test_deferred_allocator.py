@@ -0,0 +1,68 @@
+"""Tests for deferred arena handles, which map their memory on the first allocation."""
+
+import anvil_memory as am
+
+CAPACITY = 1 << 16
+
+
+def test_handle_maps_nothing_until_first_alloc():
+    handle = am.deferred_allocator_create(CAPACITY, am.MIN_ALIGNMENT)
+    assert not am.deferred_allocator_mapped(handle)
+    assert am.deferred_allocator_stats(handle)["committed"] == 0
+
+    ptr = am.deferred_allocator_alloc(handle, 100, am.MIN_ALIGNMENT)
+    assert ptr is not None
+    assert am.deferred_allocator_mapped(handle)
+    am.write_bytes(ptr, b"a" * 100)
+    assert am.read_bytes(ptr, 100) == b"a" * 100
+
+    stats = am.deferred_allocator_stats(handle)
+    assert stats["allocated"] == 100
+    assert stats["committed"] == CAPACITY
+    assert am.deferred_allocator_destroy(handle) == am.ERR_SUCCESS
+
+
+def test_unused_handle_is_destroyed_without_mapping():
+    handles = [am.deferred_allocator_create(CAPACITY, am.MIN_ALIGNMENT) for _ in range(1000)]
+    assert not any(am.deferred_allocator_mapped(h) for h in handles)
+    assert all(am.deferred_allocator_destroy(h) == am.ERR_SUCCESS for h in handles)
+
+
+def test_exhaustion_is_reported_after_mapping():
+    handle = am.deferred_allocator_create(CAPACITY, am.MIN_ALIGNMENT)
+    assert am.deferred_allocator_alloc(handle, CAPACITY, am.MIN_ALIGNMENT) is not None
+
+    ptr, err = am.deferred_allocator_try_alloc(handle, 1, am.MIN_ALIGNMENT)
+    assert ptr is None
+    assert err == am.ERR_OUT_OF_MEMORY
+    assert am.deferred_allocator_stats(handle)["exhaustion_count"] == 1
+
+    assert am.deferred_allocator_reset(handle) == am.ERR_SUCCESS
+    ptr, err = am.deferred_allocator_try_alloc(handle, 1, am.MIN_ALIGNMENT)
+    assert ptr is not None and err == am.ERR_SUCCESS
+    assert am.deferred_allocator_stats(handle)["reset_count"] == 1
+    assert am.deferred_allocator_destroy(handle) == am.ERR_SUCCESS
+
+
+def test_first_alloc_larger_than_capacity_does_not_map():
+    handle = am.deferred_allocator_create(CAPACITY, am.MIN_ALIGNMENT, am.MAPPING_DONTDUMP)
+    ptr, err = am.deferred_allocator_try_alloc(handle, 2 * CAPACITY, am.MIN_ALIGNMENT)
+    assert ptr is None and err == am.ERR_OUT_OF_MEMORY
+    assert not am.deferred_allocator_mapped(handle)
+    assert am.deferred_allocator_stats(handle)["exhaustion_count"] == 1
+    assert am.deferred_allocator_alloc(handle, 64, am.MIN_ALIGNMENT) is not None
+    assert am.deferred_allocator_mapped(handle)
+    assert am.deferred_allocator_destroy(handle) == am.ERR_SUCCESS
+
+
+def test_peak_is_counted_since_the_last_reset():
+    handle = am.deferred_allocator_create(CAPACITY, am.MIN_ALIGNMENT)
+    assert am.deferred_allocator_alloc(handle, 1000, am.MIN_ALIGNMENT) is not None
+    assert am.deferred_allocator_stats(handle)["peak"] == 1000
+    assert am.deferred_allocator_reset(handle) == am.ERR_SUCCESS
+    assert am.deferred_allocator_alloc(handle, 100, am.MIN_ALIGNMENT) is not None
+
+    stats = am.deferred_allocator_stats(handle)
+    assert stats["allocated"] == 100
+    assert stats["peak"] == 100
+    assert am.deferred_allocator_destroy(handle) == am.ERR_SUCCESS
@@ -0,0 +1,151 @@
+"""Tests for the generational allocator: promotion, forwarding and compaction by evacuation."""
+
+import pytest
+
+import anvil_memory as am
+
+ALIGN = 16
+
+
+@pytest.fixture
+def allocator():
+    a = am.generational_allocator_create(1 << 16, 1 << 12, ALIGN)
+    assert a is not None
+    yield a
+    assert am.generational_allocator_destroy(a) == am.ERR_SUCCESS
+
+
+def young_object(allocator, payload: bytes):
+    ptr = am.generational_allocator_alloc(allocator, len(payload), ALIGN)
+    assert ptr is not None
+    am.write_bytes(ptr, payload)
+    return ptr
+
+
+def test_promoted_objects_survive_the_frame(allocator):
+    survivor = young_object(allocator, b"survivor")
+    young_object(allocator, b"garbage!" * 8)
+    kept = {}
+
+    def trace():
+        kept["survivor"] = am.generational_allocator_promote(allocator, survivor, 8)
+
+    assert am.generational_allocator_advance(allocator, trace) == am.ERR_SUCCESS
+    assert am.read_bytes(kept["survivor"], 8) == b"survivor"
+
+    stats = am.generational_allocator_stats(allocator)
+    assert stats["young"]["allocated"] == 0
+    assert stats["old"]["allocated"] == ALIGN
+    assert stats["promoted_count"] == 1
+    assert stats["promoted_bytes"] == 8
+
+
+def test_forwarding_translates_interior_addresses_until_the_next_alloc(allocator):
+    obj = young_object(allocator, bytes(range(32)))
+    copies = []
+    assert am.generational_allocator_advance(
+        allocator, lambda: copies.append(am.generational_allocator_promote(allocator, obj, 32))) == am.ERR_SUCCESS
+
+    copy = am.ptr_to_int(copies[0])
+    assert am.ptr_to_int(am.generational_allocator_forward(allocator, obj)) == copy
+    young_object(allocator, b"next frame")
+    assert am.ptr_to_int(am.generational_allocator_forward(allocator, obj)) == am.ptr_to_int(obj)
+
+
+def test_promoting_twice_returns_the_same_copy(allocator):
+    obj = young_object(allocator, b"once")
+    copies = []
+
+    def trace():
+        copies.append(am.generational_allocator_promote(allocator, obj, 4))
+        copies.append(am.generational_allocator_promote(allocator, obj, 4))
+        # An object that already lives in the old generation is not copied again.
+        copies.append(am.generational_allocator_promote(allocator, copies[0], 4))
+
+    assert am.generational_allocator_advance(allocator, trace) == am.ERR_SUCCESS
+    assert len({am.ptr_to_int(c) for c in copies}) == 1
+    assert am.generational_allocator_stats(allocator)["promoted_count"] == 1
+
+
+def test_compaction_evacuates_live_objects_and_drops_the_rest(allocator):
+    objects = [young_object(allocator, bytes([i]) * 64) for i in range(8)]
+    old = []
+    assert am.generational_allocator_advance(
+        allocator, lambda: old.extend(am.generational_allocator_promote(allocator, o, 64) for o in objects)
+    ) == am.ERR_SUCCESS
+    assert am.generational_allocator_stats(allocator)["old"]["allocated"] == 8 * 64
+
+    live = old[1::2]
+    moved = []
+    assert am.generational_allocator_compact(
+        allocator, lambda: moved.extend(am.generational_allocator_promote(allocator, o, 64) for o in live)
+    ) == am.ERR_SUCCESS
+
+    for i, ptr in zip(range(1, 8, 2), moved):
+        assert am.read_bytes(ptr, 64) == bytes([i]) * 64
+    stats = am.generational_allocator_stats(allocator)
+    assert stats["old"]["allocated"] == 4 * 64
+    assert stats["evacuated_count"] == 4
+    assert stats["compaction_count"] == 1
+
+
+def test_full_old_generation_keeps_the_young_frame(allocator):
+    big = young_object(allocator, b"x" * (1 << 12))
+    assert am.generational_allocator_advance(
+        allocator, lambda: am.generational_allocator_promote(allocator, big, 1 << 12)) == am.ERR_SUCCESS
+
+    too_big = young_object(allocator, b"y" * 64)
+    results = []
+    assert am.generational_allocator_advance(
+        allocator, lambda: results.append(am.generational_allocator_promote(allocator, too_big, 64))
+    ) == am.ERR_OUT_OF_MEMORY
+    assert results == [None]
+    assert am.read_bytes(too_big, 64) == b"y" * 64
+
+    # Dropping the big object frees the old generation, after which the frame can be retried.
+    assert am.generational_allocator_compact(allocator, lambda: None) == am.ERR_SUCCESS
+    assert am.generational_allocator_advance(
+        allocator, lambda: results.append(am.generational_allocator_promote(allocator, too_big, 64))
+    ) == am.ERR_SUCCESS
+    assert am.read_bytes(results[-1], 64) == b"y" * 64
+
+
+def test_tracer_exceptions_propagate(allocator):
+    def trace():
+        raise RuntimeError("tracer failed")
+
+    with pytest.raises(RuntimeError, match="tracer failed"):
+        am.generational_allocator_advance(allocator, trace)
+
+
+def test_failed_evacuation_keeps_the_old_generation(allocator):
+    half = 1 << 11
+    objects = [young_object(allocator, bytes([i]) * half) for i in range(2)]
+    old = []
+    assert am.generational_allocator_advance(
+        allocator, lambda: old.extend(am.generational_allocator_promote(allocator, o, half) for o in objects)
+    ) == am.ERR_SUCCESS
+
+    # Promoting the second object and then a range over both copies more than a semispace holds.
+    results = []
+
+    def trace():
+        results.append(am.generational_allocator_promote(allocator, old[1], half))
+        results.append(am.generational_allocator_promote(allocator, old[0], 2 * half))
+
+    assert am.generational_allocator_compact(allocator, trace) == am.ERR_OUT_OF_MEMORY
+    assert results[0] is not None and results[1] is None
+    assert am.ptr_to_int(am.generational_allocator_forward(allocator, old[1])) == am.ptr_to_int(old[1])
+    for i, ptr in enumerate(old):
+        assert am.read_bytes(ptr, half) == bytes([i]) * half
+    stats = am.generational_allocator_stats(allocator)
+    assert stats["old"]["allocated"] == 2 * half
+    assert stats["compaction_count"] == 0
+
+    # The partial copy was dropped, so a compaction promoting each object once still fits.
+    moved = []
+    assert am.generational_allocator_compact(
+        allocator, lambda: moved.extend(am.generational_allocator_promote(allocator, o, half) for o in old)
+    ) == am.ERR_SUCCESS
+    for i, ptr in enumerate(moved):
+        assert am.read_bytes(ptr, half) == bytes([i]) * half
@@ -0,0 +1,69 @@
+"""Tests for guarded stack allocators, whose tail is committed by the SIGSEGV handler."""
+
+import ctypes
+import os
+import signal
+import subprocess
+import sys
+import textwrap
+
+import pytest
+
+import anvil_memory as am
+
+pytestmark = pytest.mark.skipif(not sys.platform.startswith("linux"), reason="fault-driven commits need Linux")
+
+
+def test_touching_unchecked_memory_commits_it():
+    with am.StackAllocator(1 << 22, 8, am.GUARDED) as allocator:
+        allocator.set_commit_chunk(1 << 16)
+        before = allocator.stats()["committed"]
+        addresses = [allocator.alloc_unchecked(4096, 8) for _ in range(256)]
+        assert addresses == sorted(addresses) and addresses[0] % 8 == 0
+        for address in addresses:
+            ctypes.memset(address, 0x5A, 4096)
+        assert allocator.stats()["committed"] >= before + 255 * 4096
+        assert ctypes.string_at(addresses[-1], 4096) == b"\x5a" * 4096
+
+        # Checked allocations keep working next to unchecked ones and still report exhaustion.
+        assert allocator.alloc(1 << 16) is not None
+        assert allocator.alloc(1 << 23) is None
+        assert allocator.stats()["exhaustion_count"] == 1
+
+
+def test_unchecked_requires_guarded_allocator():
+    with am.StackAllocator(1 << 16, 8, am.LAZY) as allocator:
+        with pytest.raises(ValueError):
+            allocator.alloc_unchecked(64)
+    with am.StackAllocator(1 << 16, 8, am.GUARDED) as allocator:
+        with pytest.raises(ValueError):
+            allocator.alloc_unchecked(am.GUARD_REGION_SIZE + 1)
+
+
+def test_unchecked_watermark_stays_within_the_capacity():
+    with am.StackAllocator(1 << 16, 8, am.GUARDED) as allocator:
+        for _ in range(16):
+            allocator.alloc_unchecked(4096, 1)
+        with pytest.raises(ValueError):
+            allocator.alloc_unchecked(1, 1)
+        assert allocator.stats()["allocated"] == 1 << 16
+        assert allocator.reset() == am.ERR_SUCCESS
+        assert allocator.alloc_unchecked(4096, 1) != 0
+
+
+def test_touching_past_the_capacity_is_reported():
+    script = "import ctypes\nimport anvil_memory as am\n" + textwrap.dedent("""
+        allocator = am.StackAllocator(1 << 16, 8, am.GUARDED)
+        while True:
+            try:
+                address = allocator.alloc_unchecked(4096, 8)
+            except ValueError:
+                break
+            ctypes.memset(address, 1, 4096)
+        # Runs from the last allocation into the guard region.
+        ctypes.memset(address, 1, 2 * 4096)
+    """)
+    env = dict(os.environ, PYTHONPATH=os.pathsep.join(sys.path))
+    result = subprocess.run([sys.executable, "-c", script], env=env, capture_output=True, text=True, timeout=120)
+    assert result.returncode == -signal.SIGSEGV
+    assert "anvil: unrecoverable fault in a guarded arena" in result.stderr
@@ -0,0 +1,113 @@
+"""Tests for the fork and core dump treatment of allocator arenas (MAPPING_* flags)."""
+
+import ctypes
+import os
+import sys
+
+import pytest
+
+import anvil_memory as am
+
+linux_only = pytest.mark.skipif(not sys.platform.startswith("linux"), reason="needs /proc/self/smaps")
+PAGE = 4096
+
+
+def vm_flags(address):
+    """VmFlags of the mapping that contains `address`, from /proc/self/smaps."""
+    inside = False
+    with open("/proc/self/smaps", encoding="ascii") as smaps:
+        for line in smaps:
+            head = line.split()[0]
+            if "-" in head and not head.endswith(":"):
+                lo, hi = (int(part, 16) for part in head.split("-"))
+                inside = lo <= address < hi
+            elif inside and head == "VmFlags:":
+                return set(line.split()[1:])
+    raise LookupError("address 0x%x is not mapped" % address)
+
+
+def tail_address(allocator):
+    """An address past the allocator's header page, where the mapping flags apply."""
+    address = allocator.alloc(4 * PAGE)
+    assert address is not None
+    return address + 3 * PAGE
+
+
+@linux_only
+def test_flags_are_applied_and_reverted():
+    with am.StackAllocator(1 << 20, mapping_flags=am.MAPPING_DONTFORK | am.MAPPING_DONTDUMP) as allocator:
+        assert allocator.mapping_flags == am.MAPPING_DONTFORK | am.MAPPING_DONTDUMP
+        address = tail_address(allocator)
+        assert {"dc", "dd"} <= vm_flags(address)
+
+        assert allocator.set_mapping_flags(am.MAPPING_NONE) == am.ERR_SUCCESS
+        assert allocator.mapping_flags == am.MAPPING_NONE
+        assert not {"dc", "dd"} & vm_flags(address)
+
+
+@linux_only
+def test_capsule_api_and_lazy_arenas():
+    allocator = am.scratch_allocator_create(1 << 20, 8, am.MAPPING_DONTDUMP)
+    assert am.scratch_allocator_mapping_flags(allocator) == am.MAPPING_DONTDUMP
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+    stack = am.stack_allocator_create(1 << 20, 8, am.LAZY)
+    assert am.stack_allocator_set_mapping_flags(stack, am.MAPPING_DONTDUMP) == am.ERR_SUCCESS
+    assert am.stack_allocator_mapping_flags(stack) == am.MAPPING_DONTDUMP
+    assert am.stack_allocator_destroy(stack) == am.ERR_SUCCESS
+
+    # Pages a lazy stack commits after the flags were set carry them too.
+    with am.StackAllocator(1 << 20, strategy=am.LAZY, mapping_flags=am.MAPPING_DONTDUMP) as allocator:
+        assert "dd" in vm_flags(tail_address(allocator))
+
+
+@linux_only
+@pytest.mark.parametrize("make", [
+    lambda flags: am.ScratchAllocator(1 << 20, mapping_flags=flags),
+    lambda flags: am.StackAllocator(1 << 20, strategy=am.EAGER, mapping_flags=flags),
+    lambda flags: am.StackAllocator(1 << 20, strategy=am.LAZY, mapping_flags=flags),
+    lambda flags: am.StackAllocator(1 << 20, strategy=am.GUARDED, mapping_flags=flags),
+], ids=["scratch", "eager", "lazy", "guarded"])
+def test_flags_cover_the_first_allocation(make):
+    with make(am.MAPPING_DONTDUMP) as allocator:
+        address = allocator.alloc(64)
+        assert address is not None
+        ctypes.memset(address, 0xAB, 64)
+        assert "dd" in vm_flags(address)
+
+
+@linux_only
+def test_flags_cover_the_first_deferred_allocation():
+    handle = am.deferred_allocator_create(1 << 20, am.MIN_ALIGNMENT, am.MAPPING_DONTDUMP)
+    address = am.ptr_to_int(am.deferred_allocator_alloc(handle, 64, am.MIN_ALIGNMENT))
+    assert address % PAGE == 0
+    ctypes.memset(address, 0xAB, 64)
+    assert "dd" in vm_flags(address)
+    assert am.deferred_allocator_destroy(handle) == am.ERR_SUCCESS
+
+
+def test_invalid_flags_raise():
+    with pytest.raises(ValueError):
+        am.ScratchAllocator(1 << 16, mapping_flags=1 << 5)
+    with am.StackAllocator(1 << 16) as allocator:
+        with pytest.raises(ValueError):
+            allocator.set_mapping_flags(1 << 5)
+        assert allocator.mapping_flags == am.MAPPING_NONE
+
+
+@pytest.mark.skipif(not hasattr(os, "fork"), reason="needs fork")
+def test_wipe_on_fork_child_sees_zeros():
+    with am.StackAllocator(1 << 20, mapping_flags=am.MAPPING_WIPEONFORK) as allocator:
+        # The first allocation, in the page right after the allocator, is wiped too.
+        address = allocator.alloc(64)
+        assert address is not None
+        ctypes.memset(address, 0xAB, 64)
+        pid = os.fork()
+        if pid == 0:
+            # The allocator header survives, so the child may reset and reuse the arena.
+            wiped = ctypes.string_at(address, 64) == bytes(64)
+            reusable = allocator.reset() == am.ERR_SUCCESS and allocator.alloc(64) is not None
+            os._exit(0 if wiped and reusable else 1)
+        _, status = os.waitpid(pid, 0)
+        assert os.waitstatus_to_exitcode(status) == 0
+        assert ctypes.string_at(address, 64) == b"\xab" * 64
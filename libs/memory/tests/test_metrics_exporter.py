@@ -0,0 +1,104 @@
+"""Tests for the allocator registry and the Prometheus metrics exporter."""
+
+import socket
+import time
+
+import anvil_memory as am
+
+
+def test_registered_allocators_are_rendered():
+    scratch = am.scratch_allocator_create(1 << 20, am.MIN_ALIGNMENT)
+    stack = am.stack_allocator_create(1 << 20, am.MIN_ALIGNMENT, am.LAZY)
+    assert am.registry_add(scratch, 'frame "main"') == am.ERR_SUCCESS
+    assert am.registry_add(stack, "stack") == am.ERR_SUCCESS
+    assert am.registry_size() == 2
+
+    assert am.scratch_allocator_alloc(scratch, 1000, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_alloc(stack, 100000, am.MIN_ALIGNMENT) is not None
+
+    text = am.metrics_render()
+    assert 'anvil_allocator_allocated_bytes{name="frame \\"main\\"",kind="scratch"} 1000' in text
+    assert 'anvil_allocator_allocated_bytes{name="stack",kind="stack"} 100000' in text
+    assert 'anvil_commit_latency_seconds_bucket{le="+Inf"}' in text
+    assert "anvil_registered_allocators 2" in text
+
+    assert am.registry_remove(scratch) == am.ERR_SUCCESS
+    assert am.registry_size() == 1
+    assert am.scratch_allocator_destroy(scratch) == am.ERR_SUCCESS
+    # Destroying a registered allocator removes it from the registry.
+    assert am.stack_allocator_destroy(stack) == am.ERR_SUCCESS
+    assert am.registry_size() == 0
+
+
+def test_tcp_exporter_serves_http():
+    allocator = am.scratch_allocator_create(1 << 16, am.MIN_ALIGNMENT)
+    assert am.registry_add(allocator, "served") == am.ERR_SUCCESS
+    exporter = am.metrics_exporter_start_tcp(0)
+    assert exporter is not None
+    try:
+        with socket.create_connection(("127.0.0.1", am.metrics_exporter_port(exporter)), timeout=5) as conn:
+            conn.sendall(b"GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n")
+            response = b""
+            while chunk := conn.recv(4096):
+                response += chunk
+    finally:
+        assert am.metrics_exporter_stop(exporter) == am.ERR_SUCCESS
+
+    head, _, body = response.decode().partition("\r\n\r\n")
+    assert head.startswith("HTTP/1.1 200 OK")
+    assert "text/plain; version=0.0.4" in head
+    assert 'anvil_allocator_capacity_bytes{name="served",kind="scratch"} 65536' in body
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def parse_samples(text):
+    """Samples of an exposition as {(metric, labels): value}; fails on a duplicate series."""
+    samples = {}
+    for line in text.splitlines():
+        if not line or line.startswith("#"):
+            continue
+        series, _, value = line.rpartition(" ")
+        assert series not in samples, "duplicate series " + series
+        samples[series] = float(value)
+    return samples
+
+
+def test_allocators_sharing_a_name_are_summed():
+    first = am.scratch_allocator_create(1 << 16, am.MIN_ALIGNMENT)
+    second = am.scratch_allocator_create(1 << 16, am.MIN_ALIGNMENT)
+    assert am.registry_add(first, "connection") == am.ERR_SUCCESS
+    assert am.registry_add(second, "connection") == am.ERR_SUCCESS
+    assert am.scratch_allocator_alloc(first, 100, am.MIN_ALIGNMENT) is not None
+    assert am.scratch_allocator_alloc(second, 200, am.MIN_ALIGNMENT) is not None
+
+    samples = parse_samples(am.metrics_render())
+    labels = '{name="connection",kind="scratch"}'
+    assert samples["anvil_allocator_allocated_bytes" + labels] == 300
+    assert samples["anvil_allocator_capacity_bytes" + labels] == 2 << 16
+    assert samples["anvil_allocator_instances" + labels] == 2
+    assert samples["anvil_registered_allocators"] == 2
+
+    assert am.scratch_allocator_destroy(first) == am.ERR_SUCCESS
+    assert am.scratch_allocator_destroy(second) == am.ERR_SUCCESS
+
+
+def test_stalled_client_does_not_block_stop():
+    # Enough distinct series that the response outgrows the socket buffers of both ends.
+    allocators = [am.scratch_allocator_create(1 << 12, am.MIN_ALIGNMENT) for _ in range(20000)]
+    for i, allocator in enumerate(allocators):
+        assert am.registry_add(allocator, "arena-%d" % i) == am.ERR_SUCCESS
+    exporter = am.metrics_exporter_start_tcp(0)
+    assert exporter is not None
+    conn = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    conn.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+    try:
+        conn.connect(("127.0.0.1", am.metrics_exporter_port(exporter)))
+        conn.sendall(b"GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n")
+        time.sleep(0.2)
+        started = time.monotonic()
+        assert am.metrics_exporter_stop(exporter) == am.ERR_SUCCESS
+        assert time.monotonic() - started < 5
+    finally:
+        conn.close()
+        for allocator in allocators:
+            assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
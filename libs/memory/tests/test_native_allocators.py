@@ -0,0 +1,81 @@
+"""Tests for the ScratchAllocator and StackAllocator classes."""
+
+import pytest
+
+import anvil_memory as am
+
+
+def test_scratch_context_manager_closes():
+    with am.ScratchAllocator(1 << 16, 16) as allocator:
+        address = allocator.alloc(100, 16)
+        assert address is not None and address % 16 == 0
+        assert allocator.stats()["allocated"] >= 100
+        assert allocator.reset() == am.ERR_SUCCESS
+        assert allocator.stats()["allocated"] == 0
+    assert allocator.closed
+    with pytest.raises(ValueError):
+        allocator.alloc(8)
+    assert allocator.close() == am.ERR_SUCCESS  # closing twice is a no-op
+
+
+def test_exhaustion_returns_none():
+    with am.ScratchAllocator(4096) as allocator:
+        assert allocator.alloc(4096) is not None
+        assert allocator.alloc(1) is None
+
+
+@pytest.mark.parametrize("cls", [am.ScratchAllocator, am.StackAllocator])
+def test_try_alloc_reports_the_failure_reason(cls):
+    with cls(4096) as allocator:
+        address, error = allocator.try_alloc(4096)
+        assert address is not None and error == am.ERR_SUCCESS
+        assert allocator.try_alloc(1) == (None, am.ERR_OUT_OF_MEMORY)
+        assert allocator.stats()["exhaustion_count"] == 1
+
+
+def test_invalid_arguments_raise():
+    with pytest.raises(ValueError):
+        am.ScratchAllocator(0)
+    with pytest.raises(ValueError):
+        am.StackAllocator(1 << 16, 3)
+    with pytest.raises(ValueError):
+        am.StackAllocator(1 << 16, 8, 12345)
+    with am.StackAllocator(1 << 16) as allocator:
+        with pytest.raises(ValueError):
+            allocator.alloc(0)
+        with pytest.raises(ValueError):
+            allocator.unwind()
+
+
+def test_stack_record_unwind_and_views():
+    with am.StackAllocator(1 << 20, 8, am.LAZY) as allocator:
+        outer = allocator.alloc(64, 8)
+        assert allocator.record() == am.ERR_SUCCESS
+        inner = allocator.alloc(64, 8)
+        view = allocator.view(inner, 64)
+        memoryview(view)[:3] = b"abc"
+        assert bytes(memoryview(view)[:3]) == b"abc"
+        assert allocator.unwind() == am.ERR_SUCCESS
+        assert not view.valid
+        assert allocator.alloc(64, 8) == inner
+        assert outer < inner
+
+
+def test_large_arena_lifecycle_releases_the_gil():
+    # Large arenas take the GIL-releasing path; the observable contract is unchanged.
+    allocator = am.StackAllocator(64 << 20, 64, am.LAZY)
+    assert allocator.alloc(1 << 20, 64) is not None
+    assert allocator.reset() == am.ERR_SUCCESS
+    assert allocator.close() == am.ERR_SUCCESS
+
+
+def test_alloc_many_returns_addresses():
+    np = pytest.importorskip("numpy")
+    with am.ScratchAllocator(1 << 12, 8) as allocator:
+        addresses = allocator.alloc_many([512, 512, 1024, 4096], 8)
+        assert addresses.dtype == np.uint64 and addresses.shape == (4,)
+        assert list(np.diff(addresses[:3])) == [512, 512]
+        assert addresses[3] == 0  # does not fit any more
+        with pytest.raises(ValueError):
+            allocator.alloc_many(np.array([8, 0]), 8)
+        assert allocator.stats()["allocated"] == 2048
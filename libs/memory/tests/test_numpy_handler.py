@@ -0,0 +1,85 @@
+"""Tests for the NumPy data-memory handler backed by an Anvil arena."""
+
+import pytest
+
+import anvil_memory as am
+
+np = pytest.importorskip("numpy")
+pytestmark = pytest.mark.skipif(not hasattr(am, "NumpyArena"), reason="built without NumPy headers")
+
+try:
+    from numpy._core.multiarray import get_handler_name
+except ImportError:  # NumPy < 2
+    from numpy.core.multiarray import get_handler_name
+
+
+def test_arrays_use_the_arena_inside_the_scope():
+    arena = am.NumpyArena(1 << 24, threshold=1 << 16)
+    with arena:
+        a = np.arange(1000, dtype=np.float64)
+        b = np.zeros((10, 10), dtype=np.int32)
+        assert get_handler_name(a) == "anvil_arena"
+        assert arena.stats()["arena_arrays"] == 2
+        assert b.sum() == 0 and a.sum() == 999 * 1000 / 2
+        del a, b
+    assert get_handler_name(np.empty(4)) != "anvil_arena"
+
+    stats = arena.stats()
+    assert stats["arena_arrays"] == 0 and stats["allocated"] == 0 and stats["resets"] == 1
+
+
+def test_large_arrays_get_dedicated_mappings():
+    arena = am.NumpyArena(1 << 20, threshold=1 << 16)
+    with arena:
+        big = np.ones(1 << 16, dtype=np.float64)
+        assert arena.stats()["mapped_arrays"] == 1
+        assert arena.stats()["arena_arrays"] == 0
+    assert big.sum() == 1 << 16
+    del big
+    assert arena.stats()["mapped_arrays"] == 0
+
+
+def test_resizing_large_arrays_remaps_them():
+    arena = am.NumpyArena(1 << 20, threshold=1 << 16)
+    with arena:
+        grown = np.arange(1 << 14, dtype=np.float64)
+        grown.resize(1 << 22, refcheck=False)  # realloc of a dedicated mapping goes through mremap
+        assert arena.stats()["mapped_arrays"] == 1
+        assert grown[: 1 << 14].sum() == (1 << 14) * ((1 << 14) - 1) / 2
+        assert not grown[1 << 14:].any()
+        grown.resize(1 << 15, refcheck=False)
+        assert grown.sum() == (1 << 14) * ((1 << 14) - 1) / 2
+    del grown
+    assert arena.stats()["mapped_arrays"] == 0
+
+
+def test_arrays_outliving_the_scope_defer_the_reset():
+    arena = am.NumpyArena(1 << 20)
+    with arena:
+        survivor = np.full(100, 7, dtype=np.int64)
+        scratch = np.zeros(100)
+        del scratch
+    stats = arena.stats()
+    assert stats["pending_reset"] and stats["resets"] == 0
+
+    with arena:
+        other = np.full(100, 1, dtype=np.int64)
+    assert survivor.sum() == 700 and other.sum() == 100
+
+    survivor.resize(1000, refcheck=False)  # realloc outside any scope moves the data off the arena
+    assert survivor[:100].sum() == 700
+    del other
+    stats = arena.stats()
+    assert not stats["pending_reset"] and stats["resets"] == 1 and stats["allocated"] == 0
+
+
+def test_exhausted_arena_falls_back_to_malloc():
+    arena = am.NumpyArena(1 << 14, threshold=1 << 20)
+    with arena:
+        arrays = [np.ones(512) for _ in range(8)]
+        stats = arena.stats()
+        assert stats["arena_arrays"] + stats["fallback_arrays"] == 8
+        assert stats["fallback_arrays"] > 0
+        assert sum(int(a.sum()) for a in arrays) == 8 * 512
+        del arrays
+    assert arena.stats()["fallback_arrays"] == 0
@@ -0,0 +1,81 @@
+"""Tests for the sampling allocation-site profiler."""
+
+import threading
+
+import anvil_memory as am
+
+
+def test_samples_are_attributed_to_their_allocator(tmp_path):
+    sampled = am.scratch_allocator_create(4 << 20, am.MIN_ALIGNMENT)
+    other = am.stack_allocator_create(1 << 16, am.MIN_ALIGNMENT, am.EAGER)
+    am.profiler_clear()
+    am.profiler_enable(1)
+    try:
+        # The first allocation arms the countdown; at a rate of one byte the following ones are sampled.
+        for _ in range(64):
+            assert am.scratch_allocator_alloc(sampled, 4096, am.MIN_ALIGNMENT) is not None
+    finally:
+        am.profiler_disable()
+
+    assert am.profiler_sample_count(sampled) > 0
+    assert am.profiler_sample_count(other) == 0
+    assert am.profiler_sample_count() == am.profiler_sample_count(sampled)
+
+    path = tmp_path / "anvil.heap"
+    assert am.profiler_dump(str(path), sampled) == am.ERR_SUCCESS
+    lines = path.read_text().splitlines()
+    assert lines[0].startswith("heap profile:")
+    assert lines[0].endswith("@ heap_v2/1")
+    assert "MAPPED_LIBRARIES:" in lines
+
+    am.profiler_clear()
+    assert am.profiler_sample_count() == 0
+    assert am.scratch_allocator_destroy(sampled) == am.ERR_SUCCESS
+    assert am.stack_allocator_destroy(other) == am.ERR_SUCCESS
+
+
+def test_disabled_profiler_records_nothing():
+    allocator = am.scratch_allocator_create(1 << 20, am.MIN_ALIGNMENT)
+    am.profiler_clear()
+    am.profiler_disable()
+    for _ in range(1024):
+        am.scratch_allocator_alloc(allocator, 512, am.MIN_ALIGNMENT)
+    assert am.profiler_sample_count() == 0
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def test_allocations_while_disabled_leave_the_countdown_alone():
+    allocator = am.scratch_allocator_create(1 << 20, am.MIN_ALIGNMENT)
+    am.profiler_clear()
+    am.profiler_enable(1)
+    try:
+        for _ in range(8):
+            am.scratch_allocator_alloc(allocator, 64, am.MIN_ALIGNMENT)
+        am.profiler_disable()
+        am.profiler_clear()
+        # Disabled allocations skip the countdown; enabling again resumes it where it stopped.
+        for _ in range(1024):
+            am.scratch_allocator_alloc(allocator, 512, am.MIN_ALIGNMENT)
+        assert am.profiler_sample_count() == 0
+        am.profiler_enable(1)
+        am.scratch_allocator_alloc(allocator, 64, am.MIN_ALIGNMENT)
+        am.scratch_allocator_alloc(allocator, 64, am.MIN_ALIGNMENT)
+    finally:
+        am.profiler_disable()
+    assert am.profiler_sample_count(allocator) > 0
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
+
+
+def test_first_allocation_of_a_thread_only_arms_the_countdown():
+    allocator = am.scratch_allocator_create(1 << 20, am.MIN_ALIGNMENT)
+    am.profiler_clear()
+    am.profiler_enable(1 << 40)
+    try:
+        # A fresh thread starts with an expired countdown; its first allocation must not be recorded.
+        thread = threading.Thread(target=lambda: am.scratch_allocator_alloc(allocator, 64, am.MIN_ALIGNMENT))
+        thread.start()
+        thread.join()
+    finally:
+        am.profiler_disable()
+    assert am.profiler_sample_count() == 0
+    assert am.scratch_allocator_destroy(allocator) == am.ERR_SUCCESS
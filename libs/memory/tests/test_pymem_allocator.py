@@ -0,0 +1,67 @@
+"""Tests for the Anvil-backed PyMem allocator hook.
+
+Each test runs in a fresh interpreter so the hook never outlives the test that installed it.
+"""
+
+import os
+import subprocess
+import sys
+import textwrap
+
+import pytest
+
+
+def run_isolated(body: str) -> None:
+    script = "import anvil_memory as am\n" + textwrap.dedent(body)
+    env = dict(os.environ, PYTHONPATH=os.pathsep.join(sys.path))
+    result = subprocess.run([sys.executable, "-c", script], env=env, capture_output=True, text=True, timeout=120)
+    assert result.returncode == 0, result.stderr
+
+
+# Small RAW requests are rare in a plain workload; large ones reach RAW through pymalloc's fallback.
+@pytest.mark.parametrize("domain,pooled", [("PYMEM_DOMAIN_RAW", False), ("PYMEM_DOMAIN_MEM", True),
+                                           ("PYMEM_DOMAIN_OBJ", True)])
+def test_small_requests_are_pooled(domain, pooled):
+    run_isolated(f"""
+        domain = am.{domain}
+        assert am.pymem_install(domain, 1 << 26) == am.ERR_SUCCESS
+        data = [{{"key": str(i), "values": list(range(i % 7))}} for i in range(20000)]
+        big = bytearray(1 << 20)
+        stats = am.pymem_stats(domain)
+        assert stats["installed"] and stats["enabled"]
+        assert stats["pooled_allocs"] + stats["forwarded_allocs"] > 0
+        if {pooled}:
+            assert stats["pooled_allocs"] > 0 and stats["live_blocks"] > 0 and stats["chunks"] > 0
+        assert sum(len(d["values"]) for d in data) == sum(i % 7 for i in range(20000))
+        del data, big
+    """)
+
+
+def test_uninstall_drains_until_pooled_blocks_are_freed():
+    run_isolated("""
+        domain = am.PYMEM_DOMAIN_MEM
+        assert am.pymem_install(domain, 1 << 26, 256) == am.ERR_SUCCESS
+        keep = [[i] * 3 for i in range(1000)]  # list storage is a MEM request
+        live = am.pymem_stats(domain)["live_blocks"]
+        if am.pymem_uninstall(domain):
+            assert live == 0
+        else:
+            stats = am.pymem_stats(domain)
+            assert stats["installed"] and not stats["enabled"]
+            before = stats["forwarded_allocs"]
+            more = [[i] * 3 for i in range(1000)]
+            assert am.pymem_stats(domain)["forwarded_allocs"] > before
+            assert am.pymem_install(domain) == am.ERR_SUCCESS
+            assert am.pymem_stats(domain)["enabled"]
+            del more
+        del keep
+    """)
+
+
+def test_rejects_unknown_domain():
+    import anvil_memory as am
+
+    with pytest.raises(ValueError):
+        am.pymem_install(7)
+    with pytest.raises(ValueError):
+        am.pymem_install(am.PYMEM_DOMAIN_OBJ, 1 << 20, 4096)
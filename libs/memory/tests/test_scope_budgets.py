@@ -0,0 +1,68 @@
+"""Tests for per-scope byte budgets of stack allocators."""
+
+import pytest
+
+import anvil_memory as am
+
+CAPACITY = 1 << 20
+
+
+@pytest.fixture(params=[am.EAGER, am.LAZY], ids=["eager", "lazy"])
+def allocator(request):
+    a = am.stack_allocator_create(CAPACITY, am.MIN_ALIGNMENT, request.param)
+    assert a is not None
+    yield a
+    assert am.stack_allocator_destroy(a) == am.ERR_SUCCESS
+
+
+def test_scope_fails_past_its_budget_while_the_arena_has_room(allocator):
+    assert am.stack_allocator_record(allocator, 4096) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 4000, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_alloc(allocator, 96, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_alloc(allocator, 1, am.MIN_ALIGNMENT) is None
+
+    stats = am.stack_allocator_stats(allocator)
+    assert stats["allocated"] == 4096
+    assert stats["exhaustion_count"] == 0
+
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 1 << 16, am.MIN_ALIGNMENT) is not None
+
+
+def test_try_alloc_reports_budget_exhaustion():
+    allocator = am.StackAllocator(CAPACITY, am.MIN_ALIGNMENT, am.LAZY)
+    assert allocator.record(1024) == am.ERR_SUCCESS
+    assert allocator.try_alloc(2048)[1] == am.ERR_BUDGET_EXHAUSTED
+    assert allocator.try_alloc(2 * CAPACITY)[1] == am.ERR_OUT_OF_MEMORY
+    address, error = allocator.try_alloc(1024)
+    assert address is not None and error == am.ERR_SUCCESS
+    assert allocator.unwind() == am.ERR_SUCCESS
+
+
+def test_nested_scopes_inherit_the_remaining_budget(allocator):
+    assert am.stack_allocator_record(allocator, 1000) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 600, am.MIN_ALIGNMENT) is not None
+
+    # A larger budget cannot widen what is left of the enclosing one.
+    assert am.stack_allocator_record(allocator, 10000) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 401, am.MIN_ALIGNMENT) is None
+    assert am.stack_allocator_alloc(allocator, 400, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+
+    # A smaller one narrows it until its own unwind, and a scope without a budget keeps the inherited one.
+    assert am.stack_allocator_record(allocator, 100) == am.ERR_SUCCESS
+    assert am.stack_allocator_record(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 101, am.MIN_ALIGNMENT) is None
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 100, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+
+    assert am.stack_allocator_alloc(allocator, 400, am.MIN_ALIGNMENT) is not None
+    assert am.stack_allocator_alloc(allocator, 1, am.MIN_ALIGNMENT) is None
+    assert am.stack_allocator_unwind(allocator) == am.ERR_SUCCESS
+
+
+def test_reset_drops_budgets(allocator):
+    assert am.stack_allocator_record(allocator, 64) == am.ERR_SUCCESS
+    assert am.stack_allocator_reset(allocator) == am.ERR_SUCCESS
+    assert am.stack_allocator_alloc(allocator, 1 << 16, am.MIN_ALIGNMENT) is not None